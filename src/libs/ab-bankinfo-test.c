@@ -0,0 +1,112 @@
+#include "plugins/bankinfo/generic/generic_p.h"
+
+#include <aqbanking/banking.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Test for the cache statistics of the generic bank info plugin.
+ *
+ * Reading the same entry of "banks.data" twice must be answered from the cache the second time.
+ */
+
+#define TEST_BANK1 "bankId=\"10000000\"\nbankName=\"Bundesbank\"\nlocation=\"Berlin\"\n\n"
+#define TEST_BANK2 "bankId=\"10010010\"\nbankName=\"Postbank\"\nlocation=\"Berlin\"\n\n"
+
+
+
+static int readBank(AB_BANKINFO_PLUGIN *bip, uint32_t pos, const char *expectedBankId)
+{
+  AB_BANKINFO *bi;
+  int result = 0;
+
+  bi = AB_BankInfoPluginGENERIC__ReadBankInfoAt(bip, pos);
+  if (bi == NULL) {
+    fprintf(stderr, "No bank at %u\n", (unsigned int) pos);
+    return -1;
+  }
+  if (AB_BankInfo_GetBankId(bi) == NULL || strcmp(AB_BankInfo_GetBankId(bi), expectedBankId) != 0) {
+    fprintf(stderr, "Bank at %u is \"%s\", expected \"%s\"\n",
+            (unsigned int) pos, AB_BankInfo_GetBankId(bi), expectedBankId);
+    result = -1;
+  }
+  AB_BankInfo_free(bi);
+  return result;
+}
+
+
+
+static int check(const char *step, AB_BANKINFO_PLUGIN *bip, uint32_t expectedHits, uint32_t expectedMisses)
+{
+  uint32_t hits;
+  uint32_t misses;
+
+  hits = AB_BankInfoPluginGENERIC_GetCacheHits(bip);
+  misses = AB_BankInfoPluginGENERIC_GetCacheMisses(bip);
+  if (hits != expectedHits || misses != expectedMisses) {
+    fprintf(stderr, "%s: %u hits and %u misses, expected %u and %u\n",
+            step, (unsigned int) hits, (unsigned int) misses,
+            (unsigned int) expectedHits, (unsigned int) expectedMisses);
+    return -1;
+  }
+  return 0;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+  AB_BANKINFO_PLUGIN *bip;
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+  char dataDir[] = "bankinfo-tmp.XXXXXX";
+  char fname[256];
+  FILE *f;
+  uint32_t pos2;
+  int result = 0;
+
+  if (mkdtemp(dataDir) == NULL) {
+    fprintf(stderr, "Could not create temporary folder\n");
+    return 1;
+  }
+  snprintf(fname, sizeof(fname), "%s/banks.data", dataDir);
+  f = fopen(fname, "w");
+  if (f == NULL) {
+    fprintf(stderr, "Could not create \"%s\"\n", fname);
+    rmdir(dataDir);
+    return 1;
+  }
+  fputs(TEST_BANK1, f);
+  fputs(TEST_BANK2, f);
+  fclose(f);
+  pos2 = strlen(TEST_BANK1);
+
+  bip = AB_BankInfoPluginGENERIC_new(NULL, "de");
+  bde = GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC, bip);
+  bde->dataDir = strdup(dataDir);
+
+  if (check("initial", bip, 0, 0))
+    result = -1;
+
+  if (readBank(bip, 0, "10000000") || check("first read", bip, 0, 1))
+    result = -1;
+  if (readBank(bip, 0, "10000000") || check("same entry", bip, 1, 1))
+    result = -1;
+  if (readBank(bip, pos2, "10010010") || check("other entry", bip, 1, 2))
+    result = -1;
+  if (readBank(bip, pos2, "10010010") || check("other entry again", bip, 2, 2))
+    result = -1;
+  if (readBank(bip, 0, "10000000") || check("first entry again", bip, 3, 2))
+    result = -1;
+
+  AB_BankInfoPlugin_free(bip);
+
+  unlink(fname);
+  rmdir(dataDir);
+
+  if (result == 0)
+    printf("Bank info cache statistics are correct.\n");
+  return result;
+}
@@ -0,0 +1,106 @@
+#include <aqbanking/banking.h>
+#include <aqbanking/types/imexporter_context.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Micro-benchmark for AB_ImExporterContext_AddTransaction() with a growing number of accounts.
+ *
+ * For every account count the same number of transactions is distributed over the accounts of a
+ * context. The time per transaction should stay flat, the linear search which was used before is
+ * measured for comparison.
+ */
+
+static const int accountCounts[] = { 4, 16, 64, 256, 1024, 4096, 0 };
+
+
+static AB_TRANSACTION *createTransaction(int account)
+{
+  AB_TRANSACTION *t;
+  char accountNumber[32];
+
+  snprintf(accountNumber, sizeof(accountNumber), "%010d", account);
+  t = AB_Transaction_new();
+  AB_Transaction_SetLocalBankCode(t, "20030000");
+  AB_Transaction_SetLocalAccountNumber(t, accountNumber);
+  return t;
+}
+
+
+static double runIndexed(int accounts, int transactions)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  clock_t start;
+  int i;
+
+  ctx = AB_ImExporterContext_new();
+  for (i = 0; i < accounts; i++)
+    AB_ImExporterContext_AddTransaction(ctx, createTransaction(i));
+
+  start = clock();
+  for (i = 0; i < transactions; i++)
+    AB_ImExporterContext_AddTransaction(ctx, createTransaction(rand() % accounts));
+  start = clock() - start;
+
+  if (AB_ImExporterContext_GetAccountInfoCount(ctx) != accounts)
+    fprintf(stderr, "Unexpected number of accounts (%d != %d)\n", AB_ImExporterContext_GetAccountInfoCount(ctx), accounts);
+  AB_ImExporterContext_free(ctx);
+  return ((double)start) / CLOCKS_PER_SEC;
+}
+
+
+static double runLinear(int accounts, int transactions)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  AB_IMEXPORTER_ACCOUNTINFO_LIST *ail;
+  clock_t start;
+  int i;
+
+  ctx = AB_ImExporterContext_new();
+  for (i = 0; i < accounts; i++)
+    AB_ImExporterContext_AddTransaction(ctx, createTransaction(i));
+  ail = AB_ImExporterContext_GetAccountInfoList(ctx);
+
+  start = clock();
+  for (i = 0; i < transactions; i++) {
+    AB_TRANSACTION *t;
+    AB_IMEXPORTER_ACCOUNTINFO *ai;
+
+    t = createTransaction(rand() % accounts);
+    ai = AB_ImExporterAccountInfo_List_GetByBankCodeAndAccountNumber(ail,
+                                                                    AB_Transaction_GetLocalBankCode(t),
+                                                                    AB_Transaction_GetLocalAccountNumber(t),
+                                                                    AB_AccountType_Unknown);
+    AB_ImExporterAccountInfo_AddTransaction(ai, t);
+  }
+  start = clock() - start;
+
+  AB_ImExporterContext_free(ctx);
+  return ((double)start) / CLOCKS_PER_SEC;
+}
+
+
+int main(int argc, char *argv[])
+{
+  int transactions = 100000;
+  int i;
+
+  if (argc > 1)
+    transactions = atoi(argv[1]);
+
+  printf("%d transactions per run\n", transactions);
+  printf("accounts   indexed    linear\n");
+  for (i = 0; accountCounts[i]; i++) {
+    double tIndexed, tLinear;
+
+    srand(1);
+    tIndexed = runIndexed(accountCounts[i], transactions);
+    srand(1);
+    tLinear = runLinear(accountCounts[i], transactions);
+    printf("%8d  %7.3fs  %7.3fs\n", accountCounts[i], tIndexed, tLinear);
+  }
+
+  return 0;
+}
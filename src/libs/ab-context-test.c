@@ -0,0 +1,261 @@
+#include <aqbanking/banking.h>
+#include <aqbanking/types/imexporter_context.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Test for the account info lookup in AB_ImExporterContext_AddTransaction().
+ *
+ * With many account infos the context uses a hash index. Every transaction must end up in the
+ * account info a linear search of the list finds first (or in a new one if there is none), also
+ * after account infos have been added, removed or changed once the index has been built.
+ */
+
+#define ACCOUNT_COUNT 32
+
+
+static void setKeys(AB_IMEXPORTER_ACCOUNTINFO *ai, int i)
+{
+  char buffer[32];
+
+  /* some account infos share a bank code and account number or an IBAN with an earlier one */
+  if (i % 8 != 6) {
+    snprintf(buffer, sizeof(buffer), "2003%04d", ((i % 4) == 3) ? (i - 1) % 3 : i % 3);
+    AB_ImExporterAccountInfo_SetBankCode(ai, buffer);
+    snprintf(buffer, sizeof(buffer), "%010d", ((i % 4) == 3) ? i - 1 : i);
+    AB_ImExporterAccountInfo_SetAccountNumber(ai, buffer);
+  }
+  if ((i % 4) == 0)
+    AB_ImExporterAccountInfo_SetAccountId(ai, i + 1);
+  if ((i % 4) == 1 || (i % 8) == 6) {
+    snprintf(buffer, sizeof(buffer), "DE%020d", i);
+    AB_ImExporterAccountInfo_SetIban(ai, buffer);
+  }
+  else if ((i % 4) == 3) {
+    snprintf(buffer, sizeof(buffer), "DE%020d", i - 2);
+    AB_ImExporterAccountInfo_SetIban(ai, buffer);
+  }
+}
+
+
+
+static AB_IMEXPORTER_ACCOUNTINFO *findLinear(AB_IMEXPORTER_ACCOUNTINFO_LIST *ail, const AB_TRANSACTION *t)
+{
+  AB_IMEXPORTER_ACCOUNTINFO *ai = NULL;
+  const char *s;
+
+  if (AB_Transaction_GetUniqueAccountId(t))
+    ai = AB_ImExporterAccountInfo_List_GetByAccountId(ail, AB_Transaction_GetUniqueAccountId(t));
+  if (ai == NULL) {
+    s = AB_Transaction_GetLocalIban(t);
+    if (s && *s)
+      ai = AB_ImExporterAccountInfo_List_GetByIban(ail, s);
+  }
+  if (ai == NULL)
+    ai = AB_ImExporterAccountInfo_List_GetByBankCodeAndAccountNumber(ail,
+                                                                    AB_Transaction_GetLocalBankCode(t),
+                                                                    AB_Transaction_GetLocalAccountNumber(t),
+                                                                    AB_AccountType_Unknown);
+  return ai;
+}
+
+
+
+static int checkRouting(AB_IMEXPORTER_CONTEXT *ctx, AB_TRANSACTION *t, const char *phase, int probe)
+{
+  AB_IMEXPORTER_ACCOUNTINFO_LIST *ail;
+  AB_IMEXPORTER_ACCOUNTINFO *expected;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  int count;
+
+  /* AB_ImExporterContext_GetAccountInfoList() doesn't invalidate the index */
+  ail = AB_ImExporterContext_GetAccountInfoList(ctx);
+  count = AB_ImExporterAccountInfo_List_GetCount(ail);
+  expected = findLinear(ail, t);
+
+  AB_ImExporterContext_AddTransaction(ctx, t);
+
+  ai = AB_ImExporterAccountInfo_List_First(ail);
+  while (ai) {
+    AB_TRANSACTION_LIST *tl;
+
+    tl = AB_ImExporterAccountInfo_GetTransactionList(ai);
+    if (tl && AB_Transaction_List_Last(tl) == t)
+      break;
+    ai = AB_ImExporterAccountInfo_List_Next(ai);
+  }
+
+  if (expected == NULL) {
+    if (ai == NULL || ai != AB_ImExporterAccountInfo_List_Last(ail) ||
+        AB_ImExporterAccountInfo_List_GetCount(ail) != count + 1) {
+      fprintf(stderr, "%s, probe %d: No new account info created\n", phase, probe);
+      return -1;
+    }
+  }
+  else if (ai != expected) {
+    fprintf(stderr, "%s, probe %d: Transaction added to the wrong account info\n", phase, probe);
+    return -1;
+  }
+
+  return 0;
+}
+
+
+
+static int runProbes(AB_IMEXPORTER_CONTEXT *ctx, const char *phase)
+{
+  int result = 0;
+  int k;
+
+  for (k = 0; k < ACCOUNT_COUNT + 4; k++) {
+    char iban[32];
+    char bankCode[32];
+    char accountNumber[32];
+    int probe;
+
+    for (probe = 0; probe < 7; probe++) {
+      AB_TRANSACTION *t;
+
+      t = AB_Transaction_new();
+      snprintf(bankCode, sizeof(bankCode), "2003%04d", k % 3);
+      snprintf(accountNumber, sizeof(accountNumber), "%010d", k);
+      switch (probe) {
+      case 0:
+        AB_Transaction_SetUniqueAccountId(t, k + 1);
+        break;
+      case 1:
+        snprintf(iban, sizeof(iban), "DE%020d", k);
+        AB_Transaction_SetLocalIban(t, iban);
+        break;
+      case 2:
+        /* IBANs are compared case-insensitively */
+        snprintf(iban, sizeof(iban), "de%020d", k);
+        AB_Transaction_SetLocalIban(t, iban);
+        break;
+      case 3:
+        AB_Transaction_SetLocalBankCode(t, bankCode);
+        AB_Transaction_SetLocalAccountNumber(t, accountNumber);
+        break;
+      case 4:
+        /* the account id takes precedence over the IBAN */
+        AB_Transaction_SetUniqueAccountId(t, k + 1);
+        snprintf(iban, sizeof(iban), "DE%020d", k + 1);
+        AB_Transaction_SetLocalIban(t, iban);
+        break;
+      case 5:
+        /* no keys at all, matches account infos without bank code and account number */
+        break;
+      default:
+        /* unknown account id and IBAN, falls back to bank code and account number */
+        AB_Transaction_SetUniqueAccountId(t, 100000 + k);
+        AB_Transaction_SetLocalIban(t, "DE99999999999999999999");
+        AB_Transaction_SetLocalBankCode(t, bankCode);
+        AB_Transaction_SetLocalAccountNumber(t, accountNumber);
+        break;
+      }
+
+      if (checkRouting(ctx, t, phase, k * 7 + probe))
+        result = -1;
+    }
+  }
+
+  return result;
+}
+
+
+
+static AB_IMEXPORTER_CONTEXT *createContext(void)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  int i;
+
+  ctx = AB_ImExporterContext_new();
+  for (i = 0; i < ACCOUNT_COUNT; i++) {
+    AB_IMEXPORTER_ACCOUNTINFO *ai;
+
+    ai = AB_ImExporterAccountInfo_new();
+    setKeys(ai, i);
+    AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  }
+  return ctx;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  AB_IMEXPORTER_ACCOUNTINFO_LIST *ail;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  int result = 0;
+  int i;
+
+  ctx = createContext();
+  if (runProbes(ctx, "initial"))
+    result = -1;
+  /* second round with the account infos created by the first one */
+  if (runProbes(ctx, "repeated"))
+    result = -1;
+
+  /* add account infos with keys of existing ones, the earlier ones must still win */
+  for (i = 0; i < 4; i++) {
+    ai = AB_ImExporterAccountInfo_new();
+    setKeys(ai, i * 5);
+    AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  }
+  if (runProbes(ctx, "after adding"))
+    result = -1;
+
+  /* remove account infos directly from the list, including the first and the last one */
+  ail = AB_ImExporterContext_GetAccountInfoList(ctx);
+  for (i = 0; i < 3; i++) {
+    ai = AB_ImExporterAccountInfo_List_First(ail);
+    if (i == 1)
+      ai = AB_ImExporterAccountInfo_List_Next(AB_ImExporterAccountInfo_List_Next(ai));
+    else if (i == 2)
+      ai = AB_ImExporterAccountInfo_List_Last(ail);
+    AB_ImExporterAccountInfo_List_Del(ai);
+    AB_ImExporterAccountInfo_free(ai);
+  }
+  if (runProbes(ctx, "after removing"))
+    result = -1;
+
+  /* remove one and add another directly via the list, the count stays the same */
+  ai = AB_ImExporterAccountInfo_List_First(ail);
+  ai = AB_ImExporterAccountInfo_List_Next(ai);
+  AB_ImExporterAccountInfo_List_Del(ai);
+  AB_ImExporterAccountInfo_free(ai);
+  ai = AB_ImExporterAccountInfo_new();
+  setKeys(ai, 9);
+  AB_ImExporterAccountInfo_List_Add(ai, ail);
+  if (runProbes(ctx, "after replacing"))
+    result = -1;
+
+  /* change keys of account infos handed out by the context */
+  ai = AB_ImExporterContext_GetFirstAccountInfo(ctx);
+  AB_ImExporterAccountInfo_SetIban(ai, "DE00000000000000000013");
+  AB_ImExporterAccountInfo_SetAccountId(ai, 22);
+  ai = AB_ImExporterAccountInfo_List_Next(AB_ImExporterAccountInfo_List_Next(ai));
+  AB_ImExporterAccountInfo_SetBankCode(ai, "20030001");
+  AB_ImExporterAccountInfo_SetAccountNumber(ai, "0000000004");
+  AB_ImExporterAccountInfo_SetIban(ai, NULL);
+  if (runProbes(ctx, "after changing"))
+    result = -1;
+
+  /* clearing the context must not leave stale entries */
+  AB_ImExporterContext_Clear(ctx);
+  for (i = 0; i < ACCOUNT_COUNT; i++) {
+    ai = AB_ImExporterAccountInfo_new();
+    setKeys(ai, ACCOUNT_COUNT - 1 - i);
+    AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  }
+  if (runProbes(ctx, "after clearing"))
+    result = -1;
+
+  AB_ImExporterContext_free(ctx);
+
+  if (result == 0)
+    printf("Account info lookup matches linear search.\n");
+  return result;
+}
@@ -0,0 +1,161 @@
+#include <gwenhywfar/db.h>
+#include <gwenhywfar/syncio_file.h>
+#include <aqbanking/banking.h>
+#include <aqbanking/types/imexporter_context_bin.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Load-time benchmark for context files.
+ *
+ * A context with the given number of transactions is written as text file and as binary file,
+ * then both files are loaded again (the text file the way aqbanking-cli reads it).
+ */
+
+#define TEXT_FILE   "ab-ctxbin-bench.ctx"
+#define BINARY_FILE "ab-ctxbin-bench.ctxb"
+
+
+static AB_IMEXPORTER_CONTEXT *createContext(int count)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  GWEN_DATE *dt;
+  int i;
+
+  ctx = AB_ImExporterContext_new();
+  ai = AB_ImExporterAccountInfo_new();
+  AB_ImExporterAccountInfo_SetBankCode(ai, "20030000");
+  AB_ImExporterAccountInfo_SetAccountNumber(ai, "0000000001");
+  dt = GWEN_Date_fromString("20261017");
+  for (i = 0; i < count; i++) {
+    AB_TRANSACTION *t;
+    AB_VALUE *v;
+    char buf[64];
+
+    snprintf(buf, sizeof(buf), "%d.%02d:EUR", i % 5000, i % 100);
+    v = AB_Value_fromString(buf);
+    t = AB_Transaction_new();
+    AB_Transaction_SetType(t, AB_Transaction_TypeStatement);
+    AB_Transaction_SetDate(t, dt);
+    AB_Transaction_SetValutaDate(t, dt);
+    AB_Transaction_SetValue(t, v);
+    AB_Transaction_SetRemoteName(t, "Some Remote Name");
+    AB_Transaction_SetRemoteIban(t, "DE02200300000000000002");
+    snprintf(buf, sizeof(buf), "Invoice %d", i);
+    AB_Transaction_AddPurposeLine(t, buf);
+    AB_Transaction_AddPurposeLine(t, "Thank you for your order");
+    AB_ImExporterAccountInfo_AddTransaction(ai, t);
+    AB_Value_free(v);
+  }
+  GWEN_Date_free(dt);
+  AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  return ctx;
+}
+
+
+
+static int writeFiles(AB_IMEXPORTER_CONTEXT *ctx)
+{
+  GWEN_DB_NODE *db;
+  GWEN_SYNCIO *sio;
+  int rv;
+
+  db = GWEN_DB_Group_new("context");
+  AB_ImExporterContext_toDb(ctx, db);
+  rv = GWEN_DB_WriteFile(db, TEXT_FILE, GWEN_DB_FLAGS_DEFAULT);
+  GWEN_DB_Group_free(db);
+  if (rv < 0)
+    return rv;
+
+  sio = GWEN_SyncIo_File_new(BINARY_FILE, GWEN_SyncIo_File_CreationMode_CreateAlways);
+  GWEN_SyncIo_AddFlags(sio, GWEN_SYNCIO_FILE_FLAGS_READ | GWEN_SYNCIO_FILE_FLAGS_WRITE |
+                       GWEN_SYNCIO_FILE_FLAGS_UREAD | GWEN_SYNCIO_FILE_FLAGS_UWRITE);
+  rv = GWEN_SyncIo_Connect(sio);
+  if (rv == 0) {
+    rv = AB_ImExporterContextBin_Write(ctx, sio);
+    GWEN_SyncIo_Disconnect(sio);
+  }
+  GWEN_SyncIo_free(sio);
+  return rv;
+}
+
+
+
+static double loadText(int *pCount)
+{
+  GWEN_DB_NODE *db;
+  AB_IMEXPORTER_CONTEXT *ctx;
+  clock_t start;
+
+  start = clock();
+  db = GWEN_DB_Group_new("context");
+  GWEN_DB_ReadFile(db, TEXT_FILE, GWEN_DB_FLAGS_DEFAULT | GWEN_PATH_FLAGS_CREATE_GROUP);
+  ctx = AB_ImExporterContext_fromDb(db);
+  GWEN_DB_Group_free(db);
+  start = clock() - start;
+
+  *pCount = ctx ? AB_ImExporterAccountInfo_GetTransactionCount(AB_ImExporterContext_GetFirstAccountInfo(ctx), 0, 0) : 0;
+  AB_ImExporterContext_free(ctx);
+  return ((double)start) / CLOCKS_PER_SEC;
+}
+
+
+
+static double loadBinary(int *pCount)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  clock_t start;
+  int rv;
+
+  start = clock();
+  ctx = AB_ImExporterContext_new();
+  rv = AB_ImExporterContextBin_ReadFile(ctx, BINARY_FILE);
+  start = clock() - start;
+
+  *pCount = (rv < 0) ? 0 : AB_ImExporterAccountInfo_GetTransactionCount(AB_ImExporterContext_GetFirstAccountInfo(ctx), 0, 0);
+  AB_ImExporterContext_free(ctx);
+  return ((double)start) / CLOCKS_PER_SEC;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  int count = 100000;
+  int countText = 0, countBinary = 0;
+  double tText, tBinary;
+  int rv;
+
+  if (argc > 1)
+    count = atoi(argv[1]);
+
+  ctx = createContext(count);
+  rv = writeFiles(ctx);
+  AB_ImExporterContext_free(ctx);
+  if (rv < 0) {
+    fprintf(stderr, "Error writing context files (%d)\n", rv);
+    return 1;
+  }
+
+  tText = loadText(&countText);
+  tBinary = loadBinary(&countBinary);
+  unlink(TEXT_FILE);
+  unlink(BINARY_FILE);
+  if (countText != count || countBinary != count) {
+    fprintf(stderr, "Transaction counts differ: %d/%d/%d\n", count, countText, countBinary);
+    return 1;
+  }
+
+  printf("%d transactions loaded per format\n", count);
+  printf("text file:        %.3fs\n", tText);
+  printf("binary file:      %.3fs\n", tBinary);
+  if (tBinary > 0.0)
+    printf("speedup:          %.2fx\n", tText / tBinary);
+
+  return 0;
+}
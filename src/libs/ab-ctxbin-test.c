@@ -0,0 +1,312 @@
+#include <gwenhywfar/buffer.h>
+#include <gwenhywfar/db.h>
+#include <gwenhywfar/syncio_memory.h>
+#include <aqbanking/banking.h>
+#include <aqbanking/types/imexporter_context_bin.h>
+#include <aqbanking/types/imexporter_context_cursor.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Round-trip test for binary context files.
+ *
+ * A context is written in binary format and read back from memory and from a file, the textual
+ * GWEN_DB representation of both contexts must be identical. Binary and textual data must be
+ * told apart, truncated data must be rejected. Cursors must walk through both kinds of files.
+ */
+
+
+static AB_IMEXPORTER_CONTEXT *createContext(void)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  int a;
+
+  ctx = AB_ImExporterContext_new();
+  for (a = 0; a < 3; a++) {
+    AB_IMEXPORTER_ACCOUNTINFO *ai;
+    AB_BALANCE *bal;
+    AB_VALUE *v;
+    GWEN_DATE *dt;
+    char accountNumber[32];
+    int i;
+
+    snprintf(accountNumber, sizeof(accountNumber), "%010d", a + 1);
+    ai = AB_ImExporterAccountInfo_new();
+    AB_ImExporterAccountInfo_SetBankCode(ai, "20030000");
+    AB_ImExporterAccountInfo_SetAccountNumber(ai, accountNumber);
+    AB_ImExporterAccountInfo_SetIban(ai, "DE02200300000000000001");
+    AB_ImExporterAccountInfo_SetOwner(ai, "J\xc3\xbcrgen M\xc3\xbcller");
+    AB_ImExporterAccountInfo_SetAccountId(ai, a + 1);
+
+    v = AB_Value_fromString("1234.56:EUR");
+    dt = GWEN_Date_fromString("20261017");
+    bal = AB_Balance_new();
+    AB_Balance_SetType(bal, AB_Balance_TypeBooked);
+    AB_Balance_SetValue(bal, v);
+    AB_Balance_SetDate(bal, dt);
+    AB_ImExporterAccountInfo_AddBalance(ai, bal);
+
+    /* the second account has no transactions */
+    for (i = 0; a != 1 && i < 10; i++) {
+      AB_TRANSACTION *t;
+
+      t = AB_Transaction_new();
+      AB_Transaction_SetType(t, AB_Transaction_TypeStatement);
+      AB_Transaction_SetDate(t, dt);
+      AB_Transaction_SetValutaDate(t, dt);
+      AB_Transaction_SetValue(t, v);
+      AB_Transaction_SetRemoteName(t, "Stra\xc3\x9f" "enbahn \"AG\"");
+      AB_Transaction_AddPurposeLine(t, "first line");
+      AB_Transaction_AddPurposeLine(t, "second line with = and # and \\");
+      AB_Transaction_SetUniqueId(t, (uint32_t)(a * 100 + i));
+      AB_ImExporterAccountInfo_AddTransaction(ai, t);
+    }
+    GWEN_Date_free(dt);
+    AB_Value_free(v);
+    AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  }
+
+  {
+    AB_SECURITY *sec;
+    AB_MESSAGE *msg;
+
+    sec = AB_Security_new();
+    AB_Security_SetName(sec, "Some Fund");
+    AB_Security_SetUniqueId(sec, "DE0001234567");
+    AB_ImExporterContext_AddSecurity(ctx, sec);
+
+    msg = AB_Message_new();
+    AB_Message_SetSource(msg, AB_Message_SourceBank);
+    AB_Message_SetSubject(msg, "Subject");
+    AB_Message_SetText(msg, "Text\nwith two lines");
+    AB_ImExporterContext_AddMessage(ctx, msg);
+  }
+
+  return ctx;
+}
+
+
+
+static int contextToString(const AB_IMEXPORTER_CONTEXT *ctx, GWEN_BUFFER *buf)
+{
+  GWEN_DB_NODE *db;
+  int rv;
+
+  db = GWEN_DB_Group_new("context");
+  rv = AB_ImExporterContext_toDb(ctx, db);
+  if (rv == 0)
+    rv = GWEN_DB_WriteToBuffer(db, buf, GWEN_DB_FLAGS_DEFAULT);
+  GWEN_DB_Group_free(db);
+  return rv;
+}
+
+
+
+static int writeFile(const char *fname, const char *ptr, uint32_t len)
+{
+  FILE *f;
+
+  f = fopen(fname, "wb");
+  if (f == NULL) {
+    fprintf(stderr, "Could not create \"%s\"\n", fname);
+    return -1;
+  }
+  if (len && fwrite(ptr, len, 1, f) != 1) {
+    fprintf(stderr, "Could not write \"%s\"\n", fname);
+    fclose(f);
+    return -1;
+  }
+  fclose(f);
+  return 0;
+}
+
+
+
+/* compare ctx2 to the expected textual representation in buf1, frees ctx2 */
+static int checkContext(const char *step, int rv, AB_IMEXPORTER_CONTEXT *ctx2, GWEN_BUFFER *buf1)
+{
+  GWEN_BUFFER *buf2;
+  int result = 0;
+
+  if (rv < 0) {
+    fprintf(stderr, "%s: Error reading context (%d)\n", step, rv);
+    AB_ImExporterContext_free(ctx2);
+    return -1;
+  }
+
+  buf2 = GWEN_Buffer_new(NULL, 4096, 0, 1);
+  if (contextToString(ctx2, buf2)) {
+    fprintf(stderr, "%s: Error writing context to db\n", step);
+    result = -1;
+  }
+  else if (strcmp(GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetStart(buf2)) != 0) {
+    fprintf(stderr, "%s: Contexts differ:\n%s\n---\n%s\n", step, GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetStart(buf2));
+    result = -1;
+  }
+  GWEN_Buffer_free(buf2);
+  AB_ImExporterContext_free(ctx2);
+  return result;
+}
+
+
+
+/* walk through a file with a cursor, returns the number of items or an error code */
+static int countCursorItems(const char *fname, int *pTransactions)
+{
+  AB_IMEXPORTER_CONTEXT_CURSOR *cur;
+  int items = 0;
+  int rv;
+
+  *pTransactions = 0;
+  rv = AB_ImExporterContextCursor_Open(fname, &cur);
+  if (rv < 0)
+    return rv;
+  while ((rv = AB_ImExporterContextCursor_Next(cur)) > 0) {
+    items++;
+    if (rv == AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_TRANSACTION) {
+      if (AB_ImExporterContextCursor_GetTransaction(cur) == NULL) {
+        rv = GWEN_ERROR_BAD_DATA;
+        break;
+      }
+      (*pTransactions)++;
+    }
+  }
+  AB_ImExporterContextCursor_free(cur);
+  return (rv < 0) ? rv : items;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+  AB_IMEXPORTER_CONTEXT *ctx1, *ctx2;
+  GWEN_BUFFER *binBuf, *buf1;
+  GWEN_SYNCIO *sio;
+  char dataDir[] = "ctxbin-tmp.XXXXXX";
+  char binFile[256];
+  char textFile[256];
+  int transactions;
+  int rv;
+  int result = 0;
+
+  ctx1 = createContext();
+  binBuf = GWEN_Buffer_new(NULL, 1024, 0, 1);
+  sio = GWEN_SyncIo_Memory_new(binBuf, 0);
+  rv = AB_ImExporterContextBin_Write(ctx1, sio);
+  GWEN_SyncIo_free(sio);
+  if (rv < 0) {
+    fprintf(stderr, "Error writing binary context (%d)\n", rv);
+    return 1;
+  }
+
+  buf1 = GWEN_Buffer_new(NULL, 4096, 0, 1);
+  if (contextToString(ctx1, buf1)) {
+    fprintf(stderr, "Error writing context to db\n");
+    return 1;
+  }
+  printf("%u bytes binary, %u bytes text\n", GWEN_Buffer_GetUsedBytes(binBuf), GWEN_Buffer_GetUsedBytes(buf1));
+
+  /* from memory */
+  ctx2 = AB_ImExporterContext_new();
+  rv = AB_ImExporterContextBin_ReadFromMemory(ctx2,
+                                              (const uint8_t *) GWEN_Buffer_GetStart(binBuf),
+                                              GWEN_Buffer_GetUsedBytes(binBuf));
+  if (checkContext("memory", rv, ctx2, buf1))
+    result = 1;
+
+  /* format detection in memory, as used for data read from stdin */
+  ctx2 = AB_ImExporterContext_new();
+  rv = AB_ImExporterContextBin_ReadAnyFromMemory(ctx2,
+                                                 (const uint8_t *) GWEN_Buffer_GetStart(binBuf),
+                                                 GWEN_Buffer_GetUsedBytes(binBuf));
+  if (checkContext("binary data of unknown format", rv, ctx2, buf1))
+    result = 1;
+  ctx2 = AB_ImExporterContext_new();
+  rv = AB_ImExporterContextBin_ReadAnyFromMemory(ctx2,
+                                                 (const uint8_t *) GWEN_Buffer_GetStart(buf1),
+                                                 GWEN_Buffer_GetUsedBytes(buf1));
+  if (checkContext("text data of unknown format", rv, ctx2, buf1))
+    result = 1;
+  if (AB_ImExporterContextBin_IsBinary((const uint8_t *) GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetUsedBytes(buf1))) {
+    fprintf(stderr, "Text data detected as binary\n");
+    result = 1;
+  }
+
+  /* from files (mapped into memory if possible) */
+  if (mkdtemp(dataDir) == NULL) {
+    fprintf(stderr, "Could not create temporary folder\n");
+    return 1;
+  }
+  snprintf(binFile, sizeof(binFile), "%s/ctx.bin", dataDir);
+  snprintf(textFile, sizeof(textFile), "%s/ctx.txt", dataDir);
+  if (writeFile(binFile, GWEN_Buffer_GetStart(binBuf), GWEN_Buffer_GetUsedBytes(binBuf)) ||
+      writeFile(textFile, GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetUsedBytes(buf1)))
+    result = 1;
+  else {
+    if (AB_ImExporterContextBin_IsBinaryFile(binFile) != 1) {
+      fprintf(stderr, "Binary file not detected\n");
+      result = 1;
+    }
+    if (AB_ImExporterContextBin_IsBinaryFile(textFile) != 0) {
+      fprintf(stderr, "Text file detected as binary\n");
+      result = 1;
+    }
+
+    ctx2 = AB_ImExporterContext_new();
+    rv = AB_ImExporterContextBin_ReadFile(ctx2, binFile);
+    if (checkContext("file", rv, ctx2, buf1))
+      result = 1;
+
+    ctx2 = AB_ImExporterContext_new();
+    rv = AB_ImExporterContextBin_ReadFile(ctx2, textFile);
+    if (rv != GWEN_ERROR_BAD_DATA) {
+      fprintf(stderr, "Text file not rejected (%d)\n", rv);
+      result = 1;
+    }
+    AB_ImExporterContext_free(ctx2);
+
+    /* 3 account infos with 20 transactions */
+    rv = countCursorItems(binFile, &transactions);
+    if (rv != 23 || transactions != 20) {
+      fprintf(stderr, "Binary file cursor: %d items, %d transactions\n", rv, transactions);
+      result = 1;
+    }
+    rv = countCursorItems(textFile, &transactions);
+    if (rv != 23 || transactions != 20) {
+      fprintf(stderr, "Text file cursor: %d items, %d transactions\n", rv, transactions);
+      result = 1;
+    }
+
+    /* record size beyond the end of the file */
+    if (writeFile(binFile, "ABCT\0\1\0\0\2\x7f\xff\xff\xff", 13) == 0) {
+      rv = countCursorItems(binFile, &transactions);
+      if (rv != GWEN_ERROR_BAD_DATA) {
+        fprintf(stderr, "Bad record size not rejected (%d)\n", rv);
+        result = 1;
+      }
+    }
+  }
+  unlink(textFile);
+  unlink(binFile);
+  rmdir(dataDir);
+
+  /* missing END record */
+  ctx2 = AB_ImExporterContext_new();
+  rv = AB_ImExporterContextBin_ReadFromMemory(ctx2,
+                                              (const uint8_t *) GWEN_Buffer_GetStart(binBuf),
+                                              GWEN_Buffer_GetUsedBytes(binBuf) - 1);
+  if (rv != GWEN_ERROR_BAD_DATA) {
+    fprintf(stderr, "Truncated data not rejected (%d)\n", rv);
+    result = 1;
+  }
+  AB_ImExporterContext_free(ctx2);
+
+  GWEN_Buffer_free(buf1);
+  GWEN_Buffer_free(binBuf);
+  AB_ImExporterContext_free(ctx1);
+
+  return result;
+}
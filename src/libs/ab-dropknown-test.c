@@ -0,0 +1,183 @@
+#include <aqbanking/banking.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/*
+ * Test for AB_Banking_DropKnownTransactions() and AB_Banking_AddKnownTransactions().
+ *
+ * Only statement transactions remembered by an earlier call to AB_Banking_AddKnownTransactions() may
+ * be dropped, and of identical statement transactions only as many as have been remembered.
+ * A hash store file with an incomplete header must be treated as empty.
+ */
+
+#define TEST_IBAN "DE02200300000000000001"
+
+
+
+static void addTransaction(AB_IMEXPORTER_ACCOUNTINFO *ai, AB_TRANSACTION_TYPE ty, const char *name, const char *value)
+{
+  AB_TRANSACTION *t;
+  AB_VALUE *v;
+  GWEN_DATE *dt;
+
+  v = AB_Value_fromString(value);
+  dt = GWEN_Date_fromString("20261017");
+  t = AB_Transaction_new();
+  AB_Transaction_SetType(t, ty);
+  AB_Transaction_SetDate(t, dt);
+  AB_Transaction_SetValutaDate(t, dt);
+  AB_Transaction_SetValue(t, v);
+  AB_Transaction_SetRemoteName(t, name);
+  AB_Transaction_AddPurposeLine(t, "purpose");
+  AB_ImExporterAccountInfo_AddTransaction(ai, t);
+  GWEN_Date_free(dt);
+  AB_Value_free(v);
+}
+
+
+
+/* identical statements "A", statement "B", optionally statement "C" and a transfer equal to "A" */
+static AB_IMEXPORTER_CONTEXT *createContext(int countA, int withC)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  int i;
+
+  ctx = AB_ImExporterContext_new();
+  ai = AB_ImExporterAccountInfo_new();
+  AB_ImExporterAccountInfo_SetIban(ai, TEST_IBAN);
+  for (i = 0; i < countA; i++)
+    addTransaction(ai, AB_Transaction_TypeStatement, "A", "10:EUR");
+  addTransaction(ai, AB_Transaction_TypeStatement, "B", "-20:EUR");
+  if (withC)
+    addTransaction(ai, AB_Transaction_TypeStatement, "C", "30:EUR");
+  addTransaction(ai, AB_Transaction_TypeTransfer, "A", "10:EUR");
+  AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  return ctx;
+}
+
+
+
+static int countTransactions(const AB_IMEXPORTER_CONTEXT *ctx, int ty)
+{
+  const AB_TRANSACTION *t;
+  int count = 0;
+
+  t = AB_ImExporterAccountInfo_GetFirstTransaction(AB_ImExporterContext_GetFirstAccountInfo(ctx), ty, 0);
+  while (t) {
+    count++;
+    t = AB_Transaction_List_FindNextByType(t, ty, 0);
+  }
+  return count;
+}
+
+
+
+static int check(const char *step, int rv, int expectedRv,
+                 const AB_IMEXPORTER_CONTEXT *ctx, int expectedStatements)
+{
+  int result = 0;
+
+  if (rv != expectedRv) {
+    fprintf(stderr, "%s: Returned %d, expected %d\n", step, rv, expectedRv);
+    result = -1;
+  }
+  if (countTransactions(ctx, AB_Transaction_TypeStatement) != expectedStatements) {
+    fprintf(stderr, "%s: %d statements left, expected %d\n",
+            step, countTransactions(ctx, AB_Transaction_TypeStatement), expectedStatements);
+    result = -1;
+  }
+  if (countTransactions(ctx, AB_Transaction_TypeTransfer) != 1) {
+    fprintf(stderr, "%s: Transfer has been dropped\n", step);
+    result = -1;
+  }
+  return result;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+  AB_BANKING *ab;
+  AB_IMEXPORTER_CONTEXT *ctx;
+  char dataDir[] = "dropknown-tmp.XXXXXX";
+  char fname[256];
+  FILE *f;
+  int rv;
+  int result = 0;
+
+  if (mkdtemp(dataDir) == NULL) {
+    fprintf(stderr, "Could not create temporary folder\n");
+    return 1;
+  }
+  ab = AB_Banking_new("ab-dropknown-test", dataDir, 0);
+
+  /* writing the header of the store has been interrupted */
+  snprintf(fname, sizeof(fname), "%s/transactionhashes", dataDir);
+  mkdir(fname, 0700);
+  snprintf(fname, sizeof(fname), "%s/transactionhashes/" TEST_IBAN ".hashes", dataDir);
+  f = fopen(fname, "wb");
+  if (f) {
+    fputs("ABH", f);
+    fclose(f);
+  }
+
+  /* nothing known yet, identical statements must not drop each other */
+  ctx = createContext(2, 0);
+  rv = AB_Banking_DropKnownTransactions(ab, ctx);
+  if (check("first drop", rv, 0, ctx, 3))
+    result = -1;
+  AB_ImExporterContext_free(ctx);
+
+  /* not committed (e.g. the context could not be written), so still nothing is known */
+  ctx = createContext(2, 0);
+  rv = AB_Banking_DropKnownTransactions(ab, ctx);
+  if (check("drop without commit", rv, 0, ctx, 3))
+    result = -1;
+
+  /* "A" is remembered twice, "B" once */
+  rv = AB_Banking_AddKnownTransactions(ab, ctx);
+  if (check("first add", rv, 3, ctx, 3))
+    result = -1;
+  AB_ImExporterContext_free(ctx);
+
+  /* overlapping download: both "A" and "B" are dropped, "C" and the transfer are kept */
+  ctx = createContext(2, 1);
+  rv = AB_Banking_DropKnownTransactions(ab, ctx);
+  if (check("second drop", rv, 3, ctx, 1))
+    result = -1;
+  rv = AB_Banking_AddKnownTransactions(ab, ctx);
+  if (check("second add", rv, 1, ctx, 1))
+    result = -1;
+  AB_ImExporterContext_free(ctx);
+
+  /* everything is known now */
+  ctx = createContext(2, 1);
+  rv = AB_Banking_DropKnownTransactions(ab, ctx);
+  if (check("third drop", rv, 4, ctx, 0))
+    result = -1;
+  AB_ImExporterContext_free(ctx);
+
+  /* a third "A" has been booked, only the two known ones are dropped */
+  ctx = createContext(3, 1);
+  rv = AB_Banking_DropKnownTransactions(ab, ctx);
+  if (check("new identical booking", rv, 4, ctx, 1))
+    result = -1;
+  AB_ImExporterContext_free(ctx);
+
+  AB_Banking_free(ab);
+
+  snprintf(fname, sizeof(fname), "%s/transactionhashes/" TEST_IBAN ".hashes", dataDir);
+  unlink(fname);
+  snprintf(fname, sizeof(fname), "%s/transactionhashes", dataDir);
+  rmdir(fname);
+  rmdir(dataDir);
+
+  if (result == 0)
+    printf("Only transactions of earlier runs are dropped, at most as often as they were received.\n");
+  return result;
+}
@@ -0,0 +1,128 @@
+#include <aqbanking/banking.h>
+#include <aqbanking/types/transaction_hashstore.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Benchmark for transaction hash stores.
+ *
+ * The given number of pseudo-random digests is added to a store backed by a file, the file is
+ * loaded again and every digest is looked up (all must be found), followed by the same number of
+ * lookups for digests which are not in the store.
+ */
+
+#define STORE_FILE "ab-hashstore-bench.hashes"
+
+
+static void makeDigest(uint32_t seed, uint32_t n, uint8_t *digest)
+{
+  uint64_t x, z = 0;
+  int i;
+
+  /* splitmix64 is a bijection, so different seed/number pairs never give the same digest */
+  x = (((uint64_t) seed) << 32) | n;
+  for (i = 0; i < AB_TRANSACTION_HASHSTORE_DIGEST_SIZE; i++) {
+    if ((i % 8) == 0) {
+      z = (x += 0x9e3779b97f4a7c15ull);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+      z ^= z >> 31;
+    }
+    digest[i] = (uint8_t)(z >> (8 * (i % 8)));
+  }
+}
+
+
+
+static double addDigests(uint32_t count, int *pAdded)
+{
+  AB_TRANSACTION_HASHSTORE *hs;
+  clock_t start;
+  uint32_t i;
+  int added = 0;
+  int rv;
+
+  unlink(STORE_FILE);
+  start = clock();
+  hs = AB_TransactionHashStore_new();
+  rv = AB_TransactionHashStore_Open(hs, STORE_FILE);
+  for (i = 0; rv >= 0 && i < count; i++) {
+    uint8_t digest[AB_TRANSACTION_HASHSTORE_DIGEST_SIZE];
+
+    makeDigest(0x12345678, i, digest);
+    rv = AB_TransactionHashStore_AddDigest(hs, digest);
+    added += (rv == 1);
+  }
+  if (rv >= 0)
+    rv = AB_TransactionHashStore_Close(hs);
+  AB_TransactionHashStore_free(hs);
+  start = clock() - start;
+
+  *pAdded = (rv < 0) ? -1 : added;
+  return ((double)start) / CLOCKS_PER_SEC;
+}
+
+
+
+static double lookupDigests(uint32_t count, double *pLoadTime, int *pFound, int *pNotFound)
+{
+  AB_TRANSACTION_HASHSTORE *hs;
+  clock_t start;
+  uint32_t i;
+  int found = 0, notFound = 0;
+
+  start = clock();
+  hs = AB_TransactionHashStore_new();
+  if (AB_TransactionHashStore_Open(hs, STORE_FILE) < 0) {
+    AB_TransactionHashStore_free(hs);
+    *pFound = -1;
+    return 0.0;
+  }
+  *pLoadTime = ((double)(clock() - start)) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (i = 0; i < count; i++) {
+    uint8_t digest[AB_TRANSACTION_HASHSTORE_DIGEST_SIZE];
+
+    makeDigest(0x12345678, i, digest);
+    found += AB_TransactionHashStore_HasDigest(hs, digest);
+    makeDigest(0x87654321, i, digest);
+    notFound += !AB_TransactionHashStore_HasDigest(hs, digest);
+  }
+  start = clock() - start;
+  AB_TransactionHashStore_free(hs);
+
+  *pFound = found;
+  *pNotFound = notFound;
+  return ((double)start) / CLOCKS_PER_SEC;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+  uint32_t count = 4000000;
+  int added = 0, found = 0, notFound = 0;
+  double tAdd, tLoad = 0.0, tLookup;
+
+  if (argc > 1)
+    count = (uint32_t) atoi(argv[1]);
+
+  tAdd = addDigests(count, &added);
+  tLookup = lookupDigests(count, &tLoad, &found, &notFound);
+  unlink(STORE_FILE);
+  if (added != (int) count || found != (int) count || notFound != (int) count) {
+    fprintf(stderr, "Unexpected results: %u/%d/%d/%d\n", count, added, found, notFound);
+    return 1;
+  }
+
+  printf("%u digests\n", count);
+  printf("add and write:    %.3fs\n", tAdd);
+  printf("load file:        %.3fs\n", tLoad);
+  printf("lookup hit+miss:  %.3fs (%.0f ns per lookup)\n", tLookup, (tLookup * 1e9) / (2.0 * count));
+
+  return 0;
+}
@@ -0,0 +1,307 @@
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "plugins/imexporters/sepa/sepa_l.h"
+
+#include <gwenhywfar/buffer.h>
+#include <gwenhywfar/db.h>
+#include <gwenhywfar/syncio_memory.h>
+#include <aqbanking/banking.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Golden output test for the SEPA exporter.
+ *
+ * Every pain.001 and pain.008 profile shipped with the exporter is run on a fixed context with a
+ * fixed creation time and fixed message ids. The output must be byte for byte the content of
+ * "plugins/imexporters/sepa/testdata/<profile>.xml".
+ */
+
+#define TEST_TIME      "20261017123456"
+#define TEST_FIRST_UID 4711
+
+
+#ifdef AQBANKING_WITH_PLUGIN_IMEXPORTER_SEPA
+
+typedef struct {
+  const char *name;
+  int docType;
+} TEST_PROFILE;
+
+
+static const TEST_PROFILE testProfiles[] = {
+  {"default",    1},
+  {"001_001_02", 1},
+  {"001_002_03", 1},
+  {"001_003_03", 1},
+  {"008_001_01", 8},
+  {"008_002_02", 8},
+  {"008_003_02", 8},
+  {NULL,         0}
+};
+
+
+
+static void addTransaction(AB_IMEXPORTER_ACCOUNTINFO *ai, AB_TRANSACTION *t,
+                           const char *date, const char *value, const char *remoteName, const char *purpose)
+{
+  GWEN_DATE *dt;
+  AB_VALUE *v;
+
+  dt = GWEN_Date_fromString(date);
+  v = AB_Value_fromString(value);
+  AB_Transaction_SetDate(t, dt);
+  AB_Transaction_SetValue(t, v);
+  AB_Transaction_SetRemoteName(t, remoteName);
+  AB_Transaction_SetPurpose(t, purpose);
+  AB_ImExporterAccountInfo_AddTransaction(ai, t);
+  AB_Value_free(v);
+  GWEN_Date_free(dt);
+}
+
+
+
+static AB_IMEXPORTER_ACCOUNTINFO *createAccountInfo(void)
+{
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+
+  ai = AB_ImExporterAccountInfo_new();
+  AB_ImExporterAccountInfo_SetOwner(ai, "Hans & Grete M\xc3\xbcller");
+  AB_ImExporterAccountInfo_SetIban(ai, "DE89370400440532013000");
+  AB_ImExporterAccountInfo_SetBic(ai, "COBADEFFXXX");
+  return ai;
+}
+
+
+
+static AB_IMEXPORTER_CONTEXT *createTransferContext(void)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  AB_TRANSACTION *t;
+
+  ctx = AB_ImExporterContext_new();
+  ai = createAccountInfo();
+
+  t = AB_Transaction_new();
+  AB_Transaction_SetType(t, AB_Transaction_TypeTransfer);
+  AB_Transaction_SetRemoteIban(t, "DE02120300000000202051");
+  AB_Transaction_SetRemoteBic(t, "BYLADEM1001");
+  AB_Transaction_SetEndToEndReference(t, "E2E-1");
+  addTransaction(ai, t, "20261019", "100.5:EUR", "Erika Mustermann", "Rechnung 4711");
+
+  /* the second PmtInf block */
+  t = AB_Transaction_new();
+  AB_Transaction_SetType(t, AB_Transaction_TypeTransfer);
+  AB_Transaction_SetRemoteIban(t, "DE02500105170137075030");
+  AB_Transaction_SetRemoteBic(t, "INGDDEFFXXX");
+  addTransaction(ai, t, "20261020", "12:EUR", "Max Mustermann", "Miete");
+
+  /* back to the first block, with characters which need escaping */
+  t = AB_Transaction_new();
+  AB_Transaction_SetType(t, AB_Transaction_TypeTransfer);
+  AB_Transaction_SetRemoteIban(t, "DE02100500000054540402");
+  AB_Transaction_SetRemoteBic(t, "BELADEBEXXX");
+  AB_Transaction_SetCustomerReference(t, "CUST-2");
+  addTransaction(ai, t, "20261019", "0.99:EUR", "<Shop> \"Best\" 'Deals'", "Bestellung & Versand");
+
+  AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  return ctx;
+}
+
+
+
+static AB_IMEXPORTER_CONTEXT *createDebitNoteContext(void)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  AB_TRANSACTION *t;
+  GWEN_DATE *dt;
+
+  ctx = AB_ImExporterContext_new();
+  ai = createAccountInfo();
+  dt = GWEN_Date_fromString("20250101");
+
+  t = AB_Transaction_new();
+  AB_Transaction_SetType(t, AB_Transaction_TypeDebitNote);
+  AB_Transaction_SetRemoteIban(t, "DE02120300000000202051");
+  AB_Transaction_SetRemoteBic(t, "BYLADEM1001");
+  AB_Transaction_SetCustomerReference(t, "CUST-1");
+  AB_Transaction_SetSequence(t, AB_Transaction_SequenceFirst);
+  AB_Transaction_SetCreditorSchemeId(t, "DE98ZZZ09999999999");
+  AB_Transaction_SetMandateId(t, "M-1");
+  AB_Transaction_SetMandateDate(t, dt);
+  AB_Transaction_SetMandateDebitorName(t, "Erika & Otto");
+  addTransaction(ai, t, "20261021", "49.9:EUR", "Erika Mustermann", "Beitrag Oktober");
+
+  /* amended mandate */
+  t = AB_Transaction_new();
+  AB_Transaction_SetType(t, AB_Transaction_TypeDebitNote);
+  AB_Transaction_SetRemoteIban(t, "DE02500105170137075030");
+  AB_Transaction_SetRemoteBic(t, "INGDDEFFXXX");
+  AB_Transaction_SetEndToEndReference(t, "E2E-2");
+  AB_Transaction_SetSequence(t, AB_Transaction_SequenceFirst);
+  AB_Transaction_SetCreditorSchemeId(t, "DE98ZZZ09999999999");
+  AB_Transaction_SetMandateId(t, "M-2");
+  AB_Transaction_SetMandateDate(t, dt);
+  AB_Transaction_SetOriginalMandateId(t, "M-OLD-2");
+  AB_Transaction_SetOriginalCreditorSchemeId(t, "DE11ZZZ00000000001");
+  AB_Transaction_SetOriginalCreditorName(t, "Alt & Co");
+  addTransaction(ai, t, "20261021", "10:EUR", "Max Mustermann", "Beitrag <Oktober>");
+
+  /* another sequence type, only the original mandate id has changed, purpose is cropped */
+  t = AB_Transaction_new();
+  AB_Transaction_SetType(t, AB_Transaction_TypeDebitNote);
+  AB_Transaction_SetRemoteIban(t, "DE02100500000054540402");
+  AB_Transaction_SetRemoteBic(t, "BELADEBEXXX");
+  AB_Transaction_SetSequence(t, AB_Transaction_SequenceFollowing);
+  AB_Transaction_SetCreditorSchemeId(t, "DE98ZZZ09999999999");
+  AB_Transaction_SetMandateId(t, "M-3");
+  AB_Transaction_SetMandateDate(t, dt);
+  AB_Transaction_SetOriginalMandateId(t, "M-OLD-3");
+  addTransaction(ai, t, "20261021", "1234.56:EUR", "Firma \"Beispiel\" GmbH",
+                 "Rechnung 2026-0001 Rechnung 2026-0002 Rechnung 2026-0003 Rechnung 2026-0004 "
+                 "Rechnung 2026-0005 Rechnung 2026-0006 Rechnung 2026-0007 Rechnung 2026-0008");
+
+  GWEN_Date_free(dt);
+  AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  return ctx;
+}
+
+
+
+static void reportDifference(const char *profileName, const char *expected, const char *got)
+{
+  int line = 1;
+
+  while (*expected && *expected == *got) {
+    if (*expected == '\n')
+      line++;
+    expected++;
+    got++;
+  }
+  fprintf(stderr, "%s: Output differs in line %d\n", profileName, line);
+}
+
+
+
+static int readFile(const char *fname, GWEN_BUFFER *buf)
+{
+  FILE *f;
+  char buffer[1024];
+  size_t len;
+
+  f = fopen(fname, "rb");
+  if (f == NULL)
+    return -1;
+  while ((len = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    GWEN_Buffer_AppendBytes(buf, buffer, len);
+  fclose(f);
+  return 0;
+}
+
+
+
+static int testProfile(AB_IMEXPORTER *ie, const char *srcDir, const TEST_PROFILE *profile)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  GWEN_DB_NODE *params;
+  GWEN_BUFFER *expected, *got;
+  GWEN_SYNCIO *sio;
+  char fname[512];
+  int rv;
+  int result = 0;
+
+  snprintf(fname, sizeof(fname), "%s/plugins/imexporters/sepa/profiles/%s.conf", srcDir, profile->name);
+  params = GWEN_DB_Group_new("profile");
+  rv = GWEN_DB_ReadFile(params, fname, GWEN_DB_FLAGS_DEFAULT);
+  if (rv < 0) {
+    fprintf(stderr, "%s: Could not read profile (%d)\n", profile->name, rv);
+    GWEN_DB_Group_free(params);
+    return -1;
+  }
+
+  expected = GWEN_Buffer_new(0, 4096, 0, 1);
+  snprintf(fname, sizeof(fname), "%s/plugins/imexporters/sepa/testdata/%s.xml", srcDir, profile->name);
+  if (readFile(fname, expected)) {
+    fprintf(stderr, "%s: Could not read \"%s\"\n", profile->name, fname);
+    GWEN_Buffer_free(expected);
+    GWEN_DB_Group_free(params);
+    return -1;
+  }
+
+  ctx = (profile->docType == 1) ? createTransferContext() : createDebitNoteContext();
+  got = GWEN_Buffer_new(0, 4096, 0, 1);
+
+  /* every document starts with the same ids */
+  AH_ImExporterSEPA_SetFixedIds(ie, TEST_TIME, TEST_FIRST_UID);
+  sio = GWEN_SyncIo_Memory_new(got, 0);
+  rv = AB_ImExporter_Export(ie, ctx, sio, params);
+  GWEN_SyncIo_free(sio);
+  if (rv < 0) {
+    fprintf(stderr, "%s: Export failed (%d)\n", profile->name, rv);
+    result = -1;
+  }
+  else if (strcmp(GWEN_Buffer_GetStart(expected), GWEN_Buffer_GetStart(got)) != 0) {
+    reportDifference(profile->name, GWEN_Buffer_GetStart(expected), GWEN_Buffer_GetStart(got));
+    fprintf(stderr, "Expected:\n%s\nGot:\n%s\n", GWEN_Buffer_GetStart(expected), GWEN_Buffer_GetStart(got));
+    result = -1;
+  }
+
+  GWEN_Buffer_free(got);
+  GWEN_Buffer_free(expected);
+  AB_ImExporterContext_free(ctx);
+  GWEN_DB_Group_free(params);
+  return result;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+  AB_BANKING *ab;
+  AB_IMEXPORTER *ie;
+  const char *srcDir;
+  int result = 0;
+  int i;
+
+  /* set by "make check" */
+  srcDir = getenv("srcdir");
+  if (srcDir == NULL)
+    srcDir = ".";
+
+  ab = AB_Banking_new("ab-sepa-test", NULL, 0);
+  ie = AB_ImExporterSEPA_new(ab);
+  if (AH_ImExporterSEPA_SetFixedIds(ie, TEST_TIME, TEST_FIRST_UID) < 0) {
+    fprintf(stderr, "Could not set creation time\n");
+    result = -1;
+  }
+  else {
+    for (i = 0; testProfiles[i].name; i++) {
+      if (testProfile(ie, srcDir, &testProfiles[i]))
+        result = -1;
+    }
+  }
+
+  AB_ImExporter_free(ie);
+  AB_Banking_free(ab);
+
+  if (result == 0)
+    printf("SEPA exporter output matches the expected documents.\n");
+  return result;
+}
+
+#else
+
+int main(int argc, char *argv[])
+{
+  /* tells "make check" that the test has been skipped */
+  printf("SEPA exporter not available.\n");
+  return 77;
+}
+
+#endif
@@ -0,0 +1,160 @@
+#include <gwenhywfar/buffer.h>
+#include <aqbanking/banking.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Micro-benchmark for AB_Value_fromString() and the arithmetic functions.
+ *
+ * Every amount is parsed as is (which takes the single-pass path for simple amounts) and with a
+ * blank inserted before the currency (which is ignored by the parser but forces the GMP string path),
+ * both results must be identical. Values created by the GMP string path are stored as GMP rationals,
+ * so the arithmetic is measured for both the inline and the GMP representation.
+ */
+
+static const char *amounts[] = {
+  "0", "1", "-1", "12.5", "1234,56", "-1234.56:EUR", "+99999.99:EUR", "0,01", "-0.00",
+  "123456789012.34", "7:CHF", "42,", ".5", "100000000:EUR", "3.14159", "-17,30:USD",
+  NULL
+};
+
+
+static int compareResults(const char *s1, const char *s2)
+{
+  AB_VALUE *v1, *v2;
+  GWEN_BUFFER *buf1, *buf2;
+  int rv;
+
+  v1 = AB_Value_fromString(s1);
+  v2 = AB_Value_fromString(s2);
+  if (v1 == NULL || v2 == NULL) {
+    fprintf(stderr, "Could not parse \"%s\"\n", s1);
+    AB_Value_free(v2);
+    AB_Value_free(v1);
+    return -1;
+  }
+
+  buf1 = GWEN_Buffer_new(NULL, 64, 0, 1);
+  buf2 = GWEN_Buffer_new(NULL, 64, 0, 1);
+  AB_Value_toString(v1, buf1);
+  AB_Value_toString(v2, buf2);
+  rv = strcmp(GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetStart(buf2));
+  if (rv != 0)
+    fprintf(stderr, "Results differ for \"%s\": %s != %s\n", s1, GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetStart(buf2));
+  GWEN_Buffer_free(buf2);
+  GWEN_Buffer_free(buf1);
+  AB_Value_free(v2);
+  AB_Value_free(v1);
+  return (rv == 0) ? 0 : -1;
+}
+
+
+static double runBenchmark(const char **inputs, int count, int loops)
+{
+  clock_t start;
+  int l, i;
+
+  start = clock();
+  for (l = 0; l < loops; l++) {
+    for (i = 0; i < count; i++)
+      AB_Value_free(AB_Value_fromString(inputs[i]));
+  }
+  return ((double)(clock() - start)) / CLOCKS_PER_SEC;
+}
+
+
+static double runArithmeticBenchmark(const char **inputs, int count, int loops, GWEN_BUFFER *sumBuf)
+{
+  AB_VALUE *values[64];
+  AB_VALUE *sum;
+  clock_t start;
+  int l, i;
+
+  for (i = 0; i < count; i++)
+    values[i] = AB_Value_fromString(inputs[i]);
+  sum = AB_Value_new();
+
+  start = clock();
+  for (l = 0; l < loops; l++) {
+    for (i = 0; i < count; i++) {
+      AB_VALUE *v;
+
+      v = AB_Value_dup(values[i]);
+      if (AB_Value_Compare(v, sum) > 0)
+        AB_Value_AddValue(sum, v);
+      else
+        AB_Value_SubValue(sum, v);
+      AB_Value_free(v);
+    }
+  }
+  start = clock() - start;
+
+  AB_Value_toString(sum, sumBuf);
+  AB_Value_free(sum);
+  for (i = 0; i < count; i++)
+    AB_Value_free(values[i]);
+  return ((double)start) / CLOCKS_PER_SEC;
+}
+
+
+int main(int argc, char *argv[])
+{
+  const char *simpleInputs[64];
+  const char *gmpInputs[64];
+  char gmpBuffers[64][64];
+  int count;
+  int loops = 200000;
+  double tSimple, tGmp;
+  GWEN_BUFFER *sumBuf1, *sumBuf2;
+  int rv;
+
+  if (argc > 1)
+    loops = atoi(argv[1]);
+
+  for (count = 0; amounts[count]; count++) {
+    const char *currency;
+
+    currency = strchr(amounts[count], ':');
+    if (currency)
+      snprintf(gmpBuffers[count], sizeof(gmpBuffers[count]), "%.*s %s",
+               (int)(currency - amounts[count]), amounts[count], currency);
+    else
+      snprintf(gmpBuffers[count], sizeof(gmpBuffers[count]), "%s ", amounts[count]);
+    simpleInputs[count] = amounts[count];
+    gmpInputs[count] = gmpBuffers[count];
+    if (compareResults(simpleInputs[count], gmpInputs[count]))
+      return 1;
+  }
+
+  tSimple = runBenchmark(simpleInputs, count, loops);
+  tGmp = runBenchmark(gmpInputs, count, loops);
+
+  printf("%d values parsed per path\n", count * loops);
+  printf("single-pass path: %.3fs\n", tSimple);
+  printf("GMP string path:  %.3fs\n", tGmp);
+  if (tSimple > 0.0)
+    printf("speedup:          %.2fx\n", tGmp / tSimple);
+
+  sumBuf1 = GWEN_Buffer_new(NULL, 64, 0, 1);
+  sumBuf2 = GWEN_Buffer_new(NULL, 64, 0, 1);
+  tSimple = runArithmeticBenchmark(simpleInputs, count, loops, sumBuf1);
+  tGmp = runArithmeticBenchmark(gmpInputs, count, loops, sumBuf2);
+  rv = strcmp(GWEN_Buffer_GetStart(sumBuf1), GWEN_Buffer_GetStart(sumBuf2));
+  if (rv != 0)
+    fprintf(stderr, "Sums differ: %s != %s\n", GWEN_Buffer_GetStart(sumBuf1), GWEN_Buffer_GetStart(sumBuf2));
+  GWEN_Buffer_free(sumBuf2);
+  GWEN_Buffer_free(sumBuf1);
+  if (rv != 0)
+    return 1;
+
+  printf("dup/compare/add per path\n");
+  printf("inline values:    %.3fs\n", tSimple);
+  printf("GMP values:       %.3fs\n", tGmp);
+  if (tSimple > 0.0)
+    printf("speedup:          %.2fx\n", tGmp / tSimple);
+
+  return 0;
+}
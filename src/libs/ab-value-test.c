@@ -1,8 +1,385 @@
 #include <gwenhywfar/buffer.h>
 #include <aqbanking/banking.h>
 
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
 char *input = "1,361.54";
 
+
+/*
+ * Inputs of the form "[+-]digits[.|,digits][:currency]" with up to 18 digits are parsed by the single-pass
+ * parser, everything else by the GMP based one. A blank is ignored by the latter but not accepted by the
+ * former, so inserting one before the currency (or at the end) forces the GMP path for the same value.
+ */
+static const char *fastPathInputs[] = {
+  "0", "1", "-1", "+1", "-0", "+0.00", "  42", "007", "-007,50", "0.05", "00,10", "12.5", "12.50",
+  "1234,56", "-1234.56:EUR", "+99999.99:EUR", "42,", ".5", "-,25", "3.14159", "-17,30:USD",
+  "100000000:EUR", "123456789012345678", "-0.00000000000000001", "999999999999999999:EUR",
+  NULL
+};
+
+/* inputs not handled by the single-pass parser, the result must be the same as before */
+static const char *slowPathInputs[] = {
+  "1/3", "-1/3", "2/4:EUR", "1234567890123456789", "-12345678901234567.89", "1,234.56", "1.234,56:EUR",
+  NULL
+};
+
+static const char *invalidInputs[] = {
+  "", "-", "+", "abc", ":EUR", NULL
+};
+
+/*
+ * Operands for the arithmetic tests. Values with a denominator > 0 and a numerator > -INT64_MAX are kept
+ * inline, the others (and every result which doesn't fit) use GMP. Numerators and denominators are not
+ * reduced on purpose, the inline operations must return exactly what GMP returns for the same operands.
+ */
+static const long int arithmeticOperands[][2] = {
+  {0, 1}, {1, 1}, {-1, 1}, {2, 1}, {-2, 1}, {125, 100}, {-1999, 100}, {1, 3}, {2, 4}, {-5, 10},
+  {3037000499L, 1}, {-3037000500L, 1}, {4294967296L, 1}, {-4294967296L, 100},
+  {LONG_MAX, 1}, {LONG_MAX - 1, 1}, {-LONG_MAX + 1, 1}, {-LONG_MAX, 1}, {LONG_MIN, 1},
+  {LONG_MAX / 2, 1}, {LONG_MAX / 2 + 1, 1}, {-(LONG_MAX / 2) - 1, 1},
+  {LONG_MAX, 100}, {-LONG_MAX + 1, 3}, {1, LONG_MAX}, {7, LONG_MAX - 1}, {-3, LONG_MAX / 2},
+};
+
+
+static int _valueToString(const char *s, GWEN_BUFFER *buf)
+{
+  AB_VALUE *v;
+
+  v = AB_Value_fromString(s);
+  if (v == NULL) {
+    fprintf(stderr, "Could not parse \"%s\"\n", s);
+    return -1;
+  }
+  AB_Value_toString(v, buf);
+  AB_Value_free(v);
+  return 0;
+}
+
+
+static void _makeGmpInput(const char *s, char *buffer, size_t size)
+{
+  const char *currency;
+
+  currency = strchr(s, ':');
+  if (currency)
+    snprintf(buffer, size, "%.*s %s", (int)(currency - s), s, currency);
+  else
+    snprintf(buffer, size, "%s ", s);
+}
+
+
+static int _checkSameAsGmp(const char *s)
+{
+  char gmpInput[128];
+  GWEN_BUFFER *buf1, *buf2;
+  int rv;
+
+  _makeGmpInput(s, gmpInput, sizeof(gmpInput));
+  buf1 = GWEN_Buffer_new(NULL, 64, 0, 1);
+  buf2 = GWEN_Buffer_new(NULL, 64, 0, 1);
+  rv = _valueToString(s, buf1);
+  if (rv == 0)
+    rv = _valueToString(gmpInput, buf2);
+  if (rv == 0 && strcmp(GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetStart(buf2)) != 0) {
+    fprintf(stderr, "Results differ for \"%s\": %s != %s\n", s, GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetStart(buf2));
+    rv = -1;
+  }
+  GWEN_Buffer_free(buf2);
+  GWEN_Buffer_free(buf1);
+  return rv;
+}
+
+
+static int _checkParse(const char *s, const char *expected)
+{
+  GWEN_BUFFER *buf;
+  int rv;
+
+  buf = GWEN_Buffer_new(NULL, 64, 0, 1);
+  rv = _valueToString(s, buf);
+  if (rv == 0 && strcmp(GWEN_Buffer_GetStart(buf), expected) != 0) {
+    fprintf(stderr, "Unexpected result for \"%s\": %s (expected %s)\n", s, GWEN_Buffer_GetStart(buf), expected);
+    rv = -1;
+  }
+  GWEN_Buffer_free(buf);
+  return rv;
+}
+
+
+static int _testParser(void)
+{
+  int result = 0;
+  int i;
+
+  for (i = 0; fastPathInputs[i]; i++) {
+    if (_checkSameAsGmp(fastPathInputs[i]))
+      result = -1;
+  }
+  for (i = 0; slowPathInputs[i]; i++) {
+    if (_checkSameAsGmp(slowPathInputs[i]))
+      result = -1;
+  }
+
+  /* numerator and denominator are not reduced by either parser */
+  if (_checkParse("-007,50", "-750/100") ||
+      _checkParse("+99999.99:EUR", "9999999/100:EUR") ||
+      _checkParse("42,", "42") ||
+      _checkParse("-0", "0") ||
+      _checkParse("0.00", "0/100") ||
+      _checkParse("1/3", "1/3"))
+    result = -1;
+
+  /* invalid input */
+  for (i = 0; invalidInputs[i]; i++) {
+    AB_VALUE *v;
+
+    v = AB_Value_fromString(invalidInputs[i]);
+    if (v) {
+      fprintf(stderr, "Invalid input \"%s\" accepted\n", invalidInputs[i]);
+      AB_Value_free(v);
+      result = -1;
+    }
+  }
+
+  return result;
+}
+
+
+static AB_VALUE *_makeInline(const long int *operand)
+{
+  return AB_Value_fromInt(operand[0], operand[1]);
+}
+
+
+
+static AB_VALUE *_makeGmp(const long int *operand)
+{
+  AB_VALUE *v;
+  AB_VALUE *one;
+
+  /* division always uses GMP, dividing by one gives the same numerator and denominator */
+  v = AB_Value_fromInt(operand[0], operand[1]);
+  one = AB_Value_fromInt(1, 1);
+  AB_Value_DivValue(v, one);
+  AB_Value_free(one);
+  return v;
+}
+
+
+
+static int _checkSameValue(const char *what, const AB_VALUE *v1, const AB_VALUE *v2)
+{
+  GWEN_BUFFER *buf1, *buf2;
+  int rv = 0;
+
+  buf1 = GWEN_Buffer_new(NULL, 64, 0, 1);
+  buf2 = GWEN_Buffer_new(NULL, 64, 0, 1);
+  AB_Value_toString(v1, buf1);
+  AB_Value_toString(v2, buf2);
+  if (strcmp(GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetStart(buf2)) != 0) {
+    fprintf(stderr, "%s: %s != %s\n", what, GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetStart(buf2));
+    rv = -1;
+  }
+  GWEN_Buffer_free(buf2);
+  GWEN_Buffer_free(buf1);
+  return rv;
+}
+
+
+
+static int _checkOperation(const long int *op1, const long int *op2, int op)
+{
+  static const char *opNames[] = {"+", "-", "*"};
+  AB_VALUE *expected;
+  AB_VALUE *v1;
+  AB_VALUE *v2;
+  char what[256];
+  int mixed;
+  int rv = 0;
+
+  snprintf(what, sizeof(what), "%ld/%ld %s %ld/%ld", op1[0], op1[1], opNames[op], op2[0], op2[1]);
+
+  /* reference: both operands in GMP representation */
+  expected = _makeGmp(op1);
+  v2 = _makeGmp(op2);
+  switch (op) {
+  case 0: AB_Value_AddValue(expected, v2); break;
+  case 1: AB_Value_SubValue(expected, v2); break;
+  default: AB_Value_MultValue(expected, v2); break;
+  }
+  AB_Value_free(v2);
+
+  /* inline op inline, inline op GMP, GMP op inline */
+  for (mixed = 0; mixed < 3; mixed++) {
+    v1 = (mixed == 2) ? _makeGmp(op1) : _makeInline(op1);
+    v2 = (mixed == 1) ? _makeGmp(op2) : _makeInline(op2);
+    switch (op) {
+    case 0: AB_Value_AddValue(v1, v2); break;
+    case 1: AB_Value_SubValue(v1, v2); break;
+    default: AB_Value_MultValue(v1, v2); break;
+    }
+    if (_checkSameValue(what, v1, expected))
+      rv = -1;
+    AB_Value_free(v2);
+    AB_Value_free(v1);
+  }
+
+  AB_Value_free(expected);
+  return rv;
+}
+
+
+
+static int _checkComparison(const long int *op1, const long int *op2)
+{
+  AB_VALUE *i1, *i2, *g1, *g2;
+  int expectedCmp;
+  int expectedEqual;
+  int rv = 0;
+
+  i1 = _makeInline(op1);
+  i2 = _makeInline(op2);
+  g1 = _makeGmp(op1);
+  g2 = _makeGmp(op2);
+
+  expectedCmp = AB_Value_Compare(g1, g2);
+  expectedCmp = (expectedCmp < 0) ? -1 : ((expectedCmp > 0) ? 1 : 0);
+  expectedEqual = AB_Value_Equal(g1, g2);
+  if (AB_Value_Equal(i1, i2) != expectedEqual ||
+      AB_Value_Equal(i1, g2) != expectedEqual ||
+      AB_Value_Equal(g1, i2) != expectedEqual) {
+    fprintf(stderr, "Equal() differs for %ld/%ld and %ld/%ld\n", op1[0], op1[1], op2[0], op2[1]);
+    rv = -1;
+  }
+  if (AB_Value_Compare(i1, i2) != expectedCmp ||
+      AB_Value_Compare(i1, g2) != expectedCmp ||
+      AB_Value_Compare(g1, i2) != expectedCmp) {
+    fprintf(stderr, "Compare() differs for %ld/%ld and %ld/%ld\n", op1[0], op1[1], op2[0], op2[1]);
+    rv = -1;
+  }
+
+  AB_Value_free(g2);
+  AB_Value_free(g1);
+  AB_Value_free(i2);
+  AB_Value_free(i1);
+  return rv;
+}
+
+
+
+static int _checkUnary(const long int *operand)
+{
+  AB_VALUE *v, *expected;
+  char what[128];
+  int rv = 0;
+
+  /* squaring (both arguments are the same object) */
+  snprintf(what, sizeof(what), "(%ld/%ld)^2", operand[0], operand[1]);
+  expected = _makeGmp(operand);
+  AB_Value_MultValue(expected, expected);
+  v = _makeInline(operand);
+  AB_Value_MultValue(v, v);
+  if (_checkSameValue(what, v, expected))
+    rv = -1;
+  AB_Value_free(v);
+  AB_Value_free(expected);
+
+  /* doubling */
+  snprintf(what, sizeof(what), "%ld/%ld + itself", operand[0], operand[1]);
+  expected = _makeGmp(operand);
+  AB_Value_AddValue(expected, expected);
+  v = _makeInline(operand);
+  AB_Value_AddValue(v, v);
+  if (_checkSameValue(what, v, expected))
+    rv = -1;
+  AB_Value_free(v);
+  AB_Value_free(expected);
+
+  /* negation and sign */
+  snprintf(what, sizeof(what), "-(%ld/%ld)", operand[0], operand[1]);
+  expected = _makeGmp(operand);
+  AB_Value_Negate(expected);
+  v = _makeInline(operand);
+  AB_Value_Negate(v);
+  if (_checkSameValue(what, v, expected) ||
+      AB_Value_IsNegative(v) != AB_Value_IsNegative(expected) ||
+      AB_Value_IsPositive(v) != AB_Value_IsPositive(expected) ||
+      AB_Value_IsZero(v) != AB_Value_IsZero(expected)) {
+    fprintf(stderr, "Sign differs for %s\n", what);
+    rv = -1;
+  }
+  AB_Value_free(v);
+  AB_Value_free(expected);
+
+  return rv;
+}
+
+
+
+static int _testArithmetic(void)
+{
+  int count;
+  int i, j, op;
+  int result = 0;
+
+  count = sizeof(arithmeticOperands) / sizeof(arithmeticOperands[0]);
+  for (i = 0; i < count; i++) {
+    if (_checkUnary(arithmeticOperands[i]))
+      result = -1;
+    for (j = 0; j < count; j++) {
+      if (_checkComparison(arithmeticOperands[i], arithmeticOperands[j]))
+        result = -1;
+      for (op = 0; op < 3; op++) {
+        if (_checkOperation(arithmeticOperands[i], arithmeticOperands[j], op))
+          result = -1;
+      }
+    }
+  }
+
+#if LONG_MAX == 9223372036854775807L
+  /* results just outside of the inline range */
+  {
+    AB_VALUE *v, *v2;
+    GWEN_BUFFER *buf;
+
+    buf = GWEN_Buffer_new(NULL, 64, 0, 1);
+
+    v = AB_Value_fromInt(LONG_MAX, 1);
+    v2 = AB_Value_fromInt(1, 1);
+    AB_Value_AddValue(v, v2);
+    AB_Value_toString(v, buf);
+    if (strcmp(GWEN_Buffer_GetStart(buf), "9223372036854775808") != 0) {
+      fprintf(stderr, "INT64_MAX+1: %s\n", GWEN_Buffer_GetStart(buf));
+      result = -1;
+    }
+    AB_Value_free(v2);
+    AB_Value_free(v);
+
+    /* INT64_MIN itself is never stored inline */
+    GWEN_Buffer_Reset(buf);
+    v = AB_Value_fromInt(-LONG_MAX + 1, 1);
+    v2 = AB_Value_fromInt(2, 1);
+    AB_Value_SubValue(v, v2);
+    AB_Value_toString(v, buf);
+    if (strcmp(GWEN_Buffer_GetStart(buf), "-9223372036854775808") != 0) {
+      fprintf(stderr, "-INT64_MAX-1: %s\n", GWEN_Buffer_GetStart(buf));
+      result = -1;
+    }
+    AB_Value_free(v2);
+    AB_Value_free(v);
+
+    GWEN_Buffer_free(buf);
+  }
+#endif
+
+  return result;
+}
+
+
+
 int main(int argc, char *argv[])
 {
   AB_VALUE *value;
@@ -31,5 +408,10 @@ int main(int argc, char *argv[])
   GWEN_Buffer_free(buf2);
   AB_Value_free(value);
 
+  if (argc < 2 && _testParser())
+    result = -1;
+  if (argc < 2 && _testArithmetic())
+    result = -1;
+
   return result;
 }
@@ -0,0 +1,951 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "workerpool_p.h"
+
+#include <aqbanking/error.h>
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+#include <gwenhywfar/gui.h>
+#include <gwenhywfar/gui_be.h>
+#include <gwenhywfar/inetsocket.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#define AB_WORKERPOOL_TASKARRAY_STEP 16
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void _runSequential(AB_WORKERPOOL *wp);
+
+#ifdef AB_WORKERPOOL_WITH_THREADS
+static int _runThreaded(AB_WORKERPOOL *wp);
+static void *_workerThreadRun(void *arg);
+static AB_WORKERPOOL_TASK *_getNextRunnableTask(AB_WORKERPOOL *wp);
+static int _countRunningTasksInGroup(const AB_WORKERPOOL *wp, const char *groupName);
+
+static void _createGlobalLockKey(void);
+static void _initGlobalLock(void);
+static int _globalLockIsHeld(void);
+static void _globalLockAcquire(void);
+static void _globalLockRelease(void);
+static void _globalLockWait(pthread_cond_t *cond);
+static int _globalLockTimedWait(pthread_cond_t *cond, int msecs);
+
+static int _installGuiHooks(void);
+static void _removeGuiHooks(void);
+static int _isGuiThread(void);
+static void _guiCall(AB_WORKERPOOL_GUICALL *call);
+static void _serveGuiCall(void);
+static void _runGuiCall(AB_WORKERPOOL_GUICALL *call);
+
+static int GWENHYWFAR_CB _waitForSockets(GWEN_GUI *gui,
+                                         GWEN_SOCKET_LIST2 *readSockets,
+                                         GWEN_SOCKET_LIST2 *writeSockets,
+                                         uint32_t guiid,
+                                         int msecs);
+static int GWENHYWFAR_CB _messageBox(GWEN_GUI *gui,
+                                     uint32_t flags,
+                                     const char *title,
+                                     const char *text,
+                                     const char *b1,
+                                     const char *b2,
+                                     const char *b3,
+                                     uint32_t guiid);
+static int GWENHYWFAR_CB _inputBox(GWEN_GUI *gui,
+                                   uint32_t flags,
+                                   const char *title,
+                                   const char *text,
+                                   char *buffer,
+                                   int minLen,
+                                   int maxLen,
+                                   uint32_t guiid);
+static uint32_t GWENHYWFAR_CB _showBox(GWEN_GUI *gui, uint32_t flags, const char *title, const char *text, uint32_t guiid);
+static void GWENHYWFAR_CB _hideBox(GWEN_GUI *gui, uint32_t id);
+static uint32_t GWENHYWFAR_CB _progressStart(GWEN_GUI *gui,
+                                             uint32_t progressFlags,
+                                             const char *title,
+                                             const char *text,
+                                             uint64_t total,
+                                             uint32_t guiid);
+static int GWENHYWFAR_CB _progressAdvance(GWEN_GUI *gui, uint32_t id, uint64_t progress);
+static int GWENHYWFAR_CB _progressSetTotal(GWEN_GUI *gui, uint32_t id, uint64_t total);
+static int GWENHYWFAR_CB _progressLog(GWEN_GUI *gui, uint32_t id, GWEN_LOGGER_LEVEL level, const char *text);
+static int GWENHYWFAR_CB _progressEnd(GWEN_GUI *gui, uint32_t id);
+static int GWENHYWFAR_CB _getPassword(GWEN_GUI *gui,
+                                      uint32_t flags,
+                                      const char *token,
+                                      const char *title,
+                                      const char *text,
+                                      char *buffer,
+                                      int minLen,
+                                      int maxLen,
+                                      GWEN_GUI_PASSWORD_METHOD methodId,
+                                      GWEN_DB_NODE *methodParams,
+                                      uint32_t guiid);
+static int GWENHYWFAR_CB _setPasswordStatus(GWEN_GUI *gui,
+                                            const char *token,
+                                            const char *pin,
+                                            GWEN_GUI_PASSWORD_STATUS status,
+                                            uint32_t guiid);
+static int GWENHYWFAR_CB _checkCert(GWEN_GUI *gui, const GWEN_SSLCERTDESCR *cert, GWEN_SYNCIO *sio, uint32_t guiid);
+static int GWENHYWFAR_CB _execDialog(GWEN_GUI *gui, GWEN_DIALOG *dlg, uint32_t guiid);
+
+static int _selectSockets(GWEN_SOCKET_LIST2 *readSockets, GWEN_SOCKET_LIST2 *writeSockets, int msecs);
+static void _addSocketsToSet(GWEN_SOCKET_LIST2 *socketList, GWEN_SOCKETSET *socketSet);
+#endif
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * global lock
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#ifdef AB_WORKERPOOL_WITH_THREADS
+/* Only one thread at a time is allowed to run AqBanking/Gwenhywfar code. This lock is only released while
+ * waiting for sockets, for a GUI callback to be run by the GUI thread or for worker threads to finish. */
+static pthread_mutex_t _globalLock=PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t _globalLockOnce=PTHREAD_ONCE_INIT;
+static pthread_key_t _globalLockKey;
+
+/* GUI hooks installed by the outermost running worker pool, _guiThread is the thread which started it */
+static int _guiHookCount=0;
+static GWEN_GUI *_guiHookGui=NULL;
+static pthread_t _guiThread;
+static AB_WORKERPOOL_GUIFNS _guiHookOldFns;
+
+/* GUI callback of a worker thread waiting to be run by the GUI thread (only one at a time) */
+static AB_WORKERPOOL_GUICALL *_pendingGuiCall=NULL;
+/* signalled when a GUI call is posted or a worker thread exits */
+static pthread_cond_t _callerWakeup=PTHREAD_COND_INITIALIZER;
+/* signalled when the pending GUI call has been run */
+static pthread_cond_t _guiCallDone=PTHREAD_COND_INITIALIZER;
+#endif
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AB_WORKERPOOL *AB_WorkerPool_new(int maxThreads, int maxPerGroup)
+{
+  AB_WORKERPOOL *wp;
+
+  GWEN_NEW_OBJECT(AB_WORKERPOOL, wp);
+  wp->maxThreads=(maxThreads<1)?1:maxThreads;
+  wp->maxPerGroup=(maxPerGroup<0)?0:maxPerGroup;
+#ifdef AB_WORKERPOOL_WITH_THREADS
+  pthread_cond_init(&(wp->stateChanged), NULL);
+#endif
+  return wp;
+}
+
+
+
+void AB_WorkerPool_free(AB_WORKERPOOL *wp)
+{
+  if (wp) {
+    int i;
+
+    for (i=0; i<wp->taskCount; i++)
+      free(wp->tasks[i].groupName);
+    free(wp->tasks);
+#ifdef AB_WORKERPOOL_WITH_THREADS
+    pthread_cond_destroy(&(wp->stateChanged));
+#endif
+    GWEN_FREE_OBJECT(wp);
+  }
+}
+
+
+
+void AB_WorkerPool_AddTask(AB_WORKERPOOL *wp, AB_WORKERPOOL_TASK_FN fn, void *arg, const char *groupName)
+{
+  AB_WORKERPOOL_TASK *t;
+
+  assert(wp);
+  assert(fn);
+
+  if (wp->taskCount>=wp->taskArraySize) {
+    AB_WORKERPOOL_TASK *newTasks;
+
+    newTasks=(AB_WORKERPOOL_TASK *) realloc(wp->tasks,
+                                            (wp->taskArraySize+AB_WORKERPOOL_TASKARRAY_STEP)*sizeof(AB_WORKERPOOL_TASK));
+    assert(newTasks);
+    wp->tasks=newTasks;
+    wp->taskArraySize+=AB_WORKERPOOL_TASKARRAY_STEP;
+  }
+
+  t=&(wp->tasks[wp->taskCount++]);
+  memset(t, 0, sizeof(AB_WORKERPOOL_TASK));
+  t->fn=fn;
+  t->arg=arg;
+  t->groupName=(groupName && *groupName)?strdup(groupName):NULL;
+  t->state=AB_WORKERPOOL_TASKSTATE_PENDING;
+  wp->pendingCount++;
+}
+
+
+
+int AB_WorkerPool_Run(AB_WORKERPOOL *wp)
+{
+  assert(wp);
+
+#ifdef AB_WORKERPOOL_WITH_THREADS
+  if (wp->pendingCount>1 && wp->maxThreads>1 && GWEN_Gui_GetGui()) {
+    int rv;
+
+    rv=_runThreaded(wp);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    return 0;
+  }
+#endif
+
+  _runSequential(wp);
+  return 0;
+}
+
+
+
+int AB_WorkerPool_IsAvailable(void)
+{
+#ifdef AB_WORKERPOOL_WITH_THREADS
+  return (GWEN_Gui_GetGui()!=NULL)?1:0;
+#else
+  return 0;
+#endif
+}
+
+
+
+void _runSequential(AB_WORKERPOOL *wp)
+{
+  int i;
+
+  for (i=0; i<wp->taskCount; i++) {
+    AB_WORKERPOOL_TASK *t;
+
+    t=&(wp->tasks[i]);
+    if (t->state==AB_WORKERPOOL_TASKSTATE_PENDING) {
+      t->state=AB_WORKERPOOL_TASKSTATE_RUNNING;
+      wp->pendingCount--;
+      t->fn(t->arg);
+      t->state=AB_WORKERPOOL_TASKSTATE_FINISHED;
+    }
+  }
+}
+
+
+
+#ifdef AB_WORKERPOOL_WITH_THREADS
+
+int _runThreaded(AB_WORKERPOOL *wp)
+{
+  pthread_t *threads;
+  int threadCount;
+  int startedThreads=0;
+  int topLevel;
+  int i;
+
+  _initGlobalLock();
+
+  /* when called from within a task the calling thread already holds the lock */
+  topLevel=!_globalLockIsHeld();
+  if (topLevel)
+    _globalLockAcquire();
+
+  if (_installGuiHooks()<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Could not hook into GUI, running tasks sequentially");
+    _runSequential(wp);
+    if (topLevel)
+      _globalLockRelease();
+    return 0;
+  }
+
+  threadCount=(wp->pendingCount<wp->maxThreads)?wp->pendingCount:wp->maxThreads;
+  threads=(pthread_t *) malloc(threadCount*sizeof(pthread_t));
+  assert(threads);
+  for (i=0; i<threadCount; i++) {
+    if (pthread_create(&(threads[startedThreads]), NULL, _workerThreadRun, wp)==0)
+      startedThreads++;
+    else {
+      DBG_WARN(AQBANKING_LOGDOMAIN, "Could not start worker thread %d", i);
+    }
+  }
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Running %d tasks on %d threads", wp->pendingCount, startedThreads);
+
+  /* let the workers run, the GUI thread runs their GUI callbacks meanwhile */
+  wp->runningThreads=startedThreads;
+  while (wp->runningThreads>0) {
+    if (_pendingGuiCall && _isGuiThread())
+      _serveGuiCall();
+    else if (_globalLockTimedWait(&_callerWakeup, AB_WORKERPOOL_GUI_IDLE_MSECS)==GWEN_ERROR_TIMEOUT &&
+             _isGuiThread())
+      /* keep the GUI responsive */
+      GWEN_Gui_ProgressAdvance(0, GWEN_GUI_PROGRESS_NONE);
+  }
+  /* worker threads only release the lock after leaving their loop */
+  for (i=0; i<startedThreads; i++)
+    pthread_join(threads[i], NULL);
+  free(threads);
+
+  /* run remaining tasks (if no thread could be started) */
+  _runSequential(wp);
+
+  _removeGuiHooks();
+  if (topLevel)
+    _globalLockRelease();
+  return 0;
+}
+
+
+
+void *_workerThreadRun(void *arg)
+{
+  AB_WORKERPOOL *wp;
+
+  wp=(AB_WORKERPOOL *) arg;
+
+  _globalLockAcquire();
+  for (;;) {
+    AB_WORKERPOOL_TASK *t;
+
+    t=_getNextRunnableTask(wp);
+    if (t) {
+      t->state=AB_WORKERPOOL_TASKSTATE_RUNNING;
+      wp->pendingCount--;
+      t->fn(t->arg);
+      t->state=AB_WORKERPOOL_TASKSTATE_FINISHED;
+      pthread_cond_broadcast(&(wp->stateChanged));
+    }
+    else if (wp->pendingCount==0)
+      break;
+    else
+      /* group limit reached for all pending tasks, wait for a running task to finish */
+      _globalLockWait(&(wp->stateChanged));
+  }
+  wp->runningThreads--;
+  pthread_cond_broadcast(&_callerWakeup);
+  _globalLockRelease();
+
+  return NULL;
+}
+
+
+
+AB_WORKERPOOL_TASK *_getNextRunnableTask(AB_WORKERPOOL *wp)
+{
+  int i;
+
+  for (i=0; i<wp->taskCount; i++) {
+    AB_WORKERPOOL_TASK *t;
+
+    t=&(wp->tasks[i]);
+    if (t->state==AB_WORKERPOOL_TASKSTATE_PENDING) {
+      if (wp->maxPerGroup==0 || t->groupName==NULL ||
+          _countRunningTasksInGroup(wp, t->groupName)<wp->maxPerGroup)
+        return t;
+    }
+  }
+
+  return NULL;
+}
+
+
+
+int _countRunningTasksInGroup(const AB_WORKERPOOL *wp, const char *groupName)
+{
+  int i;
+  int cnt=0;
+
+  for (i=0; i<wp->taskCount; i++) {
+    const AB_WORKERPOOL_TASK *t;
+
+    t=&(wp->tasks[i]);
+    if (t->state==AB_WORKERPOOL_TASKSTATE_RUNNING && t->groupName && strcasecmp(t->groupName, groupName)==0)
+      cnt++;
+  }
+
+  return cnt;
+}
+
+
+
+void _createGlobalLockKey(void)
+{
+  pthread_key_create(&_globalLockKey, NULL);
+}
+
+
+
+void _initGlobalLock(void)
+{
+  pthread_once(&_globalLockOnce, _createGlobalLockKey);
+}
+
+
+
+int _globalLockIsHeld(void)
+{
+  return (pthread_getspecific(_globalLockKey)!=NULL)?1:0;
+}
+
+
+
+void _globalLockAcquire(void)
+{
+  pthread_mutex_lock(&_globalLock);
+  pthread_setspecific(_globalLockKey, (void *) &_globalLock);
+}
+
+
+
+void _globalLockRelease(void)
+{
+  pthread_setspecific(_globalLockKey, NULL);
+  pthread_mutex_unlock(&_globalLock);
+}
+
+
+
+void _globalLockWait(pthread_cond_t *cond)
+{
+  pthread_setspecific(_globalLockKey, NULL);
+  pthread_cond_wait(cond, &_globalLock);
+  pthread_setspecific(_globalLockKey, (void *) &_globalLock);
+}
+
+
+
+int _globalLockTimedWait(pthread_cond_t *cond, int msecs)
+{
+  struct timespec ts;
+  int rv;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  ts.tv_sec+=msecs/1000;
+  ts.tv_nsec+=(long)(msecs%1000)*1000000L;
+  if (ts.tv_nsec>=1000000000L) {
+    ts.tv_sec++;
+    ts.tv_nsec-=1000000000L;
+  }
+
+  pthread_setspecific(_globalLockKey, NULL);
+  rv=pthread_cond_timedwait(cond, &_globalLock, &ts);
+  pthread_setspecific(_globalLockKey, (void *) &_globalLock);
+  return (rv==ETIMEDOUT)?GWEN_ERROR_TIMEOUT:0;
+}
+
+
+
+int _installGuiHooks(void)
+{
+  if (_guiHookCount==0) {
+    GWEN_GUI *gui;
+
+    gui=GWEN_Gui_GetGui();
+    if (gui==NULL)
+      return GWEN_ERROR_NOT_AVAILABLE;
+    _guiHookGui=gui;
+    _guiThread=pthread_self();
+    _guiHookOldFns.waitForSocketsFn=GWEN_Gui_SetWaitForSocketsFn(gui, _waitForSockets);
+    _guiHookOldFns.messageBoxFn=GWEN_Gui_SetMessageBoxFn(gui, _messageBox);
+    _guiHookOldFns.inputBoxFn=GWEN_Gui_SetInputBoxFn(gui, _inputBox);
+    _guiHookOldFns.showBoxFn=GWEN_Gui_SetShowBoxFn(gui, _showBox);
+    _guiHookOldFns.hideBoxFn=GWEN_Gui_SetHideBoxFn(gui, _hideBox);
+    _guiHookOldFns.progressStartFn=GWEN_Gui_SetProgressStartFn(gui, _progressStart);
+    _guiHookOldFns.progressAdvanceFn=GWEN_Gui_SetProgressAdvanceFn(gui, _progressAdvance);
+    _guiHookOldFns.progressSetTotalFn=GWEN_Gui_SetProgressSetTotalFn(gui, _progressSetTotal);
+    _guiHookOldFns.progressLogFn=GWEN_Gui_SetProgressLogFn(gui, _progressLog);
+    _guiHookOldFns.progressEndFn=GWEN_Gui_SetProgressEndFn(gui, _progressEnd);
+    _guiHookOldFns.getPasswordFn=GWEN_Gui_SetGetPasswordFn(gui, _getPassword);
+    _guiHookOldFns.setPasswordStatusFn=GWEN_Gui_SetSetPasswordStatusFn(gui, _setPasswordStatus);
+    _guiHookOldFns.checkCertFn=GWEN_Gui_SetCheckCertFn(gui, _checkCert);
+    _guiHookOldFns.execDialogFn=GWEN_Gui_SetExecDialogFn(gui, _execDialog);
+  }
+  _guiHookCount++;
+  return 0;
+}
+
+
+
+void _removeGuiHooks(void)
+{
+  assert(_guiHookCount>0);
+  if (--_guiHookCount==0) {
+    GWEN_GUI *gui;
+
+    gui=_guiHookGui;
+    GWEN_Gui_SetWaitForSocketsFn(gui, _guiHookOldFns.waitForSocketsFn);
+    GWEN_Gui_SetMessageBoxFn(gui, _guiHookOldFns.messageBoxFn);
+    GWEN_Gui_SetInputBoxFn(gui, _guiHookOldFns.inputBoxFn);
+    GWEN_Gui_SetShowBoxFn(gui, _guiHookOldFns.showBoxFn);
+    GWEN_Gui_SetHideBoxFn(gui, _guiHookOldFns.hideBoxFn);
+    GWEN_Gui_SetProgressStartFn(gui, _guiHookOldFns.progressStartFn);
+    GWEN_Gui_SetProgressAdvanceFn(gui, _guiHookOldFns.progressAdvanceFn);
+    GWEN_Gui_SetProgressSetTotalFn(gui, _guiHookOldFns.progressSetTotalFn);
+    GWEN_Gui_SetProgressLogFn(gui, _guiHookOldFns.progressLogFn);
+    GWEN_Gui_SetProgressEndFn(gui, _guiHookOldFns.progressEndFn);
+    GWEN_Gui_SetGetPasswordFn(gui, _guiHookOldFns.getPasswordFn);
+    GWEN_Gui_SetSetPasswordStatusFn(gui, _guiHookOldFns.setPasswordStatusFn);
+    GWEN_Gui_SetCheckCertFn(gui, _guiHookOldFns.checkCertFn);
+    GWEN_Gui_SetExecDialogFn(gui, _guiHookOldFns.execDialogFn);
+    memset(&_guiHookOldFns, 0, sizeof(_guiHookOldFns));
+    _guiHookGui=NULL;
+  }
+}
+
+
+
+int _isGuiThread(void)
+{
+  return (_guiHookCount>0 && pthread_equal(pthread_self(), _guiThread))?1:0;
+}
+
+
+
+void _guiCall(AB_WORKERPOOL_GUICALL *call)
+{
+  if (!_globalLockIsHeld() || _isGuiThread()) {
+    /* not called from a worker thread */
+    _runGuiCall(call);
+    return;
+  }
+
+  /* worker thread: let the GUI thread run the callback and wait for the result */
+  while (_pendingGuiCall)
+    _globalLockWait(&_guiCallDone);
+  _pendingGuiCall=call;
+  pthread_cond_broadcast(&_callerWakeup);
+  while (!call->done)
+    _globalLockWait(&_guiCallDone);
+}
+
+
+
+void _serveGuiCall(void)
+{
+  AB_WORKERPOOL_GUICALL *call;
+
+  call=_pendingGuiCall;
+  _runGuiCall(call);
+  call->done=1;
+  _pendingGuiCall=NULL;
+  pthread_cond_broadcast(&_guiCallDone);
+}
+
+
+
+void _runGuiCall(AB_WORKERPOOL_GUICALL *call)
+{
+  GWEN_GUI *gui;
+
+  gui=_guiHookGui;
+  call->result=GWEN_ERROR_NOT_IMPLEMENTED;
+  call->resultId=0;
+
+  switch (call->callType) {
+  case AB_WORKERPOOL_GUICALL_MESSAGEBOX:
+    if (_guiHookOldFns.messageBoxFn)
+      call->result=_guiHookOldFns.messageBoxFn(gui, call->flags, call->title, call->text,
+                                               call->button1, call->button2, call->button3, call->guiid);
+    break;
+  case AB_WORKERPOOL_GUICALL_INPUTBOX:
+    if (_guiHookOldFns.inputBoxFn)
+      call->result=_guiHookOldFns.inputBoxFn(gui, call->flags, call->title, call->text,
+                                             call->buffer, call->minLen, call->maxLen, call->guiid);
+    break;
+  case AB_WORKERPOOL_GUICALL_SHOWBOX:
+    if (_guiHookOldFns.showBoxFn)
+      call->resultId=_guiHookOldFns.showBoxFn(gui, call->flags, call->title, call->text, call->guiid);
+    break;
+  case AB_WORKERPOOL_GUICALL_HIDEBOX:
+    if (_guiHookOldFns.hideBoxFn)
+      _guiHookOldFns.hideBoxFn(gui, call->id);
+    break;
+  case AB_WORKERPOOL_GUICALL_PROGRESS_START:
+    if (_guiHookOldFns.progressStartFn)
+      call->resultId=_guiHookOldFns.progressStartFn(gui, call->flags, call->title, call->text, call->value, call->guiid);
+    break;
+  case AB_WORKERPOOL_GUICALL_PROGRESS_ADVANCE:
+    call->result=0;
+    if (_guiHookOldFns.progressAdvanceFn)
+      call->result=_guiHookOldFns.progressAdvanceFn(gui, call->id, call->value);
+    break;
+  case AB_WORKERPOOL_GUICALL_PROGRESS_SETTOTAL:
+    call->result=0;
+    if (_guiHookOldFns.progressSetTotalFn)
+      call->result=_guiHookOldFns.progressSetTotalFn(gui, call->id, call->value);
+    break;
+  case AB_WORKERPOOL_GUICALL_PROGRESS_LOG:
+    call->result=0;
+    if (_guiHookOldFns.progressLogFn)
+      call->result=_guiHookOldFns.progressLogFn(gui, call->id, call->logLevel, call->text);
+    break;
+  case AB_WORKERPOOL_GUICALL_PROGRESS_END:
+    call->result=0;
+    if (_guiHookOldFns.progressEndFn)
+      call->result=_guiHookOldFns.progressEndFn(gui, call->id);
+    break;
+  case AB_WORKERPOOL_GUICALL_GETPASSWORD:
+    if (_guiHookOldFns.getPasswordFn)
+      call->result=_guiHookOldFns.getPasswordFn(gui, call->flags, call->token, call->title, call->text,
+                                                call->buffer, call->minLen, call->maxLen,
+                                                call->methodId, call->methodParams, call->guiid);
+    break;
+  case AB_WORKERPOOL_GUICALL_SETPASSWORDSTATUS:
+    if (_guiHookOldFns.setPasswordStatusFn)
+      call->result=_guiHookOldFns.setPasswordStatusFn(gui, call->token, call->pin, call->passwordStatus, call->guiid);
+    break;
+  case AB_WORKERPOOL_GUICALL_CHECKCERT:
+    if (_guiHookOldFns.checkCertFn)
+      call->result=_guiHookOldFns.checkCertFn(gui, call->cert, call->sio, call->guiid);
+    break;
+  case AB_WORKERPOOL_GUICALL_EXECDIALOG:
+    if (_guiHookOldFns.execDialogFn)
+      call->result=_guiHookOldFns.execDialogFn(gui, call->dialog, call->guiid);
+    break;
+  default:
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Unknown GUI call %d", call->callType);
+    break;
+  }
+}
+
+
+
+int GWENHYWFAR_CB _waitForSockets(GWEN_GUI *gui,
+                                  GWEN_SOCKET_LIST2 *readSockets,
+                                  GWEN_SOCKET_LIST2 *writeSockets,
+                                  uint32_t guiid,
+                                  int msecs)
+{
+  int rv;
+
+  if (!_globalLockIsHeld() || _isGuiThread()) {
+    /* not called from a worker thread */
+    if (_guiHookOldFns.waitForSocketsFn)
+      return _guiHookOldFns.waitForSocketsFn(gui, readSockets, writeSockets, guiid, msecs);
+    return _selectSockets(readSockets, writeSockets, msecs);
+  }
+
+  /* worker thread: GUI events are handled by the GUI thread meanwhile */
+  _globalLockRelease();
+  rv=_selectSockets(readSockets, writeSockets, msecs);
+  _globalLockAcquire();
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _messageBox(GWEN_GUI *gui,
+                              uint32_t flags,
+                              const char *title,
+                              const char *text,
+                              const char *b1,
+                              const char *b2,
+                              const char *b3,
+                              uint32_t guiid)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_MESSAGEBOX;
+  call.flags=flags;
+  call.title=title;
+  call.text=text;
+  call.button1=b1;
+  call.button2=b2;
+  call.button3=b3;
+  call.guiid=guiid;
+  _guiCall(&call);
+  return call.result;
+}
+
+
+
+int GWENHYWFAR_CB _inputBox(GWEN_GUI *gui,
+                            uint32_t flags,
+                            const char *title,
+                            const char *text,
+                            char *buffer,
+                            int minLen,
+                            int maxLen,
+                            uint32_t guiid)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_INPUTBOX;
+  call.flags=flags;
+  call.title=title;
+  call.text=text;
+  call.buffer=buffer;
+  call.minLen=minLen;
+  call.maxLen=maxLen;
+  call.guiid=guiid;
+  _guiCall(&call);
+  return call.result;
+}
+
+
+
+uint32_t GWENHYWFAR_CB _showBox(GWEN_GUI *gui, uint32_t flags, const char *title, const char *text, uint32_t guiid)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_SHOWBOX;
+  call.flags=flags;
+  call.title=title;
+  call.text=text;
+  call.guiid=guiid;
+  _guiCall(&call);
+  return call.resultId;
+}
+
+
+
+void GWENHYWFAR_CB _hideBox(GWEN_GUI *gui, uint32_t id)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_HIDEBOX;
+  call.id=id;
+  _guiCall(&call);
+}
+
+
+
+uint32_t GWENHYWFAR_CB _progressStart(GWEN_GUI *gui,
+                                      uint32_t progressFlags,
+                                      const char *title,
+                                      const char *text,
+                                      uint64_t total,
+                                      uint32_t guiid)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_PROGRESS_START;
+  call.flags=progressFlags;
+  call.title=title;
+  call.text=text;
+  call.value=total;
+  call.guiid=guiid;
+  _guiCall(&call);
+  return call.resultId;
+}
+
+
+
+int GWENHYWFAR_CB _progressAdvance(GWEN_GUI *gui, uint32_t id, uint64_t progress)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_PROGRESS_ADVANCE;
+  call.id=id;
+  call.value=progress;
+  _guiCall(&call);
+  return call.result;
+}
+
+
+
+int GWENHYWFAR_CB _progressSetTotal(GWEN_GUI *gui, uint32_t id, uint64_t total)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_PROGRESS_SETTOTAL;
+  call.id=id;
+  call.value=total;
+  _guiCall(&call);
+  return call.result;
+}
+
+
+
+int GWENHYWFAR_CB _progressLog(GWEN_GUI *gui, uint32_t id, GWEN_LOGGER_LEVEL level, const char *text)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_PROGRESS_LOG;
+  call.id=id;
+  call.logLevel=level;
+  call.text=text;
+  _guiCall(&call);
+  return call.result;
+}
+
+
+
+int GWENHYWFAR_CB _progressEnd(GWEN_GUI *gui, uint32_t id)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_PROGRESS_END;
+  call.id=id;
+  _guiCall(&call);
+  return call.result;
+}
+
+
+
+int GWENHYWFAR_CB _getPassword(GWEN_GUI *gui,
+                               uint32_t flags,
+                               const char *token,
+                               const char *title,
+                               const char *text,
+                               char *buffer,
+                               int minLen,
+                               int maxLen,
+                               GWEN_GUI_PASSWORD_METHOD methodId,
+                               GWEN_DB_NODE *methodParams,
+                               uint32_t guiid)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_GETPASSWORD;
+  call.flags=flags;
+  call.token=token;
+  call.title=title;
+  call.text=text;
+  call.buffer=buffer;
+  call.minLen=minLen;
+  call.maxLen=maxLen;
+  call.methodId=methodId;
+  call.methodParams=methodParams;
+  call.guiid=guiid;
+  _guiCall(&call);
+  return call.result;
+}
+
+
+
+int GWENHYWFAR_CB _setPasswordStatus(GWEN_GUI *gui,
+                                     const char *token,
+                                     const char *pin,
+                                     GWEN_GUI_PASSWORD_STATUS status,
+                                     uint32_t guiid)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_SETPASSWORDSTATUS;
+  call.token=token;
+  call.pin=pin;
+  call.passwordStatus=status;
+  call.guiid=guiid;
+  _guiCall(&call);
+  return call.result;
+}
+
+
+
+int GWENHYWFAR_CB _checkCert(GWEN_GUI *gui, const GWEN_SSLCERTDESCR *cert, GWEN_SYNCIO *sio, uint32_t guiid)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_CHECKCERT;
+  call.cert=cert;
+  call.sio=sio;
+  call.guiid=guiid;
+  _guiCall(&call);
+  return call.result;
+}
+
+
+
+int GWENHYWFAR_CB _execDialog(GWEN_GUI *gui, GWEN_DIALOG *dlg, uint32_t guiid)
+{
+  AB_WORKERPOOL_GUICALL call;
+
+  memset(&call, 0, sizeof(call));
+  call.callType=AB_WORKERPOOL_GUICALL_EXECDIALOG;
+  call.dialog=dlg;
+  call.guiid=guiid;
+  _guiCall(&call);
+  return call.result;
+}
+
+
+
+int _selectSockets(GWEN_SOCKET_LIST2 *readSockets, GWEN_SOCKET_LIST2 *writeSockets, int msecs)
+{
+  GWEN_SOCKETSET *rset;
+  GWEN_SOCKETSET *wset;
+  int rv;
+
+  rset=GWEN_SocketSet_new();
+  wset=GWEN_SocketSet_new();
+  _addSocketsToSet(readSockets, rset);
+  _addSocketsToSet(writeSockets, wset);
+  rv=GWEN_Socket_Select(GWEN_SocketSet_GetSocketCount(rset)?rset:NULL,
+                        GWEN_SocketSet_GetSocketCount(wset)?wset:NULL,
+                        NULL,
+                        msecs);
+  GWEN_SocketSet_free(wset);
+  GWEN_SocketSet_free(rset);
+  return rv;
+}
+
+
+
+void _addSocketsToSet(GWEN_SOCKET_LIST2 *socketList, GWEN_SOCKETSET *socketSet)
+{
+  if (socketList) {
+    GWEN_SOCKET_LIST2_ITERATOR *it;
+
+    it=GWEN_Socket_List2_First(socketList);
+    if (it) {
+      GWEN_SOCKET *sk;
+
+      sk=GWEN_Socket_List2Iterator_Data(it);
+      while (sk) {
+        GWEN_SocketSet_AddSocket(socketSet, sk);
+        sk=GWEN_Socket_List2Iterator_Next(it);
+      }
+      GWEN_Socket_List2Iterator_free(it);
+    }
+  }
+}
+
+#endif
+
@@ -0,0 +1,77 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_WORKERPOOL_H
+#define AB_WORKERPOOL_H
+
+#include <gwenhywfar/types.h>
+
+
+/** @defgroup G_AB_WORKERPOOL Worker Pool
+ * @ingroup G_AB_BE_INTERFACE
+ *
+ * A worker pool runs a number of tasks on worker threads, e.g. to talk to several bank servers at the same time.
+ * This is an internal API of AqBanking and its backends.
+ *
+ * Neither Gwenhywfar nor AqBanking are thread-safe, so only one thread at a time is allowed to run code
+ * of those libraries. This lock is only released while a task waits for network sockets (via
+ * GWEN_Gui_WaitForSockets), so that network round-trips overlap, or while it waits for a GUI callback.
+ *
+ * GUI callbacks of the tasks (message boxes, progress, password input, certificate checks, dialogs) are not
+ * called on the worker threads: They are passed to the thread which called @ref AB_WorkerPool_Run and run
+ * there while that thread waits for the tasks to finish.
+ *
+ * Worker pools can be nested (i.e. a task can run another worker pool).
+ * If threads are not available (or there is no GUI object to hook into) the tasks are run one after another
+ * in the order in which they were added.
+ */
+/*@{*/
+
+typedef struct AB_WORKERPOOL AB_WORKERPOOL;
+
+typedef void (*AB_WORKERPOOL_TASK_FN)(void *arg);
+
+
+/**
+ * Create a worker pool.
+ * @param maxThreads maximum number of tasks running at the same time
+ * @param maxPerGroup maximum number of tasks of the same group running at the same time (0 for no limit)
+ */
+AB_WORKERPOOL *AB_WorkerPool_new(int maxThreads, int maxPerGroup);
+
+void AB_WorkerPool_free(AB_WORKERPOOL *wp);
+
+/**
+ * Add a task.
+ * @param wp worker pool
+ * @param fn function to call
+ * @param arg argument for the function
+ * @param groupName name of the group this task belongs to (e.g. the name of a bank server, NULL for none)
+ */
+void AB_WorkerPool_AddTask(AB_WORKERPOOL *wp, AB_WORKERPOOL_TASK_FN fn, void *arg, const char *groupName);
+
+/**
+ * Run all tasks and return when all of them are finished.
+ * @return 0 if ok, error code otherwise
+ */
+int AB_WorkerPool_Run(AB_WORKERPOOL *wp);
+
+/**
+ * Check whether tasks can really run concurrently (i.e. AqBanking has been compiled with thread support
+ * and there is a GUI object).
+ */
+int AB_WorkerPool_IsAvailable(void);
+
+/*@}*/
+
+
+#endif
+
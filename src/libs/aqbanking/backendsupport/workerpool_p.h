@@ -0,0 +1,128 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_WORKERPOOL_P_H
+#define AB_WORKERPOOL_P_H
+
+#include "workerpool.h"
+
+#include <gwenhywfar/gui_be.h>
+
+#if defined(HAVE_PTHREAD_H) && defined(HAVE_PTHREAD_CREATE)
+# include <pthread.h>
+# define AB_WORKERPOOL_WITH_THREADS
+#endif
+
+
+#define AB_WORKERPOOL_TASKSTATE_PENDING  0
+#define AB_WORKERPOOL_TASKSTATE_RUNNING  1
+#define AB_WORKERPOOL_TASKSTATE_FINISHED 2
+
+/* while waiting for worker threads the calling thread lets the GUI handle its events at this interval */
+#define AB_WORKERPOOL_GUI_IDLE_MSECS 100
+
+
+#define AB_WORKERPOOL_GUICALL_MESSAGEBOX        1
+#define AB_WORKERPOOL_GUICALL_INPUTBOX          2
+#define AB_WORKERPOOL_GUICALL_SHOWBOX           3
+#define AB_WORKERPOOL_GUICALL_HIDEBOX           4
+#define AB_WORKERPOOL_GUICALL_PROGRESS_START    5
+#define AB_WORKERPOOL_GUICALL_PROGRESS_ADVANCE  6
+#define AB_WORKERPOOL_GUICALL_PROGRESS_SETTOTAL 7
+#define AB_WORKERPOOL_GUICALL_PROGRESS_LOG      8
+#define AB_WORKERPOOL_GUICALL_PROGRESS_END      9
+#define AB_WORKERPOOL_GUICALL_GETPASSWORD       10
+#define AB_WORKERPOOL_GUICALL_SETPASSWORDSTATUS 11
+#define AB_WORKERPOOL_GUICALL_CHECKCERT         12
+#define AB_WORKERPOOL_GUICALL_EXECDIALOG        13
+
+
+typedef struct AB_WORKERPOOL_TASK AB_WORKERPOOL_TASK;
+struct AB_WORKERPOOL_TASK {
+  AB_WORKERPOOL_TASK_FN fn;
+  void *arg;
+  char *groupName;
+  int state;
+};
+
+
+/* arguments and result of a GUI callback passed from a worker thread to the calling thread */
+typedef struct AB_WORKERPOOL_GUICALL AB_WORKERPOOL_GUICALL;
+struct AB_WORKERPOOL_GUICALL {
+  int callType;
+
+  uint32_t flags;
+  uint32_t id;
+  const char *token;
+  const char *title;
+  const char *text;
+  const char *button1;
+  const char *button2;
+  const char *button3;
+  const char *pin;
+  char *buffer;
+  int minLen;
+  int maxLen;
+  uint64_t value;
+  GWEN_LOGGER_LEVEL logLevel;
+  GWEN_GUI_PASSWORD_METHOD methodId;
+  GWEN_DB_NODE *methodParams;
+  GWEN_GUI_PASSWORD_STATUS passwordStatus;
+  const GWEN_SSLCERTDESCR *cert;
+  GWEN_SYNCIO *sio;
+  GWEN_DIALOG *dialog;
+  uint32_t guiid;
+
+  int result;
+  uint32_t resultId;
+  int done;
+};
+
+
+/* GUI functions replaced while worker pools are running */
+typedef struct AB_WORKERPOOL_GUIFNS AB_WORKERPOOL_GUIFNS;
+struct AB_WORKERPOOL_GUIFNS {
+  GWEN_GUI_WAITFORSOCKETS_FN waitForSocketsFn;
+  GWEN_GUI_MESSAGEBOX_FN messageBoxFn;
+  GWEN_GUI_INPUTBOX_FN inputBoxFn;
+  GWEN_GUI_SHOWBOX_FN showBoxFn;
+  GWEN_GUI_HIDEBOX_FN hideBoxFn;
+  GWEN_GUI_PROGRESS_START_FN progressStartFn;
+  GWEN_GUI_PROGRESS_ADVANCE_FN progressAdvanceFn;
+  GWEN_GUI_PROGRESS_SETTOTAL_FN progressSetTotalFn;
+  GWEN_GUI_PROGRESS_LOG_FN progressLogFn;
+  GWEN_GUI_PROGRESS_END_FN progressEndFn;
+  GWEN_GUI_GETPASSWORD_FN getPasswordFn;
+  GWEN_GUI_SETPASSWORDSTATUS_FN setPasswordStatusFn;
+  GWEN_GUI_CHECKCERT_FN checkCertFn;
+  GWEN_GUI_EXEC_DIALOG_FN execDialogFn;
+};
+
+
+
+struct AB_WORKERPOOL {
+  int maxThreads;
+  int maxPerGroup;
+
+  AB_WORKERPOOL_TASK *tasks;
+  int taskCount;
+  int taskArraySize;
+  int pendingCount;
+
+#ifdef AB_WORKERPOOL_WITH_THREADS
+  pthread_cond_t stateChanged;
+  int runningThreads;
+#endif
+};
+
+
+#endif
+
@@ -118,6 +118,7 @@ AB_BANKING *AB_Banking_new(const char *appName,
   ab->appName=strdup(appName);
   ab->cryptTokenList=GWEN_Crypt_Token_List2_new();
   ab->dbRuntimeConfig=GWEN_DB_Group_new("runtimeConfig");
+  ab->accountSpecCache=AB_Banking__AccountSpecCache_new();
 
   GWEN_Buffer_free(nbuf);
 
@@ -163,9 +164,12 @@ void AB_Banking_free(AB_BANKING *ab)
     GWEN_INHERIT_FINI(AB_BANKING, ab);
 
     GWEN_DB_Group_free(ab->dbRuntimeConfig);
+    AB_Banking__AccountSpecCache_free(ab->accountSpecCache);
+    AB_Banking__ImExporterProfileCache_free(ab->imExporterProfileCache);
     AB_Banking_ClearCryptTokenList(ab);
     GWEN_Crypt_Token_List2_free(ab->cryptTokenList);
     GWEN_ConfigMgr_free(ab->configMgr);
+    free(ab->configMgrDir);
     free(ab->startFolder);
     free(ab->appName);
     free(ab->appEscName);
@@ -180,9 +184,37 @@ void AB_Banking_free(AB_BANKING *ab)
 int AB_Banking_GetNamedUniqueId(AB_BANKING *ab, const char *idName, int startAtStdUniqueId)
 {
   int rv;
-  int uid=0;
+  uint32_t uid=0;
+
+  rv=AB_Banking_ReserveNamedUniqueIdRange(ab, idName, startAtStdUniqueId, 1, &uid);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  return (int) uid;
+}
+
+
+
+int AB_Banking_ReserveNamedUniqueIdRange(AB_BANKING *ab,
+                                         const char *idName,
+                                         int startAtStdUniqueId,
+                                         uint32_t count,
+                                         uint32_t *pFirstId)
+{
+  int rv;
+  uint32_t uid=0;
   GWEN_DB_NODE *dbConfig=NULL;
 
+  assert(ab);
+  assert(pFirstId);
+
+  if (count<1) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid number of ids requested (%lu)", (unsigned long int) count);
+    return GWEN_ERROR_INVALID;
+  }
+
   rv=GWEN_ConfigMgr_LockGroup(ab->configMgr,
                               AB_CFG_GROUP_MAIN,
                               "uniqueId");
@@ -197,6 +229,9 @@ int AB_Banking_GetNamedUniqueId(AB_BANKING *ab, const char *idName, int startAtS
                              &dbConfig);
   if (rv<0) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to read main config (%d)", rv);
+    GWEN_ConfigMgr_UnlockGroup(ab->configMgr,
+                               AB_CFG_GROUP_MAIN,
+                               "uniqueId");
     return rv;
   }
 
@@ -212,19 +247,19 @@ int AB_Banking_GetNamedUniqueId(AB_BANKING *ab, const char *idName, int startAtS
       /* not set yet, start with a unique id from standard source */
       uid=GWEN_DB_GetIntValue(dbConfig, "uniqueId", 0, 0);
       uid++;
-      GWEN_DB_SetIntValue(dbConfig, GWEN_DB_FLAGS_OVERWRITE_VARS, "uniqueId", uid);
-      GWEN_DB_SetIntValue(dbConfig, GWEN_DB_FLAGS_OVERWRITE_VARS, GWEN_Buffer_GetStart(tbuf), uid);
+      GWEN_DB_SetIntValue(dbConfig, GWEN_DB_FLAGS_OVERWRITE_VARS, "uniqueId", uid+count-1);
+      GWEN_DB_SetIntValue(dbConfig, GWEN_DB_FLAGS_OVERWRITE_VARS, GWEN_Buffer_GetStart(tbuf), uid+count-1);
     }
     else {
       uid++;
-      GWEN_DB_SetIntValue(dbConfig, GWEN_DB_FLAGS_OVERWRITE_VARS, GWEN_Buffer_GetStart(tbuf), uid);
+      GWEN_DB_SetIntValue(dbConfig, GWEN_DB_FLAGS_OVERWRITE_VARS, GWEN_Buffer_GetStart(tbuf), uid+count-1);
     }
     GWEN_Buffer_free(tbuf);
   }
   else {
     uid=GWEN_DB_GetIntValue(dbConfig, "uniqueId", 0, 0);
     uid++;
-    GWEN_DB_SetIntValue(dbConfig, GWEN_DB_FLAGS_OVERWRITE_VARS, "uniqueId", uid);
+    GWEN_DB_SetIntValue(dbConfig, GWEN_DB_FLAGS_OVERWRITE_VARS, "uniqueId", uid+count-1);
   }
 
   rv=GWEN_ConfigMgr_SetGroup(ab->configMgr,
@@ -250,7 +285,82 @@ int AB_Banking_GetNamedUniqueId(AB_BANKING *ab, const char *idName, int startAtS
     return rv;
   }
 
-  return uid;
+  *pFirstId=uid;
+  return 0;
+}
+
+
+
+int AB_Banking_ReleaseNamedUniqueIdRange(AB_BANKING *ab,
+                                         const char *idName,
+                                         uint32_t firstUnusedId,
+                                         uint32_t lastId)
+{
+  int rv;
+  GWEN_DB_NODE *dbConfig=NULL;
+  GWEN_BUFFER *tbuf;
+
+  assert(ab);
+  assert(idName && *idName);
+
+  if (firstUnusedId==0 || firstUnusedId>lastId)
+    /* nothing to release */
+    return 0;
+
+  rv=GWEN_ConfigMgr_LockGroup(ab->configMgr,
+                              AB_CFG_GROUP_MAIN,
+                              "uniqueId");
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to lock main config (%d)", rv);
+    return rv;
+  }
+
+  rv=GWEN_ConfigMgr_GetGroup(ab->configMgr,
+                             AB_CFG_GROUP_MAIN,
+                             "uniqueId",
+                             &dbConfig);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to read main config (%d)", rv);
+    GWEN_ConfigMgr_UnlockGroup(ab->configMgr,
+                               AB_CFG_GROUP_MAIN,
+                               "uniqueId");
+    return rv;
+  }
+
+  tbuf=GWEN_Buffer_new(0, 256, 0, 1);
+  GWEN_Buffer_AppendString(tbuf, "uniqueid-");
+  GWEN_Buffer_AppendString(tbuf, idName);
+
+  /* only possible if nobody else reserved ids since, otherwise just leave a gap */
+  if ((uint32_t) GWEN_DB_GetIntValue(dbConfig, GWEN_Buffer_GetStart(tbuf), 0, 0)==lastId) {
+    GWEN_DB_SetIntValue(dbConfig, GWEN_DB_FLAGS_OVERWRITE_VARS, GWEN_Buffer_GetStart(tbuf), firstUnusedId-1);
+    rv=GWEN_ConfigMgr_SetGroup(ab->configMgr,
+                               AB_CFG_GROUP_MAIN,
+                               "uniqueId",
+                               dbConfig);
+    if (rv<0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to write main config (%d)", rv);
+      GWEN_ConfigMgr_UnlockGroup(ab->configMgr,
+                                 AB_CFG_GROUP_MAIN,
+                                 "uniqueId");
+      GWEN_Buffer_free(tbuf);
+      GWEN_DB_Group_free(dbConfig);
+      return rv;
+    }
+  }
+  GWEN_Buffer_free(tbuf);
+  GWEN_DB_Group_free(dbConfig);
+
+  /* unlock */
+  rv=GWEN_ConfigMgr_UnlockGroup(ab->configMgr,
+                                AB_CFG_GROUP_MAIN,
+                                "uniqueId");
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to unlock main config (%d)", rv);
+    return rv;
+  }
+
+  return 0;
 }
 
 
@@ -332,6 +332,14 @@ int AB_Banking_UnlockSharedConfig(AB_BANKING *ab, const char *name);
  *       (see https://www.hbci-zka.de/register/prod_register.htm)</li>
  *   <li>fintsApplicationVersionString (char): string containing the version of the application
  *       (major and minor version only, e.g. "1.2")</li>
+ *   <li>parallelProviders (int): if !=0 @ref AB_Banking_SendCommands sends the commands of different backends
+ *       concurrently (one worker thread per backend). All GUI callbacks are still called one at a time but
+ *       possibly from a worker thread, so only enable this if the GUI can handle that.</li>
+ *   <li>aqhbciMaxParallelCustomers (int): maximum number of HBCI customers for which AqHBCI runs dialogs
+ *       concurrently (default: 1, i.e. one customer after the other). The same restrictions regarding the GUI
+ *       apply as for "parallelProviders".</li>
+ *   <li>aqhbciMaxDialogsPerServer (int): maximum number of concurrent AqHBCI dialogs with the same bank
+ *       server (default: 1)</li>
  * </ul>
  */
 /*@{*/
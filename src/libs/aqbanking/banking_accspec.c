@@ -20,6 +20,22 @@
 static const char *_nonEmptyString(const char *s, const char *altstring);
 static void _logAccountSpec(const AB_ACCOUNT_SPEC *a, const char *logMessage);
 
+static int _readAccountSpecList(const AB_BANKING *ab, AB_ACCOUNT_SPEC_LIST **pAccountSpecList);
+static AB_ACCOUNT_SPEC_LIST *_dupAccountSpecList(const AB_ACCOUNT_SPEC_LIST *accountSpecList);
+
+static int _getCachedAccountSpecs(const AB_BANKING *ab, AB_BANKING_ACCSPEC_CACHE **pCache);
+static void _accountSpecCacheClear(AB_BANKING_ACCSPEC_CACHE *cache);
+static void _accountSpecCacheFill(AB_BANKING_ACCSPEC_CACHE *cache, AB_ACCOUNT_SPEC_LIST *accountSpecList, int generation);
+static void _accountSpecCacheInvalidate(AB_BANKING *ab);
+static int _accountSpecCacheStampUnchanged(const AB_BANKING *ab, const AB_BANKING_ACCSPEC_CACHE *cache);
+static const AB_ACCOUNT_SPEC *_accountSpecCacheFindByIban(const AB_BANKING_ACCSPEC_CACHE *cache, const char *iban);
+static const AB_ACCOUNT_SPEC *_accountSpecCacheFindByBankAccount(const AB_BANKING_ACCSPEC_CACHE *cache,
+                                                                 const char *bankCode,
+                                                                 const char *accountNumber);
+static int _cmpByIban(const void *p1, const void *p2);
+static int _cmpByBankAccount(const void *p1, const void *p2);
+static int _cmpStrings(const char *s1, const char *s2);
+
 
 /* ------------------------------------------------------------------------------------------------
  * implementations
@@ -86,10 +102,12 @@ int AB_Banking_WriteAccountSpec(AB_BANKING *ab, const AB_ACCOUNT_SPEC *accountSp
   if (rv<0) {
     DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
     GWEN_DB_Group_free(db);
+    _accountSpecCacheInvalidate(ab);
     return rv;
   }
   GWEN_DB_Group_free(db);
 
+  _accountSpecCacheInvalidate(ab);
   return 0;
 }
 
@@ -102,9 +120,11 @@ int AB_Banking_DeleteAccountSpec(AB_BANKING *ab, uint32_t uid)
   rv=AB_Banking_DeleteConfigGroup(ab, AB_CFG_GROUP_ACCOUNTSPECS, uid);
   if (rv<0) {
     DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    _accountSpecCacheInvalidate(ab);
     return rv;
   }
 
+  _accountSpecCacheInvalidate(ab);
   return 0;
 }
 
@@ -114,6 +134,125 @@ int AB_Banking_DeleteAccountSpec(AB_BANKING *ab, uint32_t uid)
 
 
 int AB_Banking_GetAccountSpecList(const AB_BANKING *ab, AB_ACCOUNT_SPEC_LIST **pAccountSpecList)
+{
+  AB_BANKING_ACCSPEC_CACHE *cache=NULL;
+  int rv;
+
+  rv=_getCachedAccountSpecs(ab, &cache);
+  if (rv==GWEN_ERROR_NOT_AVAILABLE) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Account spec cache not available, reading account specs");
+    return _readAccountSpecList(ab, pAccountSpecList);
+  }
+  else if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  if (AB_AccountSpec_List_GetCount(cache->accountSpecList)) {
+    *pAccountSpecList=_dupAccountSpecList(cache->accountSpecList);
+    return 0;
+  }
+  else {
+    DBG_WARN(AQBANKING_LOGDOMAIN, "No valid account specs found");
+    return GWEN_ERROR_NOT_FOUND;
+  }
+}
+
+
+
+int AB_Banking_GetAccountSpecByUniqueId(const AB_BANKING *ab, uint32_t uniqueAccountId, AB_ACCOUNT_SPEC **pAccountSpec)
+{
+  AB_BANKING_ACCSPEC_CACHE *cache=NULL;
+  int rv;
+
+  rv=_getCachedAccountSpecs(ab, &cache);
+  if (rv==0) {
+    const AB_ACCOUNT_SPEC *as;
+
+    as=(const AB_ACCOUNT_SPEC *) GWEN_IdMap_Find(cache->idMap, uniqueAccountId);
+    if (as) {
+      if (pAccountSpec)
+        *pAccountSpec=AB_AccountSpec_dup(as);
+      return 0;
+    }
+    /* not in cache (e.g. account spec without uniqueId variable), read directly */
+  }
+
+  rv=AB_Banking_ReadAccountSpec(ab, uniqueAccountId, pAccountSpec);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  return rv;
+}
+
+
+
+int AB_Banking_GetAccountSpecByIban(const AB_BANKING *ab, const char *iban, AB_ACCOUNT_SPEC **pAccountSpec)
+{
+  AB_BANKING_ACCSPEC_CACHE *cache=NULL;
+  const AB_ACCOUNT_SPEC *as;
+  int rv;
+
+  if (!(iban && *iban)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "No IBAN given");
+    return GWEN_ERROR_INVALID;
+  }
+
+  rv=_getCachedAccountSpecs(ab, &cache);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  as=_accountSpecCacheFindByIban(cache, iban);
+  if (as==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No account spec for IBAN \"%s\"", iban);
+    return GWEN_ERROR_NOT_FOUND;
+  }
+
+  if (pAccountSpec)
+    *pAccountSpec=AB_AccountSpec_dup(as);
+  return 0;
+}
+
+
+
+int AB_Banking_GetAccountSpecByBankCodeAndAccountNumber(const AB_BANKING *ab,
+                                                        const char *bankCode,
+                                                        const char *accountNumber,
+                                                        AB_ACCOUNT_SPEC **pAccountSpec)
+{
+  AB_BANKING_ACCSPEC_CACHE *cache=NULL;
+  const AB_ACCOUNT_SPEC *as;
+  int rv;
+
+  if (!(accountNumber && *accountNumber)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "No account number given");
+    return GWEN_ERROR_INVALID;
+  }
+
+  rv=_getCachedAccountSpecs(ab, &cache);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  as=_accountSpecCacheFindByBankAccount(cache, bankCode, accountNumber);
+  if (as==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No account spec for account \"%s/%s\"", bankCode?bankCode:"", accountNumber);
+    return GWEN_ERROR_NOT_FOUND;
+  }
+
+  if (pAccountSpec)
+    *pAccountSpec=AB_AccountSpec_dup(as);
+  return 0;
+}
+
+
+
+int _readAccountSpecList(const AB_BANKING *ab, AB_ACCOUNT_SPEC_LIST **pAccountSpecList)
 {
   GWEN_DB_NODE *dbAll=NULL;
   int rv;
@@ -123,6 +262,8 @@ int AB_Banking_GetAccountSpecList(const AB_BANKING *ab, AB_ACCOUNT_SPEC_LIST **p
   rv=AB_Banking_ReadConfigGroups(ab, AB_CFG_GROUP_ACCOUNTSPECS, "uniqueId", NULL, NULL, &dbAll);
   if (rv<0) {
     DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    if (rv==GWEN_ERROR_PARTIAL)
+      GWEN_DB_Group_free(dbAll);
     return rv;
   }
   else {
@@ -168,17 +309,309 @@ int AB_Banking_GetAccountSpecList(const AB_BANKING *ab, AB_ACCOUNT_SPEC_LIST **p
 
 
 
-int AB_Banking_GetAccountSpecByUniqueId(const AB_BANKING *ab, uint32_t uniqueAccountId, AB_ACCOUNT_SPEC **pAccountSpec)
+AB_ACCOUNT_SPEC_LIST *_dupAccountSpecList(const AB_ACCOUNT_SPEC_LIST *accountSpecList)
+{
+  AB_ACCOUNT_SPEC_LIST *newList;
+  const AB_ACCOUNT_SPEC *as;
+
+  newList=AB_AccountSpec_List_new();
+  as=AB_AccountSpec_List_First(accountSpecList);
+  while (as) {
+    AB_AccountSpec_List_Add(AB_AccountSpec_dup(as), newList);
+    as=AB_AccountSpec_List_Next(as);
+  }
+
+  return newList;
+}
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * account spec cache
+ * ------------------------------------------------------------------------------------------------
+ */
+
+AB_BANKING_ACCSPEC_CACHE *AB_Banking__AccountSpecCache_new(void)
+{
+  AB_BANKING_ACCSPEC_CACHE *cache;
+
+  GWEN_NEW_OBJECT(AB_BANKING_ACCSPEC_CACHE, cache);
+  cache->idMap=GWEN_IdMap_new(GWEN_IdMapAlgo_Hex4);
+  return cache;
+}
+
+
+
+void AB_Banking__AccountSpecCache_free(AB_BANKING_ACCSPEC_CACHE *cache)
 {
+  if (cache) {
+    _accountSpecCacheClear(cache);
+    GWEN_IdMap_free(cache->idMap);
+    GWEN_FREE_OBJECT(cache);
+  }
+}
+
+
+
+int _getCachedAccountSpecs(const AB_BANKING *ab, AB_BANKING_ACCSPEC_CACHE **pCache)
+{
+  AB_BANKING_ACCSPEC_CACHE *cache;
+  AB_ACCOUNT_SPEC_LIST *accountSpecList=NULL;
+  int generation=0;
+  int stampValid;
+  time_t stampTime;
+  time_t stampModTime=0;
+  off_t stampSize=0;
   int rv;
 
-  rv=AB_Banking_ReadAccountSpec(ab, uniqueAccountId, pAccountSpec);
+  assert(ab);
+  cache=ab->accountSpecCache;
+  assert(cache);
+
+  /* no generation counter changed since the last check (changes by this process clear the cache) */
+  if (cache->valid && _accountSpecCacheStampUnchanged(ab, cache)) {
+    *pCache=cache;
+    return 0;
+  }
+
+  /* take the stamp before reading the generation so that every later change is noticed */
+  stampTime=time(NULL);
+  stampValid=(AB_Banking__GetConfigGenerationsFileStamp(ab, &stampModTime, &stampSize)==0);
+
+  /* check whether the account specs have been changed (possibly by another process) */
+  rv=AB_Banking__GetConfigGroupGeneration(ab, AB_CFG_GROUP_ACCOUNTSPECS, &generation, NULL);
   if (rv<0) {
+    /* can't tell whether the cache is still valid */
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    _accountSpecCacheClear(cache);
+    return GWEN_ERROR_NOT_AVAILABLE;
+  }
+
+  if (cache->valid && cache->generation==generation) {
+    cache->stampValid=stampValid;
+    cache->stampTime=stampTime;
+    cache->stampModTime=stampModTime;
+    cache->stampSize=stampSize;
+    *pCache=cache;
+    return 0;
+  }
+
+  /* (re)load account specs */
+  _accountSpecCacheClear(cache);
+  rv=_readAccountSpecList(ab, &accountSpecList);
+  if (rv==GWEN_ERROR_NOT_FOUND) {
+    accountSpecList=AB_AccountSpec_List_new();
+  }
+  else if (rv<0) {
     DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
     return rv;
   }
 
-  return rv;
+  _accountSpecCacheFill(cache, accountSpecList, generation);
+  cache->stampValid=stampValid;
+  cache->stampTime=stampTime;
+  cache->stampModTime=stampModTime;
+  cache->stampSize=stampSize;
+  *pCache=cache;
+  return 0;
+}
+
+
+
+int _accountSpecCacheStampUnchanged(const AB_BANKING *ab, const AB_BANKING_ACCSPEC_CACHE *cache)
+{
+  time_t modTime;
+  off_t size;
+
+  if (!cache->stampValid)
+    return 0;
+
+  /* a change within the same second as taking the stamp can't be told by the modification time */
+  if (cache->stampModTime>=cache->stampTime)
+    return 0;
+
+  if (AB_Banking__GetConfigGenerationsFileStamp(ab, &modTime, &size)<0)
+    return 0;
+
+  return (modTime==cache->stampModTime && size==cache->stampSize);
+}
+
+
+
+void _accountSpecCacheClear(AB_BANKING_ACCSPEC_CACHE *cache)
+{
+  cache->valid=0;
+  cache->generation=0;
+  cache->stampValid=0;
+  GWEN_IdMap_Clear(cache->idMap);
+  free(cache->ibanIndex);
+  cache->ibanIndex=NULL;
+  cache->ibanIndexCount=0;
+  free(cache->bankAccountIndex);
+  cache->bankAccountIndex=NULL;
+  cache->bankAccountIndexCount=0;
+  if (cache->accountSpecList) {
+    AB_AccountSpec_List_free(cache->accountSpecList);
+    cache->accountSpecList=NULL;
+  }
+}
+
+
+
+void _accountSpecCacheFill(AB_BANKING_ACCSPEC_CACHE *cache, AB_ACCOUNT_SPEC_LIST *accountSpecList, int generation)
+{
+  AB_ACCOUNT_SPEC *as;
+  uint32_t count;
+
+  cache->accountSpecList=accountSpecList;
+  count=AB_AccountSpec_List_GetCount(accountSpecList);
+  if (count) {
+    cache->ibanIndex=(AB_ACCOUNT_SPEC **) malloc(count*sizeof(AB_ACCOUNT_SPEC *));
+    cache->bankAccountIndex=(AB_ACCOUNT_SPEC **) malloc(count*sizeof(AB_ACCOUNT_SPEC *));
+    assert(cache->ibanIndex && cache->bankAccountIndex);
+  }
+
+  as=AB_AccountSpec_List_First(accountSpecList);
+  while (as) {
+    const char *s;
+
+    GWEN_IdMap_Insert(cache->idMap, AB_AccountSpec_GetUniqueId(as), as);
+
+    s=AB_AccountSpec_GetIban(as);
+    if (s && *s)
+      cache->ibanIndex[cache->ibanIndexCount++]=as;
+
+    s=AB_AccountSpec_GetAccountNumber(as);
+    if (s && *s)
+      cache->bankAccountIndex[cache->bankAccountIndexCount++]=as;
+
+    as=AB_AccountSpec_List_Next(as);
+  }
+
+  if (cache->ibanIndexCount>1)
+    qsort(cache->ibanIndex, cache->ibanIndexCount, sizeof(AB_ACCOUNT_SPEC *), _cmpByIban);
+  if (cache->bankAccountIndexCount>1)
+    qsort(cache->bankAccountIndex, cache->bankAccountIndexCount, sizeof(AB_ACCOUNT_SPEC *), _cmpByBankAccount);
+
+  cache->generation=generation;
+  cache->valid=1;
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Account spec cache filled (%u account specs, generation %d)", count, generation);
+}
+
+
+
+void _accountSpecCacheInvalidate(AB_BANKING *ab)
+{
+  /* other processes are notified via the generation counter of the config group */
+  assert(ab);
+  _accountSpecCacheClear(ab->accountSpecCache);
+}
+
+
+
+const AB_ACCOUNT_SPEC *_accountSpecCacheFindByIban(const AB_BANKING_ACCSPEC_CACHE *cache, const char *iban)
+{
+  uint32_t lo, hi;
+
+  /* find the first matching entry (lower bound) */
+  lo=0;
+  hi=cache->ibanIndexCount;
+  while (lo<hi) {
+    uint32_t mid;
+
+    mid=lo+((hi-lo)/2);
+    if (_cmpStrings(AB_AccountSpec_GetIban(cache->ibanIndex[mid]), iban)<0)
+      lo=mid+1;
+    else
+      hi=mid;
+  }
+
+  if (lo<cache->ibanIndexCount && _cmpStrings(AB_AccountSpec_GetIban(cache->ibanIndex[lo]), iban)==0)
+    return cache->ibanIndex[lo];
+  return NULL;
+}
+
+
+
+const AB_ACCOUNT_SPEC *_accountSpecCacheFindByBankAccount(const AB_BANKING_ACCSPEC_CACHE *cache,
+                                                          const char *bankCode,
+                                                          const char *accountNumber)
+{
+  uint32_t lo, hi;
+
+  /* find the first matching entry (lower bound) */
+  lo=0;
+  hi=cache->bankAccountIndexCount;
+  while (lo<hi) {
+    const AB_ACCOUNT_SPEC *as;
+    uint32_t mid;
+    int res;
+
+    mid=lo+((hi-lo)/2);
+    as=cache->bankAccountIndex[mid];
+    res=_cmpStrings(AB_AccountSpec_GetBankCode(as), bankCode);
+    if (res==0)
+      res=_cmpStrings(AB_AccountSpec_GetAccountNumber(as), accountNumber);
+    if (res<0)
+      lo=mid+1;
+    else
+      hi=mid;
+  }
+
+  if (lo<cache->bankAccountIndexCount) {
+    const AB_ACCOUNT_SPEC *as;
+
+    as=cache->bankAccountIndex[lo];
+    if (_cmpStrings(AB_AccountSpec_GetBankCode(as), bankCode)==0 &&
+        _cmpStrings(AB_AccountSpec_GetAccountNumber(as), accountNumber)==0)
+      return as;
+  }
+  return NULL;
+}
+
+
+
+int _cmpByIban(const void *p1, const void *p2)
+{
+  const AB_ACCOUNT_SPEC *as1=*((const AB_ACCOUNT_SPEC **) p1);
+  const AB_ACCOUNT_SPEC *as2=*((const AB_ACCOUNT_SPEC **) p2);
+  int res;
+
+  res=_cmpStrings(AB_AccountSpec_GetIban(as1), AB_AccountSpec_GetIban(as2));
+  if (res==0) {
+    uint32_t id1=AB_AccountSpec_GetUniqueId(as1);
+    uint32_t id2=AB_AccountSpec_GetUniqueId(as2);
+
+    res=(id1<id2)?-1:((id1>id2)?1:0);
+  }
+  return res;
+}
+
+
+
+int _cmpByBankAccount(const void *p1, const void *p2)
+{
+  const AB_ACCOUNT_SPEC *as1=*((const AB_ACCOUNT_SPEC **) p1);
+  const AB_ACCOUNT_SPEC *as2=*((const AB_ACCOUNT_SPEC **) p2);
+  int res;
+
+  res=_cmpStrings(AB_AccountSpec_GetBankCode(as1), AB_AccountSpec_GetBankCode(as2));
+  if (res==0)
+    res=_cmpStrings(AB_AccountSpec_GetAccountNumber(as1), AB_AccountSpec_GetAccountNumber(as2));
+  if (res==0) {
+    uint32_t id1=AB_AccountSpec_GetUniqueId(as1);
+    uint32_t id2=AB_AccountSpec_GetUniqueId(as2);
+
+    res=(id1<id2)?-1:((id1>id2)?1:0);
+  }
+  return res;
+}
+
+
+
+int _cmpStrings(const char *s1, const char *s2)
+{
+  return strcasecmp(s1?s1:"", s2?s2:"");
 }
 
 
@@ -154,6 +154,41 @@ int AB_Banking_CheckCryptToken(AB_BANKING *ab,
 int AB_Banking_GetNamedUniqueId(AB_BANKING *ab, const char *idName, int startAtStdUniqueId);
 
 
+/**
+ * Reserve a range of consecutive named unique ids with a single update of the configuration.
+ *
+ * This works like @ref AB_Banking_GetNamedUniqueId but only needs to lock the configuration once for
+ * any number of ids. The ids firstId to firstId+count-1 are reserved for the caller.
+ * @return 0 if ok, error code otherwise
+ * @param ab pointer to AB_BANKING object
+ * @param idName name of the id to get (e.g. "account", "user", "job" etc)
+ * @param startAtStdUniqueId if the given id is zero and this var is !=0 start with the current standard uniqueId
+ * @param count number of ids to reserve
+ * @param pFirstId pointer to a variable to receive the first id of the reserved range
+ */
+int AB_Banking_ReserveNamedUniqueIdRange(AB_BANKING *ab,
+                                         const char *idName,
+                                         int startAtStdUniqueId,
+                                         uint32_t count,
+                                         uint32_t *pFirstId);
+
+/**
+ * Return the unused end of a range reserved via @ref AB_Banking_ReserveNamedUniqueIdRange.
+ *
+ * This is only possible if no other ids have been reserved in the meantime (e.g. by another process).
+ * Otherwise the unused ids are just skipped, since gaps in the id sequence are harmless.
+ * @return 0 if ok, error code otherwise
+ * @param ab pointer to AB_BANKING object
+ * @param idName name of the id
+ * @param firstUnusedId first unused id of the reserved range
+ * @param lastId last id of the reserved range
+ */
+int AB_Banking_ReleaseNamedUniqueIdRange(AB_BANKING *ab,
+                                         const char *idName,
+                                         uint32_t firstUnusedId,
+                                         uint32_t lastId);
+
+
 int AB_Banking_GetCert(AB_BANKING *ab,
                        const char *url,
                        const char *defaultProto,
@@ -10,6 +10,42 @@
 
 
 
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static int _readConfigGroupsUnlocked(const AB_BANKING *ab,
+                                     const char *groupName,
+                                     const GWEN_STRINGLIST *sl,
+                                     const char *uidField,
+                                     const char *matchVar,
+                                     const char *matchVal,
+                                     GWEN_DB_NODE *dbAll);
+static int _readConfigGroupsLocked(const AB_BANKING *ab,
+                                   const char *groupName,
+                                   const GWEN_STRINGLIST *sl,
+                                   const char *uidField,
+                                   const char *matchVar,
+                                   const char *matchVal,
+                                   GWEN_DB_NODE *dbAll);
+static void _addConfigGroupIfMatches(GWEN_DB_NODE *dbAll,
+                                     GWEN_DB_NODE *db,
+                                     const char *subGroupName,
+                                     const char *uidField,
+                                     const char *matchVar,
+                                     const char *matchVal);
+static int _incConfigGroupGeneration(AB_BANKING *ab, const char *groupName, int finished);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
 int AB_Banking__GetConfigManager(AB_BANKING *ab, const char *dname)
 {
   GWEN_BUFFER *buf;
@@ -79,6 +115,7 @@ int AB_Banking__GetConfigManager(AB_BANKING *ab, const char *dname)
     GWEN_Buffer_free(buf);
     return GWEN_ERROR_GENERIC;
   }
+  ab->configMgrDir=strdup(GWEN_Buffer_GetStart(buf)+strlen("dir://"));
 
   /* done */
   GWEN_Buffer_free(buf);
@@ -367,15 +404,34 @@ int AB_Banking_WriteNamedConfigGroup(AB_BANKING *ab,
     }
   }
 
+  /* let unlocked readers know that a write is in progress */
+  rv=_incConfigGroupGeneration(ab, groupName, 0);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not update generation of config group (%d)", rv);
+    if (doLock)
+      GWEN_ConfigMgr_UnlockGroup(ab->configMgr, groupName, subGroupName);
+    return rv;
+  }
+
   /* store group (is locked now) */
   rv=GWEN_ConfigMgr_SetGroup(ab->configMgr, groupName, subGroupName, db);
   if (rv<0) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not load config group (%d)", rv);
+    _incConfigGroupGeneration(ab, groupName, 1);
     if (doLock)
       GWEN_ConfigMgr_UnlockGroup(ab->configMgr, groupName, subGroupName);
     return rv;
   }
 
+  /* let unlocked readers and caches know that the write is finished (while the group is still locked) */
+  rv=_incConfigGroupGeneration(ab, groupName, 1);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not update generation of config group (%d)", rv);
+    if (doUnlock)
+      GWEN_ConfigMgr_UnlockGroup(ab->configMgr, groupName, subGroupName);
+    return rv;
+  }
+
   /* unlock group */
   if (doUnlock) {
     rv=GWEN_ConfigMgr_UnlockGroup(ab->configMgr, groupName, subGroupName);
@@ -523,10 +579,42 @@ int AB_Banking_DeleteConfigGroup(AB_BANKING *ab, const char *groupName, uint32_t
   }
   idBuf[sizeof(idBuf)-1]=0;
 
-  /* unlock group */
-  rv=GWEN_ConfigMgr_DeleteGroup(ab->configMgr, groupName, idBuf);
+  rv=AB_Banking_DeleteNamedConfigGroup(ab, groupName, idBuf);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+int AB_Banking_DeleteNamedConfigGroup(AB_BANKING *ab, const char *groupName, const char *subGroupName)
+{
+  int rv;
+
+  assert(ab);
+
+  /* let unlocked readers know that a write is in progress */
+  rv=_incConfigGroupGeneration(ab, groupName, 0);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not update generation of config group (%d)", rv);
+    return rv;
+  }
+
+  /* delete group */
+  rv=GWEN_ConfigMgr_DeleteGroup(ab->configMgr, groupName, subGroupName);
   if (rv<0) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to delete config group (%d)", rv);
+    _incConfigGroupGeneration(ab, groupName, 1);
+    return rv;
+  }
+
+  /* let unlocked readers and caches know that the write is finished */
+  rv=_incConfigGroupGeneration(ab, groupName, 1);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not update generation of config group (%d)", rv);
     return rv;
   }
 
@@ -587,73 +675,18 @@ int AB_Banking_ReadConfigGroups(const AB_BANKING *ab,
   }
   if (GWEN_StringList_Count(sl)) {
     GWEN_DB_NODE *dbAll;
-    GWEN_STRINGLISTENTRY *se;
     int ignoredGroups=0;
 
     dbAll=GWEN_DB_Group_new("all");
 
-    se=GWEN_StringList_FirstEntry(sl);
-    while (se) {
-      const char *t;
-      GWEN_DB_NODE *db=NULL;
-
-      t=GWEN_StringListEntry_Data(se);
-      assert(t);
-
-      /* lock before reading */
-      rv=GWEN_ConfigMgr_LockGroup(ab->configMgr, groupName, t);
-      if (rv<0) {
-        DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to lock config group \"%s\" (%d), ignoring", t, rv);
-        ignoredGroups++;
-      }
-      else {
-        rv=GWEN_ConfigMgr_GetGroup(ab->configMgr, groupName, t, &db);
-        if (rv<0) {
-          DBG_WARN(AQBANKING_LOGDOMAIN, "Could not load group [%s] (%d), ignoring", t, rv);
-          GWEN_ConfigMgr_UnlockGroup(ab->configMgr, groupName, t);
-          ignoredGroups++;
-        }
-        else {
-          int doAdd=1;
-
-          /* unlock after reading */
-          rv=GWEN_ConfigMgr_UnlockGroup(ab->configMgr, groupName, t);
-          if (rv<0) {
-            DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not unlock group [%s] (%d)", t, rv);
-          }
-
-          assert(db);
-          GWEN_DB_GroupRename(db, t);
-          if (doAdd && uidField && *uidField) {
-            int v;
-
-            v=GWEN_DB_GetIntValue(db, uidField, 0, 0);
-            if (v==0)
-              doAdd=0;
-          }
-
-          if (doAdd && matchVar && *matchVar) {
-            const char *s;
-
-            s=GWEN_DB_GetCharValue(db, matchVar, 0, NULL);
-            if (s && *s) {
-              if (strcasecmp(s, matchVal)!=0)
-                doAdd=0;
-            }
-            else {
-              if (matchVal && *matchVal)
-                doAdd=0;
-            }
-          }
-
-          if (doAdd)
-            GWEN_DB_AddGroup(dbAll, db);
-          else
-            GWEN_DB_Group_free(db);
-        } /* if getGroup ok */
-      } /* if locking ok */
-      se=GWEN_StringListEntry_Next(se);
-    } /* while se */
+    /* try to read all groups without locking them one by one, fall back to locking if that fails */
+    rv=_readConfigGroupsUnlocked(ab, groupName, sl, uidField, matchVar, matchVal, dbAll);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Unlocked read of \"%s\" not possible (%d), locking groups", groupName, rv);
+      GWEN_DB_Group_free(dbAll);
+      dbAll=GWEN_DB_Group_new("all");
+      ignoredGroups=_readConfigGroupsLocked(ab, groupName, sl, uidField, matchVar, matchVal, dbAll);
+    }
 
     if (GWEN_DB_Groups_Count(dbAll)) {
       *pDb=dbAll;
@@ -679,5 +712,283 @@ int AB_Banking_ReadConfigGroups(const AB_BANKING *ab,
 
 
 
+int AB_Banking__GetConfigGroupGeneration(const AB_BANKING *ab, const char *groupName, int *pGeneration, int *pWriting)
+{
+  GWEN_DB_NODE *db=NULL;
+  int rv;
+
+  rv=GWEN_ConfigMgr_LockGroup(ab->configMgr, AB_CFG_GROUP_MAIN, AB_CFG_SUBGROUP_GENERATIONS);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Unable to lock generations group (%d)", rv);
+    return rv;
+  }
+
+  rv=GWEN_ConfigMgr_GetGroup(ab->configMgr, AB_CFG_GROUP_MAIN, AB_CFG_SUBGROUP_GENERATIONS, &db);
+  if (rv==GWEN_ERROR_NOT_FOUND) {
+    /* nothing written since generation counters were introduced */
+    *pGeneration=0;
+    if (pWriting)
+      *pWriting=0;
+  }
+  else if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Unable to read generations group (%d)", rv);
+    GWEN_ConfigMgr_UnlockGroup(ab->configMgr, AB_CFG_GROUP_MAIN, AB_CFG_SUBGROUP_GENERATIONS);
+    return rv;
+  }
+  else {
+    GWEN_DB_NODE *dbGroup;
+
+    dbGroup=GWEN_DB_GetGroup(db, GWEN_PATH_FLAGS_NAMEMUSTEXIST, groupName);
+    *pGeneration=dbGroup?GWEN_DB_GetIntValue(dbGroup, "generation", 0, 0):0;
+    if (pWriting)
+      *pWriting=dbGroup?(GWEN_DB_GetIntValue(dbGroup, "completed", 0, *pGeneration)!=*pGeneration):0;
+    GWEN_DB_Group_free(db);
+  }
+
+  rv=GWEN_ConfigMgr_UnlockGroup(ab->configMgr, AB_CFG_GROUP_MAIN, AB_CFG_SUBGROUP_GENERATIONS);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Unable to unlock generations group (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+int AB_Banking__GetConfigGenerationsFileStamp(const AB_BANKING *ab, time_t *pModTime, off_t *pSize)
+{
+  GWEN_BUFFER *buf;
+  struct stat st;
+  int rv;
+
+  if (ab->configMgrDir==NULL)
+    return GWEN_ERROR_NOT_AVAILABLE;
+
+  /* file used by the "dir" config manager for the generations group */
+  buf=GWEN_Buffer_new(0, 256, 0, 1);
+  GWEN_Buffer_AppendString(buf, ab->configMgrDir);
+  GWEN_Buffer_AppendString(buf, DIRSEP);
+  GWEN_Buffer_AppendString(buf, AB_CFG_GROUP_MAIN);
+  GWEN_Buffer_AppendString(buf, DIRSEP);
+  GWEN_Buffer_AppendString(buf, AB_CFG_SUBGROUP_GENERATIONS);
+  GWEN_Buffer_AppendString(buf, ".conf");
+  rv=stat(GWEN_Buffer_GetStart(buf), &st);
+  GWEN_Buffer_free(buf);
+  if (rv)
+    return GWEN_ERROR_NOT_FOUND;
+
+  *pModTime=st.st_mtime;
+  *pSize=st.st_size;
+  return 0;
+}
+
+
+
+int _incConfigGroupGeneration(AB_BANKING *ab, const char *groupName, int finished)
+{
+  const char *varName;
+  GWEN_DB_NODE *db=NULL;
+  GWEN_DB_NODE *dbGroup;
+  int rv;
+
+  rv=GWEN_ConfigMgr_LockGroup(ab->configMgr, AB_CFG_GROUP_MAIN, AB_CFG_SUBGROUP_GENERATIONS);
+  if (rv<0) {
+    DBG_WARN(AQBANKING_LOGDOMAIN, "Unable to lock generations group (%d)", rv);
+    return rv;
+  }
+
+  rv=GWEN_ConfigMgr_GetGroup(ab->configMgr, AB_CFG_GROUP_MAIN, AB_CFG_SUBGROUP_GENERATIONS, &db);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Generations group not readable (%d), creating it", rv);
+    db=GWEN_DB_Group_new(AB_CFG_SUBGROUP_GENERATIONS);
+  }
+
+  /*
+   * "generation" is incremented before and "completed" after every write, so a write is in progress while
+   * they differ. Using two counters instead of one also works with concurrent writers of different subgroups.
+   */
+  varName=finished?"completed":"generation";
+  dbGroup=GWEN_DB_GetGroup(db, GWEN_DB_FLAGS_DEFAULT, groupName);
+  assert(dbGroup);
+  if (!GWEN_DB_VariableExists(dbGroup, "completed")) {
+    /* written by a version only counting finished writes */
+    GWEN_DB_SetIntValue(dbGroup, GWEN_DB_FLAGS_OVERWRITE_VARS, "completed",
+                        GWEN_DB_GetIntValue(dbGroup, "generation", 0, 0));
+  }
+  GWEN_DB_SetIntValue(dbGroup, GWEN_DB_FLAGS_OVERWRITE_VARS, varName,
+                      GWEN_DB_GetIntValue(dbGroup, varName, 0, 0)+1);
+
+  rv=GWEN_ConfigMgr_SetGroup(ab->configMgr, AB_CFG_GROUP_MAIN, AB_CFG_SUBGROUP_GENERATIONS, db);
+  GWEN_DB_Group_free(db);
+  if (rv<0) {
+    DBG_WARN(AQBANKING_LOGDOMAIN, "Unable to write generations group (%d)", rv);
+    GWEN_ConfigMgr_UnlockGroup(ab->configMgr, AB_CFG_GROUP_MAIN, AB_CFG_SUBGROUP_GENERATIONS);
+    return rv;
+  }
+
+  rv=GWEN_ConfigMgr_UnlockGroup(ab->configMgr, AB_CFG_GROUP_MAIN, AB_CFG_SUBGROUP_GENERATIONS);
+  if (rv<0) {
+    DBG_WARN(AQBANKING_LOGDOMAIN, "Unable to unlock generations group (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+int _readConfigGroupsUnlocked(const AB_BANKING *ab,
+                              const char *groupName,
+                              const GWEN_STRINGLIST *sl,
+                              const char *uidField,
+                              const char *matchVar,
+                              const char *matchVal,
+                              GWEN_DB_NODE *dbAll)
+{
+  GWEN_STRINGLISTENTRY *se;
+  int generationBefore=0;
+  int generationAfter=0;
+  int writing=0;
+  int rv;
+
+  /*
+   * The generation is incremented before every write or delete, so the result is only used if no write
+   * was in progress when starting and none started while reading.
+   */
+  rv=AB_Banking__GetConfigGroupGeneration(ab, groupName, &generationBefore, &writing);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+  if (writing) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Group \"%s\" is being written", groupName);
+    return GWEN_ERROR_TRY_AGAIN;
+  }
+
+  se=GWEN_StringList_FirstEntry(sl);
+  while (se) {
+    const char *t;
+    GWEN_DB_NODE *db=NULL;
+
+    t=GWEN_StringListEntry_Data(se);
+    assert(t);
+
+    rv=GWEN_ConfigMgr_GetGroup(ab->configMgr, groupName, t, &db);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Could not load group [%s] (%d)", t, rv);
+      return rv;
+    }
+    _addConfigGroupIfMatches(dbAll, db, t, uidField, matchVar, matchVal);
+    se=GWEN_StringListEntry_Next(se);
+  } /* while se */
+
+  rv=AB_Banking__GetConfigGroupGeneration(ab, groupName, &generationAfter, NULL);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+  if (generationAfter!=generationBefore) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Group \"%s\" changed while reading", groupName);
+    return GWEN_ERROR_TRY_AGAIN;
+  }
+
+  return 0;
+}
+
+
+
+int _readConfigGroupsLocked(const AB_BANKING *ab,
+                            const char *groupName,
+                            const GWEN_STRINGLIST *sl,
+                            const char *uidField,
+                            const char *matchVar,
+                            const char *matchVal,
+                            GWEN_DB_NODE *dbAll)
+{
+  GWEN_STRINGLISTENTRY *se;
+  int ignoredGroups=0;
+
+  se=GWEN_StringList_FirstEntry(sl);
+  while (se) {
+    const char *t;
+    GWEN_DB_NODE *db=NULL;
+    int rv;
+
+    t=GWEN_StringListEntry_Data(se);
+    assert(t);
+
+    /* lock before reading */
+    rv=GWEN_ConfigMgr_LockGroup(ab->configMgr, groupName, t);
+    if (rv<0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to lock config group \"%s\" (%d), ignoring", t, rv);
+      ignoredGroups++;
+    }
+    else {
+      rv=GWEN_ConfigMgr_GetGroup(ab->configMgr, groupName, t, &db);
+      if (rv<0) {
+        DBG_WARN(AQBANKING_LOGDOMAIN, "Could not load group [%s] (%d), ignoring", t, rv);
+        GWEN_ConfigMgr_UnlockGroup(ab->configMgr, groupName, t);
+        ignoredGroups++;
+      }
+      else {
+        /* unlock after reading */
+        rv=GWEN_ConfigMgr_UnlockGroup(ab->configMgr, groupName, t);
+        if (rv<0) {
+          DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not unlock group [%s] (%d)", t, rv);
+        }
+
+        _addConfigGroupIfMatches(dbAll, db, t, uidField, matchVar, matchVal);
+      } /* if getGroup ok */
+    } /* if locking ok */
+    se=GWEN_StringListEntry_Next(se);
+  } /* while se */
+
+  return ignoredGroups;
+}
+
+
+
+void _addConfigGroupIfMatches(GWEN_DB_NODE *dbAll,
+                              GWEN_DB_NODE *db,
+                              const char *subGroupName,
+                              const char *uidField,
+                              const char *matchVar,
+                              const char *matchVal)
+{
+  int doAdd=1;
+
+  assert(db);
+  GWEN_DB_GroupRename(db, subGroupName);
+  if (doAdd && uidField && *uidField) {
+    int v;
+
+    v=GWEN_DB_GetIntValue(db, uidField, 0, 0);
+    if (v==0)
+      doAdd=0;
+  }
+
+  if (doAdd && matchVar && *matchVar) {
+    const char *s;
+
+    s=GWEN_DB_GetCharValue(db, matchVar, 0, NULL);
+    if (s && *s) {
+      if (strcasecmp(s, matchVal)!=0)
+        doAdd=0;
+    }
+    else {
+      if (matchVal && *matchVal)
+        doAdd=0;
+    }
+  }
+
+  if (doAdd)
+    GWEN_DB_AddGroup(dbAll, db);
+  else
+    GWEN_DB_Group_free(db);
+}
+
+
+
 
 
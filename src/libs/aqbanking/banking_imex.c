@@ -11,6 +11,7 @@
 /* This file is included by banking.c */
 
 #include "aqbanking/backendsupport/swiftdescr.h"
+#include "aqbanking/types/transaction_hashstore.h"
 
 
 #ifdef AQBANKING_WITH_PLUGIN_IMEXPORTER_CSV
@@ -64,6 +65,35 @@
 
 
 
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static GWEN_DB_NODE *_getCachedImExporterProfiles(AB_BANKING *ab, const char *imExporterName);
+static GWEN_STRINGLIST *_getImExporterProfileFolders(AB_BANKING *ab, const char *imExporterName);
+static time_t _getFolderModTime(const char *folder);
+
+static AB_BANKING_IMEXPROFILE_CACHE *_imExporterProfileCacheRead(AB_BANKING *ab,
+                                                                 const char *imExporterName,
+                                                                 const GWEN_STRINGLIST *folderList);
+static int _imExporterProfileCacheIsValid(const AB_BANKING_IMEXPROFILE_CACHE *entry, const GWEN_STRINGLIST *folderList);
+static AB_BANKING_IMEXPROFILE_CACHE *_imExporterProfileCacheFind(const AB_BANKING *ab, const char *imExporterName);
+static void _imExporterProfileCacheRemove(AB_BANKING *ab, const char *imExporterName);
+static void _imExporterProfileCacheEntryFree(AB_BANKING_IMEXPROFILE_CACHE *entry);
+
+static int _getTransactionHashStorePath(AB_BANKING *ab, const AB_IMEXPORTER_ACCOUNTINFO *iea, GWEN_BUFFER *buf);
+static int _dropKnownTransactionsFromAccountInfo(AB_IMEXPORTER_ACCOUNTINFO *iea, const char *fname);
+static int _addKnownTransactionsFromAccountInfo(const AB_IMEXPORTER_ACCOUNTINFO *iea, const char *fname);
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
 
 AB_IMEXPORTER *AB_Banking__CreateImExporterPlugin(AB_BANKING *ab, const char *modname)
 {
@@ -644,6 +674,235 @@ int AB_Banking_ExportToBufferLoadProfile(AB_BANKING *ab,
 
 
 
+int AB_Banking_DropKnownTransactions(AB_BANKING *ab, AB_IMEXPORTER_CONTEXT *ctx)
+{
+  AB_IMEXPORTER_ACCOUNTINFO *iea;
+  GWEN_BUFFER *buf;
+  int dropped=0;
+
+  assert(ab);
+  assert(ctx);
+
+  buf=GWEN_Buffer_new(0, 256, 0, 1);
+  iea=AB_ImExporterContext_GetFirstAccountInfo(ctx);
+  while (iea) {
+    if (AB_ImExporterAccountInfo_GetFirstTransaction(iea, AB_Transaction_TypeStatement, 0)) {
+      int rv;
+
+      GWEN_Buffer_Reset(buf);
+      rv=_getTransactionHashStorePath(ab, iea, buf);
+      if (rv==0)
+        rv=_dropKnownTransactionsFromAccountInfo(iea, GWEN_Buffer_GetStart(buf));
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        GWEN_Buffer_free(buf);
+        return rv;
+      }
+      dropped+=rv;
+    }
+    iea=AB_ImExporterAccountInfo_List_Next(iea);
+  }
+  GWEN_Buffer_free(buf);
+
+  return dropped;
+}
+
+
+
+int AB_Banking_AddKnownTransactions(AB_BANKING *ab, const AB_IMEXPORTER_CONTEXT *ctx)
+{
+  const AB_IMEXPORTER_ACCOUNTINFO *iea;
+  GWEN_BUFFER *buf;
+  int added=0;
+
+  assert(ab);
+  assert(ctx);
+
+  buf=GWEN_Buffer_new(0, 256, 0, 1);
+  iea=AB_ImExporterContext_GetFirstAccountInfo(ctx);
+  while (iea) {
+    if (AB_ImExporterAccountInfo_GetFirstTransaction(iea, AB_Transaction_TypeStatement, 0)) {
+      int rv;
+
+      GWEN_Buffer_Reset(buf);
+      rv=_getTransactionHashStorePath(ab, iea, buf);
+      if (rv==0)
+        rv=_addKnownTransactionsFromAccountInfo(iea, GWEN_Buffer_GetStart(buf));
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        GWEN_Buffer_free(buf);
+        return rv;
+      }
+      added+=rv;
+    }
+    iea=AB_ImExporterAccountInfo_List_Next(iea);
+  }
+  GWEN_Buffer_free(buf);
+
+  return added;
+}
+
+
+
+int _getTransactionHashStorePath(AB_BANKING *ab, const AB_IMEXPORTER_ACCOUNTINFO *iea, GWEN_BUFFER *buf)
+{
+  GWEN_BUFFER *keyBuf;
+  const char *s;
+  int rv;
+
+  /* prefer the IBAN, it doesn't depend on the local account database */
+  keyBuf=GWEN_Buffer_new(0, 64, 0, 1);
+  s=AB_ImExporterAccountInfo_GetIban(iea);
+  if (s && *s)
+    GWEN_Buffer_AppendString(keyBuf, s);
+  else if (AB_ImExporterAccountInfo_GetAccountNumber(iea)) {
+    s=AB_ImExporterAccountInfo_GetBankCode(iea);
+    GWEN_Buffer_AppendString(keyBuf, (s && *s)?s:"none");
+    GWEN_Buffer_AppendString(keyBuf, "_");
+    GWEN_Buffer_AppendString(keyBuf, AB_ImExporterAccountInfo_GetAccountNumber(iea));
+  }
+  else if (AB_ImExporterAccountInfo_GetAccountId(iea)) {
+    char numbuf[32];
+
+    snprintf(numbuf, sizeof(numbuf)-1, "id_%u", (unsigned int) AB_ImExporterAccountInfo_GetAccountId(iea));
+    numbuf[sizeof(numbuf)-1]=0;
+    GWEN_Buffer_AppendString(keyBuf, numbuf);
+  }
+  else {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Account info without IBAN, account number or account id");
+    GWEN_Buffer_free(keyBuf);
+    return GWEN_ERROR_INVALID;
+  }
+
+  rv=AB_Banking_GetUserDataDir(ab, buf);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not get user data dir");
+    GWEN_Buffer_free(keyBuf);
+    return rv;
+  }
+  GWEN_Buffer_AppendString(buf, DIRSEP AB_TRANSACTION_HASHES_FOLDER DIRSEP);
+  rv=GWEN_Text_EscapeToBufferTolerant(GWEN_Buffer_GetStart(keyBuf), buf);
+  GWEN_Buffer_free(keyBuf);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+  GWEN_Buffer_AppendString(buf, ".hashes");
+
+  /* make sure the folder exists */
+  if (GWEN_Directory_GetPath(GWEN_Buffer_GetStart(buf), GWEN_PATH_FLAGS_VARIABLE)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not create folder for \"%s\"", GWEN_Buffer_GetStart(buf));
+    return GWEN_ERROR_IO;
+  }
+
+  return 0;
+}
+
+
+
+int _dropKnownTransactionsFromAccountInfo(AB_IMEXPORTER_ACCOUNTINFO *iea, const char *fname)
+{
+  AB_TRANSACTION_HASHSTORE *hs;
+  AB_TRANSACTION_HASHSTORE *hsDropped;
+  AB_TRANSACTION *t;
+  int dropped=0;
+  int rv;
+
+  hs=AB_TransactionHashStore_new();
+  rv=AB_TransactionHashStore_Open(hs, fname);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    AB_TransactionHashStore_free(hs);
+    return rv;
+  }
+  /* only compare against the digests of earlier runs, the store is only updated by
+   * AB_Banking_AddKnownTransactions(). */
+  rv=AB_TransactionHashStore_Close(hs);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    AB_TransactionHashStore_free(hs);
+    return rv;
+  }
+
+  /* identical bookings (e.g. two equal payments on the same day) have the same digest, so never drop
+   * more copies of a digest than have been received before (counted in memory by hsDropped) */
+  hsDropped=AB_TransactionHashStore_new();
+  t=AB_ImExporterAccountInfo_GetFirstTransaction(iea, AB_Transaction_TypeStatement, 0);
+  while (t) {
+    AB_TRANSACTION *tNext;
+    uint8_t digest[AB_TRANSACTION_HASHSTORE_DIGEST_SIZE];
+
+    tNext=AB_Transaction_List_FindNextByType(t, AB_Transaction_TypeStatement, 0);
+    rv=AB_TransactionHashStore_GetTransactionDigest(t, digest);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      AB_TransactionHashStore_free(hsDropped);
+      AB_TransactionHashStore_free(hs);
+      return rv;
+    }
+    if (AB_TransactionHashStore_GetDigestCount(hsDropped, digest)<AB_TransactionHashStore_GetDigestCount(hs, digest)) {
+      rv=AB_TransactionHashStore_AddDigest(hsDropped, digest);
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        AB_TransactionHashStore_free(hsDropped);
+        AB_TransactionHashStore_free(hs);
+        return rv;
+      }
+      AB_Transaction_List_Del(t);
+      AB_Transaction_free(t);
+      dropped++;
+    }
+    t=tNext;
+  }
+  AB_TransactionHashStore_free(hsDropped);
+  AB_TransactionHashStore_free(hs);
+
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Dropped %d known transactions (%s)", dropped, fname);
+  return dropped;
+}
+
+
+
+int _addKnownTransactionsFromAccountInfo(const AB_IMEXPORTER_ACCOUNTINFO *iea, const char *fname)
+{
+  AB_TRANSACTION_HASHSTORE *hs;
+  const AB_TRANSACTION *t;
+  int added=0;
+  int rv;
+
+  hs=AB_TransactionHashStore_new();
+  rv=AB_TransactionHashStore_Open(hs, fname);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    AB_TransactionHashStore_free(hs);
+    return rv;
+  }
+
+  t=AB_ImExporterAccountInfo_GetFirstTransaction(iea, AB_Transaction_TypeStatement, 0);
+  while (t) {
+    rv=AB_TransactionHashStore_AddTransaction(hs, t);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      AB_TransactionHashStore_free(hs);
+      return rv;
+    }
+    added++;
+    t=AB_Transaction_List_FindNextByType(t, AB_Transaction_TypeStatement, 0);
+  }
+
+  rv=AB_TransactionHashStore_Close(hs);
+  AB_TransactionHashStore_free(hs);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Added %d transactions to the known ones (%s)", added, fname);
+  return added;
+}
+
+
+
 GWEN_PLUGIN_DESCRIPTION_LIST2 *AB_Banking_GetImExporterDescrs(AB_BANKING *ab)
 {
   assert(ab);
@@ -767,93 +1026,16 @@ int AB_Banking__ReadImExporterProfiles(AB_BANKING *ab,
 GWEN_DB_NODE *AB_Banking_GetImExporterProfiles(AB_BANKING *ab,
                                                const char *name)
 {
-  GWEN_BUFFER *buf;
-  GWEN_DB_NODE *db;
-  int rv;
-  GWEN_STRINGLIST *sl;
-  GWEN_STRINGLISTENTRY *sentry;
-
-  buf=GWEN_Buffer_new(0, 256, 0, 1);
-  db=GWEN_DB_Group_new("profiles");
-
-  sl=AB_Banking_GetGlobalDataDirs();
-  assert(sl);
-
-  sentry=GWEN_StringList_FirstEntry(sl);
-  assert(sentry);
-
-  while (sentry) {
-    const char *pkgdatadir;
-
-    pkgdatadir = GWEN_StringListEntry_Data(sentry);
-    assert(pkgdatadir);
-
-    /* read global profiles */
-    GWEN_Buffer_AppendString(buf, pkgdatadir);
-    GWEN_Buffer_AppendString(buf,
-                             DIRSEP
-                             "aqbanking"
-                             DIRSEP
-                             AB_IMEXPORTER_FOLDER
-                             DIRSEP);
-    if (GWEN_Text_EscapeToBufferTolerant(name, buf)) {
-      DBG_ERROR(AQBANKING_LOGDOMAIN,
-                "Bad name for importer/exporter");
-      GWEN_StringList_free(sl);
-      GWEN_DB_Group_free(db);
-      GWEN_Buffer_free(buf);
-      return 0;
-    }
-    GWEN_Buffer_AppendString(buf, DIRSEP "profiles");
-    rv=AB_Banking__ReadImExporterProfiles(ab,
-                                          GWEN_Buffer_GetStart(buf),
-                                          db,
-                                          1);
-    if (rv && rv!=GWEN_ERROR_NOT_FOUND) {
-      DBG_ERROR(AQBANKING_LOGDOMAIN,
-                "Error reading global profiles");
-      GWEN_StringList_free(sl);
-      GWEN_DB_Group_free(db);
-      GWEN_Buffer_free(buf);
-      return 0;
-    }
-    GWEN_Buffer_Reset(buf);
-    sentry=GWEN_StringListEntry_Next(sentry);
-  }
-  GWEN_StringList_free(sl);
-
-  /* read local user profiles */
-  if (AB_Banking_GetUserDataDir(ab, buf)) {
-    DBG_ERROR(AQBANKING_LOGDOMAIN,
-              "Could not get user data dir");
-    GWEN_DB_Group_free(db);
-    GWEN_Buffer_free(buf);
-    return 0;
-  }
-  GWEN_Buffer_AppendString(buf, DIRSEP AB_IMEXPORTER_FOLDER DIRSEP);
-  if (GWEN_Text_EscapeToBufferTolerant(name, buf)) {
-    DBG_ERROR(AQBANKING_LOGDOMAIN,
-              "Bad name for importer/exporter");
-    GWEN_DB_Group_free(db);
-    GWEN_Buffer_free(buf);
-    return 0;
-  }
-  GWEN_Buffer_AppendString(buf, DIRSEP "profiles");
+  GWEN_DB_NODE *dbProfiles;
 
-  rv=AB_Banking__ReadImExporterProfiles(ab,
-                                        GWEN_Buffer_GetStart(buf),
-                                        db,
-                                        0);
-  if (rv && rv!=GWEN_ERROR_NOT_FOUND) {
-    DBG_ERROR(AQBANKING_LOGDOMAIN,
-              "Error reading users profiles");
-    GWEN_DB_Group_free(db);
-    GWEN_Buffer_free(buf);
-    return 0;
+  dbProfiles=_getCachedImExporterProfiles(ab, name);
+  if (dbProfiles==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here");
+    return NULL;
   }
-  GWEN_Buffer_free(buf);
 
-  return db;
+  /* the caller owns (and may modify) the returned copy */
+  return GWEN_DB_Group_dup(dbProfiles);
 }
 
 
@@ -894,6 +1076,9 @@ int AB_Banking_SaveLocalImExporterProfile(AB_BANKING *ab,
     return rv;
   }
 
+  /* overwriting an existing file doesn't change the modification time of the folder */
+  _imExporterProfileCacheRemove(ab, imexporterName);
+
   GWEN_Buffer_AppendString(buf, DIRSEP);
   if (fname && *fname)
     GWEN_Buffer_AppendString(buf, fname);
@@ -1054,7 +1239,7 @@ GWEN_DB_NODE *AB_Banking_GetImExporterProfile(AB_BANKING *ab,
 {
   GWEN_DB_NODE *dbProfiles;
 
-  dbProfiles=AB_Banking_GetImExporterProfiles(ab, imExporterName);
+  dbProfiles=_getCachedImExporterProfiles(ab, imExporterName);
   if (dbProfiles) {
     GWEN_DB_NODE *dbProfile;
 
@@ -1072,13 +1257,10 @@ GWEN_DB_NODE *AB_Banking_GetImExporterProfile(AB_BANKING *ab,
       DBG_ERROR(AQBANKING_LOGDOMAIN,
                 "Profile \"%s\" for exporter \"%s\" not found",
                 profileName, imExporterName);
-      GWEN_DB_Group_free(dbProfiles);
       return NULL;
     }
 
-    GWEN_DB_UnlinkGroup(dbProfile);
-    GWEN_DB_Group_free(dbProfiles);
-    return dbProfile;
+    return GWEN_DB_Group_dup(dbProfile);
   }
   else {
     DBG_ERROR(AQBANKING_LOGDOMAIN,
@@ -1101,7 +1283,7 @@ GWEN_DB_NODE *AB_Banking_FindMatchingSwiftImExporterProfile(AB_BANKING *ab,
 {
   GWEN_DB_NODE *dbProfiles;
 
-  dbProfiles=AB_Banking_GetImExporterProfiles(ab, imExporterName);
+  dbProfiles=_getCachedImExporterProfiles(ab, imExporterName);
   if (dbProfiles) {
     GWEN_DB_NODE *dbProfile;
 
@@ -1129,13 +1311,10 @@ GWEN_DB_NODE *AB_Banking_FindMatchingSwiftImExporterProfile(AB_BANKING *ab,
                 "Profile \"%s.%03d.%03d.%02d\" for exporter \"%s\" not found",
                 family, version1, version2, version3,
                 imExporterName);
-      GWEN_DB_Group_free(dbProfiles);
       return NULL;
     }
 
-    GWEN_DB_UnlinkGroup(dbProfile);
-    GWEN_DB_Group_free(dbProfiles);
-    return dbProfile;
+    return GWEN_DB_Group_dup(dbProfile);
   }
   else {
     DBG_ERROR(AQBANKING_LOGDOMAIN,
@@ -1153,7 +1332,7 @@ AB_SWIFT_DESCR_LIST *AB_Banking_GetSwiftDescriptorsForImExporter(AB_BANKING *ab,
 {
   GWEN_DB_NODE *dbProfiles;
 
-  dbProfiles=AB_Banking_GetImExporterProfiles(ab, imExporterName);
+  dbProfiles=_getCachedImExporterProfiles(ab, imExporterName);
   if (dbProfiles) {
     GWEN_DB_NODE *dbProfile;
     AB_SWIFT_DESCR_LIST *descrList;
@@ -1196,4 +1375,257 @@ AB_SWIFT_DESCR_LIST *AB_Banking_GetSwiftDescriptorsForImExporter(AB_BANKING *ab,
 
 
 
+/* ------------------------------------------------------------------------------------------------
+ * im-/exporter profile cache
+ * ------------------------------------------------------------------------------------------------
+ */
+
+void AB_Banking__ImExporterProfileCache_free(AB_BANKING_IMEXPROFILE_CACHE *cache)
+{
+  while (cache) {
+    AB_BANKING_IMEXPROFILE_CACHE *next;
+
+    next=cache->next;
+    _imExporterProfileCacheEntryFree(cache);
+    cache=next;
+  }
+}
+
+
+
+/* Returns the profiles of the given im-/exporter, re-reading them only if a profile folder has changed.
+ * The group returned belongs to the cache and must neither be modified nor freed. */
+GWEN_DB_NODE *_getCachedImExporterProfiles(AB_BANKING *ab, const char *imExporterName)
+{
+  GWEN_STRINGLIST *folderList;
+  AB_BANKING_IMEXPROFILE_CACHE *entry;
+
+  assert(ab);
+  assert(imExporterName);
+
+  folderList=_getImExporterProfileFolders(ab, imExporterName);
+  if (folderList==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here");
+    return NULL;
+  }
+
+  entry=_imExporterProfileCacheFind(ab, imExporterName);
+  if (entry && _imExporterProfileCacheIsValid(entry, folderList)) {
+    DBG_DEBUG(AQBANKING_LOGDOMAIN, "Using cached profiles for \"%s\"", imExporterName);
+    GWEN_StringList_free(folderList);
+    return entry->dbProfiles;
+  }
+
+  entry=_imExporterProfileCacheRead(ab, imExporterName, folderList);
+  GWEN_StringList_free(folderList);
+  if (entry==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here");
+    return NULL;
+  }
+
+  _imExporterProfileCacheRemove(ab, imExporterName);
+  entry->next=ab->imExporterProfileCache;
+  ab->imExporterProfileCache=entry;
+  return entry->dbProfiles;
+}
+
+
+
+/* Returns the profile folders of the given im-/exporter, global folders first, the users folder last. */
+GWEN_STRINGLIST *_getImExporterProfileFolders(AB_BANKING *ab, const char *imExporterName)
+{
+  GWEN_BUFFER *buf;
+  GWEN_STRINGLIST *sl;
+  GWEN_STRINGLISTENTRY *sentry;
+  GWEN_STRINGLIST *folderList;
+
+  buf=GWEN_Buffer_new(0, 256, 0, 1);
+  folderList=GWEN_StringList_new();
+
+  sl=AB_Banking_GetGlobalDataDirs();
+  assert(sl);
+
+  sentry=GWEN_StringList_FirstEntry(sl);
+  assert(sentry);
+
+  while (sentry) {
+    const char *pkgdatadir;
+
+    pkgdatadir = GWEN_StringListEntry_Data(sentry);
+    assert(pkgdatadir);
+
+    /* global profiles */
+    GWEN_Buffer_AppendString(buf, pkgdatadir);
+    GWEN_Buffer_AppendString(buf,
+                             DIRSEP
+                             "aqbanking"
+                             DIRSEP
+                             AB_IMEXPORTER_FOLDER
+                             DIRSEP);
+    if (GWEN_Text_EscapeToBufferTolerant(imExporterName, buf)) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN,
+                "Bad name for importer/exporter");
+      GWEN_StringList_free(sl);
+      GWEN_StringList_free(folderList);
+      GWEN_Buffer_free(buf);
+      return NULL;
+    }
+    GWEN_Buffer_AppendString(buf, DIRSEP "profiles");
+    GWEN_StringList_AppendString(folderList, GWEN_Buffer_GetStart(buf), 0, 0);
+    GWEN_Buffer_Reset(buf);
+    sentry=GWEN_StringListEntry_Next(sentry);
+  }
+  GWEN_StringList_free(sl);
+
+  /* local user profiles */
+  if (AB_Banking_GetUserDataDir(ab, buf)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN,
+              "Could not get user data dir");
+    GWEN_StringList_free(folderList);
+    GWEN_Buffer_free(buf);
+    return NULL;
+  }
+  GWEN_Buffer_AppendString(buf, DIRSEP AB_IMEXPORTER_FOLDER DIRSEP);
+  if (GWEN_Text_EscapeToBufferTolerant(imExporterName, buf)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN,
+              "Bad name for importer/exporter");
+    GWEN_StringList_free(folderList);
+    GWEN_Buffer_free(buf);
+    return NULL;
+  }
+  GWEN_Buffer_AppendString(buf, DIRSEP "profiles");
+  GWEN_StringList_AppendString(folderList, GWEN_Buffer_GetStart(buf), 0, 0);
+  GWEN_Buffer_free(buf);
+
+  return folderList;
+}
+
+
+
+time_t _getFolderModTime(const char *folder)
+{
+  struct stat st;
+
+  if (stat(folder, &st) || !S_ISDIR(st.st_mode))
+    return (time_t) -1;
+  return st.st_mtime;
+}
+
+
+
+AB_BANKING_IMEXPROFILE_CACHE *_imExporterProfileCacheRead(AB_BANKING *ab,
+                                                          const char *imExporterName,
+                                                          const GWEN_STRINGLIST *folderList)
+{
+  AB_BANKING_IMEXPROFILE_CACHE *entry;
+  GWEN_STRINGLISTENTRY *sentry;
+  int i=0;
+
+  GWEN_NEW_OBJECT(AB_BANKING_IMEXPROFILE_CACHE, entry);
+  entry->imExporterName=strdup(imExporterName);
+  entry->dbProfiles=GWEN_DB_Group_new("profiles");
+  entry->folderList=GWEN_StringList_dup(folderList);
+  entry->folderModTimes=(time_t *) malloc(sizeof(time_t)*(GWEN_StringList_Count(folderList)+1));
+  entry->readTime=time(NULL);
+
+  sentry=GWEN_StringList_FirstEntry(entry->folderList);
+  while (sentry) {
+    const char *folder;
+    int isGlobal;
+    int rv;
+
+    folder=GWEN_StringListEntry_Data(sentry);
+    /* the users folder is the last one */
+    isGlobal=(GWEN_StringListEntry_Next(sentry)!=NULL);
+
+    /* get the time before reading so that changes while reading are detected with the next call */
+    entry->folderModTimes[i++]=_getFolderModTime(folder);
+    rv=AB_Banking__ReadImExporterProfiles(ab, folder, entry->dbProfiles, isGlobal);
+    if (rv && rv!=GWEN_ERROR_NOT_FOUND) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN,
+                "Error reading %s profiles", isGlobal?"global":"users");
+      _imExporterProfileCacheEntryFree(entry);
+      return NULL;
+    }
+    sentry=GWEN_StringListEntry_Next(sentry);
+  }
+
+  return entry;
+}
+
+
+
+int _imExporterProfileCacheIsValid(const AB_BANKING_IMEXPROFILE_CACHE *entry, const GWEN_STRINGLIST *folderList)
+{
+  GWEN_STRINGLISTENTRY *seCached;
+  GWEN_STRINGLISTENTRY *seCurrent;
+  int i=0;
+
+  seCached=GWEN_StringList_FirstEntry(entry->folderList);
+  seCurrent=GWEN_StringList_FirstEntry(folderList);
+  while (seCached && seCurrent) {
+    time_t modTime;
+
+    if (strcmp(GWEN_StringListEntry_Data(seCached), GWEN_StringListEntry_Data(seCurrent))!=0)
+      return 0;
+
+    /* folders modified in the second the profiles were read might have changed after reading */
+    modTime=_getFolderModTime(GWEN_StringListEntry_Data(seCurrent));
+    if (modTime!=entry->folderModTimes[i++] || (modTime!=(time_t) -1 && modTime>=entry->readTime))
+      return 0;
+
+    seCached=GWEN_StringListEntry_Next(seCached);
+    seCurrent=GWEN_StringListEntry_Next(seCurrent);
+  }
+
+  return (seCached==NULL && seCurrent==NULL);
+}
+
+
+
+AB_BANKING_IMEXPROFILE_CACHE *_imExporterProfileCacheFind(const AB_BANKING *ab, const char *imExporterName)
+{
+  AB_BANKING_IMEXPROFILE_CACHE *entry;
+
+  entry=ab->imExporterProfileCache;
+  while (entry) {
+    if (strcmp(entry->imExporterName, imExporterName)==0)
+      return entry;
+    entry=entry->next;
+  }
+
+  return NULL;
+}
+
+
+
+void _imExporterProfileCacheRemove(AB_BANKING *ab, const char *imExporterName)
+{
+  AB_BANKING_IMEXPROFILE_CACHE **pEntry;
+
+  pEntry=&(ab->imExporterProfileCache);
+  while (*pEntry) {
+    AB_BANKING_IMEXPROFILE_CACHE *entry;
+
+    entry=*pEntry;
+    if (strcmp(entry->imExporterName, imExporterName)==0) {
+      *pEntry=entry->next;
+      _imExporterProfileCacheEntryFree(entry);
+      return;
+    }
+    pEntry=&(entry->next);
+  }
+}
+
+
 
+void _imExporterProfileCacheEntryFree(AB_BANKING_IMEXPROFILE_CACHE *entry)
+{
+  if (entry) {
+    free(entry->folderModTimes);
+    GWEN_StringList_free(entry->folderList);
+    GWEN_DB_Group_free(entry->dbProfiles);
+    free(entry->imExporterName);
+    GWEN_FREE_OBJECT(entry);
+  }
+}
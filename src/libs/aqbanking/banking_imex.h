@@ -507,6 +507,39 @@ int AB_Banking_ExportToBufferLoadProfile(AB_BANKING *ab,
                                          const char *profileFile);
 
 
+/**
+ * Remove bank statement transactions which have already been seen from the given context.
+ *
+ * For every account info the fingerprints of all statement transactions received so far are kept in a
+ * transaction hash store (see @ref AB_TransactionHashStore_Open) below the user data folder. Transactions
+ * whose fingerprint is already in that store are removed from the context, but never more copies of a
+ * fingerprint than have been added to the store. So if two identical bookings have been received so far,
+ * a third one is kept. The store itself is not changed. Call @ref AB_Banking_AddKnownTransactions once
+ * the context has been stored successfully.
+ * This is useful when repeatedly requesting overlapping statement periods.
+ *
+ * @return number of transactions removed, error code otherwise
+ *
+ * @param ab pointer to the AB_BANKING object
+ * @param ctx context to remove known transactions from
+ */
+AQBANKING_API
+int AB_Banking_DropKnownTransactions(AB_BANKING *ab, AB_IMEXPORTER_CONTEXT *ctx);
+
+/**
+ * Add the fingerprints of all bank statement transactions of the given context to the transaction hash
+ * stores used by @ref AB_Banking_DropKnownTransactions. Identical transactions add their fingerprint
+ * once for every copy.
+ *
+ * @return number of fingerprints added, error code otherwise
+ *
+ * @param ab pointer to the AB_BANKING object
+ * @param ctx context whose transactions are to be remembered
+ */
+AQBANKING_API
+int AB_Banking_AddKnownTransactions(AB_BANKING *ab, const AB_IMEXPORTER_CONTEXT *ctx);
+
+
 
 /*@}*/
 
@@ -456,6 +456,9 @@ int AB_Banking_Fini(AB_BANKING *ab)
       return GWEN_ERROR_GENERIC;
     }
 
+    /* give back job ids reserved in advance but not used */
+    AB_Banking__ReleaseJobIds(ab);
+
     /* lock group */
     rv=GWEN_ConfigMgr_LockGroup(ab->configMgr, AB_CFG_GROUP_MAIN, "config");
     if (rv<0) {
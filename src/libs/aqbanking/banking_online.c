@@ -53,6 +53,8 @@ static int _sortCommandsByAccounts(AB_BANKING *ab,
                                    AB_ACCOUNTQUEUE_LIST *aql,
                                    uint32_t pid);
 
+static int _reserveJobIdsForCommands(AB_BANKING *ab, AB_TRANSACTION_LIST2 *commandList, uint32_t *pFirstId);
+
 static int _sortAccountQueuesByProvider(AB_BANKING *ab,
                                         AB_ACCOUNTQUEUE_LIST *aql,
                                         AB_PROVIDERQUEUE_LIST *pql,
@@ -62,6 +64,14 @@ static int _sendProviderQueues(AB_BANKING *ab,
                                AB_PROVIDERQUEUE_LIST *pql,
                                AB_IMEXPORTER_CONTEXT *ctx,
                                uint32_t pid);
+static void _sendProviderQueue(AB_BANKING *ab, AB_PROVIDERQUEUE *pq, AB_IMEXPORTER_CONTEXT *localCtx, uint32_t pid);
+
+static int _sendProviderQueuesParallel(AB_BANKING *ab,
+                                       AB_PROVIDERQUEUE_LIST *pql,
+                                       AB_IMEXPORTER_CONTEXT *ctx,
+                                       uint32_t pid);
+static void _providerWorkerRun(void *arg);
+
 
 
 
@@ -595,6 +605,15 @@ int _sortCommandsByAccounts(AB_BANKING *ab,
 {
   AB_TRANSACTION_LIST2_ITERATOR *jit;
   AB_ACCOUNTQUEUE *aq;
+  uint32_t nextJobId=0;
+  int rv;
+
+  /* reserve unique ids for all jobs which don't have one with a single config update */
+  rv=_reserveJobIdsForCommands(ab, commandList, &nextJobId);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
 
   /* sort commands by account */
   jit=AB_Transaction_List2_First(commandList);
@@ -613,6 +632,7 @@ int _sortCommandsByAccounts(AB_BANKING *ab,
         uid=AB_Transaction_GetUniqueAccountId(t);
         if (uid==0) {
           DBG_ERROR(AQBANKING_LOGDOMAIN, "No unique account id given in transaction, aborting");
+          AB_Transaction_List2Iterator_free(jit);
           return GWEN_ERROR_BAD_DATA;
         }
 
@@ -626,7 +646,7 @@ int _sortCommandsByAccounts(AB_BANKING *ab,
 
         /* assign unique id to job (if none) */
         if (AB_Transaction_GetUniqueId(t)==0)
-          AB_Transaction_SetUniqueId(t, AB_Banking_GetNamedUniqueId(ab, "jobid", 1));
+          AB_Transaction_SetUniqueId(t, nextJobId++);
         AB_Transaction_SetRefUniqueId(t, 0);
         /* set status */
         AB_Transaction_SetStatus(t, AB_Transaction_StatusEnqueued);
@@ -649,6 +669,45 @@ int _sortCommandsByAccounts(AB_BANKING *ab,
 
 
 
+int _reserveJobIdsForCommands(AB_BANKING *ab, AB_TRANSACTION_LIST2 *commandList, uint32_t *pFirstId)
+{
+  AB_TRANSACTION_LIST2_ITERATOR *jit;
+  uint32_t count=0;
+
+  /* count commands which will need a job id */
+  jit=AB_Transaction_List2_First(commandList);
+  if (jit) {
+    AB_TRANSACTION *t;
+
+    t=AB_Transaction_List2Iterator_Data(jit);
+    while (t) {
+      AB_TRANSACTION_STATUS tStatus;
+
+      tStatus=AB_Transaction_GetStatus(t);
+      if ((tStatus==AB_Transaction_StatusUnknown || tStatus==AB_Transaction_StatusNone ||
+           tStatus==AB_Transaction_StatusEnqueued) &&
+          AB_Transaction_GetUniqueId(t)==0)
+        count++;
+      t=AB_Transaction_List2Iterator_Next(jit);
+    }
+    AB_Transaction_List2Iterator_free(jit);
+  }
+
+  if (count) {
+    int rv;
+
+    rv=AB_Banking__ReserveJobIds(ab, count, pFirstId);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+  }
+
+  return 0;
+}
+
+
+
 int _sortAccountQueuesByProvider(AB_BANKING *ab,
                                  AB_ACCOUNTQUEUE_LIST *aql,
                                  AB_PROVIDERQUEUE_LIST *pql,
@@ -701,53 +760,194 @@ int _sendProviderQueues(AB_BANKING *ab,
                         uint32_t pid)
 {
   AB_PROVIDERQUEUE *pq;
-  int rv;
+
+  if (AB_Banking_RuntimeConfig_GetIntValue(ab, "parallelProviders", 0) &&
+      AB_ProviderQueue_List_GetCount(pql)>1 &&
+      AB_WorkerPool_IsAvailable())
+    return _sendProviderQueuesParallel(ab, pql, ctx, pid);
 
   pq=AB_ProviderQueue_List_First(pql);
   while (pq) {
     AB_PROVIDERQUEUE *pqNext;
-    const char *providerName;
+    AB_IMEXPORTER_CONTEXT *localCtx;
 
     pqNext=AB_ProviderQueue_List_Next(pq);
     AB_ProviderQueue_List_Del(pq);
 
-    providerName=AB_ProviderQueue_GetProviderName(pq);
-    if (providerName && *providerName) {
-      AB_PROVIDER *pro;
+    localCtx=AB_ImExporterContext_new();
+    _sendProviderQueue(ab, pq, localCtx, pid);
+    AB_ImExporterContext_AddContext(ctx, localCtx);
+    AB_ProviderQueue_free(pq);
 
-      pro=AB_Banking_BeginUseProvider(ab, providerName);
-      if (pro) {
-        AB_IMEXPORTER_CONTEXT *localCtx;
-
-        GWEN_Gui_ProgressLog2(pid, GWEN_LoggerLevel_Info, I18N("Send commands to provider \"%s\""), providerName);
-        localCtx=AB_ImExporterContext_new();
-        rv=AB_Provider_SendCommands(pro, pq, localCtx);
-        if (rv<0) {
-          GWEN_Gui_ProgressLog2(pid, GWEN_LoggerLevel_Error, I18N("Error sending commands to provider \"%s\":%d"), providerName,
-                                rv);
-          DBG_INFO(AQBANKING_LOGDOMAIN, "Error sending commands to provider \"%s\" (%d)", AB_Provider_GetName(pro), rv);
-        }
-        AB_ImExporterContext_AddContext(ctx, localCtx);
-        AB_Banking_EndUseProvider(ab, pro);
-      }
-      else {
-        GWEN_Gui_ProgressLog2(pid, GWEN_LoggerLevel_Info, I18N("Provider \"%s\" is not available."), providerName);
-        DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not start using provider \"%s\"", providerName);
+    pq=pqNext;
+  }
+  return 0;
+}
+
+
+
+void _sendProviderQueue(AB_BANKING *ab, AB_PROVIDERQUEUE *pq, AB_IMEXPORTER_CONTEXT *localCtx, uint32_t pid)
+{
+  const char *providerName;
+
+  providerName=AB_ProviderQueue_GetProviderName(pq);
+  if (providerName && *providerName) {
+    AB_PROVIDER *pro;
+
+    pro=AB_Banking_BeginUseProvider(ab, providerName);
+    if (pro) {
+      int rv;
+
+      GWEN_Gui_ProgressLog2(pid, GWEN_LoggerLevel_Info, I18N("Send commands to provider \"%s\""), providerName);
+      rv=AB_Provider_SendCommands(pro, pq, localCtx);
+      if (rv<0) {
+        GWEN_Gui_ProgressLog2(pid, GWEN_LoggerLevel_Error, I18N("Error sending commands to provider \"%s\":%d"), providerName,
+                              rv);
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Error sending commands to provider \"%s\" (%d)", AB_Provider_GetName(pro), rv);
       }
+      AB_Banking_EndUseProvider(ab, pro);
     }
-    AB_ProviderQueue_free(pq);
+    else {
+      GWEN_Gui_ProgressLog2(pid, GWEN_LoggerLevel_Info, I18N("Provider \"%s\" is not available."), providerName);
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not start using provider \"%s\"", providerName);
+    }
+  }
+}
+
 
+
+int _sendProviderQueuesParallel(AB_BANKING *ab,
+                                AB_PROVIDERQUEUE_LIST *pql,
+                                AB_IMEXPORTER_CONTEXT *ctx,
+                                uint32_t pid)
+{
+  AB_BANKING_PROVIDER_WORKER *workers;
+  AB_WORKERPOOL *wp;
+  AB_PROVIDERQUEUE *pq;
+  int workerCount;
+  int i;
+  int rv;
+
+  workerCount=AB_ProviderQueue_List_GetCount(pql);
+  workers=(AB_BANKING_PROVIDER_WORKER *) calloc(workerCount, sizeof(AB_BANKING_PROVIDER_WORKER));
+  assert(workers);
+  wp=AB_WorkerPool_new(workerCount, 0);
+
+  /* keep the order of the provider queues, contexts are merged in that order at the end */
+  i=0;
+  pq=AB_ProviderQueue_List_First(pql);
+  while (pq) {
+    AB_PROVIDERQUEUE *pqNext;
+
+    pqNext=AB_ProviderQueue_List_Next(pq);
+    AB_ProviderQueue_List_Del(pq);
+    workers[i].ab=ab;
+    workers[i].providerQueue=pq;
+    workers[i].localCtx=AB_ImExporterContext_new();
+    workers[i].pid=pid;
+    AB_WorkerPool_AddTask(wp, _providerWorkerRun, &(workers[i]), NULL);
+    i++;
     pq=pqNext;
   }
+
+  GWEN_Gui_ProgressLog2(pid, GWEN_LoggerLevel_Info, I18N("Sending commands to %d providers in parallel"), workerCount);
+  rv=AB_WorkerPool_Run(wp);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+  }
+  AB_WorkerPool_free(wp);
+
+  /* merge results deterministically */
+  for (i=0; i<workerCount; i++) {
+    AB_ImExporterContext_AddContext(ctx, workers[i].localCtx);
+    AB_ProviderQueue_free(workers[i].providerQueue);
+  }
+  free(workers);
+
   return 0;
 }
 
 
 
+void _providerWorkerRun(void *arg)
+{
+  AB_BANKING_PROVIDER_WORKER *w;
+
+  w=(AB_BANKING_PROVIDER_WORKER *) arg;
+  _sendProviderQueue(w->ab, w->providerQueue, w->localCtx, w->pid);
+}
+
+
 
 uint32_t AB_Banking_ReserveJobId(AB_BANKING *ab)
 {
-  return AB_Banking_GetNamedUniqueId(ab, "jobid", 1);
+  int rv;
+  uint32_t uid=0;
+
+  rv=AB_Banking__ReserveJobIds(ab, 1, &uid);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to reserve job id (%d)", rv);
+    return 0;
+  }
+  return uid;
+}
+
+
+
+int AB_Banking__ReserveJobIds(AB_BANKING *ab, uint32_t count, uint32_t *pFirstId)
+{
+  int rv;
+  uint32_t firstId=0;
+
+  assert(ab);
+
+  /* take from reserved block if possible */
+  if (ab->nextJobId && (ab->lastJobId-ab->nextJobId)+1>=count) {
+    *pFirstId=ab->nextJobId;
+    ab->nextJobId+=count;
+    if (ab->nextJobId>ab->lastJobId)
+      ab->nextJobId=ab->lastJobId=0;
+    return 0;
+  }
+
+  if (count>=AB_BANKING_JOBID_BLOCKSIZE) {
+    /* large request, reserve exactly the number of ids needed */
+    rv=AB_Banking_ReserveNamedUniqueIdRange(ab, "jobid", 1, count, &firstId);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    *pFirstId=firstId;
+    return 0;
+  }
+
+  /* reserve a new block, unused ids of the previous block are skipped */
+  rv=AB_Banking_ReserveNamedUniqueIdRange(ab, "jobid", 1, AB_BANKING_JOBID_BLOCKSIZE, &firstId);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+  *pFirstId=firstId;
+  ab->nextJobId=firstId+count;
+  ab->lastJobId=firstId+AB_BANKING_JOBID_BLOCKSIZE-1;
+  return 0;
+}
+
+
+
+void AB_Banking__ReleaseJobIds(AB_BANKING *ab)
+{
+  assert(ab);
+
+  if (ab->nextJobId) {
+    int rv;
+
+    rv=AB_Banking_ReleaseNamedUniqueIdRange(ab, "jobid", ab->nextJobId, ab->lastJobId);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Could not release unused job ids, ignoring (%d)", rv);
+    }
+    ab->nextJobId=ab->lastJobId=0;
+  }
 }
 
 
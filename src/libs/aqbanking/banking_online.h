@@ -53,6 +53,35 @@ AQBANKING_API int AB_Banking_GetAccountSpecByUniqueId(const AB_BANKING *ab, uint
                                                       AB_ACCOUNT_SPEC **pAccountSpec);
 
 
+/**
+ * Returns an AB_ACCOUNT_SPEC object for the account with the given IBAN (compared case-insensitively).
+ * If there are multiple accounts with the same IBAN the one with the lowest unique id is returned.
+ * The caller is responsible for freeing the data returned (if any) via @ref ABS_AccountSpec_free.
+ * @return 0 if ok, error code otherwise (see @ref AB_ERROR)
+ * @param ab pointer to the AB_BANKING object
+ * @param iban IBAN of the account
+ * @param pAccountSpec Pointer to a variable to receive the matching account spec.
+ */
+AQBANKING_API int AB_Banking_GetAccountSpecByIban(const AB_BANKING *ab, const char *iban,
+                                                  AB_ACCOUNT_SPEC **pAccountSpec);
+
+
+/**
+ * Returns an AB_ACCOUNT_SPEC object for the account with the given bank code and account number.
+ * If there are multiple matching accounts (e.g. sub accounts) the one with the lowest unique id is returned.
+ * The caller is responsible for freeing the data returned (if any) via @ref ABS_AccountSpec_free.
+ * @return 0 if ok, error code otherwise (see @ref AB_ERROR)
+ * @param ab pointer to the AB_BANKING object
+ * @param bankCode bank code of the account
+ * @param accountNumber account number
+ * @param pAccountSpec Pointer to a variable to receive the matching account spec.
+ */
+AQBANKING_API int AB_Banking_GetAccountSpecByBankCodeAndAccountNumber(const AB_BANKING *ab,
+                                                                      const char *bankCode,
+                                                                      const char *accountNumber,
+                                                                      AB_ACCOUNT_SPEC **pAccountSpec);
+
+
 /*@}*/
 
 
@@ -25,6 +25,9 @@
 
 #define AB_WIZARD_FOLDER "wizards"
 
+/** folder below the user data dir holding the transaction hash stores */
+#define AB_TRANSACTION_HASHES_FOLDER "transactionhashes"
+
 #ifdef OS_WIN32
 # define AB_BANKING_USERDATADIR "aqbanking"
 #else
@@ -45,15 +48,84 @@
 #define AB_CFG_GROUP_ACCOUNTSPECS "accountspecs"
 #define AB_CFG_GROUP_USERSPECS    "userspecs"
 
+/** subgroup of AB_CFG_GROUP_MAIN holding the generation counters of cached config groups */
+#define AB_CFG_SUBGROUP_GENERATIONS "generations"
+
+/** number of job ids reserved at once by @ref AB_Banking_ReserveJobId */
+#define AB_BANKING_JOBID_BLOCKSIZE 32
+
 
 
 #include "banking_l.h"
 #include "backendsupport/provider_l.h"
 #include "backendsupport/imexporter_l.h"
 #include "backendsupport/bankinfoplugin_l.h"
+#include "backendsupport/workerpool.h"
 
 #include <gwenhywfar/plugin.h>
 #include <gwenhywfar/syncio_memory.h>
+#include <gwenhywfar/idmap.h>
+
+#include <time.h>
+#include <sys/types.h>
+
+
+
+/**
+ * Account specs loaded from the configuration. The cache is revalidated by comparing the generation
+ * counter of the account spec config group (see @ref AB_Banking__GetConfigGroupGeneration) with
+ * the one seen when loading the account specs. That counter is only read if the file holding the
+ * generation counters changed since the last check (see @ref AB_Banking__GetConfigGenerationsFileStamp).
+ */
+typedef struct AB_BANKING_ACCSPEC_CACHE AB_BANKING_ACCSPEC_CACHE;
+struct AB_BANKING_ACCSPEC_CACHE {
+  int valid;
+  int generation;
+
+  /* state of the generations file when the generation was last read */
+  int stampValid;
+  time_t stampTime;
+  time_t stampModTime;
+  off_t stampSize;
+
+  AB_ACCOUNT_SPEC_LIST *accountSpecList;
+  GWEN_IDMAP *idMap;
+
+  /* arrays of pointers into accountSpecList, sorted by IBAN and by bank code/account number */
+  AB_ACCOUNT_SPEC **ibanIndex;
+  uint32_t ibanIndexCount;
+  AB_ACCOUNT_SPEC **bankAccountIndex;
+  uint32_t bankAccountIndexCount;
+};
+
+
+
+/**
+ * Profiles of one im-/exporter as returned by @ref AB_Banking_GetImExporterProfiles. The entry is revalidated
+ * by comparing the modification times of the profile folders with those seen when reading the profiles.
+ */
+typedef struct AB_BANKING_IMEXPROFILE_CACHE AB_BANKING_IMEXPROFILE_CACHE;
+struct AB_BANKING_IMEXPROFILE_CACHE {
+  AB_BANKING_IMEXPROFILE_CACHE *next;
+  char *imExporterName;
+  GWEN_DB_NODE *dbProfiles;
+
+  /* profile folders in the order they were read (global folders first), (time_t)-1 for missing folders */
+  GWEN_STRINGLIST *folderList;
+  time_t *folderModTimes;
+  time_t readTime;
+};
+
+
+
+/** arguments for a worker pool task sending the commands of one provider queue */
+typedef struct AB_BANKING_PROVIDER_WORKER AB_BANKING_PROVIDER_WORKER;
+struct AB_BANKING_PROVIDER_WORKER {
+  AB_BANKING *ab;
+  AB_PROVIDERQUEUE *providerQueue;
+  AB_IMEXPORTER_CONTEXT *localCtx;
+  uint32_t pid;
+};
 
 
 
@@ -74,8 +146,20 @@ struct AB_BANKING {
   GWEN_CRYPT_TOKEN_LIST2 *cryptTokenList;
 
   GWEN_CONFIGMGR *configMgr;
+  /* folder of the "dir" config manager (i.e. its URL without "dir://") */
+  char *configMgrDir;
 
   GWEN_DB_NODE *dbRuntimeConfig;
+
+  /* allocated separately so that it can be updated via const AB_BANKING pointers */
+  AB_BANKING_ACCSPEC_CACHE *accountSpecCache;
+
+  /* list of AB_BANKING_IMEXPROFILE_CACHE, one per im-/exporter */
+  AB_BANKING_IMEXPROFILE_CACHE *imExporterProfileCache;
+
+  /* block of job ids reserved in advance (nextJobId to lastJobId) */
+  uint32_t nextJobId;
+  uint32_t lastJobId;
 };
 
 
@@ -103,6 +187,66 @@ static int AB_Banking__ReadImExporterProfiles(AB_BANKING *ab,
                                               int isGlobal);
 
 
+
+/* ========================================================================================================================
+ *                                                banking_imex.c
+ * ========================================================================================================================
+ */
+
+static void AB_Banking__ImExporterProfileCache_free(AB_BANKING_IMEXPROFILE_CACHE *cache);
+
+
+/* ========================================================================================================================
+ *                                                banking_cfg.c
+ * ========================================================================================================================
+ */
+
+/**
+ * Read the generation counter of the given config group. The counter is incremented before a subgroup is
+ * written or deleted via @ref AB_Banking_WriteConfigGroup or @ref AB_Banking_DeleteConfigGroup.
+ * @param pWriting if not NULL this receives a value !=0 if a write is still in progress
+ */
+static int AB_Banking__GetConfigGroupGeneration(const AB_BANKING *ab, const char *groupName, int *pGeneration,
+                                                int *pWriting);
+
+/**
+ * Get modification time and size of the file holding the generation counters without asking the config manager.
+ * The file is located in the folder of the config manager (see @ref AB_Banking__GetConfigManager).
+ * Every change of a generation counter changes this file, so callers can skip
+ * @ref AB_Banking__GetConfigGroupGeneration as long as the file is unchanged.
+ */
+static int AB_Banking__GetConfigGenerationsFileStamp(const AB_BANKING *ab, time_t *pModTime, off_t *pSize);
+
+
+
+/* ========================================================================================================================
+ *                                                banking_accspec.c
+ * ========================================================================================================================
+ */
+
+static AB_BANKING_ACCSPEC_CACHE *AB_Banking__AccountSpecCache_new(void);
+static void AB_Banking__AccountSpecCache_free(AB_BANKING_ACCSPEC_CACHE *cache);
+
+
+
+/* ========================================================================================================================
+ *                                                banking_online.c
+ * ========================================================================================================================
+ */
+
+/**
+ * Get a range of count job ids, either from the block reserved in advance or via
+ * @ref AB_Banking_ReserveNamedUniqueIdRange.
+ */
+static int AB_Banking__ReserveJobIds(AB_BANKING *ab, uint32_t count, uint32_t *pFirstId);
+
+/**
+ * Return the unused job ids from the block reserved in advance.
+ */
+static void AB_Banking__ReleaseJobIds(AB_BANKING *ab);
+
+
+
 static int AB_Banking__TransformIban(const char *iban, int len, char *newIban, int maxLen);
 
 
@@ -169,6 +313,11 @@ static int AB_Banking_ReadConfigGroup(const AB_BANKING *ab,
                                       int doUnlock,
                                       GWEN_DB_NODE **pDb);
 
+/**
+ * Delete a subgroup and update the generation counter of the group (see @ref AB_Banking__GetConfigGroupGeneration).
+ */
+static int AB_Banking_DeleteNamedConfigGroup(AB_BANKING *ab, const char *groupName, const char *subGroupName);
+
 static int AB_Banking_HasConfigGroup(const AB_BANKING *ab,
                                      const char *groupName,
                                      uint32_t uniqueId);
@@ -91,7 +91,7 @@ int AB_Banking_UpdateConfList(AB_BANKING *ab, const char *groupName)
           }
 
           DBG_WARN(AQBANKING_LOGDOMAIN, "%s: Removing old group \"%s\" (%lu)", groupName, subGroupName, (unsigned long int)uid);
-          rv=GWEN_ConfigMgr_DeleteGroup(ab->configMgr, groupName, subGroupName);
+          rv=AB_Banking_DeleteNamedConfigGroup(ab, groupName, subGroupName);
           if (rv<0) {
             DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
             GWEN_DB_Group_free(dbAll);
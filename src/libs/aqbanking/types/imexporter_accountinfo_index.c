@@ -0,0 +1,402 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "imexporter_accountinfo_index_p.h"
+
+#include <gwenhywfar/misc.h>
+#include <gwenhywfar/debug.h>
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void _clear(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx);
+static void _rebuild(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, const AB_IMEXPORTER_ACCOUNTINFO_LIST *l);
+static int _isUpToDate(const AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, const AB_IMEXPORTER_ACCOUNTINFO_LIST *l);
+static void _addAccountInfo(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, AB_IMEXPORTER_ACCOUNTINFO *ai);
+static void _addEntry(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, int keyType, uint32_t hash, AB_IMEXPORTER_ACCOUNTINFO *ai);
+static void _appendEntry(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *entry);
+static void _resize(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, uint32_t bucketCount);
+static AB_IMEXPORTER_ACCOUNTINFO *_findById(const AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, uint32_t id);
+static AB_IMEXPORTER_ACCOUNTINFO *_findByIban(const AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, const char *iban);
+static AB_IMEXPORTER_ACCOUNTINFO *_findByBankCodeAndAccountNumber(const AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+                                                                  const char *bankCode,
+                                                                  const char *accountNumber);
+static uint32_t _hashId(uint32_t id);
+static uint32_t _hashSeed(int keyType);
+static uint32_t _hashString(uint32_t hash, const char *s);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AB_IMEXPORTER_ACCOUNTINFO_INDEX *AB_ImExporterAccountInfoIndex_new(void)
+{
+  AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx;
+
+  GWEN_NEW_OBJECT(AB_IMEXPORTER_ACCOUNTINFO_INDEX, idx);
+  return idx;
+}
+
+
+
+void AB_ImExporterAccountInfoIndex_free(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx)
+{
+  if (idx) {
+    _clear(idx);
+    free(idx->lastEntries);
+    free(idx->firstEntries);
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+void AB_ImExporterAccountInfoIndex_Invalidate(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx)
+{
+  if (idx)
+    idx->valid=0;
+}
+
+
+
+void AB_ImExporterAccountInfoIndex_Add(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+                                       const AB_IMEXPORTER_ACCOUNTINFO_LIST *l,
+                                       AB_IMEXPORTER_ACCOUNTINFO *ai)
+{
+  assert(idx);
+  assert(ai);
+
+  /* only extend an index which was up-to-date before the account info was added */
+  if (idx->valid &&
+      idx->accountInfoCount+1==AB_ImExporterAccountInfo_List_GetCount(l) &&
+      AB_ImExporterAccountInfo_List_Previous(ai)==idx->lastAccountInfo) {
+    _addAccountInfo(idx, ai);
+    idx->accountInfoCount++;
+    idx->lastAccountInfo=ai;
+  }
+  else
+    idx->valid=0;
+}
+
+
+
+AB_IMEXPORTER_ACCOUNTINFO *AB_ImExporterAccountInfoIndex_FindForTransaction(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+                                                                            const AB_IMEXPORTER_ACCOUNTINFO_LIST *l,
+                                                                            const AB_TRANSACTION *t)
+{
+  AB_IMEXPORTER_ACCOUNTINFO *ai=NULL;
+  const char *s;
+
+  assert(idx);
+  assert(t);
+
+  if (!_isUpToDate(idx, l))
+    _rebuild(idx, l);
+
+  /* same order as the linear search in AB_ImExporterContext_AddTransaction() */
+  if (AB_Transaction_GetUniqueAccountId(t))
+    ai=_findById(idx, AB_Transaction_GetUniqueAccountId(t));
+
+  if (ai==NULL) {
+    s=AB_Transaction_GetLocalIban(t);
+    if (s && *s)
+      ai=_findByIban(idx, s);
+  }
+
+  if (ai==NULL)
+    ai=_findByBankCodeAndAccountNumber(idx, AB_Transaction_GetLocalBankCode(t), AB_Transaction_GetLocalAccountNumber(t));
+
+  return ai;
+}
+
+
+
+void _clear(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx)
+{
+  uint32_t i;
+
+  for (i=0; i<idx->bucketCount; i++) {
+    AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *entry;
+
+    entry=idx->firstEntries[i];
+    while (entry) {
+      AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *next;
+
+      next=entry->next;
+      GWEN_FREE_OBJECT(entry);
+      entry=next;
+    }
+    idx->firstEntries[i]=NULL;
+    idx->lastEntries[i]=NULL;
+  }
+  idx->entryCount=0;
+  idx->accountInfoCount=0;
+  idx->lastAccountInfo=NULL;
+  idx->valid=0;
+}
+
+
+
+void _rebuild(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, const AB_IMEXPORTER_ACCOUNTINFO_LIST *l)
+{
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+
+  _clear(idx);
+
+  ai=AB_ImExporterAccountInfo_List_First(l);
+  while (ai) {
+    _addAccountInfo(idx, ai);
+    idx->accountInfoCount++;
+    idx->lastAccountInfo=ai;
+    ai=AB_ImExporterAccountInfo_List_Next(ai);
+  }
+  idx->valid=1;
+}
+
+
+
+int _isUpToDate(const AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, const AB_IMEXPORTER_ACCOUNTINFO_LIST *l)
+{
+  /* also catches account infos added or removed directly via the list */
+  return (idx->valid &&
+          idx->accountInfoCount==AB_ImExporterAccountInfo_List_GetCount(l) &&
+          idx->lastAccountInfo==AB_ImExporterAccountInfo_List_Last(l));
+}
+
+
+
+void _addAccountInfo(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, AB_IMEXPORTER_ACCOUNTINFO *ai)
+{
+  const char *s;
+  uint32_t hash;
+
+  if (AB_ImExporterAccountInfo_GetAccountId(ai))
+    _addEntry(idx, AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_ID, _hashId(AB_ImExporterAccountInfo_GetAccountId(ai)), ai);
+
+  s=AB_ImExporterAccountInfo_GetIban(ai);
+  if (s && *s)
+    _addEntry(idx, AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_IBAN,
+              _hashString(_hashSeed(AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_IBAN), s), ai);
+
+  /* empty bank code and account number match as well */
+  hash=_hashString(_hashSeed(AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_ACCOUNT), AB_ImExporterAccountInfo_GetBankCode(ai));
+  hash=_hashString(hash, AB_ImExporterAccountInfo_GetAccountNumber(ai));
+  _addEntry(idx, AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_ACCOUNT, hash, ai);
+}
+
+
+
+void _addEntry(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, int keyType, uint32_t hash, AB_IMEXPORTER_ACCOUNTINFO *ai)
+{
+  AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *entry;
+
+  if (idx->entryCount>=idx->bucketCount)
+    _resize(idx, idx->bucketCount?(idx->bucketCount*2):AB_IMEXPORTER_ACCOUNTINFO_INDEX_MINBUCKETS);
+
+  GWEN_NEW_OBJECT(AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY, entry);
+  entry->hash=hash;
+  entry->keyType=keyType;
+  entry->accountInfo=ai;
+  _appendEntry(idx, entry);
+  idx->entryCount++;
+}
+
+
+
+void _appendEntry(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *entry)
+{
+  uint32_t bucket;
+
+  bucket=entry->hash & (idx->bucketCount-1);
+  entry->next=NULL;
+  if (idx->lastEntries[bucket])
+    idx->lastEntries[bucket]->next=entry;
+  else
+    idx->firstEntries[bucket]=entry;
+  idx->lastEntries[bucket]=entry;
+}
+
+
+
+void _resize(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, uint32_t bucketCount)
+{
+  AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY **oldFirstEntries;
+  uint32_t oldBucketCount;
+  uint32_t i;
+
+  oldFirstEntries=idx->firstEntries;
+  oldBucketCount=idx->bucketCount;
+  free(idx->lastEntries);
+
+  idx->firstEntries=(AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY **) calloc(bucketCount, sizeof(AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *));
+  idx->lastEntries=(AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY **) calloc(bucketCount, sizeof(AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *));
+  assert(idx->firstEntries && idx->lastEntries);
+  idx->bucketCount=bucketCount;
+
+  /* entries of one old bucket stay in order, so entries with the same key do, too */
+  for (i=0; i<oldBucketCount; i++) {
+    AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *entry;
+
+    entry=oldFirstEntries[i];
+    while (entry) {
+      AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *next;
+
+      next=entry->next;
+      _appendEntry(idx, entry);
+      entry=next;
+    }
+  }
+  free(oldFirstEntries);
+}
+
+
+
+AB_IMEXPORTER_ACCOUNTINFO *_findById(const AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, uint32_t id)
+{
+  const AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *entry;
+  uint32_t hash;
+
+  if (idx->bucketCount==0)
+    return NULL;
+
+  hash=_hashId(id);
+  entry=idx->firstEntries[hash & (idx->bucketCount-1)];
+  while (entry) {
+    /* always compare with the current value, the account info might have been changed */
+    if (entry->hash==hash &&
+        entry->keyType==AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_ID &&
+        AB_ImExporterAccountInfo_GetAccountId(entry->accountInfo)==id)
+      return entry->accountInfo;
+    entry=entry->next;
+  }
+
+  return NULL;
+}
+
+
+
+AB_IMEXPORTER_ACCOUNTINFO *_findByIban(const AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, const char *iban)
+{
+  const AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *entry;
+  uint32_t hash;
+
+  if (idx->bucketCount==0)
+    return NULL;
+
+  hash=_hashString(_hashSeed(AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_IBAN), iban);
+  entry=idx->firstEntries[hash & (idx->bucketCount-1)];
+  while (entry) {
+    if (entry->hash==hash && entry->keyType==AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_IBAN) {
+      const char *s;
+
+      s=AB_ImExporterAccountInfo_GetIban(entry->accountInfo);
+      if (s && strcasecmp(s, iban)==0)
+        return entry->accountInfo;
+    }
+    entry=entry->next;
+  }
+
+  return NULL;
+}
+
+
+
+AB_IMEXPORTER_ACCOUNTINFO *_findByBankCodeAndAccountNumber(const AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+                                                           const char *bankCode,
+                                                           const char *accountNumber)
+{
+  const AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *entry;
+  uint32_t hash;
+
+  if (idx->bucketCount==0)
+    return NULL;
+
+  if (bankCode==NULL)
+    bankCode="";
+  if (accountNumber==NULL)
+    accountNumber="";
+
+  hash=_hashString(_hashSeed(AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_ACCOUNT), bankCode);
+  hash=_hashString(hash, accountNumber);
+  entry=idx->firstEntries[hash & (idx->bucketCount-1)];
+  while (entry) {
+    if (entry->hash==hash && entry->keyType==AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_ACCOUNT) {
+      const char *sBankCode;
+      const char *sAccountNumber;
+
+      sBankCode=AB_ImExporterAccountInfo_GetBankCode(entry->accountInfo);
+      sAccountNumber=AB_ImExporterAccountInfo_GetAccountNumber(entry->accountInfo);
+      if (strcasecmp(sBankCode?sBankCode:"", bankCode)==0 &&
+          strcasecmp(sAccountNumber?sAccountNumber:"", accountNumber)==0)
+        return entry->accountInfo;
+    }
+    entry=entry->next;
+  }
+
+  return NULL;
+}
+
+
+
+uint32_t _hashId(uint32_t id)
+{
+  uint32_t hash;
+
+  hash=id^AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_ID;
+  hash^=hash>>16;
+  hash*=0x45d9f3bu;
+  hash^=hash>>16;
+  return hash;
+}
+
+
+
+uint32_t _hashSeed(int keyType)
+{
+  return 2166136261u^(uint32_t) keyType;
+}
+
+
+
+uint32_t _hashString(uint32_t hash, const char *s)
+{
+  /* FNV-1a over the lowercased string, matching the case-insensitive comparison */
+  if (s) {
+    while (*s) {
+      hash^=(uint32_t) tolower((unsigned char) *(s++));
+      hash*=16777619u;
+    }
+  }
+  /* separator */
+  hash^=0xff;
+  hash*=16777619u;
+  return hash;
+}
+
+
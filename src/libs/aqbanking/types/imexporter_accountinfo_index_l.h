@@ -0,0 +1,55 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_ACCOUNTINFO_INDEX_L_H
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_L_H
+
+#include <aqbanking/types/imexporter_accountinfo.h>
+#include <aqbanking/types/transaction.h>
+
+
+/**
+ * Hash index over the account infos of an AB_IMEXPORTER_CONTEXT, used internally by
+ * @ref AB_ImExporterContext_AddTransaction to find the account info for a transaction.
+ */
+typedef struct AB_IMEXPORTER_ACCOUNTINFO_INDEX AB_IMEXPORTER_ACCOUNTINFO_INDEX;
+
+
+/** below this number of account infos a linear search is faster than maintaining the index */
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_MINCOUNT 8
+
+
+AB_IMEXPORTER_ACCOUNTINFO_INDEX *AB_ImExporterAccountInfoIndex_new(void);
+void AB_ImExporterAccountInfoIndex_free(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx);
+
+/**
+ * Mark the index as outdated, it is rebuilt with the next lookup.
+ * This must be called whenever account infos are handed out to callers which might change them.
+ */
+void AB_ImExporterAccountInfoIndex_Invalidate(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx);
+
+/**
+ * Add an account info which has just been appended to the given list.
+ */
+void AB_ImExporterAccountInfoIndex_Add(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+                                       const AB_IMEXPORTER_ACCOUNTINFO_LIST *l,
+                                       AB_IMEXPORTER_ACCOUNTINFO *ai);
+
+/**
+ * Find the account info for a transaction: By unique account id, IBAN or bank code and
+ * account number (in that order), like a linear search of the given list would.
+ */
+AB_IMEXPORTER_ACCOUNTINFO *AB_ImExporterAccountInfoIndex_FindForTransaction(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+                                                                            const AB_IMEXPORTER_ACCOUNTINFO_LIST *l,
+                                                                            const AB_TRANSACTION *t);
+
+
+#endif
@@ -0,0 +1,50 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_ACCOUNTINFO_INDEX_P_H
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_P_H
+
+#include "imexporter_accountinfo_index_l.h"
+
+#include <stdint.h>
+
+
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_MINBUCKETS 64
+
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_ID      1
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_IBAN    2
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_KEY_ACCOUNT 3
+
+
+typedef struct AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY;
+struct AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY {
+  AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY *next;
+  uint32_t hash;
+  int keyType;
+  AB_IMEXPORTER_ACCOUNTINFO *accountInfo;
+};
+
+
+struct AB_IMEXPORTER_ACCOUNTINFO_INDEX {
+  /* entries with the same key are kept in list order */
+  AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY **firstEntries;
+  AB_IMEXPORTER_ACCOUNTINFO_INDEX_ENTRY **lastEntries;
+  uint32_t bucketCount;
+  uint32_t entryCount;
+
+  /* state of the account info list when the index was last updated */
+  int valid;
+  uint32_t accountInfoCount;
+  const AB_IMEXPORTER_ACCOUNTINFO *lastAccountInfo;
+};
+
+
+#endif
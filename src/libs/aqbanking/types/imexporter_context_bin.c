@@ -0,0 +1,794 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "imexporter_context_bin_p.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+#include <gwenhywfar/buffer.h>
+#include <gwenhywfar/db.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+# include <sys/mman.h>
+# define AB_IMEXPORTER_CONTEXT_BIN_USE_MMAP
+#endif
+
+#ifndef O_BINARY
+# define O_BINARY 0
+#endif
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static int _writeAccountInfo(const AB_IMEXPORTER_ACCOUNTINFO *ai, GWEN_DB_NODE *db, GWEN_BUFFER *buf, GWEN_SYNCIO *sio);
+static int _writeRecord(uint8_t recordType, GWEN_DB_NODE *db, GWEN_BUFFER *buf, GWEN_SYNCIO *sio);
+static int _flush(GWEN_BUFFER *buf, GWEN_SYNCIO *sio, uint32_t minSize);
+static void _encodeDbContent(GWEN_DB_NODE *db, GWEN_BUFFER *buf);
+static void _encodeVar(GWEN_DB_NODE *dbVar, GWEN_BUFFER *buf);
+static void _encodeName(uint8_t itemType, const char *name, GWEN_BUFFER *buf);
+static void _appendUint16(GWEN_BUFFER *buf, uint16_t v);
+static void _appendUint32(GWEN_BUFFER *buf, uint32_t v);
+
+static int _readRecord(AB_IMEXPORTER_CONTEXT *ctx,
+                       uint8_t recordType,
+                       GWEN_DB_NODE *db,
+                       AB_IMEXPORTER_ACCOUNTINFO **pCurrentAccountInfo);
+static int _readName(const uint8_t **pPtr, const uint8_t *end, const char **pName);
+static int _readBlob(const uint8_t **pPtr, const uint8_t *end, const uint8_t **pData, uint32_t *pSize);
+static uint16_t _readUint16(const uint8_t *p);
+static uint32_t _readUint32(const uint8_t *p);
+
+static int _mapFile(const char *fname, uint8_t **pDataPtr, size_t *pDataSize, int *pIsMapped);
+static void _unmapFile(uint8_t *dataPtr, size_t dataSize, int isMapped);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+int AB_ImExporterContextBin_IsBinary(const uint8_t *ptr, uint32_t len)
+{
+  if (ptr && len>=AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE && memcmp(ptr, AB_IMEXPORTER_CONTEXT_BIN_MAGIC, 4)==0)
+    return 1;
+  return 0;
+}
+
+
+
+int AB_ImExporterContextBin_IsBinaryFile(const char *fname)
+{
+  int fd;
+  uint8_t header[AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE];
+  ssize_t rv;
+
+  fd=open(fname, O_RDONLY | O_BINARY);
+  if (fd==-1)
+    return 0;
+  do {
+    rv=read(fd, header, sizeof(header));
+  } while (rv<0 && errno==EINTR);
+  close(fd);
+
+  if (rv<(ssize_t) sizeof(header))
+    return 0;
+  return AB_ImExporterContextBin_IsBinary(header, sizeof(header));
+}
+
+
+
+int AB_ImExporterContextBin_Write(const AB_IMEXPORTER_CONTEXT *ctx, GWEN_SYNCIO *sio)
+{
+  GWEN_BUFFER *buf;
+  GWEN_DB_NODE *db;
+  const AB_IMEXPORTER_ACCOUNTINFO *ai;
+  const AB_SECURITY *sec;
+  const AB_MESSAGE *msg;
+  int rv;
+
+  assert(ctx);
+  assert(sio);
+
+  buf=GWEN_Buffer_new(0, AB_IMEXPORTER_CONTEXT_BIN_FLUSHSIZE+1024, 0, 1);
+  GWEN_Buffer_AppendBytes(buf, AB_IMEXPORTER_CONTEXT_BIN_MAGIC, 4);
+  _appendUint16(buf, AB_IMEXPORTER_CONTEXT_BIN_VERSION);
+  _appendUint16(buf, 0);
+
+  /* the same DB is used for all records */
+  db=GWEN_DB_Group_new("record");
+
+  ai=AB_ImExporterAccountInfo_List_First(AB_ImExporterContext_GetAccountInfoList(ctx));
+  while (ai) {
+    rv=_writeAccountInfo(ai, db, buf, sio);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      GWEN_DB_Group_free(db);
+      GWEN_Buffer_free(buf);
+      return rv;
+    }
+    ai=AB_ImExporterAccountInfo_List_Next(ai);
+  }
+
+  sec=AB_Security_List_First(AB_ImExporterContext_GetSecurityList(ctx));
+  while (sec) {
+    AB_Security_toDb(sec, db);
+    rv=_writeRecord(AB_IMEXPORTER_CONTEXT_BIN_REC_SECURITY, db, buf, sio);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      GWEN_DB_Group_free(db);
+      GWEN_Buffer_free(buf);
+      return rv;
+    }
+    sec=AB_Security_List_Next(sec);
+  }
+
+  msg=AB_Message_List_First(AB_ImExporterContext_GetMessageList(ctx));
+  while (msg) {
+    AB_Message_toDb(msg, db);
+    rv=_writeRecord(AB_IMEXPORTER_CONTEXT_BIN_REC_MESSAGE, db, buf, sio);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      GWEN_DB_Group_free(db);
+      GWEN_Buffer_free(buf);
+      return rv;
+    }
+    msg=AB_Message_List_Next(msg);
+  }
+  GWEN_DB_Group_free(db);
+
+  GWEN_Buffer_AppendByte(buf, AB_IMEXPORTER_CONTEXT_BIN_REC_END);
+  _appendUint32(buf, 0);
+  rv=_flush(buf, sio, 0);
+  GWEN_Buffer_free(buf);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+int _writeAccountInfo(const AB_IMEXPORTER_ACCOUNTINFO *ai, GWEN_DB_NODE *db, GWEN_BUFFER *buf, GWEN_SYNCIO *sio)
+{
+  const AB_TRANSACTION_LIST *transactionList;
+  const AB_TRANSACTION *t;
+  int rv;
+
+  AB_ImExporterAccountInfo_toDb(ai, db);
+  /* transactions get records of their own, keep them out of the account info record */
+  GWEN_DB_DeleteGroup(db, "transactionList");
+
+  rv=_writeRecord(AB_IMEXPORTER_CONTEXT_BIN_REC_ACCOUNTINFO, db, buf, sio);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  transactionList=AB_ImExporterAccountInfo_GetTransactionList(ai);
+  t=transactionList?AB_Transaction_List_First(transactionList):NULL;
+  while (t) {
+    AB_Transaction_toDb(t, db);
+    rv=_writeRecord(AB_IMEXPORTER_CONTEXT_BIN_REC_TRANSACTION, db, buf, sio);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    t=AB_Transaction_List_Next(t);
+  }
+
+  return 0;
+}
+
+
+
+int _writeRecord(uint8_t recordType, GWEN_DB_NODE *db, GWEN_BUFFER *buf, GWEN_SYNCIO *sio)
+{
+  uint32_t sizePos;
+  uint32_t payloadSize;
+  uint8_t *p;
+
+  GWEN_Buffer_AppendByte(buf, recordType);
+  sizePos=GWEN_Buffer_GetPos(buf);
+  _appendUint32(buf, 0);
+  _encodeDbContent(db, buf);
+  GWEN_DB_ClearGroup(db, NULL);
+
+  /* patch payload size */
+  payloadSize=GWEN_Buffer_GetPos(buf)-sizePos-4;
+  if (payloadSize>AB_IMEXPORTER_CONTEXT_BIN_MAX_RECORD_SIZE) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Record too large (%lu bytes)", (unsigned long) payloadSize);
+    return GWEN_ERROR_BAD_DATA;
+  }
+  p=(uint8_t *) GWEN_Buffer_GetStart(buf)+sizePos;
+  p[0]=(payloadSize>>24) & 0xff;
+  p[1]=(payloadSize>>16) & 0xff;
+  p[2]=(payloadSize>>8) & 0xff;
+  p[3]=payloadSize & 0xff;
+
+  return _flush(buf, sio, AB_IMEXPORTER_CONTEXT_BIN_FLUSHSIZE);
+}
+
+
+
+int _flush(GWEN_BUFFER *buf, GWEN_SYNCIO *sio, uint32_t minSize)
+{
+  if (GWEN_Buffer_GetUsedBytes(buf)>=minSize && GWEN_Buffer_GetUsedBytes(buf)>0) {
+    int rv;
+
+    rv=GWEN_SyncIo_WriteForced(sio, (const uint8_t *) GWEN_Buffer_GetStart(buf), GWEN_Buffer_GetUsedBytes(buf));
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    GWEN_Buffer_Reset(buf);
+  }
+  return 0;
+}
+
+
+
+void _encodeDbContent(GWEN_DB_NODE *db, GWEN_BUFFER *buf)
+{
+  GWEN_DB_NODE *dbT;
+
+  dbT=GWEN_DB_GetFirstVar(db);
+  while (dbT) {
+    _encodeVar(dbT, buf);
+    dbT=GWEN_DB_GetNextVar(dbT);
+  }
+
+  dbT=GWEN_DB_GetFirstGroup(db);
+  while (dbT) {
+    _encodeName(AB_IMEXPORTER_CONTEXT_BIN_ITEM_GROUP_BEGIN, GWEN_DB_GroupName(dbT), buf);
+    _encodeDbContent(dbT, buf);
+    GWEN_Buffer_AppendByte(buf, AB_IMEXPORTER_CONTEXT_BIN_ITEM_GROUP_END);
+    dbT=GWEN_DB_GetNextGroup(dbT);
+  }
+}
+
+
+
+void _encodeVar(GWEN_DB_NODE *dbVar, GWEN_BUFFER *buf)
+{
+  const char *name;
+  GWEN_DB_NODE *dbV;
+
+  name=GWEN_DB_VariableName(dbVar);
+  dbV=GWEN_DB_GetFirstValue(dbVar);
+  while (dbV) {
+    const char *s;
+    const void *p;
+    unsigned int size;
+
+    switch (GWEN_DB_GetValueType(dbV)) {
+    case GWEN_DB_NodeType_ValueChar:
+      s=GWEN_DB_GetCharValueFromNode(dbV);
+      if (s) {
+        size=strlen(s);
+        _encodeName(AB_IMEXPORTER_CONTEXT_BIN_ITEM_CHAR, name, buf);
+        _appendUint32(buf, size);
+        GWEN_Buffer_AppendBytes(buf, s, size+1);
+      }
+      break;
+    case GWEN_DB_NodeType_ValueInt:
+      _encodeName(AB_IMEXPORTER_CONTEXT_BIN_ITEM_INT, name, buf);
+      _appendUint32(buf, (uint32_t) GWEN_DB_GetIntValueFromNode(dbV));
+      break;
+    case GWEN_DB_NodeType_ValueBin:
+      size=0;
+      p=GWEN_DB_GetBinValueFromNode(dbV, &size);
+      _encodeName(AB_IMEXPORTER_CONTEXT_BIN_ITEM_BIN, name, buf);
+      _appendUint32(buf, size);
+      if (size)
+        GWEN_Buffer_AppendBytes(buf, (const char *) p, size);
+      GWEN_Buffer_AppendByte(buf, 0);
+      break;
+    default:
+      /* pointer values are not written to text files either */
+      break;
+    }
+    dbV=GWEN_DB_GetNextValue(dbV);
+  }
+}
+
+
+
+void _encodeName(uint8_t itemType, const char *name, GWEN_BUFFER *buf)
+{
+  size_t len;
+
+  len=name?strlen(name):0;
+  assert(len<0xffff);
+  GWEN_Buffer_AppendByte(buf, itemType);
+  _appendUint16(buf, (uint16_t) len);
+  if (len)
+    GWEN_Buffer_AppendBytes(buf, name, len);
+  GWEN_Buffer_AppendByte(buf, 0);
+}
+
+
+
+void _appendUint16(GWEN_BUFFER *buf, uint16_t v)
+{
+  GWEN_Buffer_AppendByte(buf, (v>>8) & 0xff);
+  GWEN_Buffer_AppendByte(buf, v & 0xff);
+}
+
+
+
+void _appendUint32(GWEN_BUFFER *buf, uint32_t v)
+{
+  GWEN_Buffer_AppendByte(buf, (v>>24) & 0xff);
+  GWEN_Buffer_AppendByte(buf, (v>>16) & 0xff);
+  GWEN_Buffer_AppendByte(buf, (v>>8) & 0xff);
+  GWEN_Buffer_AppendByte(buf, v & 0xff);
+}
+
+
+
+int AB_ImExporterContextBin_ReadFromMemory(AB_IMEXPORTER_CONTEXT *ctx, const uint8_t *ptr, uint32_t len)
+{
+  const uint8_t *end;
+  GWEN_DB_NODE *db;
+  AB_IMEXPORTER_ACCOUNTINFO *currentAccountInfo=NULL;
+  int rv;
+
+  assert(ctx);
+
+  rv=AB_ImExporterContextBin_CheckHeader(ptr, len);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  end=ptr+len;
+  ptr+=AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE;
+
+  db=GWEN_DB_Group_new("record");
+  for (;;) {
+    uint8_t recordType;
+    uint32_t payloadSize;
+
+    if ((size_t)(end-ptr)<AB_IMEXPORTER_CONTEXT_BIN_RECHDR_SIZE) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Binary context file is truncated");
+      GWEN_DB_Group_free(db);
+      return GWEN_ERROR_BAD_DATA;
+    }
+    AB_ImExporterContextBin_ParseRecordHeader(ptr, &recordType, &payloadSize);
+    ptr+=AB_IMEXPORTER_CONTEXT_BIN_RECHDR_SIZE;
+    if (recordType==AB_IMEXPORTER_CONTEXT_BIN_REC_END)
+      break;
+    if (payloadSize>(size_t)(end-ptr) || payloadSize>AB_IMEXPORTER_CONTEXT_BIN_MAX_RECORD_SIZE) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Binary context file is truncated");
+      GWEN_DB_Group_free(db);
+      return GWEN_ERROR_BAD_DATA;
+    }
+
+    rv=AB_ImExporterContextBin_DecodeDb(ptr, payloadSize, db);
+    if (rv==0)
+      rv=_readRecord(ctx, recordType, db, &currentAccountInfo);
+    GWEN_DB_ClearGroup(db, NULL);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      GWEN_DB_Group_free(db);
+      return rv;
+    }
+    ptr+=payloadSize;
+  }
+  GWEN_DB_Group_free(db);
+
+  return 0;
+}
+
+
+
+int AB_ImExporterContextBin_ReadAnyFromMemory(AB_IMEXPORTER_CONTEXT *ctx, const uint8_t *ptr, uint32_t len)
+{
+  GWEN_DB_NODE *db;
+  AB_IMEXPORTER_CONTEXT *ctxText;
+  int rv=0;
+
+  assert(ctx);
+
+  if (AB_ImExporterContextBin_IsBinary(ptr, len)) {
+    rv=AB_ImExporterContextBin_ReadFromMemory(ctx, ptr, len);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    return 0;
+  }
+
+  db=GWEN_DB_Group_new("context");
+  if (len)
+    rv=GWEN_DB_ReadFromString(db, (const char *) ptr, len, GWEN_DB_FLAGS_DEFAULT | GWEN_PATH_FLAGS_CREATE_GROUP);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading textual context data (%d)", rv);
+    GWEN_DB_Group_free(db);
+    return rv;
+  }
+
+  ctxText=AB_ImExporterContext_fromDb(db);
+  GWEN_DB_Group_free(db);
+  if (ctxText==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "No context in input data");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  /* frees ctxText */
+  AB_ImExporterContext_AddContext(ctx, ctxText);
+
+  return 0;
+}
+
+
+
+int AB_ImExporterContextBin_CheckHeader(const uint8_t *ptr, uint32_t len)
+{
+  uint16_t version;
+
+  if (!AB_ImExporterContextBin_IsBinary(ptr, len)) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Not a binary context file");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  version=_readUint16(ptr+4);
+  if (version!=AB_IMEXPORTER_CONTEXT_BIN_VERSION) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Unsupported binary context file version %d", version);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  return 0;
+}
+
+
+
+void AB_ImExporterContextBin_ParseRecordHeader(const uint8_t *ptr, uint8_t *pRecordType, uint32_t *pPayloadSize)
+{
+  *pRecordType=ptr[0];
+  *pPayloadSize=_readUint32(ptr+1);
+}
+
+
+
+int AB_ImExporterContextBin_ReadFile(AB_IMEXPORTER_CONTEXT *ctx, const char *fname)
+{
+  uint8_t *dataPtr=NULL;
+  size_t dataSize=0;
+  int isMapped=0;
+  int rv;
+
+  rv=_mapFile(fname, &dataPtr, &dataSize, &isMapped);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  rv=AB_ImExporterContextBin_ReadFromMemory(ctx, dataPtr, (uint32_t) dataSize);
+  _unmapFile(dataPtr, dataSize, isMapped);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Error reading binary context file \"%s\" (%d)", fname, rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+int _readRecord(AB_IMEXPORTER_CONTEXT *ctx,
+                uint8_t recordType,
+                GWEN_DB_NODE *db,
+                AB_IMEXPORTER_ACCOUNTINFO **pCurrentAccountInfo)
+{
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  AB_TRANSACTION *t;
+  AB_SECURITY *sec;
+  AB_MESSAGE *msg;
+
+  switch (recordType) {
+  case AB_IMEXPORTER_CONTEXT_BIN_REC_ACCOUNTINFO:
+    ai=AB_ImExporterAccountInfo_fromDb(db);
+    if (ai==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad account info record");
+      return GWEN_ERROR_BAD_DATA;
+    }
+    AB_ImExporterContext_AddAccountInfo(ctx, ai);
+    *pCurrentAccountInfo=ai;
+    break;
+
+  case AB_IMEXPORTER_CONTEXT_BIN_REC_TRANSACTION:
+    if (*pCurrentAccountInfo==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Transaction record without account info");
+      return GWEN_ERROR_BAD_DATA;
+    }
+    t=AB_Transaction_fromDb(db);
+    if (t==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad transaction record");
+      return GWEN_ERROR_BAD_DATA;
+    }
+    AB_ImExporterAccountInfo_AddTransaction(*pCurrentAccountInfo, t);
+    break;
+
+  case AB_IMEXPORTER_CONTEXT_BIN_REC_SECURITY:
+    sec=AB_Security_fromDb(db);
+    if (sec==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad security record");
+      return GWEN_ERROR_BAD_DATA;
+    }
+    AB_ImExporterContext_AddSecurity(ctx, sec);
+    break;
+
+  case AB_IMEXPORTER_CONTEXT_BIN_REC_MESSAGE:
+    msg=AB_Message_fromDb(db);
+    if (msg==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad message record");
+      return GWEN_ERROR_BAD_DATA;
+    }
+    AB_ImExporterContext_AddMessage(ctx, msg);
+    break;
+
+  default:
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Skipping unknown record type %d", recordType);
+    break;
+  }
+
+  return 0;
+}
+
+
+
+int AB_ImExporterContextBin_DecodeDb(const uint8_t *ptr, uint32_t len, GWEN_DB_NODE *db)
+{
+  const uint8_t *end;
+  GWEN_DB_NODE *groupStack[AB_IMEXPORTER_CONTEXT_BIN_MAXDEPTH];
+  int depth=0;
+
+  end=ptr+len;
+  while (ptr<end) {
+    uint8_t itemType;
+    const char *name;
+    const uint8_t *data;
+    uint32_t size;
+    GWEN_DB_NODE *dbGroup;
+    int rv;
+
+    itemType=*(ptr++);
+    if (itemType==AB_IMEXPORTER_CONTEXT_BIN_ITEM_GROUP_END) {
+      if (depth<1) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "Unbalanced group end in binary context file");
+        return GWEN_ERROR_BAD_DATA;
+      }
+      db=groupStack[--depth];
+      continue;
+    }
+
+    rv=_readName(&ptr, end, &name);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+
+    switch (itemType) {
+    case AB_IMEXPORTER_CONTEXT_BIN_ITEM_GROUP_BEGIN:
+      if (depth>=AB_IMEXPORTER_CONTEXT_BIN_MAXDEPTH) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "Groups nested too deeply in binary context file");
+        return GWEN_ERROR_BAD_DATA;
+      }
+      groupStack[depth++]=db;
+      dbGroup=GWEN_DB_Group_new(name);
+      GWEN_DB_AddGroup(db, dbGroup);
+      db=dbGroup;
+      break;
+
+    case AB_IMEXPORTER_CONTEXT_BIN_ITEM_CHAR:
+      rv=_readBlob(&ptr, end, &data, &size);
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        return rv;
+      }
+      GWEN_DB_SetCharValue(db, 0, name, (const char *) data);
+      break;
+
+    case AB_IMEXPORTER_CONTEXT_BIN_ITEM_INT:
+      if ((size_t)(end-ptr)<4) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "Binary context record is truncated");
+        return GWEN_ERROR_BAD_DATA;
+      }
+      GWEN_DB_SetIntValue(db, 0, name, (int)(int32_t) _readUint32(ptr));
+      ptr+=4;
+      break;
+
+    case AB_IMEXPORTER_CONTEXT_BIN_ITEM_BIN:
+      rv=_readBlob(&ptr, end, &data, &size);
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        return rv;
+      }
+      GWEN_DB_SetBinValue(db, 0, name, data, size);
+      break;
+
+    default:
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Unknown item type %d in binary context file", itemType);
+      return GWEN_ERROR_BAD_DATA;
+    }
+  }
+
+  if (depth) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Unbalanced group begin in binary context file");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  return 0;
+}
+
+
+
+int _readName(const uint8_t **pPtr, const uint8_t *end, const char **pName)
+{
+  const uint8_t *ptr;
+  uint16_t len;
+
+  ptr=*pPtr;
+  if ((size_t)(end-ptr)<2) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Binary context record is truncated");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  len=_readUint16(ptr);
+  ptr+=2;
+  if ((size_t)(end-ptr)<(size_t) len+1 || ptr[len]!=0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad name in binary context record");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  *pName=(const char *) ptr;
+  *pPtr=ptr+len+1;
+  return 0;
+}
+
+
+
+int _readBlob(const uint8_t **pPtr, const uint8_t *end, const uint8_t **pData, uint32_t *pSize)
+{
+  const uint8_t *ptr;
+  uint32_t len;
+
+  ptr=*pPtr;
+  if ((size_t)(end-ptr)<4) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Binary context record is truncated");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  len=_readUint32(ptr);
+  ptr+=4;
+  if ((size_t)(end-ptr)<(size_t) len+1 || ptr[len]!=0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad value in binary context record");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  *pData=ptr;
+  *pSize=len;
+  *pPtr=ptr+len+1;
+  return 0;
+}
+
+
+
+uint16_t _readUint16(const uint8_t *p)
+{
+  return (uint16_t)((p[0]<<8) | p[1]);
+}
+
+
+
+uint32_t _readUint32(const uint8_t *p)
+{
+  return (((uint32_t) p[0])<<24) | (((uint32_t) p[1])<<16) | (((uint32_t) p[2])<<8) | ((uint32_t) p[3]);
+}
+
+
+
+int _mapFile(const char *fname, uint8_t **pDataPtr, size_t *pDataSize, int *pIsMapped)
+{
+  int fd;
+  struct stat st;
+  uint8_t *dataPtr;
+  size_t dataSize;
+  size_t bytesRead=0;
+
+  fd=open(fname, O_RDONLY | O_BINARY);
+  if (fd==-1)
+    return GWEN_ERROR_NOT_FOUND;
+
+  if (fstat(fd, &st)==-1) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "fstat(%s): %s", fname, strerror(errno));
+    close(fd);
+    return GWEN_ERROR_IO;
+  }
+  if (st.st_size<AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE || (uint64_t) st.st_size>0xffffffffu) {
+    close(fd);
+    return GWEN_ERROR_BAD_DATA;
+  }
+  dataSize=(size_t) st.st_size;
+
+#ifdef AB_IMEXPORTER_CONTEXT_BIN_USE_MMAP
+  {
+    void *p;
+
+    p=mmap(NULL, dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p!=MAP_FAILED) {
+      close(fd);
+      *pDataPtr=(uint8_t *) p;
+      *pDataSize=dataSize;
+      *pIsMapped=1;
+      return 0;
+    }
+    DBG_INFO(AQBANKING_LOGDOMAIN, "mmap(%s): %s, reading file instead", fname, strerror(errno));
+  }
+#endif
+
+  dataPtr=(uint8_t *) malloc(dataSize);
+  if (dataPtr==NULL) {
+    close(fd);
+    return GWEN_ERROR_MEMORY_FULL;
+  }
+  while (bytesRead<dataSize) {
+    ssize_t rv;
+
+    rv=read(fd, dataPtr+bytesRead, dataSize-bytesRead);
+    if (rv<0 && errno==EINTR)
+      continue;
+    if (rv<=0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "read(%s): %s", fname, strerror(errno));
+      close(fd);
+      free(dataPtr);
+      return GWEN_ERROR_IO;
+    }
+    bytesRead+=(size_t) rv;
+  }
+  close(fd);
+
+  *pDataPtr=dataPtr;
+  *pDataSize=dataSize;
+  *pIsMapped=0;
+  return 0;
+}
+
+
+
+void _unmapFile(uint8_t *dataPtr, size_t dataSize, int isMapped)
+{
+  if (dataPtr) {
+#ifdef AB_IMEXPORTER_CONTEXT_BIN_USE_MMAP
+    if (isMapped)
+      munmap(dataPtr, dataSize);
+    else
+#endif
+      free(dataPtr);
+  }
+}
+
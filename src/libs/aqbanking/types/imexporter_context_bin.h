@@ -0,0 +1,84 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_CONTEXT_BIN_H
+#define AB_IMEXPORTER_CONTEXT_BIN_H
+
+#include <aqbanking/error.h>
+#include <aqbanking/types/imexporter_context.h>
+
+#include <gwenhywfar/syncio.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** @defgroup G_AB_IMEXPORTER_CONTEXT_BIN Binary Context Files
+ *
+ * Besides the textual GWEN_DB format context files can be stored in a compact binary format.
+ * Such a file starts with a header (magic "ABCT" and a format version) followed by length-prefixed
+ * records, one for every account info, transaction, security and message. The transactions of an
+ * account info follow the record of that account info.
+ *
+ * Binary files are always UTF-8 encoded and can be decoded directly from a memory mapped file.
+ */
+/*@{*/
+
+#define AB_IMEXPORTER_CONTEXT_BIN_VERSION 1
+
+
+/**
+ * Check whether the given data is a binary context file (only the header is checked).
+ * @return 1 if binary, 0 otherwise
+ */
+AQBANKING_API int AB_ImExporterContextBin_IsBinary(const uint8_t *ptr, uint32_t len);
+
+/**
+ * Write the given context in binary format.
+ */
+AQBANKING_API int AB_ImExporterContextBin_Write(const AB_IMEXPORTER_CONTEXT *ctx, GWEN_SYNCIO *sio);
+
+/**
+ * Add the account infos, transactions, securities and messages of a binary context file in memory
+ * to the given context.
+ */
+AQBANKING_API int AB_ImExporterContextBin_ReadFromMemory(AB_IMEXPORTER_CONTEXT *ctx, const uint8_t *ptr, uint32_t len);
+
+/**
+ * Like @ref AB_ImExporterContextBin_ReadFromMemory, but textual GWEN_DB context data is accepted, too.
+ * The format is detected by the header, so this can be used for data of unknown origin (e.g. read
+ * from stdin).
+ */
+AQBANKING_API int AB_ImExporterContextBin_ReadAnyFromMemory(AB_IMEXPORTER_CONTEXT *ctx, const uint8_t *ptr, uint32_t len);
+
+/**
+ * Like @ref AB_ImExporterContextBin_ReadFromMemory, the file is mapped into memory if possible.
+ * @return GWEN_ERROR_BAD_DATA if the file is no binary context file
+ */
+AQBANKING_API int AB_ImExporterContextBin_ReadFile(AB_IMEXPORTER_CONTEXT *ctx, const char *fname);
+
+/**
+ * Check whether the given file is a binary context file.
+ * @return 1 if binary, 0 if not (or the file can not be read)
+ */
+AQBANKING_API int AB_ImExporterContextBin_IsBinaryFile(const char *fname);
+
+/*@}*/
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
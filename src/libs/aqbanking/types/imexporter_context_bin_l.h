@@ -0,0 +1,76 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_CONTEXT_BIN_L_H
+#define AB_IMEXPORTER_CONTEXT_BIN_L_H
+
+#include "imexporter_context_bin.h"
+
+#include <gwenhywfar/db.h>
+
+
+/*
+ * File layout (all numbers big-endian):
+ *   header: magic (4 bytes), version (uint16), reserved (uint16)
+ *   records: type (uint8), payload size (uint32), payload
+ *
+ * Every record payload is the content of the GWEN_DB written by the toDb function of the
+ * corresponding type, encoded as a sequence of items:
+ *   GROUP_BEGIN: name
+ *   GROUP_END
+ *   CHAR:        name, string value
+ *   INT:         name, int32
+ *   BIN:         name, size (uint32), data
+ * Names are stored as uint16 size, strings as uint32 size, both followed by the bytes and a
+ * terminating zero (which is not counted) so they can be used in place.
+ *
+ * Unknown record types are skipped, the END record marks a complete file.
+ */
+
+#define AB_IMEXPORTER_CONTEXT_BIN_MAGIC        "ABCT"
+#define AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE  8
+#define AB_IMEXPORTER_CONTEXT_BIN_RECHDR_SIZE  5
+
+/* every transaction has a record of its own, so larger records only appear in corrupt files */
+#define AB_IMEXPORTER_CONTEXT_BIN_MAX_RECORD_SIZE (16*1024*1024)
+
+#define AB_IMEXPORTER_CONTEXT_BIN_REC_ACCOUNTINFO 1
+#define AB_IMEXPORTER_CONTEXT_BIN_REC_TRANSACTION 2
+#define AB_IMEXPORTER_CONTEXT_BIN_REC_SECURITY    3
+#define AB_IMEXPORTER_CONTEXT_BIN_REC_MESSAGE     4
+#define AB_IMEXPORTER_CONTEXT_BIN_REC_END         0xff
+
+#define AB_IMEXPORTER_CONTEXT_BIN_ITEM_GROUP_BEGIN 'g'
+#define AB_IMEXPORTER_CONTEXT_BIN_ITEM_GROUP_END   'e'
+#define AB_IMEXPORTER_CONTEXT_BIN_ITEM_CHAR        'c'
+#define AB_IMEXPORTER_CONTEXT_BIN_ITEM_INT         'i'
+#define AB_IMEXPORTER_CONTEXT_BIN_ITEM_BIN         'b'
+
+
+
+/**
+ * Check the header of a binary context file (magic and version).
+ * @return 0 if ok, GWEN_ERROR_BAD_DATA otherwise
+ */
+int AB_ImExporterContextBin_CheckHeader(const uint8_t *ptr, uint32_t len);
+
+/**
+ * Read type and payload size from a record header (@ref AB_IMEXPORTER_CONTEXT_BIN_RECHDR_SIZE bytes).
+ */
+void AB_ImExporterContextBin_ParseRecordHeader(const uint8_t *ptr, uint8_t *pRecordType, uint32_t *pPayloadSize);
+
+/**
+ * Decode the payload of a record into the given DB (which should be empty).
+ */
+int AB_ImExporterContextBin_DecodeDb(const uint8_t *ptr, uint32_t len, GWEN_DB_NODE *db);
+
+
+#endif
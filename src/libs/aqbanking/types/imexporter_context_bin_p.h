@@ -0,0 +1,22 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_CONTEXT_BIN_P_H
+#define AB_IMEXPORTER_CONTEXT_BIN_P_H
+
+#include "imexporter_context_bin_l.h"
+
+
+#define AB_IMEXPORTER_CONTEXT_BIN_MAXDEPTH     16
+#define AB_IMEXPORTER_CONTEXT_BIN_FLUSHSIZE    65536
+
+
+#endif
@@ -0,0 +1,468 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "imexporter_context_cursor_p.h"
+#include "imexporter_context_bin_l.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+#include <gwenhywfar/buffer.h>
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static int _nextBinary(AB_IMEXPORTER_CONTEXT_CURSOR *cur);
+static int _nextText(AB_IMEXPORTER_CONTEXT_CURSOR *cur);
+static int _readRecordData(AB_IMEXPORTER_CONTEXT_CURSOR *cur, uint32_t size);
+static int _readTextAccountInfo(AB_IMEXPORTER_CONTEXT_CURSOR *cur, AB_IMEXPORTER_ACCOUNTINFO **pAccountInfo);
+static int _parseTextAccountInfo(AB_IMEXPORTER_CONTEXT_CURSOR *cur, AB_IMEXPORTER_ACCOUNTINFO **pAccountInfo);
+static int _readTextChar(AB_IMEXPORTER_CONTEXT_CURSOR *cur);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+int AB_ImExporterContextCursor_Open(const char *fname, AB_IMEXPORTER_CONTEXT_CURSOR **pCursor)
+{
+  AB_IMEXPORTER_CONTEXT_CURSOR *cur;
+  uint8_t header[AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE];
+  size_t len;
+  int rv;
+
+  assert(pCursor);
+
+  GWEN_NEW_OBJECT(AB_IMEXPORTER_CONTEXT_CURSOR, cur);
+  if (fname) {
+    cur->f=fopen(fname, "rb");
+    if (cur->f==NULL) {
+      rv=(errno==ENOENT)?GWEN_ERROR_NOT_FOUND:GWEN_ERROR_IO;
+      DBG_INFO(AQBANKING_LOGDOMAIN, "fopen(%s): %s", fname, strerror(errno));
+      AB_ImExporterContextCursor_free(cur);
+      return rv;
+    }
+    cur->closeFile=1;
+  }
+  else
+    cur->f=stdin;
+
+  len=fread(header, 1, sizeof(header), cur->f);
+  if (AB_ImExporterContextBin_IsBinary(header, len)) {
+    struct stat st;
+
+    rv=AB_ImExporterContextBin_CheckHeader(header, len);
+    cur->dbRecord=GWEN_DB_Group_new("record");
+    if (fstat(fileno(cur->f), &st)==0 && S_ISREG(st.st_mode))
+      cur->fileSize=(uint64_t) st.st_size;
+  }
+  else if (ferror(cur->f)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading context file");
+    rv=GWEN_ERROR_IO;
+  }
+  else {
+    /* the bytes already read are the start of the text */
+    cur->textBuffer=GWEN_Buffer_new(0, 4096, 0, 1);
+    memmove(cur->textStart, header, len);
+    cur->textStartLen=len;
+    rv=0;
+  }
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    AB_ImExporterContextCursor_free(cur);
+    return rv;
+  }
+
+  *pCursor=cur;
+  return 0;
+}
+
+
+
+void AB_ImExporterContextCursor_free(AB_IMEXPORTER_CONTEXT_CURSOR *cur)
+{
+  if (cur) {
+    if (cur->f && cur->closeFile)
+      fclose(cur->f);
+    free(cur->recordBuffer);
+    if (cur->dbRecord)
+      GWEN_DB_Group_free(cur->dbRecord);
+    AB_ImExporterAccountInfo_free(cur->ownAccountInfo);
+    AB_Transaction_free(cur->ownTransaction);
+    GWEN_Buffer_free(cur->textBuffer);
+    GWEN_FREE_OBJECT(cur);
+  }
+}
+
+
+
+int AB_ImExporterContextCursor_Next(AB_IMEXPORTER_CONTEXT_CURSOR *cur)
+{
+  int rv;
+
+  assert(cur);
+
+  if (cur->ownTransaction) {
+    AB_Transaction_free(cur->ownTransaction);
+    cur->ownTransaction=NULL;
+  }
+  cur->currentTransaction=NULL;
+  cur->currentItem=0;
+  if (cur->atEnd)
+    return 0;
+
+  rv=(cur->textBuffer)?_nextText(cur):_nextBinary(cur);
+  if (rv<=0) {
+    /* don't continue after errors */
+    cur->atEnd=1;
+    return rv;
+  }
+
+  cur->currentItem=rv;
+  return rv;
+}
+
+
+
+const AB_IMEXPORTER_ACCOUNTINFO *AB_ImExporterContextCursor_GetAccountInfo(const AB_IMEXPORTER_CONTEXT_CURSOR *cur)
+{
+  assert(cur);
+  return cur->currentAccountInfo;
+}
+
+
+
+const AB_TRANSACTION *AB_ImExporterContextCursor_GetTransaction(AB_IMEXPORTER_CONTEXT_CURSOR *cur)
+{
+  assert(cur);
+
+  if (cur->currentItem!=AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_TRANSACTION)
+    return NULL;
+
+  if (cur->currentTransaction==NULL && cur->textBuffer==NULL) {
+    int rv;
+
+    /* decode record read by _nextBinary() */
+    rv=AB_ImExporterContextBin_DecodeDb(cur->recordBuffer, cur->recordSize, cur->dbRecord);
+    if (rv==0)
+      cur->ownTransaction=AB_Transaction_fromDb(cur->dbRecord);
+    GWEN_DB_ClearGroup(cur->dbRecord, NULL);
+    if (cur->ownTransaction==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad transaction record (%d)", rv);
+      return NULL;
+    }
+    cur->currentTransaction=cur->ownTransaction;
+  }
+
+  return cur->currentTransaction;
+}
+
+
+
+int _nextBinary(AB_IMEXPORTER_CONTEXT_CURSOR *cur)
+{
+  for (;;) {
+    uint8_t header[AB_IMEXPORTER_CONTEXT_BIN_RECHDR_SIZE];
+    uint8_t recordType;
+    uint32_t payloadSize;
+    AB_IMEXPORTER_ACCOUNTINFO *ai;
+    int rv;
+
+    if (fread(header, 1, sizeof(header), cur->f)!=sizeof(header)) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Binary context file is truncated");
+      return GWEN_ERROR_BAD_DATA;
+    }
+    AB_ImExporterContextBin_ParseRecordHeader(header, &recordType, &payloadSize);
+    if (recordType==AB_IMEXPORTER_CONTEXT_BIN_REC_END)
+      return 0;
+
+    rv=_readRecordData(cur, payloadSize);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+
+    switch (recordType) {
+    case AB_IMEXPORTER_CONTEXT_BIN_REC_ACCOUNTINFO:
+      rv=AB_ImExporterContextBin_DecodeDb(cur->recordBuffer, cur->recordSize, cur->dbRecord);
+      ai=(rv==0)?AB_ImExporterAccountInfo_fromDb(cur->dbRecord):NULL;
+      GWEN_DB_ClearGroup(cur->dbRecord, NULL);
+      if (ai==NULL) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad account info record (%d)", rv);
+        return GWEN_ERROR_BAD_DATA;
+      }
+      AB_ImExporterAccountInfo_free(cur->ownAccountInfo);
+      cur->ownAccountInfo=ai;
+      cur->currentAccountInfo=ai;
+      return AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_ACCOUNTINFO;
+
+    case AB_IMEXPORTER_CONTEXT_BIN_REC_TRANSACTION:
+      if (cur->currentAccountInfo==NULL) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "Transaction record without account info");
+        return GWEN_ERROR_BAD_DATA;
+      }
+      /* decoded on demand by AB_ImExporterContextCursor_GetTransaction() */
+      return AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_TRANSACTION;
+
+    default:
+      /* securities, messages and unknown records */
+      break;
+    }
+  }
+}
+
+
+
+int _nextText(AB_IMEXPORTER_CONTEXT_CURSOR *cur)
+{
+  AB_IMEXPORTER_ACCOUNTINFO *ai=NULL;
+  int rv;
+
+  if (cur->currentAccountInfo) {
+    const AB_TRANSACTION *t;
+
+    if (cur->textTransaction)
+      t=AB_Transaction_List_Next(cur->textTransaction);
+    else
+      t=AB_ImExporterAccountInfo_GetFirstTransaction(cur->currentAccountInfo, 0, 0);
+    cur->textTransaction=t;
+    if (t) {
+      cur->currentTransaction=t;
+      return AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_TRANSACTION;
+    }
+  }
+
+  rv=_readTextAccountInfo(cur, &ai);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+  else if (rv==0)
+    return 0;
+  AB_ImExporterAccountInfo_free(cur->ownAccountInfo);
+  cur->ownAccountInfo=ai;
+  cur->currentAccountInfo=ai;
+  cur->textTransaction=NULL;
+  return AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_ACCOUNTINFO;
+}
+
+
+
+int _readRecordData(AB_IMEXPORTER_CONTEXT_CURSOR *cur, uint32_t size)
+{
+  /* don't allocate memory for sizes which can not be right */
+  if (size>AB_IMEXPORTER_CONTEXT_BIN_MAX_RECORD_SIZE) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad record size %lu in binary context file", (unsigned long) size);
+    return GWEN_ERROR_BAD_DATA;
+  }
+  if (cur->fileSize) {
+    long pos;
+
+    pos=ftell(cur->f);
+    if (pos<0 || (uint64_t) pos+size>cur->fileSize) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Binary context file is truncated");
+      return GWEN_ERROR_BAD_DATA;
+    }
+  }
+
+  if (size>cur->recordBufferSize) {
+    uint8_t *p;
+
+    p=(uint8_t *) realloc(cur->recordBuffer, size);
+    if (p==NULL)
+      return GWEN_ERROR_MEMORY_FULL;
+    cur->recordBuffer=p;
+    cur->recordBufferSize=size;
+  }
+
+  if (size && fread(cur->recordBuffer, 1, size, cur->f)!=size) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Binary context file is truncated");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  cur->recordSize=size;
+  return 0;
+}
+
+
+
+
+/* Reads the text up to the end of the next group below "accountInfoList", skipping everything else.
+ * Only braces outside of quotes and comments count, names are the last word before the opening brace.
+ */
+int _readTextAccountInfo(AB_IMEXPORTER_CONTEXT_CURSOR *cur, AB_IMEXPORTER_ACCOUNTINFO **pAccountInfo)
+{
+  GWEN_BUFFER *wordBuf;
+  int wordEnded=1;
+  int inQuote=0;
+  int rv;
+
+  wordBuf=GWEN_Buffer_new(0, 64, 0, 1);
+  for (;;) {
+    int c;
+    int collect;
+
+    c=_readTextChar(cur);
+    if (c==EOF) {
+      GWEN_Buffer_free(wordBuf);
+      if (ferror(cur->f)) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading context file");
+        return GWEN_ERROR_IO;
+      }
+      if (cur->textDepth || inQuote) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "Context file is truncated");
+        return GWEN_ERROR_BAD_DATA;
+      }
+      return 0;
+    }
+
+    /* only the content of the groups below "accountInfoList" is kept */
+    collect=(cur->textInAccountInfoList && cur->textDepth>=2);
+
+    if (inQuote) {
+      if (collect)
+        GWEN_Buffer_AppendByte(cur->textBuffer, (char) c);
+      if (c=='\\') {
+        c=_readTextChar(cur);
+        if (c!=EOF && collect)
+          GWEN_Buffer_AppendByte(cur->textBuffer, (char) c);
+      }
+      else if (c=='"')
+        inQuote=0;
+      continue;
+    }
+
+    if (c=='#') {
+      /* comment up to the end of the line */
+      while (c!=EOF && c!='\n')
+        c=_readTextChar(cur);
+      if (collect)
+        GWEN_Buffer_AppendByte(cur->textBuffer, '\n');
+      wordEnded=1;
+      continue;
+    }
+
+    if (c=='{') {
+      if (cur->textDepth==0)
+        cur->textInAccountInfoList=(strcmp(GWEN_Buffer_GetStart(wordBuf), "accountInfoList")==0);
+      else if (cur->textDepth==1 && cur->textInAccountInfoList) {
+        GWEN_Buffer_Reset(cur->textBuffer);
+        GWEN_Buffer_AppendBuffer(cur->textBuffer, wordBuf);
+        GWEN_Buffer_AppendString(cur->textBuffer, " {");
+      }
+      else if (collect)
+        GWEN_Buffer_AppendByte(cur->textBuffer, (char) c);
+      cur->textDepth++;
+      GWEN_Buffer_Reset(wordBuf);
+      wordEnded=1;
+    }
+    else if (c=='}') {
+      if (cur->textDepth==0) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "Unbalanced braces in context file");
+        GWEN_Buffer_free(wordBuf);
+        return GWEN_ERROR_BAD_DATA;
+      }
+      if (collect)
+        GWEN_Buffer_AppendByte(cur->textBuffer, (char) c);
+      cur->textDepth--;
+      GWEN_Buffer_Reset(wordBuf);
+      wordEnded=1;
+      if (cur->textDepth==0)
+        cur->textInAccountInfoList=0;
+      else if (cur->textDepth==1 && cur->textInAccountInfoList) {
+        GWEN_Buffer_free(wordBuf);
+        rv=_parseTextAccountInfo(cur, pAccountInfo);
+        GWEN_Buffer_Reset(cur->textBuffer);
+        if (rv<0) {
+          DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+          return rv;
+        }
+        return 1;
+      }
+    }
+    else {
+      if (c=='"')
+        inQuote=1;
+      if (collect)
+        GWEN_Buffer_AppendByte(cur->textBuffer, (char) c);
+      else if (cur->textDepth<2) {
+        if (isspace(c))
+          wordEnded=1;
+        else {
+          if (wordEnded) {
+            GWEN_Buffer_Reset(wordBuf);
+            wordEnded=0;
+          }
+          GWEN_Buffer_AppendByte(wordBuf, (char) c);
+        }
+      }
+    }
+  }
+}
+
+
+
+int _parseTextAccountInfo(AB_IMEXPORTER_CONTEXT_CURSOR *cur, AB_IMEXPORTER_ACCOUNTINFO **pAccountInfo)
+{
+  GWEN_DB_NODE *db;
+  GWEN_DB_NODE *dbAccountInfo;
+  AB_IMEXPORTER_ACCOUNTINFO *ai=NULL;
+  int rv;
+
+  db=GWEN_DB_Group_new("accountInfoList");
+  rv=GWEN_DB_ReadFromString(db,
+                            GWEN_Buffer_GetStart(cur->textBuffer),
+                            GWEN_Buffer_GetUsedBytes(cur->textBuffer),
+                            GWEN_DB_FLAGS_DEFAULT | GWEN_PATH_FLAGS_CREATE_GROUP);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading context file (%d)", rv);
+    GWEN_DB_Group_free(db);
+    return rv;
+  }
+
+  dbAccountInfo=GWEN_DB_GetFirstGroup(db);
+  if (dbAccountInfo)
+    ai=AB_ImExporterAccountInfo_fromDb(dbAccountInfo);
+  GWEN_DB_Group_free(db);
+  if (ai==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad account info in context file");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  *pAccountInfo=ai;
+  return 0;
+}
+
+
+
+int _readTextChar(AB_IMEXPORTER_CONTEXT_CURSOR *cur)
+{
+  if (cur->textStartPos<cur->textStartLen)
+    return cur->textStart[cur->textStartPos++];
+  return getc(cur->f);
+}
@@ -0,0 +1,80 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifndef AB_IMEXPORTER_CONTEXT_CURSOR_H
+#define AB_IMEXPORTER_CONTEXT_CURSOR_H
+
+#include <aqbanking/error.h>
+#include <aqbanking/types/imexporter_accountinfo.h>
+#include <aqbanking/types/transaction.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** @defgroup G_AB_IMEXPORTER_CONTEXT_CURSOR Reading Context Files Record by Record
+ *
+ * A cursor walks through the account infos and transactions of a context file without creating
+ * an @ref AB_IMEXPORTER_CONTEXT. Binary context files (see @ref G_AB_IMEXPORTER_CONTEXT_BIN) are read
+ * one record at a time, text files one account info (including its transactions) at a time, so the
+ * memory needed does not depend on the number of accounts in the file.
+ *
+ * Every account info is followed by its transactions. Securities and messages are skipped.
+ */
+/*@{*/
+
+typedef struct AB_IMEXPORTER_CONTEXT_CURSOR AB_IMEXPORTER_CONTEXT_CURSOR;
+
+#define AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_ACCOUNTINFO 1
+#define AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_TRANSACTION 2
+
+
+/**
+ * Open a context file.
+ * @param fname name of the file (NULL for stdin)
+ * @param pCursor pointer to a variable to receive the cursor
+ * @return 0 if ok, GWEN_ERROR_NOT_FOUND if the file does not exist, error code otherwise
+ */
+AQBANKING_API int AB_ImExporterContextCursor_Open(const char *fname, AB_IMEXPORTER_CONTEXT_CURSOR **pCursor);
+
+AQBANKING_API void AB_ImExporterContextCursor_free(AB_IMEXPORTER_CONTEXT_CURSOR *cur);
+
+/**
+ * Advance to the next item.
+ * @return AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_ACCOUNTINFO or AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_TRANSACTION,
+ *         0 at the end of the file, error code otherwise
+ */
+AQBANKING_API int AB_ImExporterContextCursor_Next(AB_IMEXPORTER_CONTEXT_CURSOR *cur);
+
+/**
+ * Return the current account info (i.e. the one the current transaction belongs to).
+ * It remains valid until the next account info is reached. Don't use its transaction list, it is
+ * empty for binary files.
+ */
+AQBANKING_API const AB_IMEXPORTER_ACCOUNTINFO *AB_ImExporterContextCursor_GetAccountInfo(const AB_IMEXPORTER_CONTEXT_CURSOR *cur);
+
+/**
+ * Return the current transaction (only valid until the next call to @ref AB_ImExporterContextCursor_Next).
+ * Transactions of binary files are only decoded when this function is called.
+ * @return NULL if the current item is no transaction or could not be decoded
+ */
+AQBANKING_API const AB_TRANSACTION *AB_ImExporterContextCursor_GetTransaction(AB_IMEXPORTER_CONTEXT_CURSOR *cur);
+
+/*@}*/
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,53 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifndef AB_IMEXPORTER_CONTEXT_CURSOR_P_H
+#define AB_IMEXPORTER_CONTEXT_CURSOR_P_H
+
+#include "imexporter_context_cursor.h"
+#include "imexporter_context.h"
+#include "imexporter_context_bin_l.h"
+
+#include <gwenhywfar/db.h>
+#include <gwenhywfar/buffer.h>
+
+#include <stdio.h>
+
+
+struct AB_IMEXPORTER_CONTEXT_CURSOR {
+  FILE *f;
+  int closeFile;
+  AB_IMEXPORTER_ACCOUNTINFO *ownAccountInfo;
+
+  /* binary files */
+  uint64_t fileSize; /* 0 if unknown (e.g. stdin) */
+  uint8_t *recordBuffer;
+  uint32_t recordBufferSize;
+  uint32_t recordSize;
+  GWEN_DB_NODE *dbRecord;
+  AB_TRANSACTION *ownTransaction;
+
+  /* text files (the text of one "accountInfo" group at a time is collected in textBuffer) */
+  GWEN_BUFFER *textBuffer;
+  uint8_t textStart[AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE];
+  uint32_t textStartLen;
+  uint32_t textStartPos;
+  int textDepth;
+  int textInAccountInfoList;
+  const AB_TRANSACTION *textTransaction;
+
+  int currentItem;
+  const AB_IMEXPORTER_ACCOUNTINFO *currentAccountInfo;
+  const AB_TRANSACTION *currentTransaction;
+  int atEnd;
+};
+
+
+#endif
@@ -0,0 +1,548 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "transaction_hashstore_p.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static int _lockFile(AB_TRANSACTION_HASHSTORE *hs, const char *fname);
+static void _unlockFile(AB_TRANSACTION_HASHSTORE *hs);
+static int _readHeader(FILE *f, const char *fname);
+static int _writeHeader(FILE *f);
+static int _readDigests(AB_TRANSACTION_HASHSTORE *hs, FILE *f, uint32_t *pNumRead);
+static int _addToIndex(AB_TRANSACTION_HASHSTORE *hs, const uint8_t *digest);
+static uint32_t _findDigest(const AB_TRANSACTION_HASHSTORE *hs, const uint8_t *digest);
+static int _makeRoom(AB_TRANSACTION_HASHSTORE *hs);
+static int _resizeSlots(AB_TRANSACTION_HASHSTORE *hs, uint32_t slotCount);
+static void _insertSlot(uint32_t *slots, uint32_t slotCount, const uint8_t *digest, uint32_t idx);
+static uint32_t _slotHash(const uint8_t *digest);
+static int _fromHex(const char *s, uint8_t *digest);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AB_TRANSACTION_HASHSTORE *AB_TransactionHashStore_new(void)
+{
+  AB_TRANSACTION_HASHSTORE *hs;
+
+  GWEN_NEW_OBJECT(AB_TRANSACTION_HASHSTORE, hs);
+  return hs;
+}
+
+
+
+void AB_TransactionHashStore_free(AB_TRANSACTION_HASHSTORE *hs)
+{
+  if (hs) {
+    if (hs->f)
+      fclose(hs->f);
+    _unlockFile(hs);
+    free(hs->slots);
+    free(hs->counts);
+    free(hs->digests);
+    GWEN_FREE_OBJECT(hs);
+  }
+}
+
+
+
+int AB_TransactionHashStore_Open(AB_TRANSACTION_HASHSTORE *hs, const char *fname)
+{
+  FILE *f;
+  uint32_t numRead=0;
+  int rv;
+
+  assert(hs);
+  assert(fname);
+
+  if (hs->f) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Hash store already open");
+    return GWEN_ERROR_INVALID;
+  }
+
+  rv=_lockFile(hs, fname);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  f=fopen(fname, "r+b");
+  if (f==NULL && errno==ENOENT)
+    f=fopen(fname, "w+b");
+  if (f==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "fopen(%s): %s", fname, strerror(errno));
+    _unlockFile(hs);
+    return GWEN_ERROR_IO;
+  }
+
+  rv=_readHeader(f, fname);
+  if (rv==0)
+    rv=_writeHeader(f);
+  else if (rv==1)
+    rv=_readDigests(hs, f, &numRead);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    fclose(f);
+    _unlockFile(hs);
+    return rv;
+  }
+
+  /* new digests go behind the last complete one (overwriting a partially written digest) */
+  if (fseek(f, AB_TRANSACTION_HASHSTORE_HEADER_SIZE+((long) numRead)*AB_TRANSACTION_HASHSTORE_DIGEST_SIZE, SEEK_SET)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "fseek(%s): %s", fname, strerror(errno));
+    fclose(f);
+    _unlockFile(hs);
+    return GWEN_ERROR_IO;
+  }
+
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Read %u digests from \"%s\"", numRead, fname);
+  hs->f=f;
+  return 0;
+}
+
+
+
+int AB_TransactionHashStore_Close(AB_TRANSACTION_HASHSTORE *hs)
+{
+  assert(hs);
+
+  if (hs->f) {
+    FILE *f;
+
+    f=hs->f;
+    hs->f=NULL;
+    if (fclose(f)) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "fclose(): %s", strerror(errno));
+      _unlockFile(hs);
+      return GWEN_ERROR_IO;
+    }
+    _unlockFile(hs);
+  }
+
+  return 0;
+}
+
+
+
+uint32_t AB_TransactionHashStore_GetCount(const AB_TRANSACTION_HASHSTORE *hs)
+{
+  assert(hs);
+  return hs->totalCount;
+}
+
+
+
+int AB_TransactionHashStore_HasDigest(const AB_TRANSACTION_HASHSTORE *hs, const uint8_t *digest)
+{
+  assert(hs);
+  assert(digest);
+  return (_findDigest(hs, digest)!=0)?1:0;
+}
+
+
+
+uint32_t AB_TransactionHashStore_GetDigestCount(const AB_TRANSACTION_HASHSTORE *hs, const uint8_t *digest)
+{
+  uint32_t idx;
+
+  assert(hs);
+  assert(digest);
+  idx=_findDigest(hs, digest);
+  return idx?hs->counts[idx-1]:0;
+}
+
+
+
+int AB_TransactionHashStore_AddDigest(AB_TRANSACTION_HASHSTORE *hs, const uint8_t *digest)
+{
+  assert(hs);
+  assert(digest);
+
+  /* repeated digests are written again, so the file keeps the counts */
+  if (hs->f && fwrite(digest, AB_TRANSACTION_HASHSTORE_DIGEST_SIZE, 1, hs->f)!=1) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "fwrite(): %s", strerror(errno));
+    return GWEN_ERROR_IO;
+  }
+
+  return _addToIndex(hs, digest);
+}
+
+
+
+int AB_TransactionHashStore_GetTransactionDigest(const AB_TRANSACTION *t, uint8_t *digest)
+{
+  AB_TRANSACTION *tCopy;
+  int rv;
+
+  assert(t);
+  assert(digest);
+
+  tCopy=AB_Transaction_dup(t);
+  AB_Transaction_SetUniqueAccountId(tCopy, 0);
+  AB_Transaction_SetUniqueId(tCopy, 0);
+  AB_Transaction_SetRefUniqueId(tCopy, 0);
+  AB_Transaction_SetIdForApplication(tCopy, 0);
+  AB_Transaction_SetStringIdForApplication(tCopy, NULL);
+  AB_Transaction_SetSessionId(tCopy, 0);
+  AB_Transaction_SetGroupId(tCopy, 0);
+
+  rv=AB_Transaction_GenerateHash(tCopy);
+  if (rv==0)
+    rv=_fromHex(AB_Transaction_GetHash(tCopy), digest);
+  AB_Transaction_free(tCopy);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+int AB_TransactionHashStore_AddTransaction(AB_TRANSACTION_HASHSTORE *hs, const AB_TRANSACTION *t)
+{
+  uint8_t digest[AB_TRANSACTION_HASHSTORE_DIGEST_SIZE];
+  int rv;
+
+  assert(hs);
+
+  rv=AB_TransactionHashStore_GetTransactionDigest(t, digest);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  return AB_TransactionHashStore_AddDigest(hs, digest);
+}
+
+
+
+int _lockFile(AB_TRANSACTION_HASHSTORE *hs, const char *fname)
+{
+  GWEN_FSLOCK *lck;
+  GWEN_FSLOCK_RESULT res;
+
+  lck=GWEN_FSLock_new(fname, GWEN_FSLock_TypeFile);
+  res=GWEN_FSLock_Lock(lck, AB_TRANSACTION_HASHSTORE_LOCK_TIMEOUT, 0);
+  if (res!=GWEN_FSLock_ResultOk) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not lock \"%s\" (%d)", fname, res);
+    GWEN_FSLock_free(lck);
+    return (res==GWEN_FSLock_ResultTimeout || res==GWEN_FSLock_ResultBusy)?GWEN_ERROR_TIMEOUT:GWEN_ERROR_IO;
+  }
+
+  hs->lock=lck;
+  return 0;
+}
+
+
+
+void _unlockFile(AB_TRANSACTION_HASHSTORE *hs)
+{
+  if (hs->lock) {
+    GWEN_FSLock_Unlock(hs->lock);
+    GWEN_FSLock_free(hs->lock);
+    hs->lock=NULL;
+  }
+}
+
+
+
+/* @return 0 for an empty file, 1 for a valid header, error code otherwise */
+int _readHeader(FILE *f, const char *fname)
+{
+  uint8_t header[AB_TRANSACTION_HASHSTORE_HEADER_SIZE];
+  size_t len;
+  int version;
+
+  len=fread(header, 1, sizeof(header), f);
+  if (ferror(f)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "fread(%s): %s", fname, strerror(errno));
+    return GWEN_ERROR_IO;
+  }
+  if (len==0)
+    return 0;
+
+  if (len<sizeof(header) && memcmp(header, AB_TRANSACTION_HASHSTORE_MAGIC, (len<4)?len:4)==0) {
+    /* writing the header of a new file has been interrupted, there are no digests yet */
+    DBG_WARN(AQBANKING_LOGDOMAIN, "Incomplete header in \"%s\", starting with an empty hash store", fname);
+    return 0;
+  }
+
+  if (len<sizeof(header) || memcmp(header, AB_TRANSACTION_HASHSTORE_MAGIC, 4)!=0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "\"%s\" is not a transaction hash store", fname);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  version=header[4]+(header[5]<<8);
+  if (version>AB_TRANSACTION_HASHSTORE_VERSION) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Unsupported hash store version %d in \"%s\"", version, fname);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  return 1;
+}
+
+
+
+int _writeHeader(FILE *f)
+{
+  uint8_t header[AB_TRANSACTION_HASHSTORE_HEADER_SIZE];
+
+  memmove(header, AB_TRANSACTION_HASHSTORE_MAGIC, 4);
+  header[4]=AB_TRANSACTION_HASHSTORE_VERSION & 0xff;
+  header[5]=(AB_TRANSACTION_HASHSTORE_VERSION>>8) & 0xff;
+  header[6]=0;
+  header[7]=0;
+
+  rewind(f);
+  if (fwrite(header, sizeof(header), 1, f)!=1 || fflush(f)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "fwrite(): %s", strerror(errno));
+    return GWEN_ERROR_IO;
+  }
+
+  return 0;
+}
+
+
+
+int _readDigests(AB_TRANSACTION_HASHSTORE *hs, FILE *f, uint32_t *pNumRead)
+{
+  uint8_t *buffer;
+  uint32_t numRead=0;
+
+  buffer=(uint8_t *) malloc(AB_TRANSACTION_HASHSTORE_READCHUNK*AB_TRANSACTION_HASHSTORE_DIGEST_SIZE);
+  if (buffer==NULL)
+    return GWEN_ERROR_MEMORY_FULL;
+
+  for (;;) {
+    size_t n;
+    size_t i;
+
+    /* only complete digests are returned, a partially written one at the end is ignored */
+    n=fread(buffer, AB_TRANSACTION_HASHSTORE_DIGEST_SIZE, AB_TRANSACTION_HASHSTORE_READCHUNK, f);
+    for (i=0; i<n; i++) {
+      int rv;
+
+      rv=_addToIndex(hs, buffer+i*AB_TRANSACTION_HASHSTORE_DIGEST_SIZE);
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        free(buffer);
+        return rv;
+      }
+    }
+    numRead+=n;
+    if (n<AB_TRANSACTION_HASHSTORE_READCHUNK)
+      break;
+  }
+  free(buffer);
+
+  if (ferror(f)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "fread(): %s", strerror(errno));
+    return GWEN_ERROR_IO;
+  }
+
+  *pNumRead=numRead;
+  return 0;
+}
+
+
+
+/* @return number of times the digest is in the store now, error code otherwise */
+int _addToIndex(AB_TRANSACTION_HASHSTORE *hs, const uint8_t *digest)
+{
+  uint32_t idx;
+  int rv;
+
+  idx=_findDigest(hs, digest);
+  if (idx) {
+    if (hs->counts[idx-1]>=0x7fffffff) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Digest added too often");
+      return GWEN_ERROR_INVALID;
+    }
+    hs->counts[idx-1]++;
+    hs->totalCount++;
+    return (int) hs->counts[idx-1];
+  }
+
+  rv=_makeRoom(hs);
+  if (rv<0)
+    return rv;
+
+  memmove(hs->digests+((size_t) hs->digestCount)*AB_TRANSACTION_HASHSTORE_DIGEST_SIZE,
+          digest,
+          AB_TRANSACTION_HASHSTORE_DIGEST_SIZE);
+  hs->counts[hs->digestCount]=1;
+  _insertSlot(hs->slots, hs->slotCount, digest, hs->digestCount);
+  hs->digestCount++;
+  hs->totalCount++;
+  return 1;
+}
+
+
+
+/* @return index+1 of the digest, 0 if not found */
+uint32_t _findDigest(const AB_TRANSACTION_HASHSTORE *hs, const uint8_t *digest)
+{
+  uint32_t mask;
+  uint32_t pos;
+
+  if (hs->slotCount==0)
+    return 0;
+
+  mask=hs->slotCount-1;
+  pos=_slotHash(digest) & mask;
+  while (hs->slots[pos]) {
+    const uint8_t *p;
+
+    p=hs->digests+((size_t)(hs->slots[pos]-1))*AB_TRANSACTION_HASHSTORE_DIGEST_SIZE;
+    if (memcmp(p, digest, AB_TRANSACTION_HASHSTORE_DIGEST_SIZE)==0)
+      return hs->slots[pos];
+    pos=(pos+1) & mask;
+  }
+
+  return 0;
+}
+
+
+
+int _makeRoom(AB_TRANSACTION_HASHSTORE *hs)
+{
+  if (hs->digestCount>=hs->digestCapacity) {
+    uint32_t newCapacity;
+    uint8_t *p;
+    uint32_t *pCounts;
+
+    if (hs->digestCapacity>=0x40000000) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Too many digests in hash store");
+      return GWEN_ERROR_MEMORY_FULL;
+    }
+    newCapacity=hs->digestCapacity?(hs->digestCapacity*2):AB_TRANSACTION_HASHSTORE_MINSLOTS;
+    p=(uint8_t *) realloc(hs->digests, ((size_t) newCapacity)*AB_TRANSACTION_HASHSTORE_DIGEST_SIZE);
+    if (p==NULL)
+      return GWEN_ERROR_MEMORY_FULL;
+    hs->digests=p;
+    pCounts=(uint32_t *) realloc(hs->counts, ((size_t) newCapacity)*sizeof(uint32_t));
+    if (pCounts==NULL)
+      return GWEN_ERROR_MEMORY_FULL;
+    hs->counts=pCounts;
+    hs->digestCapacity=newCapacity;
+  }
+
+  /* keep the load factor below 0.5 so probe sequences stay short */
+  if ((hs->digestCount+1)*2>hs->slotCount)
+    return _resizeSlots(hs, hs->slotCount?(hs->slotCount*2):AB_TRANSACTION_HASHSTORE_MINSLOTS);
+
+  return 0;
+}
+
+
+
+int _resizeSlots(AB_TRANSACTION_HASHSTORE *hs, uint32_t slotCount)
+{
+  uint32_t *slots;
+  uint32_t i;
+
+  slots=(uint32_t *) calloc(slotCount, sizeof(uint32_t));
+  if (slots==NULL)
+    return GWEN_ERROR_MEMORY_FULL;
+
+  for (i=0; i<hs->digestCount; i++)
+    _insertSlot(slots, slotCount, hs->digests+((size_t) i)*AB_TRANSACTION_HASHSTORE_DIGEST_SIZE, i);
+
+  free(hs->slots);
+  hs->slots=slots;
+  hs->slotCount=slotCount;
+  return 0;
+}
+
+
+
+void _insertSlot(uint32_t *slots, uint32_t slotCount, const uint8_t *digest, uint32_t idx)
+{
+  uint32_t mask;
+  uint32_t pos;
+
+  mask=slotCount-1;
+  pos=_slotHash(digest) & mask;
+  while (slots[pos])
+    pos=(pos+1) & mask;
+  slots[pos]=idx+1;
+}
+
+
+
+uint32_t _slotHash(const uint8_t *digest)
+{
+  /* digests are uniformly distributed, so their first bytes make a good hash */
+  return ((uint32_t) digest[0]) |
+         (((uint32_t) digest[1])<<8) |
+         (((uint32_t) digest[2])<<16) |
+         (((uint32_t) digest[3])<<24);
+}
+
+
+
+int _fromHex(const char *s, uint8_t *digest)
+{
+  int i;
+
+  if (s==NULL || strlen(s)!=2*AB_TRANSACTION_HASHSTORE_DIGEST_SIZE) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid transaction hash [%s]", s?s:"<empty>");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  for (i=0; i<2*AB_TRANSACTION_HASHSTORE_DIGEST_SIZE; i++) {
+    int c;
+    int v;
+
+    c=(unsigned char) s[i];
+    if (c>='0' && c<='9')
+      v=c-'0';
+    else if (c>='a' && c<='f')
+      v=c-'a'+10;
+    else if (c>='A' && c<='F')
+      v=c-'A'+10;
+    else {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid transaction hash [%s]", s);
+      return GWEN_ERROR_BAD_DATA;
+    }
+    if (i & 1)
+      digest[i/2]|=v;
+    else
+      digest[i/2]=v<<4;
+  }
+
+  return 0;
+}
+
@@ -0,0 +1,108 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_TRANSACTION_HASHSTORE_H
+#define AB_TRANSACTION_HASHSTORE_H
+
+#include <aqbanking/error.h>
+#include <aqbanking/types/transaction.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** @defgroup G_AB_TRANSACTION_HASHSTORE Transaction Hash Store
+ *
+ * A collection of transaction fingerprints (RMD160 digests, see @ref AB_Transaction_GenerateHash) which
+ * can be kept in a file. Applications which repeatedly download overlapping statement periods can use it
+ * to recognize transactions they have already seen. A digest can be added more than once (e.g. for two
+ * equal payments on the same day), the store counts how often each digest has been added.
+ *
+ * The file starts with a header (magic "ABHS" and a format version) followed by the digests in the
+ * order they were added. New digests are only ever appended. When a store is opened the digests are
+ * read into an in-memory hash table, so lookups and insertions take constant time. While a store is
+ * open its file is locked against other processes.
+ */
+/*@{*/
+
+#define AB_TRANSACTION_HASHSTORE_VERSION     1
+#define AB_TRANSACTION_HASHSTORE_DIGEST_SIZE 20
+
+
+typedef struct AB_TRANSACTION_HASHSTORE AB_TRANSACTION_HASHSTORE;
+
+
+AQBANKING_API AB_TRANSACTION_HASHSTORE *AB_TransactionHashStore_new(void);
+
+/**
+ * Closes the file (if still open) and releases the store.
+ */
+AQBANKING_API void AB_TransactionHashStore_free(AB_TRANSACTION_HASHSTORE *hs);
+
+/**
+ * Lock the given file and read all digests from it, the file is created if it doesn't exist.
+ * Digests added afterwards are appended to that file.
+ * Without a call to this function the store only lives in memory.
+ * @return 0 if ok, GWEN_ERROR_TIMEOUT if the file is locked by another process, error code otherwise
+ */
+AQBANKING_API int AB_TransactionHashStore_Open(AB_TRANSACTION_HASHSTORE *hs, const char *fname);
+
+/**
+ * Write pending digests, close and unlock the file.
+ */
+AQBANKING_API int AB_TransactionHashStore_Close(AB_TRANSACTION_HASHSTORE *hs);
+
+/**
+ * @return number of digests added to the store (a digest added twice counts twice)
+ */
+AQBANKING_API uint32_t AB_TransactionHashStore_GetCount(const AB_TRANSACTION_HASHSTORE *hs);
+
+/**
+ * @return 1 if the digest is in the store, 0 otherwise
+ */
+AQBANKING_API int AB_TransactionHashStore_HasDigest(const AB_TRANSACTION_HASHSTORE *hs, const uint8_t *digest);
+
+/**
+ * @return number of times the digest has been added to the store (0 if it is not in the store)
+ */
+AQBANKING_API uint32_t AB_TransactionHashStore_GetDigestCount(const AB_TRANSACTION_HASHSTORE *hs, const uint8_t *digest);
+
+/**
+ * Add a digest of @ref AB_TRANSACTION_HASHSTORE_DIGEST_SIZE bytes.
+ * @return number of times the digest is in the store now (1 for a new digest), error code otherwise
+ */
+AQBANKING_API int AB_TransactionHashStore_AddDigest(AB_TRANSACTION_HASHSTORE *hs, const uint8_t *digest);
+
+/**
+ * Create the fingerprint of a transaction.
+ * Ids which are assigned anew whenever a transaction is received (like unique id, session id or
+ * application ids) don't contribute to the fingerprint, so the same booking downloaded twice gets
+ * the same fingerprint. The given transaction is not modified.
+ */
+AQBANKING_API int AB_TransactionHashStore_GetTransactionDigest(const AB_TRANSACTION *t, uint8_t *digest);
+
+/**
+ * Add the fingerprint of the given transaction (see @ref AB_TransactionHashStore_GetTransactionDigest).
+ * @return number of times the fingerprint is in the store now (1 for a new one), error code otherwise
+ */
+AQBANKING_API int AB_TransactionHashStore_AddTransaction(AB_TRANSACTION_HASHSTORE *hs, const AB_TRANSACTION *t);
+
+/*@}*/
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
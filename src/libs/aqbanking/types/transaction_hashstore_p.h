@@ -0,0 +1,51 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifndef AB_TRANSACTION_HASHSTORE_P_H
+#define AB_TRANSACTION_HASHSTORE_P_H
+
+#include "transaction_hashstore.h"
+
+#include <gwenhywfar/fslock.h>
+
+#include <stdio.h>
+
+
+#define AB_TRANSACTION_HASHSTORE_MAGIC       "ABHS"
+#define AB_TRANSACTION_HASHSTORE_HEADER_SIZE 8
+
+/** initial number of slots in the hash table (power of 2) */
+#define AB_TRANSACTION_HASHSTORE_MINSLOTS    1024
+
+/** number of digests read from the file at once */
+#define AB_TRANSACTION_HASHSTORE_READCHUNK   4096
+
+/** milliseconds to wait for another process to release the file */
+#define AB_TRANSACTION_HASHSTORE_LOCK_TIMEOUT 10000
+
+
+struct AB_TRANSACTION_HASHSTORE {
+  FILE *f;
+  GWEN_FSLOCK *lock;
+
+  /* distinct digests in the order they were first added, counts holds how often each was added */
+  uint8_t *digests;
+  uint32_t *counts;
+  uint32_t digestCount;
+  uint32_t digestCapacity;
+  uint32_t totalCount;
+
+  /* open addressing hash table, each slot holds a digest index+1 (0 means empty) */
+  uint32_t *slots;
+  uint32_t slotCount;
+};
+
+
+#endif
@@ -25,6 +25,7 @@
 #endif
 
 #include <ctype.h>
+#include <inttypes.h>
 
 
 #define AB_VALUE_STRSIZE 256
@@ -40,9 +41,10 @@ AB_VALUE *AB_Value_new(void)
 {
   AB_VALUE *v;
 
+  /* starts as inline 0/1, GMP is only initialized when needed */
   GWEN_NEW_OBJECT(AB_VALUE, v);
   GWEN_LIST_INIT(AB_VALUE, v);
-  mpq_init(v->value);
+  v->denom=1;
   return v;
 }
 
@@ -51,8 +53,10 @@ AB_VALUE *AB_Value_new(void)
 void AB_Value_free(AB_VALUE *v)
 {
   if (v) {
-    mpq_clear(v->value);
-    free(v->currency);
+    if (v->flags & AB_VALUE_FLAGS_GMP)
+      mpq_clear(v->value);
+    if (v->currency!=v->currencyBuffer)
+      free(v->currency);
     GWEN_LIST_FINI(AB_VALUE, v);
     GWEN_FREE_OBJECT(v);
   }
@@ -66,9 +70,15 @@ AB_VALUE *AB_Value_dup(const AB_VALUE *ov)
 
   assert(ov);
   v=AB_Value_new();
-  mpq_set(v->value, ov->value);
+  v->flags=ov->flags;
+  v->num=ov->num;
+  v->denom=ov->denom;
+  if (ov->flags & AB_VALUE_FLAGS_GMP) {
+    mpq_init(v->value);
+    mpq_set(v->value, ov->value);
+  }
   if (ov->currency)
-    v->currency=strdup(ov->currency);
+    AB_Value_SetCurrency(v, ov->currency);
 
   return v;
 }
@@ -94,7 +104,15 @@ AB_VALUE *AB_Value_fromInt(long int num, long int denom)
   AB_VALUE *v;
 
   v=AB_Value_new();
-  mpq_set_si(v->value, num, denom);
+  if (denom>0 && num>-INT64_MAX) {
+    v->num=num;
+    v->denom=denom;
+  }
+  else {
+    v->flags|=AB_VALUE_FLAGS_GMP;
+    mpq_init(v->value);
+    mpq_set_si(v->value, num, denom);
+  }
 
   return v;
 }
@@ -117,6 +135,84 @@ static int AB_Value_determineDecimalComma(const char *s)
 
 
 AB_VALUE *AB_Value_fromString(const char *s)
+{
+  AB_VALUE *v;
+
+  if (!s) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Attempt to convert a NULL value");
+    return NULL;
+  }
+
+  v=AB_Value__fromSimpleString(s);
+  if (v)
+    return v;
+
+  return AB_Value__fromStringGmp(s);
+}
+
+
+
+/* Parses the common form "[+-]digits[.|,digits][:currency]" in a single pass without using GMP's string
+ * functions. Returns NULL for any other input (including values with more than AB_VALUE_SIMPLE_MAXDIGITS
+ * digits), those are handled by AB_Value__fromStringGmp(). The resulting numerator and denominator are
+ * the same as those AB_Value__fromStringGmp() would set, but they are stored in the inline representation. */
+AB_VALUE *AB_Value__fromSimpleString(const char *s)
+{
+  AB_VALUE *v;
+  const char *p;
+  int64_t num=0;
+  int64_t denominator=1;
+  int digits=0;
+  int afterComma=0;
+  int isNeg=0;
+
+  p=s;
+  while (*p && *p<33)
+    p++;
+
+  if (*p=='-') {
+    isNeg=1;
+    p++;
+  }
+  else if (*p=='+') {
+    p++;
+  }
+
+  for (;;) {
+    char c;
+
+    c=*p;
+    if (c>='0' && c<='9') {
+      if (++digits>AB_VALUE_SIMPLE_MAXDIGITS)
+        return NULL;
+      num=num*10+(c-'0');
+      if (afterComma)
+        denominator*=10;
+    }
+    else if ((c=='.' || c==',') && !afterComma)
+      afterComma=1;
+    else if (c==':' || c==0)
+      break;
+    else
+      return NULL;
+    p++;
+  }
+
+  if (digits<1)
+    return NULL;
+
+  v=AB_Value_new();
+  v->num=isNeg?-num:num;
+  v->denom=denominator;
+  if (*p==':')
+    AB_Value_SetCurrency(v, p+1);
+
+  return v;
+}
+
+
+
+AB_VALUE *AB_Value__fromStringGmp(const char *s)
 {
   AB_VALUE *v;
   const char *currency=NULL;
@@ -127,11 +223,6 @@ AB_VALUE *AB_Value_fromString(const char *s)
   char decimalComma;
   int isNeg=0;
 
-  if (!s) {
-    DBG_ERROR(AQBANKING_LOGDOMAIN, "Attempt to convert a NULL value");
-    return NULL;
-  }
-
   tmpString=strdup(s);
   p=tmpString;
 
@@ -173,6 +264,8 @@ AB_VALUE *AB_Value_fromString(const char *s)
   }
 
   v=AB_Value_new();
+  v->flags|=AB_VALUE_FLAGS_GMP;
+  mpq_init(v->value);
 
   t=strchr(p, '.');
   if (t) {
@@ -203,7 +296,7 @@ AB_VALUE *AB_Value_fromString(const char *s)
 
   /* set currency (if any) */
   if (currency)
-    v->currency=strdup(currency);
+    AB_Value_SetCurrency(v, currency);
 
   /* temporary string no longer needed */
   free(tmpString);
@@ -234,9 +327,17 @@ const char *AB_Value_GetCurrency(const AB_VALUE *v)
 void AB_Value_SetCurrency(AB_VALUE *v, const char *s)
 {
   assert(v);
-  free(v->currency);
-  if (s)
-    v->currency=strdup(s);
+  if (v->currency!=v->currencyBuffer)
+    free(v->currency);
+  if (s) {
+    /* avoid a heap allocation for the usual ISO 4217 codes */
+    if (strlen(s)<AB_VALUE_CURRENCY_INLINE_SIZE) {
+      strcpy(v->currencyBuffer, s);
+      v->currency=v->currencyBuffer;
+    }
+    else
+      v->currency=strdup(s);
+  }
   else
     v->currency=0;
 }
@@ -309,8 +410,16 @@ void AB_Value__toString(const AB_VALUE *v, GWEN_BUFFER *buf)
   GWEN_Buffer_AllocRoom(buf, AB_VALUE_STRSIZE);
   p=GWEN_Buffer_GetPosPointer(buf);
   size=GWEN_Buffer_GetMaxUnsegmentedWrite(buf);
-  rv=gmp_snprintf(p, size, "%Qi", v->value);
-  assert(rv<size);
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    rv=gmp_snprintf(p, size, "%Qi", v->value);
+  else {
+    /* same output as gmp_snprintf() with "%Qi" */
+    if (v->denom==1)
+      rv=snprintf(p, size, "%" PRId64, v->num);
+    else
+      rv=snprintf(p, size, "%" PRId64 "/%" PRId64, v->num, v->denom);
+  }
+  assert(rv>=0 && rv<size);
   GWEN_Buffer_IncrementPos(buf, rv);
   GWEN_Buffer_AdjustUsedBytes(buf);
 }
@@ -325,7 +434,15 @@ int AB_Value_GetNumDenomString(const AB_VALUE *v,
 
   assert(v);
 
-  rv=gmp_snprintf(buffer, buflen, "%Qu", v->value);
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    rv=gmp_snprintf(buffer, buflen, "%Qu", v->value);
+  else {
+    mpq_t q;
+
+    AB_Value__initMpq(v, q);
+    rv=gmp_snprintf(buffer, buflen, "%Qu", q);
+    mpq_clear(q);
+  }
   if (rv<0 || rv>=buflen) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Buffer too small");
     return GWEN_ERROR_BUFFER_OVERFLOW;
@@ -386,11 +503,21 @@ void AB_Value_toHumanReadableString(const AB_VALUE *v,
 double AB_Value_GetValueAsDouble(const AB_VALUE *v)
 {
   assert(v);
-  if (mpz_fits_slong_p(mpq_numref(v->value)) && mpz_fits_slong_p(mpq_denref(v->value))) {
-    return (double)(mpz_get_d(mpq_numref(v->value)) / mpz_get_d(mpq_denref(v->value)));
-  }
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    return AB_Value__mpqGetDouble(v->value);
   else {
-    return mpq_get_d(v->value);
+    /* exact conversion to double, so the division is rounded exactly like mpz_get_d() / mpz_get_d() */
+    if (v->num>=-(INT64_C(1)<<53) && v->num<=(INT64_C(1)<<53) && v->denom<=(INT64_C(1)<<53))
+      return ((double) v->num)/((double) v->denom);
+    else {
+      mpq_t q;
+      double d;
+
+      AB_Value__initMpq(v, q);
+      d=AB_Value__mpqGetDouble(q);
+      mpq_clear(q);
+      return d;
+    }
   }
 }
 
@@ -399,6 +526,7 @@ double AB_Value_GetValueAsDouble(const AB_VALUE *v)
 void AB_Value_SetValueFromDouble(AB_VALUE *v, double i)
 {
   assert(v);
+  AB_Value__promote(v);
   mpq_set_d(v->value, i);
 }
 
@@ -407,8 +535,11 @@ void AB_Value_SetValueFromDouble(AB_VALUE *v, double i)
 void AB_Value_SetZero(AB_VALUE *v)
 {
   assert(v);
-  mpq_clear(v->value);
-  mpq_init(v->value);
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    mpq_clear(v->value);
+  v->flags=0;
+  v->num=0;
+  v->denom=1;
 }
 
 
@@ -416,7 +547,9 @@ void AB_Value_SetZero(AB_VALUE *v)
 int AB_Value_IsZero(const AB_VALUE *v)
 {
   assert(v);
-  return (mpq_sgn(v->value)==0);
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    return (mpq_sgn(v->value)==0);
+  return (v->num==0);
 }
 
 
@@ -424,7 +557,9 @@ int AB_Value_IsZero(const AB_VALUE *v)
 int AB_Value_IsNegative(const AB_VALUE *v)
 {
   assert(v);
-  return (mpq_sgn(v->value)<0);
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    return (mpq_sgn(v->value)<0);
+  return (v->num<0);
 }
 
 
@@ -432,25 +567,64 @@ int AB_Value_IsNegative(const AB_VALUE *v)
 int AB_Value_IsPositive(const AB_VALUE *v)
 {
   assert(v);
-  return (mpq_sgn(v->value)>=0);
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    return (mpq_sgn(v->value)>=0);
+  return (v->num>=0);
 }
 
 
 
 int AB_Value_Compare(const AB_VALUE *v1, const AB_VALUE *v2)
 {
+  mpq_t q1;
+  mpq_t q2;
+  int rv;
+
   assert(v1);
   assert(v2);
 
-  return mpq_cmp(v1->value, v2->value);
+  if (!((v1->flags | v2->flags) & AB_VALUE_FLAGS_GMP)) {
+    int64_t num1;
+    int64_t num2;
+
+    if (v1->denom==v2->denom)
+      return (v1->num<v2->num)?-1:((v1->num>v2->num)?1:0);
+    if (AB_Value__mulInt64(v1->num, v2->denom, &num1) && AB_Value__mulInt64(v2->num, v1->denom, &num2))
+      return (num1<num2)?-1:((num1>num2)?1:0);
+  }
+  else if ((v1->flags & AB_VALUE_FLAGS_GMP) && (v2->flags & AB_VALUE_FLAGS_GMP))
+    return mpq_cmp(v1->value, v2->value);
+
+  AB_Value__initMpq(v1, q1);
+  AB_Value__initMpq(v2, q2);
+  rv=mpq_cmp(q1, q2);
+  mpq_clear(q2);
+  mpq_clear(q1);
+  return rv;
 }
 
 int AB_Value_Equal(const AB_VALUE *v1, const AB_VALUE *v2)
 {
+  mpq_t q1;
+  mpq_t q2;
+  int rv;
+
   assert(v1);
   assert(v2);
 
-  return mpq_equal(v1->value, v2->value);
+  if (!((v1->flags | v2->flags) & AB_VALUE_FLAGS_GMP)) {
+    /* mpq_equal() compares numerator and denominator as they are */
+    return (v1->num==v2->num && v1->denom==v2->denom);
+  }
+  else if ((v1->flags & AB_VALUE_FLAGS_GMP) && (v2->flags & AB_VALUE_FLAGS_GMP))
+    return mpq_equal(v1->value, v2->value);
+
+  AB_Value__initMpq(v1, q1);
+  AB_Value__initMpq(v2, q2);
+  rv=mpq_equal(q1, q2);
+  mpq_clear(q2);
+  mpq_clear(q1);
+  return rv;
 }
 
 
@@ -460,7 +634,9 @@ int AB_Value_AddValue(AB_VALUE *v1, const AB_VALUE *v2)
   assert(v1);
   assert(v2);
 
-  mpq_add(v1->value, v1->value, v2->value);
+  if (!((v1->flags | v2->flags) & AB_VALUE_FLAGS_GMP) && AB_Value__addInline(v1, v2, 0))
+    return 0;
+  AB_Value__gmpOperation(v1, v2, mpq_add);
   return 0;
 }
 
@@ -470,7 +646,10 @@ int AB_Value_SubValue(AB_VALUE *v1, const AB_VALUE *v2)
 {
   assert(v1);
   assert(v2);
-  mpq_sub(v1->value, v1->value, v2->value);
+
+  if (!((v1->flags | v2->flags) & AB_VALUE_FLAGS_GMP) && AB_Value__addInline(v1, v2, 1))
+    return 0;
+  AB_Value__gmpOperation(v1, v2, mpq_sub);
   return 0;
 }
 
@@ -481,7 +660,9 @@ int AB_Value_MultValue(AB_VALUE *v1, const AB_VALUE *v2)
   assert(v1);
   assert(v2);
 
-  mpq_mul(v1->value, v1->value, v2->value);
+  if (!((v1->flags | v2->flags) & AB_VALUE_FLAGS_GMP) && AB_Value__multInline(v1, v2))
+    return 0;
+  AB_Value__gmpOperation(v1, v2, mpq_mul);
   return 0;
 }
 
@@ -492,7 +673,8 @@ int AB_Value_DivValue(AB_VALUE *v1, const AB_VALUE *v2)
   assert(v1);
   assert(v2);
 
-  mpq_div(v1->value, v1->value, v2->value);
+  /* the quotient is rarely a decimal number */
+  AB_Value__gmpOperation(v1, v2, mpq_div);
   return 0;
 }
 
@@ -501,7 +683,10 @@ int AB_Value_DivValue(AB_VALUE *v1, const AB_VALUE *v2)
 int AB_Value_Negate(AB_VALUE *v)
 {
   assert(v);
-  mpq_neg(v->value, v->value);
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    mpq_neg(v->value, v->value);
+  else
+    v->num=-(v->num);
   return 0;
 }
 
@@ -515,12 +700,16 @@ void AB_Value_Dump(const AB_VALUE *v, FILE *f, unsigned int indent)
     fprintf(f, " ");
   fprintf(f, "Value: ");
   if (v) {
+    GWEN_BUFFER *vbuf;
     GWEN_BUFFER *nbuf;
 
+    vbuf=GWEN_Buffer_new(0, 128, 0, 1);
+    AB_Value__toString(v, vbuf);
     nbuf=GWEN_Buffer_new(0, 128, 0, 1);
     AB_Value_toHumanReadableString(v, nbuf, 2, 1);
-    gmp_fprintf(f, "%Qi (%s)\n", v->value, GWEN_Buffer_GetStart(nbuf));
+    fprintf(f, "%s (%s)\n", GWEN_Buffer_GetStart(vbuf), GWEN_Buffer_GetStart(nbuf));
     GWEN_Buffer_free(nbuf);
+    GWEN_Buffer_free(vbuf);
   }
   else
     fprintf(f, "[none]\n");
@@ -555,7 +744,19 @@ AB_VALUE_LIST *AB_Value_List_dup(const AB_VALUE_LIST *stl)
 long int AB_Value_Num(const AB_VALUE *v)
 {
   assert(v);
-  return mpz_get_si(mpq_numref(v->value));
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    return mpz_get_si(mpq_numref(v->value));
+  else {
+    mpq_t q;
+    long int rv;
+
+    if (v->num>=LONG_MIN && v->num<=LONG_MAX)
+      return (long int) v->num;
+    AB_Value__initMpq(v, q);
+    rv=mpz_get_si(mpq_numref(q));
+    mpq_clear(q);
+    return rv;
+  }
 }
 
 
@@ -563,7 +764,19 @@ long int AB_Value_Num(const AB_VALUE *v)
 long int AB_Value_Denom(const AB_VALUE *v)
 {
   assert(v);
-  return mpz_get_si(mpq_denref(v->value));
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    return mpz_get_si(mpq_denref(v->value));
+  else {
+    mpq_t q;
+    long int rv;
+
+    if (v->denom<=LONG_MAX)
+      return (long int) v->denom;
+    AB_Value__initMpq(v, q);
+    rv=mpz_get_si(mpq_denref(q));
+    mpq_clear(q);
+    return rv;
+  }
 }
 
 
@@ -602,3 +815,191 @@ void AB_Value_toHbciString(const AB_VALUE *v, GWEN_BUFFER *buf)
   GWEN_Buffer_free(tbuf);
 }
 
+
+
+void AB_Value__initMpq(const AB_VALUE *v, mpq_t q)
+{
+  mpq_init(q);
+  if (v->flags & AB_VALUE_FLAGS_GMP)
+    mpq_set(q, v->value);
+  else {
+    AB_Value__mpzSetInt64(mpq_numref(q), v->num);
+    AB_Value__mpzSetInt64(mpq_denref(q), v->denom);
+  }
+}
+
+
+
+void AB_Value__promote(AB_VALUE *v)
+{
+  if (!(v->flags & AB_VALUE_FLAGS_GMP)) {
+    mpq_init(v->value);
+    AB_Value__mpzSetInt64(mpq_numref(v->value), v->num);
+    AB_Value__mpzSetInt64(mpq_denref(v->value), v->denom);
+    v->flags|=AB_VALUE_FLAGS_GMP;
+    v->num=0;
+    v->denom=1;
+  }
+}
+
+
+
+void AB_Value__gmpOperation(AB_VALUE *v1, const AB_VALUE *v2, void (*fn)(mpq_ptr, mpq_srcptr, mpq_srcptr))
+{
+  /* v1 and v2 might be the same object, so check v2 after promoting v1 */
+  AB_Value__promote(v1);
+  if (v2->flags & AB_VALUE_FLAGS_GMP)
+    fn(v1->value, v1->value, v2->value);
+  else {
+    mpq_t q;
+
+    AB_Value__initMpq(v2, q);
+    fn(v1->value, v1->value, q);
+    mpq_clear(q);
+  }
+}
+
+
+
+/* Same algorithm as mpq_add()/mpq_sub(). Returns 1 if the result has been stored in v1, 0 if it doesn't fit
+ * into the inline representation (in which case v1 is unchanged). */
+int AB_Value__addInline(AB_VALUE *v1, const AB_VALUE *v2, int subtract)
+{
+  int64_t num2;
+  int64_t gcd;
+  int64_t t1;
+  int64_t t2;
+  int64_t num;
+  int64_t denom;
+
+  num2=subtract?-(v2->num):v2->num;
+  gcd=AB_Value__gcd(v1->denom, v2->denom);
+  if (gcd!=1) {
+    int64_t gcd2;
+
+    if (!AB_Value__mulInt64(v1->num, v2->denom/gcd, &t1) ||
+        !AB_Value__mulInt64(num2, v1->denom/gcd, &t2))
+      return 0;
+    /* INT64_MIN is never used, so every inline value can be negated */
+    if ((t2>0 && t1>INT64_MAX-t2) || (t2<0 && t1<-INT64_MAX-t2))
+      return 0;
+    num=t1+t2;
+    gcd2=AB_Value__gcd(num, gcd);
+    if (!AB_Value__mulInt64(v1->denom/gcd, v2->denom/gcd2, &denom))
+      return 0;
+    num/=gcd2;
+  }
+  else {
+    if (!AB_Value__mulInt64(v1->num, v2->denom, &t1) ||
+        !AB_Value__mulInt64(num2, v1->denom, &t2) ||
+        !AB_Value__mulInt64(v1->denom, v2->denom, &denom))
+      return 0;
+    if ((t2>0 && t1>INT64_MAX-t2) || (t2<0 && t1<-INT64_MAX-t2))
+      return 0;
+    num=t1+t2;
+  }
+
+  v1->num=num;
+  v1->denom=denom;
+  return 1;
+}
+
+
+
+/* Same algorithm as mpq_mul(). Returns 1 if the result has been stored in v1, 0 if it doesn't fit into the
+ * inline representation (in which case v1 is unchanged). */
+int AB_Value__multInline(AB_VALUE *v1, const AB_VALUE *v2)
+{
+  int64_t num;
+  int64_t denom;
+
+  if (v1==v2) {
+    /* no GCDs when squaring */
+    if (!AB_Value__mulInt64(v1->num, v1->num, &num) ||
+        !AB_Value__mulInt64(v1->denom, v1->denom, &denom))
+      return 0;
+  }
+  else if (v1->num==0 || v2->num==0) {
+    num=0;
+    denom=1;
+  }
+  else {
+    int64_t gcd1;
+    int64_t gcd2;
+
+    gcd1=AB_Value__gcd(v1->num, v2->denom);
+    gcd2=AB_Value__gcd(v2->num, v1->denom);
+    if (!AB_Value__mulInt64(v1->num/gcd1, v2->num/gcd2, &num) ||
+        !AB_Value__mulInt64(v1->denom/gcd2, v2->denom/gcd1, &denom))
+      return 0;
+  }
+
+  v1->num=num;
+  v1->denom=denom;
+  return 1;
+}
+
+
+
+/* Returns 1 if the product fits into an int64_t (excluding INT64_MIN), 0 otherwise. */
+int AB_Value__mulInt64(int64_t a, int64_t b, int64_t *pResult)
+{
+  uint64_t absA;
+  uint64_t absB;
+
+  absA=(uint64_t)((a<0)?-a:a);
+  absB=(uint64_t)((b<0)?-b:b);
+  /* no division needed for the usual small values */
+  if ((absA | absB)>UINT64_C(0x7fffffff) && absA!=0 && absB>((uint64_t) INT64_MAX)/absA)
+    return 0;
+  *pResult=a*b;
+  return 1;
+}
+
+
+
+double AB_Value__mpqGetDouble(mpq_srcptr q)
+{
+  if (mpz_fits_slong_p(mpq_numref(q)) && mpz_fits_slong_p(mpq_denref(q))) {
+    return (double)(mpz_get_d(mpq_numref(q)) / mpz_get_d(mpq_denref(q)));
+  }
+  else {
+    return mpq_get_d(q);
+  }
+}
+
+
+
+void AB_Value__mpzSetInt64(mpz_ptr z, int64_t i)
+{
+  if (i>=LONG_MIN && i<=LONG_MAX)
+    mpz_set_si(z, (long int) i);
+  else {
+    uint64_t u;
+
+    /* long int has only 32 bits on some systems */
+    u=(i<0)?-((uint64_t) i):((uint64_t) i);
+    mpz_import(z, 1, 1, sizeof(u), 0, 0, &u);
+    if (i<0)
+      mpz_neg(z, z);
+  }
+}
+
+
+
+/* Greatest common divisor of the absolute values (like mpz_gcd(), gcd(0, b) is |b|). */
+int64_t AB_Value__gcd(int64_t a, int64_t b)
+{
+  if (a<0)
+    a=-a;
+  if (b<0)
+    b=-b;
+  while (b) {
+    int64_t t;
+
+    t=a%b;
+    a=b;
+    b=t;
+  }
+  return a;
+}
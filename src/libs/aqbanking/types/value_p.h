@@ -15,18 +15,55 @@
 #include "value.h"
 
 #include <gmp.h>
+#include <limits.h>
+#include <stdint.h>
 
 
-/** Internal structure of AB_VALUE -- do not access this directly! */
+/* maximum number of digits handled by AB_Value__fromSimpleString(), numerator and denominator must fit into
+ * the inline representation (see below) */
+#define AB_VALUE_SIMPLE_MAXDIGITS 18
+
+/* currency codes shorter than this are stored inside the object itself */
+#define AB_VALUE_CURRENCY_INLINE_SIZE 8
+
+
+/* the value is stored in member "value" (otherwise as "num"/"denom") */
+#define AB_VALUE_FLAGS_GMP 0x0001
+
+
+/** Internal structure of AB_VALUE -- do not access this directly!
+ *
+ * Most values are small amounts like "1234/100" which are kept as a pair of int64_t without using GMP at
+ * all. Arithmetic on those uses the same algorithms as GMP, so numerator and denominator are exactly those
+ * GMP would produce. Values which don't fit (e.g. after an overflow) are transparently promoted to a GMP
+ * rational. The numerator is never INT64_MIN, the denominator always positive.
+ */
 struct AB_VALUE {
   GWEN_LIST_ELEMENT(AB_VALUE)
 
+  uint32_t flags;
+  int64_t num;
+  int64_t denom;
   mpq_t value;
+
   char *currency;
+  char currencyBuffer[AB_VALUE_CURRENCY_INLINE_SIZE];
 };
 
 
 static void AB_Value__toString(const AB_VALUE *v, GWEN_BUFFER *buf);
+static AB_VALUE *AB_Value__fromSimpleString(const char *s);
+static AB_VALUE *AB_Value__fromStringGmp(const char *s);
+
+static void AB_Value__initMpq(const AB_VALUE *v, mpq_t q);
+static void AB_Value__promote(AB_VALUE *v);
+static void AB_Value__gmpOperation(AB_VALUE *v1, const AB_VALUE *v2, void (*fn)(mpq_ptr, mpq_srcptr, mpq_srcptr));
+static int AB_Value__addInline(AB_VALUE *v1, const AB_VALUE *v2, int subtract);
+static int AB_Value__multInline(AB_VALUE *v1, const AB_VALUE *v2);
+static int AB_Value__mulInt64(int64_t a, int64_t b, int64_t *pResult);
+static double AB_Value__mpqGetDouble(mpq_srcptr q);
+static void AB_Value__mpzSetInt64(mpz_ptr z, int64_t i);
+static int64_t AB_Value__gcd(int64_t a, int64_t b);
 
 
 #endif /* AB_VALUE_P_H */
@@ -13,6 +13,8 @@
 #include <gwenhywfar/padd.h>
 #include <gwenhywfar/cryptkeysym.h>
 
+#include <ctype.h>
+
 
 
 int EBC_Provider_ExtractSessionKey(AB_PROVIDER *pro,
@@ -398,4 +400,218 @@ int EBC_Provider_DecryptData(GWEN_UNUSED AB_PROVIDER *pro,
 
 
 
+EBC_DECIPHER_STREAM *EBC_DecipherStream_new(AB_USER *u, GWEN_CRYPT_KEY *skey, GWEN_BUFFER *targetBuffer)
+{
+  EBC_DECIPHER_STREAM *ds;
+  const char *s;
+
+  assert(skey);
+  assert(targetBuffer);
+
+  GWEN_NEW_OBJECT(EBC_DECIPHER_STREAM, ds);
+  ds->sessionKey=skey;
+  ds->targetBuffer=targetBuffer;
+
+  s=EBC_User_GetCryptVersion(u);
+  if (!(s && *s))
+    s="E001";
+  if (strcasecmp(s, "E001")==0) {
+    ds->cryptVersion=1;
+    ds->blockSize=8;
+    /* reset IV, CBC state is kept by the key across calls to GWEN_Crypt_Key_Decipher() */
+    GWEN_Crypt_KeyDes3K_SetIV(skey, NULL, 0);
+  }
+  else if (strcasecmp(s, "E002")==0) {
+    ds->cryptVersion=2;
+    ds->blockSize=16;
+    GWEN_Crypt_KeyAes128_SetIV(skey, NULL, 0);
+  }
+  else {
+    /* like EBC_Provider_DecryptData(): unknown crypt versions produce no data */
+    DBG_INFO(AQEBICS_LOGDOMAIN, "Unknown crypt version \"%s\", ignoring data", s);
+  }
+
+  ds->base64Buffer=GWEN_Buffer_new(0, 1024, 0, 1);
+  ds->cipherBuffer=GWEN_Buffer_new(0, 1024, 0, 1);
+  ds->plainBuffer=GWEN_Buffer_new(0, 1024, 0, 1);
+
+  return ds;
+}
+
+
+
+void EBC_DecipherStream_free(EBC_DECIPHER_STREAM *ds)
+{
+  if (ds) {
+    EB_Zip_Inflater_free(ds->inflater);
+    GWEN_Buffer_free(ds->plainBuffer);
+    GWEN_Buffer_free(ds->cipherBuffer);
+    GWEN_Buffer_free(ds->base64Buffer);
+    GWEN_FREE_OBJECT(ds);
+  }
+}
+
+
+
+int EBC_DecipherStream_AddData(EBC_DECIPHER_STREAM *ds, const char *sEncryptedData)
+{
+  const char *s;
+  uint32_t len;
+  uint32_t l;
+  int rv;
+
+  assert(ds);
+  if (ds->blockSize==0)
+    return 0;
+
+  /* only decode complete groups of 4 BASE64 characters, keep the rest for the next segment */
+  GWEN_Buffer_Reset(ds->base64Buffer);
+  s=sEncryptedData;
+  while (*s) {
+    char c;
+
+    c=*(s++);
+    if (isalnum((unsigned char) c) || c=='+' || c=='/' || c=='=') {
+      ds->base64Carry[ds->base64CarryLen++]=c;
+      if (ds->base64CarryLen==4) {
+        GWEN_Buffer_AppendBytes(ds->base64Buffer, ds->base64Carry, 4);
+        ds->base64CarryLen=0;
+      }
+    }
+  }
+  if (GWEN_Buffer_GetUsedBytes(ds->base64Buffer)==0)
+    return 0;
+
+  GWEN_Buffer_Reset(ds->cipherBuffer);
+  if (ds->cipherCarryLen)
+    GWEN_Buffer_AppendBytes(ds->cipherBuffer, (const char *) ds->cipherCarry, ds->cipherCarryLen);
+  rv=GWEN_Base64_Decode((const uint8_t *)GWEN_Buffer_GetStart(ds->base64Buffer), 0, ds->cipherBuffer);
+  if (rv<0) {
+    DBG_INFO(AQEBICS_LOGDOMAIN, "Could not decode OrderData (%d)", rv);
+    return rv;
+  }
+
+  /* decipher all complete blocks but the last one which might contain the padding */
+  len=GWEN_Buffer_GetUsedBytes(ds->cipherBuffer);
+  l=len?(((len-1)/ds->blockSize)*ds->blockSize):0;
+  if (l) {
+    rv=EBC_DecipherStream__Decipher(ds, (const uint8_t *)GWEN_Buffer_GetStart(ds->cipherBuffer), l);
+    if (rv<0) {
+      DBG_INFO(AQEBICS_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    rv=EBC_DecipherStream__Inflate(ds);
+    if (rv<0) {
+      DBG_INFO(AQEBICS_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+  }
+  ds->cipherCarryLen=len-l;
+  memmove(ds->cipherCarry, GWEN_Buffer_GetStart(ds->cipherBuffer)+l, ds->cipherCarryLen);
+
+  return 0;
+}
+
+
+
+int EBC_DecipherStream_Finish(EBC_DECIPHER_STREAM *ds)
+{
+  int rv;
+
+  assert(ds);
+  if (ds->blockSize==0)
+    return 0;
+
+  if (ds->base64CarryLen) {
+    DBG_ERROR(AQEBICS_LOGDOMAIN, "Incomplete BASE64 data in OrderData");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  if (ds->cipherCarryLen!=ds->blockSize) {
+    DBG_ERROR(AQEBICS_LOGDOMAIN, "Encrypted data is not a multiple of the block size");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  rv=EBC_DecipherStream__Decipher(ds, ds->cipherCarry, ds->cipherCarryLen);
+  if (rv<0) {
+    DBG_INFO(AQEBICS_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+  ds->cipherCarryLen=0;
+
+  /* unpadd message */
+  if (ds->cryptVersion==1)
+    rv=GWEN_Padd_UnpaddWithAnsiX9_23(ds->plainBuffer);
+  else
+    rv=GWEN_Padd_UnpaddWithAnsiX9_23FromMultipleOf(ds->plainBuffer, 16);
+  if (rv<0) {
+    DBG_INFO(AQEBICS_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  rv=EBC_DecipherStream__Inflate(ds);
+  if (rv<0) {
+    DBG_INFO(AQEBICS_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  rv=EB_Zip_Inflater_Finish(ds->inflater);
+  if (rv) {
+    DBG_ERROR(AQEBICS_LOGDOMAIN, "Could not unzip doc (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+int EBC_DecipherStream__Decipher(EBC_DECIPHER_STREAM *ds, const uint8_t *p, uint32_t len)
+{
+  uint32_t l;
+  int rv;
+
+  GWEN_Buffer_Reset(ds->plainBuffer);
+  GWEN_Buffer_AllocRoom(ds->plainBuffer, len+16);
+  l=GWEN_Buffer_GetMaxUnsegmentedWrite(ds->plainBuffer);
+  rv=GWEN_Crypt_Key_Decipher(ds->sessionKey,
+                             p, len,
+                             (uint8_t *)GWEN_Buffer_GetPosPointer(ds->plainBuffer),
+                             &l);
+  if (rv<0) {
+    DBG_INFO(AQEBICS_LOGDOMAIN,
+             "Error deciphering %d bytes of data here (%d)",
+             (int)len, rv);
+    return rv;
+  }
+  GWEN_Buffer_IncrementPos(ds->plainBuffer, l);
+  GWEN_Buffer_AdjustUsedBytes(ds->plainBuffer);
+
+  return 0;
+}
+
+
+
+int EBC_DecipherStream__Inflate(EBC_DECIPHER_STREAM *ds)
+{
+  int rv;
+
+  if (ds->inflater==NULL) {
+    ds->inflater=EB_Zip_Inflater_new();
+    if (ds->inflater==NULL)
+      return GWEN_ERROR_GENERIC;
+  }
+
+  rv=EB_Zip_Inflater_AddData(ds->inflater,
+                             GWEN_Buffer_GetStart(ds->plainBuffer),
+                             GWEN_Buffer_GetUsedBytes(ds->plainBuffer),
+                             ds->targetBuffer);
+  if (rv) {
+    DBG_ERROR(AQEBICS_LOGDOMAIN, "Could not unzip doc (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
 
@@ -1073,44 +1073,6 @@ int EBC_Provider_GetCert(AB_PROVIDER *pro, AB_USER *u)
 
 
 
-int EBC_Provider_DecodeAndDecryptData(AB_PROVIDER *pro,
-                                      AB_USER *u,
-                                      GWEN_CRYPT_KEY *skey,
-                                      const char *sEncryptedData,
-                                      GWEN_BUFFER *targetBuffer)
-{
-  GWEN_BUFFER *buf1;
-  int rv;
-
-  /* BASE64-decode receiced data */
-  buf1=GWEN_Buffer_new(0, strlen(sEncryptedData), 0, 1);
-  rv=GWEN_Base64_Decode((const uint8_t *)sEncryptedData, 0, buf1);
-  if (rv<0) {
-    DBG_INFO(AQEBICS_LOGDOMAIN, "Could not decode OrderData (%d)", rv);
-    GWEN_Buffer_free(buf1);
-    return rv;
-  }
-
-  /* decrypt/unzip data */
-  rv=EBC_Provider_DecryptData(pro, u, skey,
-                              (const uint8_t *)GWEN_Buffer_GetStart(buf1),
-                              GWEN_Buffer_GetUsedBytes(buf1),
-                              targetBuffer);
-  if (rv<0) {
-    DBG_INFO(AQEBICS_LOGDOMAIN, "Could not decrypt OrderData (%d)", rv);
-    GWEN_Buffer_free(buf1);
-    return rv;
-  }
-  GWEN_Buffer_free(buf1);
-
-  /*DBG_ERROR(0, "Got this data:");
-   GWEN_Buffer_Dump(targetBuffer, stderr, 2);*/
-
-  return 0;
-}
-
-
-
 #include "provider_sendcmd.c"
 #include "provider_accspec.c"
 
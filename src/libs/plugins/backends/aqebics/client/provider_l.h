@@ -27,6 +27,9 @@
 #define EBC_DEFAULT_TRANSFER_TIMEOUT 60
 
 
+typedef struct EBC_DECIPHER_STREAM EBC_DECIPHER_STREAM;
+
+
 
 int EBC_Provider_CreateKeys(AB_PROVIDER *pro,
                             AB_USER *u,
@@ -55,12 +58,6 @@ int EBC_Provider_GetCert(AB_PROVIDER *pro, AB_USER *u);
 
 int EBC_Provider_AddBankPubKeyDigests(AB_PROVIDER *pro, AB_USER *u, xmlNodePtr node);
 
-int EBC_Provider_DecodeAndDecryptData(AB_PROVIDER *pro,
-                                      AB_USER *u,
-                                      GWEN_CRYPT_KEY *skey,
-                                      const char *sEncryptedData,
-                                      GWEN_BUFFER *targetBuffer);
-
 
 
 int EBC_Provider_Send_HIA(AB_PROVIDER *pro, AB_USER *u, int doLock);
@@ -143,6 +140,16 @@ int EBC_Provider_DecryptData(AB_PROVIDER *pro,
                              uint32_t len,
                              GWEN_BUFFER *msgBuffer);
 
+/**
+ * Decode, decrypt and unzip BASE64-encoded order data which arrives in segments.
+ * Every segment is processed as soon as it is added, the result is appended to the
+ * given target buffer. The session key is not taken over.
+ */
+EBC_DECIPHER_STREAM *EBC_DecipherStream_new(AB_USER *u, GWEN_CRYPT_KEY *skey, GWEN_BUFFER *targetBuffer);
+void EBC_DecipherStream_free(EBC_DECIPHER_STREAM *ds);
+int EBC_DecipherStream_AddData(EBC_DECIPHER_STREAM *ds, const char *sEncryptedData);
+int EBC_DecipherStream_Finish(EBC_DECIPHER_STREAM *ds);
+
 
 int EBC_Provider_EncryptData(AB_PROVIDER *pro,
                              AB_USER *u,
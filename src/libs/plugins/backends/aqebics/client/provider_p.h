@@ -12,6 +12,8 @@
 
 #include "provider_l.h"
 
+#include "aqebics/msg/zip.h"
+
 #include <aqbanking/backendsupport/provider_be.h>
 
 
@@ -26,6 +28,24 @@ struct EBC_PROVIDER {
   int transferTimeout;
 };
 
+
+struct EBC_DECIPHER_STREAM {
+  GWEN_CRYPT_KEY *sessionKey;
+  int cryptVersion;
+  int blockSize;
+
+  char base64Carry[4];
+  int base64CarryLen;
+  uint8_t cipherCarry[16];
+  int cipherCarryLen;
+
+  GWEN_BUFFER *base64Buffer;
+  GWEN_BUFFER *cipherBuffer;
+  GWEN_BUFFER *plainBuffer;
+  EB_ZIP_INFLATER *inflater;
+  GWEN_BUFFER *targetBuffer;
+};
+
 static void GWENHYWFAR_CB EBC_Provider_FreeData(void *bp, void *p);
 
 static int EBC_Provider_Init(AB_PROVIDER *pro, GWEN_DB_NODE *dbData);
@@ -41,6 +61,11 @@ int EBC_Provider__signMessage(AB_PROVIDER *pro, EB_MSG *msg, AB_USER *u);
 int EBC_Provider__generateNonce(GWEN_BUFFER *buf);
 
 
+/* p_decipher.c */
+static int EBC_DecipherStream__Decipher(EBC_DECIPHER_STREAM *ds, const uint8_t *p, uint32_t len);
+static int EBC_DecipherStream__Inflate(EBC_DECIPHER_STREAM *ds);
+
+
 /* p_tools.inc */
 static int EBC_Provider__addKiTxt(AB_PROVIDER *pro,
                                   const GWEN_CRYPT_TOKEN_KEYINFO *ki,
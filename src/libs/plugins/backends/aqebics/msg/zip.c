@@ -11,11 +11,10 @@
 # include <config.h>
 #endif
 
-#include "zip.h"
+#include "zip_p.h"
 
 #include <gwenhywfar/debug.h>
-
-#include <zlib.h>
+#include <gwenhywfar/misc.h>
 
 
 
@@ -72,50 +71,98 @@ int EB_Zip_Deflate(const char *ptr, unsigned int size, GWEN_BUFFER *buf)
 
 int EB_Zip_Inflate(const char *ptr, unsigned int size, GWEN_BUFFER *buf)
 {
-  z_stream z;
-  char outbuf[512];
+  EB_ZIP_INFLATER *zi;
   int rv;
-  int mode;
 
-  z.next_in=(unsigned char *)ptr;
-  z.avail_in=size;
-  z.next_out=(unsigned char *)outbuf;
-  z.avail_out=sizeof(outbuf);
-  z.zalloc=Z_NULL;
-  z.zfree=Z_NULL;
+  zi=EB_Zip_Inflater_new();
+  if (zi==NULL)
+    return -1;
+
+  rv=EB_Zip_Inflater_AddData(zi, ptr, size, buf);
+  if (rv==0)
+    rv=EB_Zip_Inflater_Finish(zi);
+  EB_Zip_Inflater_free(zi);
+
+  return rv;
+}
+
 
-  rv=inflateInit(&z);
+
+EB_ZIP_INFLATER *EB_Zip_Inflater_new(void)
+{
+  EB_ZIP_INFLATER *zi;
+  int rv;
+
+  GWEN_NEW_OBJECT(EB_ZIP_INFLATER, zi);
+  zi->z.zalloc=Z_NULL;
+  zi->z.zfree=Z_NULL;
+  zi->z.next_in=Z_NULL;
+  zi->z.avail_in=0;
+
+  rv=inflateInit(&(zi->z));
   if (rv!=Z_OK) {
-    DBG_ERROR(AQEBICS_LOGDOMAIN, "Error on deflateInit (%d)", rv);
-    return -1;
+    DBG_ERROR(AQEBICS_LOGDOMAIN, "Error on inflateInit (%d)", rv);
+    GWEN_FREE_OBJECT(zi);
+    return NULL;
   }
 
-  mode=Z_NO_FLUSH;
-  for (;;) {
-    rv=inflate(&z, mode);
-    if (rv==Z_STREAM_END)
-      break;
-    if (rv!=Z_OK) {
+  return zi;
+}
+
+
+
+void EB_Zip_Inflater_free(EB_ZIP_INFLATER *zi)
+{
+  if (zi) {
+    inflateEnd(&(zi->z));
+    GWEN_FREE_OBJECT(zi);
+  }
+}
+
+
+
+int EB_Zip_Inflater_AddData(EB_ZIP_INFLATER *zi, const char *ptr, unsigned int size, GWEN_BUFFER *buf)
+{
+  char outbuf[EB_ZIP_INFLATER_BUFSIZE];
+  int rv;
+
+  assert(zi);
+  if (zi->finished || size==0)
+    return 0;
+
+  zi->z.next_in=(unsigned char *)ptr;
+  zi->z.avail_in=size;
+  do {
+    zi->z.next_out=(unsigned char *)outbuf;
+    zi->z.avail_out=sizeof(outbuf);
+    rv=inflate(&(zi->z), Z_NO_FLUSH);
+    if (rv!=Z_OK && rv!=Z_STREAM_END && rv!=Z_BUF_ERROR) {
       DBG_ERROR(AQEBICS_LOGDOMAIN, "Error on inflate (%d)", rv);
-      deflateEnd(&z);
       return -1;
     }
-    if (z.avail_in==0)
-      mode=Z_FINISH;
-    if (z.avail_out==0) {
-      GWEN_Buffer_AppendBytes(buf, outbuf, sizeof(outbuf));
-      z.next_out=(unsigned char *)outbuf;
-      z.avail_out=sizeof(outbuf);
+    if (zi->z.avail_out!=sizeof(outbuf))
+      GWEN_Buffer_AppendBytes(buf, outbuf, (uint32_t)(sizeof(outbuf)-zi->z.avail_out));
+    if (rv==Z_STREAM_END) {
+      zi->finished=1;
+      break;
     }
-  }
-  if (z.avail_out!=sizeof(outbuf)) {
-    GWEN_Buffer_AppendBytes(buf, outbuf, (uint32_t)(sizeof(outbuf)-z.avail_out));
-    z.next_out=(unsigned char *)outbuf;
-    z.avail_out=sizeof(outbuf);
-  }
+    /* Z_BUF_ERROR: all input consumed, wait for the next chunk */
+  } while (zi->z.avail_out==0 || (zi->z.avail_in>0 && rv!=Z_BUF_ERROR));
+
+  zi->z.next_in=Z_NULL;
+  zi->z.avail_in=0;
+  return 0;
+}
+
 
-  inflateEnd(&z);
 
+int EB_Zip_Inflater_Finish(EB_ZIP_INFLATER *zi)
+{
+  assert(zi);
+  if (!zi->finished) {
+    DBG_ERROR(AQEBICS_LOGDOMAIN, "Compressed data incomplete");
+    return -1;
+  }
   return 0;
 }
 
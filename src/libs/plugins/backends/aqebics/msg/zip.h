@@ -18,10 +18,27 @@
 #include <gwenhywfar/buffer.h>
 
 
+typedef struct EB_ZIP_INFLATER EB_ZIP_INFLATER;
+
+
 int EB_Zip_Deflate(const char *ptr, unsigned int size, GWEN_BUFFER *buf);
 int EB_Zip_Inflate(const char *ptr, unsigned int size, GWEN_BUFFER *buf);
 
 
+/**
+ * Inflate data which arrives in chunks. Every chunk is inflated as soon as it is added,
+ * data following the end of the compressed stream is ignored.
+ */
+EB_ZIP_INFLATER *EB_Zip_Inflater_new(void);
+void EB_Zip_Inflater_free(EB_ZIP_INFLATER *zi);
+int EB_Zip_Inflater_AddData(EB_ZIP_INFLATER *zi, const char *ptr, unsigned int size, GWEN_BUFFER *buf);
+
+/**
+ * Check whether the end of the compressed stream has been reached.
+ */
+int EB_Zip_Inflater_Finish(EB_ZIP_INFLATER *zi);
+
+
 
 #endif
 
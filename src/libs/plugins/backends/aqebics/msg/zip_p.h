@@ -0,0 +1,27 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifndef AQEBICS_MSG_ZIP_P_H
+#define AQEBICS_MSG_ZIP_P_H
+
+#include "zip.h"
+
+#include <zlib.h>
+
+
+#define EB_ZIP_INFLATER_BUFSIZE 4096
+
+
+struct EB_ZIP_INFLATER {
+  z_stream z;
+  int finished;
+};
+
+
+#endif
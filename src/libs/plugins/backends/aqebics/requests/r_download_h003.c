@@ -65,7 +65,7 @@ static int _downloadRemainingSegments(AB_PROVIDER *pro,
                                       AB_USER *u,
                                       const char *transactionId,
                                       int segmentCount,
-                                      GWEN_BUFFER *dbuffer);
+                                      EBC_DECIPHER_STREAM *ds);
 
 
 static int _sendReceipt(AB_PROVIDER *pro, GWEN_HTTP_SESSION *sess, AB_USER *u, const char *transactionId,
@@ -93,7 +93,7 @@ int EBC_Provider_XchgDownloadRequest_H003(AB_PROVIDER *pro,
   int rv;
   EB_MSG *mRsp=NULL;
   GWEN_CRYPT_KEY *skey=NULL;
-  GWEN_BUFFER *dbuffer;
+  EBC_DECIPHER_STREAM *ds;
   int segmentCount;
   const char *s;
   char transactionId[36];
@@ -132,38 +132,43 @@ int EBC_Provider_XchgDownloadRequest_H003(AB_PROVIDER *pro,
     return rv;
   }
 
-  /* create data buffer */
-  dbuffer=GWEN_Buffer_new(0, 1024, 0, 1);
+  /* segments are decoded, decrypted and unzipped as soon as they are received */
+  ds=EBC_DecipherStream_new(u, skey, targetBuffer);
 
   /* read first chunk of data */
   s=EB_Msg_GetCharValue(mRsp, "body/DataTransfer/OrderData", NULL);
   if (!s) {
     DBG_ERROR(AQEBICS_LOGDOMAIN, "Bad message from server: Missing OrderData");
-    GWEN_Buffer_free(dbuffer);
+    EBC_DecipherStream_free(ds);
     GWEN_Crypt_Key_free(skey);
     EB_Msg_free(mRsp);
     return GWEN_ERROR_BAD_DATA;
   }
-  GWEN_Buffer_AppendString(dbuffer, s);
-
+  rv=EBC_DecipherStream_AddData(ds, s);
   EB_Msg_free(mRsp);
+  if (rv<0) {
+    DBG_INFO(AQEBICS_LOGDOMAIN, "here (%d)", rv);
+    EBC_DecipherStream_free(ds);
+    GWEN_Crypt_Key_free(skey);
+    return rv;
+  }
 
   /* read remaining segments if any */
   if (segmentCount>1) {
-    rv=_downloadRemainingSegments(pro, sess, u, transactionId, segmentCount, dbuffer);
+    rv=_downloadRemainingSegments(pro, sess, u, transactionId, segmentCount, ds);
     if (rv<0 || rv>=300) {
       DBG_INFO(AQEBICS_LOGDOMAIN, "here (%d)", rv);
-      GWEN_Buffer_free(dbuffer);
+      EBC_DecipherStream_free(ds);
       GWEN_Crypt_Key_free(skey);
       return rv;
     }
   }
 
-  /* decode and decrypt received data */
-  rv=EBC_Provider_DecodeAndDecryptData(pro, u, skey, GWEN_Buffer_GetStart(dbuffer), targetBuffer);
-  if (rv<0 || rv>=300) {
+  /* process the last block of received data */
+  rv=EBC_DecipherStream_Finish(ds);
+  if (rv<0) {
     DBG_INFO(AQEBICS_LOGDOMAIN, "here (%d)", rv);
-    GWEN_Buffer_free(dbuffer);
+    EBC_DecipherStream_free(ds);
     GWEN_Crypt_Key_free(skey);
     return rv;
   }
@@ -174,7 +179,7 @@ int EBC_Provider_XchgDownloadRequest_H003(AB_PROVIDER *pro,
   fprintf(stderr, "%s\n", GWEN_Buffer_GetStart(targetBuffer));
 #endif
 
-  GWEN_Buffer_free(dbuffer);
+  EBC_DecipherStream_free(ds);
   GWEN_Crypt_Key_free(skey);
 
   /* send receipt */
@@ -267,7 +272,7 @@ int _downloadRemainingSegments(AB_PROVIDER *pro,
                                AB_USER *u,
                                const char *transactionId,
                                int segmentCount,
-                               GWEN_BUFFER *dbuffer)
+                               EBC_DECIPHER_STREAM *ds)
 {
   int segmentNumber;
 
@@ -323,8 +328,12 @@ int _downloadRemainingSegments(AB_PROVIDER *pro,
       EB_Msg_free(mRsp);
       return GWEN_ERROR_BAD_DATA;
     }
-    GWEN_Buffer_AppendString(dbuffer, s);
+    rv=EBC_DecipherStream_AddData(ds, s);
     EB_Msg_free(mRsp);
+    if (rv<0) {
+      DBG_INFO(AQEBICS_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
 
     segmentNumber++;
     if (segmentNumber>=segmentCount) {
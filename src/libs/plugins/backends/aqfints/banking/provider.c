@@ -186,6 +186,7 @@ AQFINTS_PARSER *AF_Provider_CreateParser(AB_PROVIDER *pro)
   if (paths) {
     AQFINTS_PARSER *parser;
     GWEN_STRINGLISTENTRY *se;
+    GWEN_BUFFER *buf;
     int rv;
 
     parser=AQFINTS_Parser_new();
@@ -202,6 +203,18 @@ AQFINTS_PARSER *AF_Provider_CreateParser(AB_PROVIDER *pro)
     }
     GWEN_StringList_free(paths);
 
+    /* keep resolved definitions in a cache file to speed up subsequent starts */
+    buf=GWEN_Buffer_new(0, 256, 0, 1);
+    rv=AB_Provider_GetUserDataDir(pro, buf);
+    if (rv<0) {
+      DBG_INFO(AQFINTS_LOGDOMAIN, "No user data dir, not caching definitions (%d)", rv);
+    }
+    else {
+      GWEN_Buffer_AppendString(buf, GWEN_DIR_SEPARATOR_S "fintsdefs.cache");
+      AQFINTS_Parser_SetCacheFile(parser, GWEN_Buffer_GetStart(buf));
+    }
+    GWEN_Buffer_free(buf);
+
     rv=AQFINTS_Parser_ReadFiles(parser);
     if (rv<0) {
       DBG_INFO(AQFINTS_LOGDOMAIN, "here (%d)", rv);
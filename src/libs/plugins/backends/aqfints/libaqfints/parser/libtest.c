@@ -94,6 +94,55 @@ int test_readHbci(void)
 
 
 
+int test_readHbciEscapes(void)
+{
+  const char *testData=
+    "HNHBK:1:3+000000000123+300+DIALOGID?+?:?'?@??+1'"
+    "HIKAZ:2:7:3+@5@ab+:'+Verwendungszweck mit einer etwas laengeren Zeile?+ein Plus+X'";
+  int rv;
+  AQFINTS_SEGMENT_LIST *segmentList;
+  AQFINTS_SEGMENT *segment;
+  AQFINTS_ELEMENT *deg;
+  const char *s;
+
+  segmentList=AQFINTS_Segment_List_new();
+
+  rv=AQFINTS_Parser_Hbci_ReadBuffer(segmentList, (const uint8_t *) testData, strlen(testData));
+  if (rv<0) {
+    fprintf(stderr, "Error reading HBCI data.\n");
+    AQFINTS_Segment_List_free(segmentList);
+    return 2;
+  }
+
+  /* escaped delimiters in the 4th DEG of the first segment */
+  segment=AQFINTS_Segment_List_First(segmentList);
+  deg=AQFINTS_Element_Tree2_GetFirstChild(AQFINTS_Segment_GetElements(segment));
+  deg=AQFINTS_Element_Tree2_GetNext(AQFINTS_Element_Tree2_GetNext(AQFINTS_Element_Tree2_GetNext(deg)));
+  s=AQFINTS_Element_GetDataAsChar(AQFINTS_Element_Tree2_GetFirstChild(deg), NULL);
+  if (!(s && strcmp(s, "DIALOGID+:'@?")==0)) {
+    fprintf(stderr, "Bad unescaped data: %s\n", s?s:"<empty>");
+    AQFINTS_Segment_List_free(segmentList);
+    return 2;
+  }
+
+  /* long element with escapes after binary data in the second segment */
+  segment=AQFINTS_Segment_List_Next(segment);
+  deg=AQFINTS_Element_Tree2_GetFirstChild(AQFINTS_Segment_GetElements(segment));
+  deg=AQFINTS_Element_Tree2_GetNext(AQFINTS_Element_Tree2_GetNext(deg));
+  s=AQFINTS_Element_GetDataAsChar(AQFINTS_Element_Tree2_GetFirstChild(deg), NULL);
+  if (!(s && strcmp(s, "Verwendungszweck mit einer etwas laengeren Zeile+ein Plus")==0)) {
+    fprintf(stderr, "Bad unescaped data: %s\n", s?s:"<empty>");
+    AQFINTS_Segment_List_free(segmentList);
+    return 2;
+  }
+
+  AQFINTS_Segment_List_free(segmentList);
+  fprintf(stderr, "Success.\n");
+  return 0;
+}
+
+
+
 int test_readHbci2(const char *fileName)
 {
   int rv;
@@ -1026,6 +1075,7 @@ int main(int args, char **argv)
 {
   //test_loadFile("example.xml");
   //test_readHbci();
+  //test_readHbciEscapes();
   //test_readHbci2("/tmp/test.hbci");
   //test_saveFile1("example.xml", "example.xml.out");
   //test_saveFile2("example.xml.out");
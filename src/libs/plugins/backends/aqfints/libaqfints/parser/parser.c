@@ -21,12 +21,39 @@
 #include "parser_dbread.h"
 #include "parser_dbwrite.h"
 #include "parser_dump.h"
+#include "parser_cache.h"
 
 
 #include <gwenhywfar/debug.h>
 #include <gwenhywfar/stringlist.h>
 #include <gwenhywfar/directory.h>
+#include <gwenhywfar/buffer.h>
 
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void _buildIndexes(AQFINTS_PARSER *parser);
+static void _freeIndexes(AQFINTS_PARSER *parser);
+static int _segmentMatchesVersions(const AQFINTS_SEGMENT *segment, int segmentVersion, int protocolVersion);
+static int _jobDefMatchesVersions(const AQFINTS_JOBDEF *jobDef, int jobVersion, int protocolVersion);
+static AQFINTS_SEGMENT *_findSegmentInIndex(const AQFINTS_PARSER_INDEX *idx, const char *key, int segmentVersion,
+                                            int protocolVersion);
+static AQFINTS_JOBDEF *_findJobDefInIndex(const AQFINTS_PARSER_INDEX *idx, const char *key, int jobVersion,
+                                          int protocolVersion);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
 
 
 
@@ -48,6 +75,8 @@ AQFINTS_PARSER *AQFINTS_Parser_new()
 void AQFINTS_Parser_free(AQFINTS_PARSER *parser)
 {
   if (parser) {
+    _freeIndexes(parser);
+    free(parser->cacheFile);
     GWEN_StringList_free(parser->pathList);
     AQFINTS_Segment_List_free(parser->segmentList);
     AQFINTS_JobDef_List_free(parser->jobDefList);
@@ -67,10 +96,20 @@ void AQFINTS_Parser_AddPath(AQFINTS_PARSER *parser, const char *path)
 
 
 
+void AQFINTS_Parser_SetCacheFile(AQFINTS_PARSER *parser, const char *fileName)
+{
+  assert(parser);
+  free(parser->cacheFile);
+  parser->cacheFile=(fileName && *fileName)?strdup(fileName):NULL;
+}
+
+
+
 int AQFINTS_Parser_ReadFiles(AQFINTS_PARSER *parser)
 {
   GWEN_STRINGLIST *slFiles;
   GWEN_STRINGLISTENTRY *slEntry;
+  GWEN_BUFFER *keyBuf=NULL;
   AQFINTS_ELEMENT *groupTree;
   int filesLoaded=0;
 
@@ -102,6 +141,27 @@ int AQFINTS_Parser_ReadFiles(AQFINTS_PARSER *parser)
     return GWEN_ERROR_GENERIC;
   }
 
+  /* try cache file first */
+  if (parser->cacheFile) {
+    int rv;
+
+    keyBuf=GWEN_Buffer_new(0, 1024, 0, 1);
+    rv=AQFINTS_Parser_Cache_MakeKey(slFiles, keyBuf);
+    if (rv<0) {
+      DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "Not using cache file (%d)", rv);
+      GWEN_Buffer_free(keyBuf);
+      keyBuf=NULL;
+    }
+    else if (AQFINTS_Parser_Cache_ReadFile(parser->jobDefList, parser->segmentList, keyBuf, parser->cacheFile)==0) {
+      DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "Definitions loaded from cache file \"%s\"", parser->cacheFile);
+      _buildIndexes(parser);
+      GWEN_Buffer_free(keyBuf);
+      GWEN_StringList_free(slFiles);
+      AQFINTS_Element_free(groupTree);
+      return 0;
+    }
+  }
+
   /* load files */
   slEntry=GWEN_StringList_FirstEntry(slFiles);
   while (slEntry) {
@@ -123,6 +183,7 @@ int AQFINTS_Parser_ReadFiles(AQFINTS_PARSER *parser)
   }
   if (filesLoaded<1) {
     DBG_ERROR(AQFINTS_PARSER_LOGDOMAIN, "No files loaded");
+    GWEN_Buffer_free(keyBuf);
     GWEN_StringList_free(slFiles);
     AQFINTS_Element_free(groupTree);
     return GWEN_ERROR_GENERIC;
@@ -131,8 +192,18 @@ int AQFINTS_Parser_ReadFiles(AQFINTS_PARSER *parser)
   /* post-process files */
   AQFINTS_Parser_SegmentList_ResolveGroups(parser->segmentList, groupTree);
   AQFINTS_Parser_SegmentList_Normalize(parser->segmentList);
+  _buildIndexes(parser);
+  if (keyBuf) {
+    int rv;
+
+    rv=AQFINTS_Parser_Cache_WriteFile(parser->jobDefList, parser->segmentList, keyBuf, parser->cacheFile);
+    if (rv<0) {
+      DBG_WARN(AQFINTS_PARSER_LOGDOMAIN, "Could not write cache file \"%s\" (%d), ignoring", parser->cacheFile, rv);
+    }
+  }
 
   /* cleanup */
+  GWEN_Buffer_free(keyBuf);
   GWEN_StringList_free(slFiles);
   AQFINTS_Element_free(groupTree);
   return 0;
@@ -146,10 +217,12 @@ AQFINTS_SEGMENT *AQFINTS_Parser_FindSegmentByCode(const AQFINTS_PARSER *parser,
 {
   AQFINTS_SEGMENT *segment;
 
+  if (parser->segmentsByCode && id && *id)
+    return _findSegmentInIndex(parser->segmentsByCode, id, segmentVersion, protocolVersion);
+
   segment=AQFINTS_Segment_List_First(parser->segmentList);
   while (segment) {
-    if ((segmentVersion==0 || segmentVersion==AQFINTS_Segment_GetSegmentVersion(segment)) &&
-        (protocolVersion==0 || protocolVersion==AQFINTS_Segment_GetProtocolVersion(segment))) {
+    if (_segmentMatchesVersions(segment, segmentVersion, protocolVersion)) {
       if (!(id && *id))
         return segment;
       else {
@@ -173,10 +246,12 @@ AQFINTS_SEGMENT *AQFINTS_Parser_FindSegmentById(const AQFINTS_PARSER *parser, co
 {
   AQFINTS_SEGMENT *segment;
 
+  if (parser->segmentsById && id && *id)
+    return _findSegmentInIndex(parser->segmentsById, id, segmentVersion, protocolVersion);
+
   segment=AQFINTS_Segment_List_First(parser->segmentList);
   while (segment) {
-    if ((segmentVersion==0 || segmentVersion==AQFINTS_Segment_GetSegmentVersion(segment)) &&
-        (protocolVersion==0 || protocolVersion==AQFINTS_Segment_GetProtocolVersion(segment))) {
+    if (_segmentMatchesVersions(segment, segmentVersion, protocolVersion)) {
       if (!(id && *id))
         return segment;
       else {
@@ -203,6 +278,27 @@ AQFINTS_SEGMENT *AQFINTS_Parser_FindSegmentHighestVersionForProto(const AQFINTS_
   AQFINTS_SEGMENT *bestMatchSoFar=NULL;
 
   assert((id && *id));
+
+  if (parser->segmentsHighestVersionByCode) {
+    AQFINTS_PARSER_INDEX_ENTRY *entry;
+
+    if (protocolVersion==0) {
+      entry=AQFINTS_ParserIndex_FindFirst(parser->segmentsHighestVersionByCode, id);
+      return entry?((AQFINTS_SEGMENT *) AQFINTS_ParserIndexEntry_GetObject(entry)):NULL;
+    }
+
+    entry=AQFINTS_ParserIndex_FindFirst(parser->segmentsByCode, id);
+    while (entry) {
+      segment=(AQFINTS_SEGMENT *) AQFINTS_ParserIndexEntry_GetObject(entry);
+      if (protocolVersion>=AQFINTS_Segment_GetProtocolVersion(segment) &&
+          (bestMatchSoFar==NULL ||
+           AQFINTS_Segment_GetSegmentVersion(segment)>AQFINTS_Segment_GetSegmentVersion(bestMatchSoFar)))
+        bestMatchSoFar=segment;
+      entry=AQFINTS_ParserIndex_FindNext(entry);
+    }
+    return bestMatchSoFar;
+  }
+
   segment=AQFINTS_Segment_List_First(parser->segmentList);
   while (segment) {
     int possibleMatch=0;
@@ -260,10 +356,12 @@ AQFINTS_JOBDEF *AQFINTS_Parser_FindJobDefByCode(const AQFINTS_PARSER *parser, co
 {
   AQFINTS_JOBDEF *jobDef;
 
+  if (parser->jobDefsByCode && id && *id)
+    return _findJobDefInIndex(parser->jobDefsByCode, id, jobVersion, protocolVersion);
+
   jobDef=AQFINTS_JobDef_List_First(parser->jobDefList);
   while (jobDef) {
-    if ((jobVersion==0 || jobVersion==AQFINTS_JobDef_GetJobVersion(jobDef)) &&
-        (protocolVersion==0 || protocolVersion==AQFINTS_JobDef_GetProtocolVersion(jobDef))) {
+    if (_jobDefMatchesVersions(jobDef, jobVersion, protocolVersion)) {
       if (!(id && *id))
         return jobDef;
       else {
@@ -287,10 +385,12 @@ AQFINTS_JOBDEF *AQFINTS_Parser_FindJobDefById(const AQFINTS_PARSER *parser, cons
 {
   AQFINTS_JOBDEF *jobDef;
 
+  if (parser->jobDefsById && id && *id)
+    return _findJobDefInIndex(parser->jobDefsById, id, jobVersion, protocolVersion);
+
   jobDef=AQFINTS_JobDef_List_First(parser->jobDefList);
   while (jobDef) {
-    if ((jobVersion==0 || jobVersion==AQFINTS_JobDef_GetJobVersion(jobDef)) &&
-        (protocolVersion==0 || protocolVersion==AQFINTS_JobDef_GetProtocolVersion(jobDef))) {
+    if (_jobDefMatchesVersions(jobDef, jobVersion, protocolVersion)) {
       if (!(id && *id))
         return jobDef;
       else {
@@ -314,10 +414,12 @@ AQFINTS_JOBDEF *AQFINTS_Parser_FindJobDefByParams(const AQFINTS_PARSER *parser,
 {
   AQFINTS_JOBDEF *jobDef;
 
+  if (parser->jobDefsByParams && params && *params)
+    return _findJobDefInIndex(parser->jobDefsByParams, params, jobVersion, protocolVersion);
+
   jobDef=AQFINTS_JobDef_List_First(parser->jobDefList);
   while (jobDef) {
-    if ((jobVersion==0 || jobVersion==AQFINTS_JobDef_GetJobVersion(jobDef)) &&
-        (protocolVersion==0 || protocolVersion==AQFINTS_JobDef_GetProtocolVersion(jobDef))) {
+    if (_jobDefMatchesVersions(jobDef, jobVersion, protocolVersion)) {
       if (!(params && *params))
         return jobDef;
       else {
@@ -502,5 +604,121 @@ void AQFINTS_Parser_DumpDefinitions(AQFINTS_PARSER *parser, int indent)
 
 
 
+void _buildIndexes(AQFINTS_PARSER *parser)
+{
+  AQFINTS_SEGMENT *segment;
+  AQFINTS_JOBDEF *jobDef;
+  uint32_t count;
+
+  _freeIndexes(parser);
+
+  count=AQFINTS_Segment_List_GetCount(parser->segmentList);
+  parser->segmentsByCode=AQFINTS_ParserIndex_new(count);
+  parser->segmentsById=AQFINTS_ParserIndex_new(count);
+  parser->segmentsHighestVersionByCode=AQFINTS_ParserIndex_new(count);
+  segment=AQFINTS_Segment_List_First(parser->segmentList);
+  while (segment) {
+    const char *sCode;
+    AQFINTS_PARSER_INDEX_ENTRY *entry;
+
+    sCode=AQFINTS_Segment_GetCode(segment);
+    AQFINTS_ParserIndex_Add(parser->segmentsByCode, sCode, segment);
+    AQFINTS_ParserIndex_Add(parser->segmentsById, AQFINTS_Segment_GetId(segment), segment);
 
+    /* the first segment with the highest version wins (like in the list walk) */
+    entry=AQFINTS_ParserIndex_FindFirst(parser->segmentsHighestVersionByCode, sCode);
+    if (entry==NULL)
+      AQFINTS_ParserIndex_Add(parser->segmentsHighestVersionByCode, sCode, segment);
+    else if (AQFINTS_Segment_GetSegmentVersion(segment)>
+             AQFINTS_Segment_GetSegmentVersion((AQFINTS_SEGMENT *) AQFINTS_ParserIndexEntry_GetObject(entry)))
+      AQFINTS_ParserIndexEntry_SetObject(entry, segment);
 
+    segment=AQFINTS_Segment_List_Next(segment);
+  }
+
+  count=AQFINTS_JobDef_List_GetCount(parser->jobDefList);
+  parser->jobDefsByCode=AQFINTS_ParserIndex_new(count);
+  parser->jobDefsById=AQFINTS_ParserIndex_new(count);
+  parser->jobDefsByParams=AQFINTS_ParserIndex_new(count);
+  jobDef=AQFINTS_JobDef_List_First(parser->jobDefList);
+  while (jobDef) {
+    AQFINTS_ParserIndex_Add(parser->jobDefsByCode, AQFINTS_JobDef_GetCode(jobDef), jobDef);
+    AQFINTS_ParserIndex_Add(parser->jobDefsById, AQFINTS_JobDef_GetId(jobDef), jobDef);
+    AQFINTS_ParserIndex_Add(parser->jobDefsByParams, AQFINTS_JobDef_GetParamsSegmentCode(jobDef), jobDef);
+    jobDef=AQFINTS_JobDef_List_Next(jobDef);
+  }
+}
+
+
+
+void _freeIndexes(AQFINTS_PARSER *parser)
+{
+  AQFINTS_ParserIndex_free(parser->jobDefsByParams);
+  parser->jobDefsByParams=NULL;
+  AQFINTS_ParserIndex_free(parser->jobDefsById);
+  parser->jobDefsById=NULL;
+  AQFINTS_ParserIndex_free(parser->jobDefsByCode);
+  parser->jobDefsByCode=NULL;
+  AQFINTS_ParserIndex_free(parser->segmentsHighestVersionByCode);
+  parser->segmentsHighestVersionByCode=NULL;
+  AQFINTS_ParserIndex_free(parser->segmentsById);
+  parser->segmentsById=NULL;
+  AQFINTS_ParserIndex_free(parser->segmentsByCode);
+  parser->segmentsByCode=NULL;
+}
+
+
+
+int _segmentMatchesVersions(const AQFINTS_SEGMENT *segment, int segmentVersion, int protocolVersion)
+{
+  return ((segmentVersion==0 || segmentVersion==AQFINTS_Segment_GetSegmentVersion(segment)) &&
+          (protocolVersion==0 || protocolVersion==AQFINTS_Segment_GetProtocolVersion(segment)));
+}
+
+
+
+int _jobDefMatchesVersions(const AQFINTS_JOBDEF *jobDef, int jobVersion, int protocolVersion)
+{
+  return ((jobVersion==0 || jobVersion==AQFINTS_JobDef_GetJobVersion(jobDef)) &&
+          (protocolVersion==0 || protocolVersion==AQFINTS_JobDef_GetProtocolVersion(jobDef)));
+}
+
+
+
+AQFINTS_SEGMENT *_findSegmentInIndex(const AQFINTS_PARSER_INDEX *idx, const char *key, int segmentVersion,
+                                     int protocolVersion)
+{
+  AQFINTS_PARSER_INDEX_ENTRY *entry;
+
+  entry=AQFINTS_ParserIndex_FindFirst(idx, key);
+  while (entry) {
+    AQFINTS_SEGMENT *segment;
+
+    segment=(AQFINTS_SEGMENT *) AQFINTS_ParserIndexEntry_GetObject(entry);
+    if (_segmentMatchesVersions(segment, segmentVersion, protocolVersion))
+      return segment;
+    entry=AQFINTS_ParserIndex_FindNext(entry);
+  }
+
+  return NULL;
+}
+
+
+
+AQFINTS_JOBDEF *_findJobDefInIndex(const AQFINTS_PARSER_INDEX *idx, const char *key, int jobVersion,
+                                   int protocolVersion)
+{
+  AQFINTS_PARSER_INDEX_ENTRY *entry;
+
+  entry=AQFINTS_ParserIndex_FindFirst(idx, key);
+  while (entry) {
+    AQFINTS_JOBDEF *jobDef;
+
+    jobDef=(AQFINTS_JOBDEF *) AQFINTS_ParserIndexEntry_GetObject(entry);
+    if (_jobDefMatchesVersions(jobDef, jobVersion, protocolVersion))
+      return jobDef;
+    entry=AQFINTS_ParserIndex_FindNext(entry);
+  }
+
+  return NULL;
+}
@@ -125,6 +125,20 @@ int AQFINTS_Parser_WriteSegment(AQFINTS_PARSER *parser, AQFINTS_SEGMENT *segment
 void AQFINTS_Parser_AddPath(AQFINTS_PARSER *parser, const char *path);
 
 
+/**
+ * Set the name of a binary cache file for the definitions loaded by @ref AQFINTS_Parser_ReadFiles().
+ *
+ * If a cache file is set the resolved and normalized definitions are written to that file after reading
+ * the *.fints files. Subsequent calls to @ref AQFINTS_Parser_ReadFiles() load the definitions from that file
+ * instead of parsing the *.fints files again as long as the set of files, their sizes and modification times
+ * are unchanged.
+ *
+ * @param parser parser object
+ * @param fileName name of the cache file (NULL to disable caching)
+ */
+void AQFINTS_Parser_SetCacheFile(AQFINTS_PARSER *parser, const char *fileName);
+
+
 /**
  * Read files from the folders specified via @ref AQFINTS_Parser_AddPath().
  *
@@ -0,0 +1,603 @@
+/***************************************************************************
+ begin       : Sat Oct 17 2026
+ copyright   : (C) 2026 by Martin Preuss
+ email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "parser_cache_p.h"
+
+#include "aqbanking/version.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/syncio.h>
+#include <gwenhywfar/directory.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void writeSegment(const AQFINTS_SEGMENT *segment, GWEN_BUFFER *buf);
+static void writeElementTree(const AQFINTS_ELEMENT *el, GWEN_BUFFER *buf);
+static void writeJobDef(const AQFINTS_JOBDEF *jobDef, GWEN_BUFFER *buf);
+
+static AQFINTS_SEGMENT *readSegment(AQFINTS_PARSER_CACHE_READER *r);
+static AQFINTS_ELEMENT *readElementTree(AQFINTS_PARSER_CACHE_READER *r, int depth);
+static AQFINTS_JOBDEF *readJobDef(AQFINTS_PARSER_CACHE_READER *r);
+
+static int checkHeader(const uint8_t *ptr, uint32_t len, const GWEN_BUFFER *keyBuf);
+
+static void appendUint32(GWEN_BUFFER *buf, uint32_t i);
+static void appendString(GWEN_BUFFER *buf, const char *s);
+static void appendBytes(GWEN_BUFFER *buf, const uint8_t *ptr, uint32_t len);
+static void putUint32(uint8_t *p, uint32_t i);
+static uint32_t getUint32(const uint8_t *p);
+static uint32_t calcChecksum(const uint8_t *ptr, uint32_t len);
+
+static uint32_t readUint32(AQFINTS_PARSER_CACHE_READER *r);
+static const char *readString(AQFINTS_PARSER_CACHE_READER *r);
+static const uint8_t *readBytes(AQFINTS_PARSER_CACHE_READER *r, uint32_t *pLen);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+int AQFINTS_Parser_Cache_MakeKey(const GWEN_STRINGLIST *slFiles, GWEN_BUFFER *keyBuf)
+{
+  GWEN_STRINGLISTENTRY *slEntry;
+
+  /* the cached definitions depend on the code which resolved and normalized them */
+  appendString(keyBuf, AQBANKING_VERSION_FULL_STRING);
+  appendUint32(keyBuf, GWEN_StringList_Count(slFiles));
+  slEntry=GWEN_StringList_FirstEntry(slFiles);
+  while (slEntry) {
+    const char *s;
+
+    s=GWEN_StringListEntry_Data(slEntry);
+    if (s && *s) {
+      struct stat st;
+
+      if (stat(s, &st)!=0) {
+        DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "stat(%s): %s", s, strerror(errno));
+        return GWEN_ERROR_IO;
+      }
+      appendString(keyBuf, s);
+      appendUint32(keyBuf, (uint32_t)(((uint64_t) st.st_mtime)>>32));
+      appendUint32(keyBuf, (uint32_t)(st.st_mtime & 0xffffffff));
+      appendUint32(keyBuf, (uint32_t)(((uint64_t) st.st_size)>>32));
+      appendUint32(keyBuf, (uint32_t)(st.st_size & 0xffffffff));
+    }
+    slEntry=GWEN_StringListEntry_Next(slEntry);
+  }
+
+  return 0;
+}
+
+
+
+int AQFINTS_Parser_Cache_ReadFile(AQFINTS_JOBDEF_LIST *jobDefList,
+                                  AQFINTS_SEGMENT_LIST *segmentList,
+                                  const GWEN_BUFFER *keyBuf,
+                                  const char *filename)
+{
+  GWEN_BUFFER *fileBuf;
+  AQFINTS_SEGMENT_LIST *tmpSegmentList;
+  AQFINTS_JOBDEF_LIST *tmpJobDefList;
+  AQFINTS_PARSER_CACHE_READER r;
+  const uint8_t *ptr;
+  uint32_t len;
+  uint32_t count;
+  int rv;
+
+  /* read the whole file with a single read operation */
+  fileBuf=GWEN_Buffer_new(0, 256*1024, 0, 1);
+  rv=GWEN_SyncIo_Helper_ReadFile(filename, fileBuf);
+  if (rv<0) {
+    DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "Could not read cache file \"%s\" (%d)", filename, rv);
+    GWEN_Buffer_free(fileBuf);
+    return rv;
+  }
+  ptr=(const uint8_t *) GWEN_Buffer_GetStart(fileBuf);
+  len=GWEN_Buffer_GetUsedBytes(fileBuf);
+
+  rv=checkHeader(ptr, len, keyBuf);
+  if (rv<0) {
+    DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "Cache file \"%s\" is invalid or outdated (%d)", filename, rv);
+    GWEN_Buffer_free(fileBuf);
+    return rv;
+  }
+
+  r.ptr=ptr+AQFINTS_PARSER_CACHE_HEADER_SIZE+GWEN_Buffer_GetUsedBytes(keyBuf);
+  r.length=getUint32(ptr+AQFINTS_PARSER_CACHE_MAGIC_SIZE+8);
+  r.pos=0;
+  r.error=0;
+
+  tmpSegmentList=AQFINTS_Segment_List_new();
+  count=readUint32(&r);
+  while (count-- && !r.error) {
+    AQFINTS_SEGMENT *segment;
+
+    segment=readSegment(&r);
+    if (segment)
+      AQFINTS_Segment_List_Add(segment, tmpSegmentList);
+  }
+
+  tmpJobDefList=AQFINTS_JobDef_List_new();
+  count=readUint32(&r);
+  while (count-- && !r.error) {
+    AQFINTS_JOBDEF *jobDef;
+
+    jobDef=readJobDef(&r);
+    if (jobDef)
+      AQFINTS_JobDef_List_Add(jobDef, tmpJobDefList);
+  }
+  GWEN_Buffer_free(fileBuf);
+
+  if (r.error || r.pos!=r.length) {
+    DBG_ERROR(AQFINTS_PARSER_LOGDOMAIN, "Bad data in cache file \"%s\"", filename);
+    AQFINTS_JobDef_List_free(tmpJobDefList);
+    AQFINTS_Segment_List_free(tmpSegmentList);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  /* move definitions to the target lists */
+  for (;;) {
+    AQFINTS_SEGMENT *segment;
+
+    segment=AQFINTS_Segment_List_First(tmpSegmentList);
+    if (segment==NULL)
+      break;
+    AQFINTS_Segment_List_Del(segment);
+    AQFINTS_Segment_List_Add(segment, segmentList);
+  }
+  for (;;) {
+    AQFINTS_JOBDEF *jobDef;
+
+    jobDef=AQFINTS_JobDef_List_First(tmpJobDefList);
+    if (jobDef==NULL)
+      break;
+    AQFINTS_JobDef_List_Del(jobDef);
+    AQFINTS_JobDef_List_Add(jobDef, jobDefList);
+  }
+  AQFINTS_JobDef_List_free(tmpJobDefList);
+  AQFINTS_Segment_List_free(tmpSegmentList);
+
+  return 0;
+}
+
+
+
+int AQFINTS_Parser_Cache_WriteFile(const AQFINTS_JOBDEF_LIST *jobDefList,
+                                   const AQFINTS_SEGMENT_LIST *segmentList,
+                                   const GWEN_BUFFER *keyBuf,
+                                   const char *filename)
+{
+  GWEN_BUFFER *buf;
+  GWEN_BUFFER *tmpNameBuf;
+  const AQFINTS_SEGMENT *segment;
+  const AQFINTS_JOBDEF *jobDef;
+  uint8_t *ptr;
+  uint32_t keyLength;
+  uint32_t dataLength;
+  int rv;
+
+  keyLength=GWEN_Buffer_GetUsedBytes(keyBuf);
+
+  buf=GWEN_Buffer_new(0, 256*1024, 0, 1);
+  /* header is filled in below */
+  GWEN_Buffer_AppendBytes(buf, AQFINTS_PARSER_CACHE_MAGIC, AQFINTS_PARSER_CACHE_MAGIC_SIZE);
+  appendUint32(buf, AQFINTS_PARSER_CACHE_VERSION);
+  appendUint32(buf, keyLength);
+  appendUint32(buf, 0);
+  appendUint32(buf, 0);
+  GWEN_Buffer_AppendBytes(buf, GWEN_Buffer_GetStart(keyBuf), keyLength);
+
+  appendUint32(buf, AQFINTS_Segment_List_GetCount(segmentList));
+  segment=AQFINTS_Segment_List_First(segmentList);
+  while (segment) {
+    writeSegment(segment, buf);
+    segment=AQFINTS_Segment_List_Next(segment);
+  }
+
+  appendUint32(buf, AQFINTS_JobDef_List_GetCount(jobDefList));
+  jobDef=AQFINTS_JobDef_List_First(jobDefList);
+  while (jobDef) {
+    writeJobDef(jobDef, buf);
+    jobDef=AQFINTS_JobDef_List_Next(jobDef);
+  }
+
+  ptr=(uint8_t *) GWEN_Buffer_GetStart(buf);
+  dataLength=GWEN_Buffer_GetUsedBytes(buf)-AQFINTS_PARSER_CACHE_HEADER_SIZE-keyLength;
+  putUint32(ptr+AQFINTS_PARSER_CACHE_MAGIC_SIZE+8, dataLength);
+  putUint32(ptr+AQFINTS_PARSER_CACHE_MAGIC_SIZE+12,
+            calcChecksum(ptr+AQFINTS_PARSER_CACHE_HEADER_SIZE, keyLength+dataLength));
+
+  if (GWEN_Directory_GetPath(filename, GWEN_PATH_FLAGS_VARIABLE)) {
+    DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "Could not create folder for cache file \"%s\"", filename);
+    GWEN_Buffer_free(buf);
+    return GWEN_ERROR_IO;
+  }
+
+  tmpNameBuf=GWEN_Buffer_new(0, 256, 0, 1);
+  GWEN_Buffer_AppendString(tmpNameBuf, filename);
+  GWEN_Buffer_AppendString(tmpNameBuf, ".tmp");
+  rv=GWEN_SyncIo_Helper_WriteFile(GWEN_Buffer_GetStart(tmpNameBuf), ptr, GWEN_Buffer_GetUsedBytes(buf));
+  GWEN_Buffer_free(buf);
+  if (rv<0) {
+    DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "here (%d)", rv);
+    remove(GWEN_Buffer_GetStart(tmpNameBuf));
+    GWEN_Buffer_free(tmpNameBuf);
+    return rv;
+  }
+
+  if (rename(GWEN_Buffer_GetStart(tmpNameBuf), filename)!=0) {
+    /* some systems don't allow to rename onto an existing file */
+    remove(filename);
+    if (rename(GWEN_Buffer_GetStart(tmpNameBuf), filename)!=0) {
+      DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "rename(%s): %s", filename, strerror(errno));
+      remove(GWEN_Buffer_GetStart(tmpNameBuf));
+      GWEN_Buffer_free(tmpNameBuf);
+      return GWEN_ERROR_IO;
+    }
+  }
+  GWEN_Buffer_free(tmpNameBuf);
+
+  return 0;
+}
+
+
+
+void writeSegment(const AQFINTS_SEGMENT *segment, GWEN_BUFFER *buf)
+{
+  const AQFINTS_ELEMENT *elements;
+
+  appendUint32(buf, AQFINTS_Segment_GetFlags(segment));
+  appendString(buf, AQFINTS_Segment_GetId(segment));
+  appendString(buf, AQFINTS_Segment_GetCode(segment));
+  appendUint32(buf, (uint32_t) AQFINTS_Segment_GetSegmentVersion(segment));
+  appendUint32(buf, (uint32_t) AQFINTS_Segment_GetSegmentNumber(segment));
+  appendUint32(buf, (uint32_t) AQFINTS_Segment_GetRefSegmentNumber(segment));
+  appendUint32(buf, (uint32_t) AQFINTS_Segment_GetProtocolVersion(segment));
+
+  elements=AQFINTS_Segment_GetElements(segment);
+  appendUint32(buf, elements?1:0);
+  if (elements)
+    writeElementTree(elements, buf);
+}
+
+
+
+void writeElementTree(const AQFINTS_ELEMENT *el, GWEN_BUFFER *buf)
+{
+  const AQFINTS_ELEMENT *elChild;
+  uint32_t childCount=0;
+
+  appendUint32(buf, AQFINTS_Element_GetFlags(el));
+  appendUint32(buf, (uint32_t) AQFINTS_Element_GetElementType(el));
+  appendString(buf, AQFINTS_Element_GetId(el));
+  appendString(buf, AQFINTS_Element_GetName(el));
+  appendUint32(buf, (uint32_t) AQFINTS_Element_GetVersion(el));
+  appendString(buf, AQFINTS_Element_GetType(el));
+  appendUint32(buf, (uint32_t) AQFINTS_Element_GetMinNum(el));
+  appendUint32(buf, (uint32_t) AQFINTS_Element_GetMaxNum(el));
+  appendUint32(buf, (uint32_t) AQFINTS_Element_GetMinSize(el));
+  appendUint32(buf, (uint32_t) AQFINTS_Element_GetMaxSize(el));
+  appendUint32(buf, (uint32_t) AQFINTS_Element_GetTrustLevel(el));
+  appendBytes(buf, AQFINTS_Element_GetDataPointer(el), AQFINTS_Element_GetDataLength(el));
+
+  elChild=AQFINTS_Element_Tree2_GetFirstChild(el);
+  while (elChild) {
+    childCount++;
+    elChild=AQFINTS_Element_Tree2_GetNext(elChild);
+  }
+  appendUint32(buf, childCount);
+
+  elChild=AQFINTS_Element_Tree2_GetFirstChild(el);
+  while (elChild) {
+    writeElementTree(elChild, buf);
+    elChild=AQFINTS_Element_Tree2_GetNext(elChild);
+  }
+}
+
+
+
+void writeJobDef(const AQFINTS_JOBDEF *jobDef, GWEN_BUFFER *buf)
+{
+  appendUint32(buf, AQFINTS_JobDef_GetFlags(jobDef));
+  appendString(buf, AQFINTS_JobDef_GetId(jobDef));
+  appendString(buf, AQFINTS_JobDef_GetCode(jobDef));
+  appendUint32(buf, (uint32_t) AQFINTS_JobDef_GetJobVersion(jobDef));
+  appendUint32(buf, (uint32_t) AQFINTS_JobDef_GetProtocolVersion(jobDef));
+  appendString(buf, AQFINTS_JobDef_GetParamsSegmentCode(jobDef));
+  appendString(buf, AQFINTS_JobDef_GetResponseSegmentCode(jobDef));
+  appendUint32(buf, (uint32_t) AQFINTS_JobDef_GetNeededSignatures(jobDef));
+  appendUint32(buf, (uint32_t) AQFINTS_JobDef_GetSecurityClass(jobDef));
+}
+
+
+
+AQFINTS_SEGMENT *readSegment(AQFINTS_PARSER_CACHE_READER *r)
+{
+  AQFINTS_SEGMENT *segment;
+
+  segment=AQFINTS_Segment_new();
+  AQFINTS_Segment_SetFlags(segment, readUint32(r));
+  AQFINTS_Segment_SetId(segment, readString(r));
+  AQFINTS_Segment_SetCode(segment, readString(r));
+  AQFINTS_Segment_SetSegmentVersion(segment, (int) readUint32(r));
+  AQFINTS_Segment_SetSegmentNumber(segment, (int) readUint32(r));
+  AQFINTS_Segment_SetRefSegmentNumber(segment, (int) readUint32(r));
+  AQFINTS_Segment_SetProtocolVersion(segment, (int) readUint32(r));
+
+  if (readUint32(r)) {
+    AQFINTS_ELEMENT *elements;
+
+    elements=readElementTree(r, 0);
+    if (elements)
+      AQFINTS_Segment_SetElements(segment, elements);
+  }
+
+  if (r->error) {
+    AQFINTS_Segment_free(segment);
+    return NULL;
+  }
+  return segment;
+}
+
+
+
+AQFINTS_ELEMENT *readElementTree(AQFINTS_PARSER_CACHE_READER *r, int depth)
+{
+  AQFINTS_ELEMENT *el;
+  const uint8_t *ptrData;
+  uint32_t lenData;
+  uint32_t childCount;
+
+  if (depth>AQFINTS_PARSER_CACHE_MAXDEPTH) {
+    DBG_ERROR(AQFINTS_PARSER_LOGDOMAIN, "Element tree too deep");
+    r->error=1;
+    return NULL;
+  }
+
+  el=AQFINTS_Element_new();
+  AQFINTS_Element_SetFlags(el, readUint32(r));
+  AQFINTS_Element_SetElementType(el, (AQFINTS_ELEMENT_TYPE) readUint32(r));
+  AQFINTS_Element_SetId(el, readString(r));
+  AQFINTS_Element_SetName(el, readString(r));
+  AQFINTS_Element_SetVersion(el, (int) readUint32(r));
+  AQFINTS_Element_SetType(el, readString(r));
+  AQFINTS_Element_SetMinNum(el, (int) readUint32(r));
+  AQFINTS_Element_SetMaxNum(el, (int) readUint32(r));
+  AQFINTS_Element_SetMinSize(el, (int) readUint32(r));
+  AQFINTS_Element_SetMaxSize(el, (int) readUint32(r));
+  AQFINTS_Element_SetTrustLevel(el, (int) readUint32(r));
+  ptrData=readBytes(r, &lenData);
+  if (ptrData && lenData)
+    AQFINTS_Element_SetDataCopy(el, ptrData, lenData);
+
+  childCount=readUint32(r);
+  while (childCount-- && !r->error) {
+    AQFINTS_ELEMENT *elChild;
+
+    elChild=readElementTree(r, depth+1);
+    if (elChild)
+      AQFINTS_Element_Tree2_AddChild(el, elChild);
+  }
+
+  if (r->error) {
+    AQFINTS_Element_free(el);
+    return NULL;
+  }
+  return el;
+}
+
+
+
+AQFINTS_JOBDEF *readJobDef(AQFINTS_PARSER_CACHE_READER *r)
+{
+  AQFINTS_JOBDEF *jobDef;
+
+  jobDef=AQFINTS_JobDef_new();
+  AQFINTS_JobDef_SetFlags(jobDef, readUint32(r));
+  AQFINTS_JobDef_SetId(jobDef, readString(r));
+  AQFINTS_JobDef_SetCode(jobDef, readString(r));
+  AQFINTS_JobDef_SetJobVersion(jobDef, (int) readUint32(r));
+  AQFINTS_JobDef_SetProtocolVersion(jobDef, (int) readUint32(r));
+  AQFINTS_JobDef_SetParamsSegmentCode(jobDef, readString(r));
+  AQFINTS_JobDef_SetResponseSegmentCode(jobDef, readString(r));
+  AQFINTS_JobDef_SetNeededSignatures(jobDef, (int) readUint32(r));
+  AQFINTS_JobDef_SetSecurityClass(jobDef, (int) readUint32(r));
+
+  if (r->error) {
+    AQFINTS_JobDef_free(jobDef);
+    return NULL;
+  }
+  return jobDef;
+}
+
+
+
+int checkHeader(const uint8_t *ptr, uint32_t len, const GWEN_BUFFER *keyBuf)
+{
+  uint32_t keyLength;
+  uint32_t dataLength;
+
+  if (len<AQFINTS_PARSER_CACHE_HEADER_SIZE ||
+      memcmp(ptr, AQFINTS_PARSER_CACHE_MAGIC, AQFINTS_PARSER_CACHE_MAGIC_SIZE)!=0) {
+    DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "Not a cache file");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  if (getUint32(ptr+AQFINTS_PARSER_CACHE_MAGIC_SIZE)!=AQFINTS_PARSER_CACHE_VERSION) {
+    DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "Unsupported cache file version");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  keyLength=getUint32(ptr+AQFINTS_PARSER_CACHE_MAGIC_SIZE+4);
+  dataLength=getUint32(ptr+AQFINTS_PARSER_CACHE_MAGIC_SIZE+8);
+  if (keyLength!=GWEN_Buffer_GetUsedBytes(keyBuf) ||
+      len-AQFINTS_PARSER_CACHE_HEADER_SIZE<keyLength ||
+      dataLength!=len-AQFINTS_PARSER_CACHE_HEADER_SIZE-keyLength) {
+    DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "Cache file size mismatch or definition files changed");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  if (memcmp(ptr+AQFINTS_PARSER_CACHE_HEADER_SIZE, GWEN_Buffer_GetStart(keyBuf), keyLength)!=0) {
+    DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "Definition files changed");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  if (getUint32(ptr+AQFINTS_PARSER_CACHE_MAGIC_SIZE+12)!=
+      calcChecksum(ptr+AQFINTS_PARSER_CACHE_HEADER_SIZE, keyLength+dataLength)) {
+    DBG_ERROR(AQFINTS_PARSER_LOGDOMAIN, "Checksum error");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  return 0;
+}
+
+
+
+void appendUint32(GWEN_BUFFER *buf, uint32_t i)
+{
+  uint8_t b[4];
+
+  putUint32(b, i);
+  GWEN_Buffer_AppendBytes(buf, (const char *) b, 4);
+}
+
+
+
+void appendString(GWEN_BUFFER *buf, const char *s)
+{
+  if (s==NULL)
+    appendUint32(buf, AQFINTS_PARSER_CACHE_NULLSTRING);
+  else {
+    uint32_t len;
+
+    len=strlen(s);
+    appendUint32(buf, len);
+    /* include trailing zero, allows for using the string directly from the file buffer */
+    GWEN_Buffer_AppendBytes(buf, s, len+1);
+  }
+}
+
+
+
+void appendBytes(GWEN_BUFFER *buf, const uint8_t *ptr, uint32_t len)
+{
+  if (ptr==NULL)
+    len=0;
+  appendUint32(buf, len);
+  if (len)
+    GWEN_Buffer_AppendBytes(buf, (const char *) ptr, len);
+}
+
+
+
+void putUint32(uint8_t *p, uint32_t i)
+{
+  p[0]=(i>>24) & 0xff;
+  p[1]=(i>>16) & 0xff;
+  p[2]=(i>>8) & 0xff;
+  p[3]=i & 0xff;
+}
+
+
+
+uint32_t getUint32(const uint8_t *p)
+{
+  return (((uint32_t) p[0])<<24) | (((uint32_t) p[1])<<16) | (((uint32_t) p[2])<<8) | ((uint32_t) p[3]);
+}
+
+
+
+uint32_t calcChecksum(const uint8_t *ptr, uint32_t len)
+{
+  uint32_t hash=2166136261u;
+
+  while (len--) {
+    hash^=*(ptr++);
+    hash*=16777619u;
+  }
+  return hash;
+}
+
+
+
+uint32_t readUint32(AQFINTS_PARSER_CACHE_READER *r)
+{
+  uint32_t i;
+
+  if (r->error || r->length-r->pos<4) {
+    r->error=1;
+    return 0;
+  }
+  i=getUint32(r->ptr+r->pos);
+  r->pos+=4;
+  return i;
+}
+
+
+
+const char *readString(AQFINTS_PARSER_CACHE_READER *r)
+{
+  uint32_t len;
+  const char *s;
+
+  len=readUint32(r);
+  if (r->error || len==AQFINTS_PARSER_CACHE_NULLSTRING)
+    return NULL;
+
+  if (r->length-r->pos<=len || r->ptr[r->pos+len]!=0) {
+    r->error=1;
+    return NULL;
+  }
+  s=(const char *)(r->ptr+r->pos);
+  r->pos+=len+1;
+  return s;
+}
+
+
+
+const uint8_t *readBytes(AQFINTS_PARSER_CACHE_READER *r, uint32_t *pLen)
+{
+  uint32_t len;
+  const uint8_t *p;
+
+  *pLen=0;
+  len=readUint32(r);
+  if (r->error || len==0)
+    return NULL;
+
+  if (r->length-r->pos<len) {
+    r->error=1;
+    return NULL;
+  }
+  p=r->ptr+r->pos;
+  r->pos+=len;
+  *pLen=len;
+  return p;
+}
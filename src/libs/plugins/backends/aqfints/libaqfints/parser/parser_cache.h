@@ -0,0 +1,59 @@
+/***************************************************************************
+ begin       : Sat Oct 17 2026
+ copyright   : (C) 2026 by Martin Preuss
+ email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifndef AQFINTS_PARSER_CACHE_H
+#define AQFINTS_PARSER_CACHE_H
+
+
+#include "parser/segment.h"
+#include "parser/jobdef.h"
+
+#include <gwenhywfar/buffer.h>
+#include <gwenhywfar/stringlist.h>
+
+
+/**
+ * Create a key describing the library version and the given set of definition files (path, modification
+ * time and size of every file). A cache file is only used if it has been written with the same key.
+ *
+ * @return 0 if okay, error code otherwise (e.g. if a file could not be stat'ed)
+ * @param slFiles list of definition files as read by @ref AQFINTS_Parser_ReadFiles()
+ * @param keyBuf buffer to receive the key
+ */
+int AQFINTS_Parser_Cache_MakeKey(const GWEN_STRINGLIST *slFiles, GWEN_BUFFER *keyBuf);
+
+
+/**
+ * Read resolved and normalized segment and job definitions from a binary cache file.
+ *
+ * The target lists are only modified if the whole file could be read.
+ *
+ * @return 0 if okay, GWEN_ERROR_BAD_DATA if the file is invalid or has been created for another key,
+ *         other error code if the file could not be read
+ */
+int AQFINTS_Parser_Cache_ReadFile(AQFINTS_JOBDEF_LIST *jobDefList,
+                                  AQFINTS_SEGMENT_LIST *segmentList,
+                                  const GWEN_BUFFER *keyBuf,
+                                  const char *filename);
+
+/**
+ * Write resolved and normalized segment and job definitions into a binary cache file.
+ *
+ * The file is written to a temporary file first which is then renamed, so concurrent readers
+ * never see a partially written cache.
+ */
+int AQFINTS_Parser_Cache_WriteFile(const AQFINTS_JOBDEF_LIST *jobDefList,
+                                   const AQFINTS_SEGMENT_LIST *segmentList,
+                                   const GWEN_BUFFER *keyBuf,
+                                   const char *filename);
+
+
+#endif
+
@@ -0,0 +1,53 @@
+/***************************************************************************
+ begin       : Sat Oct 17 2026
+ copyright   : (C) 2026 by Martin Preuss
+ email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifndef AQFINTS_PARSER_CACHE_P_H
+#define AQFINTS_PARSER_CACHE_P_H
+
+
+#include "parser_cache.h"
+
+
+/*
+ * File layout (all numbers big endian):
+ *
+ *   magic        8 bytes ("AQFINTSC")
+ *   version      uint32
+ *   keyLength    uint32
+ *   dataLength   uint32
+ *   checksum     uint32  (FNV-1a over key and data)
+ *   key          keyLength bytes
+ *   data         dataLength bytes (segment count, segments, job definition count, job definitions)
+ *
+ * Increase AQFINTS_PARSER_CACHE_VERSION whenever the layout of the data section changes.
+ */
+#define AQFINTS_PARSER_CACHE_MAGIC       "AQFINTSC"
+#define AQFINTS_PARSER_CACHE_MAGIC_SIZE  8
+#define AQFINTS_PARSER_CACHE_VERSION     1
+#define AQFINTS_PARSER_CACHE_HEADER_SIZE (AQFINTS_PARSER_CACHE_MAGIC_SIZE+16)
+
+/* length value used for strings which are NULL */
+#define AQFINTS_PARSER_CACHE_NULLSTRING  0xffffffffu
+
+/* element trees in definition files are shallow, deeper trees indicate a broken file */
+#define AQFINTS_PARSER_CACHE_MAXDEPTH    32
+
+
+typedef struct AQFINTS_PARSER_CACHE_READER AQFINTS_PARSER_CACHE_READER;
+struct AQFINTS_PARSER_CACHE_READER {
+  const uint8_t *ptr;
+  uint32_t length;
+  uint32_t pos;
+  int error;          /* set upon first attempt to read beyond the end of the data */
+};
+
+
+
+#endif
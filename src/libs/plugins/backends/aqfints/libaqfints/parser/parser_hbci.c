@@ -13,7 +13,7 @@
 #endif
 
 
-#include "parser_hbci.h"
+#include "parser_hbci_p.h"
 #include "parser_normalize.h"
 
 #include <gwenhywfar/syncio_memory.h>
@@ -21,6 +21,10 @@
 
 #include <ctype.h>
 
+#ifdef AQFINTS_PARSER_HBCI_WITH_SSE2
+# include <emmintrin.h>
+#endif
+
 
 
 #define AQFINTS_PARSER_HBCI_BUFFERSIZE 1024
@@ -37,6 +41,9 @@ static int readDeg(AQFINTS_ELEMENT *targetElement, const uint8_t *ptrBuf, uint32
 static int readDe(AQFINTS_ELEMENT *targetElement, const uint8_t *ptrBuf, uint32_t lenBuf);
 static int readString(AQFINTS_ELEMENT *targetElement, const uint8_t *ptrBuf, uint32_t lenBuf);
 static int readBin(AQFINTS_ELEMENT *targetElement, const uint8_t *ptrBuf, uint32_t lenBuf);
+static int scanString(const uint8_t *ptrBuf, uint32_t lenBuf, AQFINTS_PARSER_HBCI_SPAN *span);
+static uint32_t findStringDelimiter(const uint8_t *ptrBuf, uint32_t lenBuf);
+static void setTextDataFromSpan(AQFINTS_ELEMENT *targetElement, const AQFINTS_PARSER_HBCI_SPAN *span);
 static void parseSegHeader(AQFINTS_SEGMENT *segment);
 
 static void writeDegSequence(AQFINTS_ELEMENT *element, GWEN_BUFFER *destBuf, int elementCount,
@@ -347,49 +354,134 @@ int readDe(AQFINTS_ELEMENT *targetElement, const uint8_t *ptrBuf, uint32_t lenBu
 
 int readString(AQFINTS_ELEMENT *targetElement, const uint8_t *ptrBuf, uint32_t lenBuf)
 {
-  uint32_t origLenBuf;
-  GWEN_BUFFER *destBuf;
+  AQFINTS_PARSER_HBCI_SPAN span;
+  int rv;
 
-  origLenBuf=lenBuf;
-  destBuf=GWEN_Buffer_new(0, 256, 0, 1);
+  rv=scanString(ptrBuf, lenBuf, &span);
+  if (rv<0) {
+    DBG_INFO(AQFINTS_PARSER_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+  if (span.length)
+    setTextDataFromSpan(targetElement, &span);
+  return rv;
+}
+
+
+
+int scanString(const uint8_t *ptrBuf, uint32_t lenBuf, AQFINTS_PARSER_HBCI_SPAN *span)
+{
+  uint32_t pos=0;
+
+  span->ptr=ptrBuf;
+  span->length=0;
+  span->hasEscapes=0;
+
+  for (;;) {
+    pos+=findStringDelimiter(ptrBuf+pos, lenBuf-pos);
+    if (pos>=lenBuf || ptrBuf[pos]==0) {
+      DBG_ERROR(AQFINTS_PARSER_LOGDOMAIN, "No delimiter at end of data");
+      return GWEN_ERROR_BAD_DATA;
+    }
+    if (ptrBuf[pos]!='?')
+      break;
+
+    /* escape character, skip it and the escaped character */
+    if (pos+1>=lenBuf || ptrBuf[pos+1]==0) {
+      DBG_ERROR(AQFINTS_PARSER_LOGDOMAIN, "Premature end of data (question mark was last character)");
+      return GWEN_ERROR_BAD_DATA;
+    }
+    span->hasEscapes=1;
+    pos+=2;
+  }
+
+  /* end of segment, DEG or DE reached */
+  span->length=pos;
+  return (int) pos;
+}
+
+
+
+/* returns the position of the first "'", "+", ":", "?" or NUL (or lenBuf if there is none) */
+uint32_t findStringDelimiter(const uint8_t *ptrBuf, uint32_t lenBuf)
+{
+  uint32_t pos=0;
+
+#ifdef AQFINTS_PARSER_HBCI_WITH_SSE2
+  if (lenBuf>=16) {
+    const __m128i vQuote=_mm_set1_epi8('\'');
+    const __m128i vPlus=_mm_set1_epi8('+');
+    const __m128i vColon=_mm_set1_epi8(':');
+    const __m128i vQuestion=_mm_set1_epi8('?');
+    const __m128i vZero=_mm_setzero_si128();
+
+    while (pos+16<=lenBuf) {
+      __m128i v;
+      __m128i m;
+      int mask;
+
+      v=_mm_loadu_si128((const __m128i *)(ptrBuf+pos));
+      m=_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, vQuote), _mm_cmpeq_epi8(v, vPlus)),
+                     _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, vColon), _mm_cmpeq_epi8(v, vQuestion)),
+                                  _mm_cmpeq_epi8(v, vZero)));
+      mask=_mm_movemask_epi8(m);
+      if (mask)
+        return pos+__builtin_ctz(mask);
+      pos+=16;
+    }
+  }
+#endif
 
-  while (*ptrBuf && lenBuf) {
-    switch (*ptrBuf) {
+  while (pos<lenBuf) {
+    switch (ptrBuf[pos]) {
     case '\'':
     case '+':
     case ':':
-      /* end of segment, DEG or DE reached */
-      if (GWEN_Buffer_GetUsedBytes(destBuf))
-        AQFINTS_Element_SetTextDataCopy(targetElement, GWEN_Buffer_GetStart(destBuf));
-      GWEN_Buffer_free(destBuf);
-      return (int)(origLenBuf-lenBuf);
     case '?':
-      /* escape character */
-      ptrBuf++;
-      lenBuf--;
-      if (lenBuf && *ptrBuf)
-        GWEN_Buffer_AppendByte(destBuf, *ptrBuf);
-      else {
-        DBG_ERROR(AQFINTS_PARSER_LOGDOMAIN, "Premature end of data (question mark was last character)");
-        GWEN_Buffer_free(destBuf);
-        return GWEN_ERROR_BAD_DATA;
-      }
-      break;
+    case 0:
+      return pos;
     default:
-      GWEN_Buffer_AppendByte(destBuf, *ptrBuf);
-    } /* switch */
+      break;
+    }
+    pos++;
+  }
 
-    ptrBuf++;
-    lenBuf--;
-  } /* while */
+  return lenBuf;
+}
 
-  DBG_ERROR(AQFINTS_PARSER_LOGDOMAIN, "No delimiter at end of data");
-  GWEN_Buffer_free(destBuf);
-  return GWEN_ERROR_BAD_DATA;
+
+
+void setTextDataFromSpan(AQFINTS_ELEMENT *targetElement, const AQFINTS_PARSER_HBCI_SPAN *span)
+{
+  uint8_t *ptrCopy;
+  uint32_t len;
+
+  /* unescaped text is never longer than the span, so allocate once and hand the copy over to the element */
+  ptrCopy=(uint8_t *) malloc(span->length+1);
+  assert(ptrCopy);
+  if (span->hasEscapes) {
+    uint32_t i;
+
+    len=0;
+    for (i=0; i<span->length; i++) {
+      if (span->ptr[i]=='?')
+        i++;
+      ptrCopy[len++]=span->ptr[i];
+    }
+  }
+  else {
+    memmove(ptrCopy, span->ptr, span->length);
+    len=span->length;
+  }
+  ptrCopy[len]=0;
+
+  /* count trailing zero (like AQFINTS_Element_SetTextDataCopy) */
+  AQFINTS_Element_SetData(targetElement, ptrCopy, len+1);
 }
 
 
 
+
 int readBin(AQFINTS_ELEMENT *targetElement, const uint8_t *ptrBuf, uint32_t lenBuf)
 {
   uint32_t origLenBuf;
@@ -0,0 +1,36 @@
+/***************************************************************************
+ begin       : Sat Oct 17 2026
+ copyright   : (C) 2026 by Martin Preuss
+ email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifndef AQFINTS_PARSER_HBCI_P_H
+#define AQFINTS_PARSER_HBCI_P_H
+
+
+#include "parser_hbci.h"
+
+
+#if defined(__SSE2__) && defined(__GNUC__)
+# define AQFINTS_PARSER_HBCI_WITH_SSE2
+#endif
+
+
+/**
+ * Position of a data element inside the message buffer. The text of the element is only copied out of
+ * the buffer when it is stored into an element (and only unescaped if hasEscapes is set).
+ */
+typedef struct AQFINTS_PARSER_HBCI_SPAN AQFINTS_PARSER_HBCI_SPAN;
+struct AQFINTS_PARSER_HBCI_SPAN {
+  const uint8_t *ptr;
+  uint32_t length;   /* number of bytes in the buffer (including escape characters) */
+  int hasEscapes;
+};
+
+
+
+#endif
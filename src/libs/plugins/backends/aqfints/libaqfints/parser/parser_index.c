@@ -0,0 +1,176 @@
+/***************************************************************************
+ begin       : Sat Oct 17 2026
+ copyright   : (C) 2026 by Martin Preuss
+ email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "parser_index_p.h"
+
+#include <gwenhywfar/misc.h>
+
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static uint32_t _hashKey(const char *key);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AQFINTS_PARSER_INDEX *AQFINTS_ParserIndex_new(uint32_t expectedEntries)
+{
+  AQFINTS_PARSER_INDEX *idx;
+  uint32_t bucketCount;
+
+  /* power of two, about two buckets per entry */
+  bucketCount=AQFINTS_PARSER_INDEX_MINBUCKETS;
+  while (bucketCount<expectedEntries*2 && bucketCount<(1U<<20))
+    bucketCount<<=1;
+
+  GWEN_NEW_OBJECT(AQFINTS_PARSER_INDEX, idx);
+  idx->bucketCount=bucketCount;
+  idx->firstEntries=(AQFINTS_PARSER_INDEX_ENTRY **) calloc(bucketCount, sizeof(AQFINTS_PARSER_INDEX_ENTRY *));
+  idx->lastEntries=(AQFINTS_PARSER_INDEX_ENTRY **) calloc(bucketCount, sizeof(AQFINTS_PARSER_INDEX_ENTRY *));
+  assert(idx->firstEntries);
+  assert(idx->lastEntries);
+
+  return idx;
+}
+
+
+
+void AQFINTS_ParserIndex_free(AQFINTS_PARSER_INDEX *idx)
+{
+  if (idx) {
+    uint32_t i;
+
+    for (i=0; i<idx->bucketCount; i++) {
+      AQFINTS_PARSER_INDEX_ENTRY *entry;
+
+      entry=idx->firstEntries[i];
+      while (entry) {
+        AQFINTS_PARSER_INDEX_ENTRY *nextEntry;
+
+        nextEntry=entry->next;
+        free(entry->key);
+        GWEN_FREE_OBJECT(entry);
+        entry=nextEntry;
+      }
+    }
+    free(idx->lastEntries);
+    free(idx->firstEntries);
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+void AQFINTS_ParserIndex_Add(AQFINTS_PARSER_INDEX *idx, const char *key, void *object)
+{
+  AQFINTS_PARSER_INDEX_ENTRY *entry;
+  uint32_t bucket;
+
+  if (!(key && *key))
+    return;
+
+  GWEN_NEW_OBJECT(AQFINTS_PARSER_INDEX_ENTRY, entry);
+  entry->key=strdup(key);
+  entry->hash=_hashKey(key);
+  entry->object=object;
+
+  /* append to keep the order of the source list */
+  bucket=entry->hash & (idx->bucketCount-1);
+  if (idx->lastEntries[bucket])
+    idx->lastEntries[bucket]->next=entry;
+  else
+    idx->firstEntries[bucket]=entry;
+  idx->lastEntries[bucket]=entry;
+}
+
+
+
+AQFINTS_PARSER_INDEX_ENTRY *AQFINTS_ParserIndex_FindFirst(const AQFINTS_PARSER_INDEX *idx, const char *key)
+{
+  AQFINTS_PARSER_INDEX_ENTRY *entry;
+  uint32_t hash;
+
+  if (!(key && *key))
+    return NULL;
+
+  hash=_hashKey(key);
+  entry=idx->firstEntries[hash & (idx->bucketCount-1)];
+  while (entry) {
+    if (entry->hash==hash && strcasecmp(entry->key, key)==0)
+      return entry;
+    entry=entry->next;
+  }
+
+  return NULL;
+}
+
+
+
+AQFINTS_PARSER_INDEX_ENTRY *AQFINTS_ParserIndex_FindNext(const AQFINTS_PARSER_INDEX_ENTRY *entry)
+{
+  AQFINTS_PARSER_INDEX_ENTRY *nextEntry;
+
+  nextEntry=entry->next;
+  while (nextEntry) {
+    if (nextEntry->hash==entry->hash && strcasecmp(nextEntry->key, entry->key)==0)
+      return nextEntry;
+    nextEntry=nextEntry->next;
+  }
+
+  return NULL;
+}
+
+
+
+void *AQFINTS_ParserIndexEntry_GetObject(const AQFINTS_PARSER_INDEX_ENTRY *entry)
+{
+  return entry->object;
+}
+
+
+
+void AQFINTS_ParserIndexEntry_SetObject(AQFINTS_PARSER_INDEX_ENTRY *entry, void *object)
+{
+  entry->object=object;
+}
+
+
+
+uint32_t _hashKey(const char *key)
+{
+  uint32_t h=2166136261u;
+
+  while (*key) {
+    h^=(uint32_t) tolower((unsigned char)(*key));
+    h*=16777619u;
+    key++;
+  }
+  return h;
+}
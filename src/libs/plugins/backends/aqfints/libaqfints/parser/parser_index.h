@@ -0,0 +1,50 @@
+/***************************************************************************
+ begin       : Sat Oct 17 2026
+ copyright   : (C) 2026 by Martin Preuss
+ email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifndef AQFINTS_PARSER_INDEX_H
+#define AQFINTS_PARSER_INDEX_H
+
+
+#include <gwenhywfar/types.h>
+
+
+/**
+ * Hash index mapping case-insensitive string keys (like segment codes) to definition objects.
+ *
+ * Several objects may share a key, those are returned in the order in which they were added, so lookups
+ * through this index find the same object as a linear walk through the list the index was built from.
+ */
+typedef struct AQFINTS_PARSER_INDEX AQFINTS_PARSER_INDEX;
+typedef struct AQFINTS_PARSER_INDEX_ENTRY AQFINTS_PARSER_INDEX_ENTRY;
+
+
+AQFINTS_PARSER_INDEX *AQFINTS_ParserIndex_new(uint32_t expectedEntries);
+void AQFINTS_ParserIndex_free(AQFINTS_PARSER_INDEX *idx);
+
+/**
+ * Add an object for the given key (ignored if key is NULL or empty).
+ */
+void AQFINTS_ParserIndex_Add(AQFINTS_PARSER_INDEX *idx, const char *key, void *object);
+
+/**
+ * Return the first entry for the given key (NULL if none).
+ */
+AQFINTS_PARSER_INDEX_ENTRY *AQFINTS_ParserIndex_FindFirst(const AQFINTS_PARSER_INDEX *idx, const char *key);
+
+/**
+ * Return the entry following the given one with the same key (NULL if none).
+ */
+AQFINTS_PARSER_INDEX_ENTRY *AQFINTS_ParserIndex_FindNext(const AQFINTS_PARSER_INDEX_ENTRY *entry);
+
+void *AQFINTS_ParserIndexEntry_GetObject(const AQFINTS_PARSER_INDEX_ENTRY *entry);
+void AQFINTS_ParserIndexEntry_SetObject(AQFINTS_PARSER_INDEX_ENTRY *entry, void *object);
+
+
+#endif
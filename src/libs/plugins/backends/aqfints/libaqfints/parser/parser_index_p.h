@@ -0,0 +1,36 @@
+/***************************************************************************
+ begin       : Sat Oct 17 2026
+ copyright   : (C) 2026 by Martin Preuss
+ email       : martin@libchipcard.de
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifndef AQFINTS_PARSER_INDEX_P_H
+#define AQFINTS_PARSER_INDEX_P_H
+
+
+#include "parser_index.h"
+
+
+#define AQFINTS_PARSER_INDEX_MINBUCKETS 64
+
+
+struct AQFINTS_PARSER_INDEX_ENTRY {
+  char *key;
+  uint32_t hash;
+  void *object;
+  AQFINTS_PARSER_INDEX_ENTRY *next;
+};
+
+
+struct AQFINTS_PARSER_INDEX {
+  uint32_t bucketCount;
+  AQFINTS_PARSER_INDEX_ENTRY **firstEntries;
+  AQFINTS_PARSER_INDEX_ENTRY **lastEntries;
+};
+
+
+#endif
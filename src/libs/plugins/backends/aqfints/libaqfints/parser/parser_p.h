@@ -14,6 +14,7 @@
 
 
 #include "parser/parser.h"
+#include "parser/parser_index.h"
 
 #include <gwenhywfar/stringlist.h>
 
@@ -23,6 +24,15 @@ struct AQFINTS_PARSER {
   AQFINTS_JOBDEF_LIST *jobDefList;
   AQFINTS_SEGMENT_LIST *segmentList;
   GWEN_STRINGLIST *pathList;
+  char *cacheFile;
+
+  /* built by AQFINTS_Parser_ReadFiles() */
+  AQFINTS_PARSER_INDEX *segmentsByCode;
+  AQFINTS_PARSER_INDEX *segmentsById;
+  AQFINTS_PARSER_INDEX *segmentsHighestVersionByCode;
+  AQFINTS_PARSER_INDEX *jobDefsByCode;
+  AQFINTS_PARSER_INDEX *jobDefsById;
+  AQFINTS_PARSER_INDEX *jobDefsByParams;
 };
 
 
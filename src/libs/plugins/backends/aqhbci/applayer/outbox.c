@@ -19,6 +19,7 @@
 
 #include "aqhbci/applayer/cbox_prepare.h"
 #include "aqhbci/applayer/cbox_queue.h"
+#include "aqhbci/banking/user_l.h"
 
 #include "aqbanking/i18n_l.h"
 
@@ -26,6 +27,7 @@
 #include <gwenhywfar/gui.h>
 
 #include <assert.h>
+#include <stdlib.h>
 
 
 /*#define EXTREME_DEBUGGING */
@@ -47,6 +49,8 @@ static int _lockUsers(AH_OUTBOX *ob, AB_USER_LIST2 *lockedUsers);
 static int _unlockUsers(AH_OUTBOX *ob, AB_USER_LIST2 *lockedUsers, int abandon);
 static void _finishRemainingCustomerBoxes(AH_OUTBOX *ob);
 static AH_OUTBOX_CBOX *_findCBox(const AH_OUTBOX *ob, const AB_USER *u);
+static int _sendAndRecvCustomerBoxesParallel(AH_OUTBOX *ob, int maxCustomers, int maxPerServer);
+static void _cboxTaskRun(void *arg);
 
 
 /* ------------------------------------------------------------------------------------------------
@@ -486,9 +490,20 @@ void _finishRemainingCustomerBoxes(AH_OUTBOX *ob)
 int _sendAndRecvCustomerBoxes(AH_OUTBOX *ob)
 {
   AH_OUTBOX_CBOX *cbox;
+  AB_BANKING *ab;
+  int maxCustomers;
   int rv;
   int errors;
 
+  ab=AB_Provider_GetBanking(ob->provider);
+  maxCustomers=AB_Banking_RuntimeConfig_GetIntValue(ab, "aqhbciMaxParallelCustomers", 1);
+  if (maxCustomers>1 &&
+      AH_OutboxCBox_List_GetCount(ob->userBoxes)>1 &&
+      AB_WorkerPool_IsAvailable())
+    return _sendAndRecvCustomerBoxesParallel(ob,
+                                             maxCustomers,
+                                             AB_Banking_RuntimeConfig_GetIntValue(ab, "aqhbciMaxDialogsPerServer", 1));
+
   errors=0;
   while ((cbox=AH_OutboxCBox_List_First(ob->userBoxes))) {
     AB_USER *u;
@@ -515,6 +530,75 @@ int _sendAndRecvCustomerBoxes(AH_OUTBOX *ob)
 
 
 
+int _sendAndRecvCustomerBoxesParallel(AH_OUTBOX *ob, int maxCustomers, int maxPerServer)
+{
+  AH_OUTBOX_CBOX_TASK *tasks;
+  AB_WORKERPOOL *wp;
+  AH_OUTBOX_CBOX *cbox;
+  int taskCount;
+  int aborted=0;
+  int i;
+  int rv;
+
+  taskCount=AH_OutboxCBox_List_GetCount(ob->userBoxes);
+  tasks=(AH_OUTBOX_CBOX_TASK *) calloc(taskCount, sizeof(AH_OUTBOX_CBOX_TASK));
+  assert(tasks);
+  wp=AB_WorkerPool_new(maxCustomers, (maxPerServer>0)?maxPerServer:1);
+
+  /* customer boxes of the same server share a group to limit the number of dialogs per server */
+  i=0;
+  cbox=AH_OutboxCBox_List_First(ob->userBoxes);
+  while (cbox) {
+    const GWEN_URL *url;
+
+    url=AH_User_GetServerUrl(AH_OutboxCBox_GetUser(cbox));
+    tasks[i].cbox=cbox;
+    tasks[i].pAborted=&aborted;
+    AB_WorkerPool_AddTask(wp, _cboxTaskRun, &(tasks[i]), url?GWEN_Url_GetServer(url):NULL);
+    i++;
+    cbox=AH_OutboxCBox_List_Next(cbox);
+  }
+
+  /* The tasks share the provider, the users and "aborted". This is safe because the worker pool only lets one
+   * task at a time run library code, other tasks only proceed while a task waits for its sockets. */
+  DBG_INFO(AQHBCI_LOGDOMAIN, "Sending messages for %d customers (at most %d at once)", taskCount, maxCustomers);
+  rv=AB_WorkerPool_Run(wp);
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
+  }
+  AB_WorkerPool_free(wp);
+  free(tasks);
+
+  /* finish customer boxes in their original order on this thread after all tasks are done */
+  _finishRemainingCustomerBoxes(ob);
+
+  return aborted?GWEN_ERROR_USER_ABORTED:0;
+}
+
+
+
+void _cboxTaskRun(void *arg)
+{
+  AH_OUTBOX_CBOX_TASK *task;
+  AB_USER *u;
+
+  task=(AH_OUTBOX_CBOX_TASK *) arg;
+  if (*(task->pAborted)) {
+    /* user aborted another customer box, don't start any new dialogs */
+    task->result=GWEN_ERROR_USER_ABORTED;
+    return;
+  }
+
+  u=AH_OutboxCBox_GetUser(task->cbox);
+  DBG_INFO(AQHBCI_LOGDOMAIN,
+           "Sending messages for customer \"%s\"",
+           AB_User_GetCustomerId(u));
+  task->result=AH_OutboxCBox_SendAndRecvBox(task->cbox);
+  if (task->result==GWEN_ERROR_USER_ABORTED)
+    *(task->pAborted)=1;
+}
+
+
 unsigned int _countTodoJobs(AH_OUTBOX *ob)
 {
   unsigned int cnt;
@@ -16,6 +16,8 @@
 #include "aqhbci/joblayer/jobqueue_l.h"
 #include "aqhbci/applayer/cbox.h"
 
+#include "aqbanking/backendsupport/workerpool.h"
+
 #include <gwenhywfar/inherit.h>
 
 
@@ -31,6 +33,17 @@ struct AH_OUTBOX {
 
 
 
+/** arguments for a worker pool task sending and receiving the messages of one customer box
+ * (pAborted is shared by all tasks, it is only accessed while holding the lock of the worker pool) */
+typedef struct AH_OUTBOX_CBOX_TASK AH_OUTBOX_CBOX_TASK;
+struct AH_OUTBOX_CBOX_TASK {
+  AH_OUTBOX_CBOX *cbox;
+  int *pAborted;
+  int result;
+};
+
+
+
 #endif /* AH_OUTBOX_P_H */
 
 
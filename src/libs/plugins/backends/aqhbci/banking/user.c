@@ -167,6 +167,7 @@ AB_USER *AH_User_new(AB_PROVIDER *pro)
   GWEN_MsgEngine_SetCharsToEscape(ue->msgEngine, ":+\'@");
   AH_MsgEngine_SetUser(ue->msgEngine, u);
   GWEN_MsgEngine_SetDefinitions(ue->msgEngine, AH_HBCI_GetDefinitions(ue->hbci), 0);
+  AH_MsgEngine_SetDefIndex(ue->msgEngine, AH_HBCI_GetDefIndex(ue->hbci));
 
   ue->hbciVersion=210;
   ue->bpd=AH_Bpd_new();
@@ -163,7 +163,7 @@ GWEN_XMLNODE *_jobGetJobNode(const AH_JOB *j, int jobVersion)
   int rv;
   int realJobVersion=0;
 
-  node=GWEN_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", 0, j->name);
+  node=AH_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", 0, j->name);
   if (!node) {
     DBG_INFO(AQHBCI_LOGDOMAIN, "Job \"%s\" not supported by local XML files", j->name);
     return NULL;
@@ -192,7 +192,7 @@ GWEN_XMLNODE *_jobGetJobNode(const AH_JOB *j, int jobVersion)
     return NULL;
   }
 
-  node=GWEN_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", realJobVersion, j->name);
+  node=AH_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", realJobVersion, j->name);
   if (node==NULL) {
     DBG_INFO(AQHBCI_LOGDOMAIN, "Job node \"%s\"[%d] not found", j->name, realJobVersion);
     return NULL;
@@ -240,6 +240,7 @@ int _jobGetBpdParamsForVersion(const AH_JOB *j, const char *paramName, int jobVe
   GWEN_DB_NODE *bpdgrp;
   GWEN_DB_NODE *jobBPD;
   int highestVersion;
+  int highestLocalVersion;
 
   DBG_INFO(AQHBCI_LOGDOMAIN, "Searching BPD job \"%s\" for Job \"%s\" (version %d)", paramName, j->name, jobVersion);
 
@@ -279,7 +280,7 @@ int _jobGetBpdParamsForVersion(const AH_JOB *j, const char *paramName, int jobVe
 
         /* now get the correct version of the JOB */
         DBG_INFO(AQHBCI_LOGDOMAIN, "Checking whether job %s (%d) can be instantiated", j->name, version);
-        node=GWEN_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", version, j->name);
+        node=AH_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", version, j->name);
         if (node) {
           DBG_INFO(AQHBCI_LOGDOMAIN, "Found BPD job");
           highestVersion=version;
@@ -290,18 +291,21 @@ int _jobGetBpdParamsForVersion(const AH_JOB *j, const char *paramName, int jobVe
     } /* while */
   }
   else {
+    /* versions above the highest one defined in the XML files can't be instantiated anyway
+     * (negative if unknown) */
+    highestLocalVersion=AH_MsgEngine_GetHighestNodeVersion(j->msgEngine, "JOB", "id", j->name);
     while (jobBPD) {
       int version;
 
       /* get version from BPD */
       version=atoi(GWEN_DB_GroupName(jobBPD));
       DBG_INFO(AQHBCI_LOGDOMAIN, "Checking Job %s (%d)", j->name, version);
-      if (version>highestVersion) {
+      if (version>highestVersion && (highestLocalVersion<0 || version<=highestLocalVersion)) {
         GWEN_XMLNODE *node;
 
         /* now get the correct version of the JOB */
         DBG_INFO(AQHBCI_LOGDOMAIN, "Checking whether job %s (%d) can be instantiated", j->name, version);
-        node=GWEN_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", version, j->name);
+        node=AH_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", version, j->name);
         if (node) {
           DBG_INFO(AQHBCI_LOGDOMAIN, "Found BPD job candidate version %d", version);
           highestVersion=version;
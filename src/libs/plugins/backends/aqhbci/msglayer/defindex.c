@@ -0,0 +1,367 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "defindex_p.h"
+#include "aqhbci_l.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void _addType(AH_DEFINDEX *idx, const char *t);
+static void _addEntry(AH_DEFINDEX *idx, const char *t, const char *pname, const char *pvalue, GWEN_XMLNODE *node);
+static GWEN_XMLNODE *_findContainer(GWEN_XMLNODE *defs, const char *t);
+static int _isDefinitionTag(const GWEN_XMLNODE *node, const char *t);
+static const AH_DEFINDEX_ENTRY *_findFirstEntry(const AH_DEFINDEX *idx,
+                                                const char *t,
+                                                const char *pname,
+                                                const char *pvalue,
+                                                uint32_t *pHash);
+static const AH_DEFINDEX_ENTRY *_findNextEntry(const AH_DEFINDEX_ENTRY *entry,
+                                               const char *t,
+                                               const char *pname,
+                                               const char *pvalue,
+                                               uint32_t hash);
+static int _entryMatches(const AH_DEFINDEX_ENTRY *entry, int protocolVersion, const char *mode);
+static uint32_t _hashKey(const char *t, const char *pname, const char *pvalue);
+static uint32_t _hashString(uint32_t hash, const char *s);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * static vars
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static const char *_indexedTypes[]= {"SEG", "JOB", "GROUP", NULL};
+static const char *_indexedProperties[]= {"id", "code", NULL};
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AH_DEFINDEX *AH_DefIndex_new(GWEN_XMLNODE *defs)
+{
+  AH_DEFINDEX *idx;
+  int i;
+
+  assert(defs);
+
+  GWEN_NEW_OBJECT(AH_DEFINDEX, idx);
+  idx->defs=defs;
+
+  for (i=0; _indexedTypes[i]; i++)
+    _addType(idx, _indexedTypes[i]);
+
+  DBG_INFO(AQHBCI_LOGDOMAIN, "Indexed %u definitions", idx->entryCount);
+  return idx;
+}
+
+
+
+void AH_DefIndex_free(AH_DEFINDEX *idx)
+{
+  if (idx) {
+    int i;
+
+    for (i=0; i<AH_DEFINDEX_BUCKETS; i++) {
+      AH_DEFINDEX_ENTRY *entry;
+
+      entry=idx->firstEntries[i];
+      while (entry) {
+        AH_DEFINDEX_ENTRY *next;
+
+        next=entry->next;
+        GWEN_FREE_OBJECT(entry);
+        entry=next;
+      }
+    }
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+const GWEN_XMLNODE *AH_DefIndex_GetDefinitions(const AH_DEFINDEX *idx)
+{
+  assert(idx);
+  return idx->defs;
+}
+
+
+
+int AH_DefIndex_IsIndexed(const AH_DEFINDEX *idx, const char *t, const char *pname)
+{
+  int tFound=0;
+  int i;
+
+  assert(idx);
+  if (!(t && *t && pname && *pname))
+    return 0;
+
+  for (i=0; _indexedTypes[i]; i++) {
+    if (strcasecmp(t, _indexedTypes[i])==0) {
+      tFound=1;
+      break;
+    }
+  }
+  if (tFound) {
+    for (i=0; _indexedProperties[i]; i++) {
+      if (strcmp(pname, _indexedProperties[i])==0)
+        return 1;
+    }
+  }
+
+  return 0;
+}
+
+
+
+GWEN_XMLNODE *AH_DefIndex_FindNode(const AH_DEFINDEX *idx,
+                                   const char *t,
+                                   const char *pname,
+                                   int version,
+                                   const char *pvalue,
+                                   int protocolVersion,
+                                   const char *mode)
+{
+  const AH_DEFINDEX_ENTRY *entry;
+  uint32_t hash;
+
+  assert(idx);
+  entry=_findFirstEntry(idx, t, pname, pvalue, &hash);
+  while (entry) {
+    if ((version==0 || version==entry->version) && _entryMatches(entry, protocolVersion, mode))
+      return entry->node;
+    entry=_findNextEntry(entry, t, pname, pvalue, hash);
+  }
+
+  return NULL;
+}
+
+
+
+int AH_DefIndex_GetHighestVersion(const AH_DEFINDEX *idx,
+                                  const char *t,
+                                  const char *pname,
+                                  const char *pvalue,
+                                  int protocolVersion,
+                                  const char *mode)
+{
+  const AH_DEFINDEX_ENTRY *entry;
+  uint32_t hash;
+  int highestVersion=0;
+
+  assert(idx);
+  entry=_findFirstEntry(idx, t, pname, pvalue, &hash);
+  while (entry) {
+    if (entry->version>highestVersion && _entryMatches(entry, protocolVersion, mode))
+      highestVersion=entry->version;
+    entry=_findNextEntry(entry, t, pname, pvalue, hash);
+  }
+
+  return highestVersion;
+}
+
+
+
+void _addType(AH_DEFINDEX *idx, const char *t)
+{
+  GWEN_XMLNODE *node;
+
+  /* only the first container is searched by GWEN_MsgEngine_FindNodeByProperty(), too */
+  node=_findContainer(idx->defs, t);
+  if (node==NULL) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "No definitions for type \"%s\"", t);
+    return;
+  }
+
+  node=GWEN_XMLNode_GetFirstTag(node);
+  while (node) {
+    if (_isDefinitionTag(node, t)) {
+      int i;
+
+      for (i=0; _indexedProperties[i]; i++)
+        _addEntry(idx, t, _indexedProperties[i], GWEN_XMLNode_GetProperty(node, _indexedProperties[i], NULL), node);
+    }
+    node=GWEN_XMLNode_GetNextTag(node);
+  }
+}
+
+
+
+void _addEntry(AH_DEFINDEX *idx, const char *t, const char *pname, const char *pvalue, GWEN_XMLNODE *node)
+{
+  AH_DEFINDEX_ENTRY *entry;
+  uint32_t bucket;
+
+  if (!(pvalue && *pvalue))
+    return;
+
+  GWEN_NEW_OBJECT(AH_DEFINDEX_ENTRY, entry);
+  entry->type=t;
+  entry->pname=pname;
+  entry->pvalue=pvalue;
+  entry->hash=_hashKey(t, pname, pvalue);
+  entry->node=node;
+  entry->version=atoi(GWEN_XMLNode_GetProperty(node, "version", "0"));
+  entry->protocolVersion=atoi(GWEN_XMLNode_GetProperty(node, "pversion", "0"));
+  entry->mode=GWEN_XMLNode_GetProperty(node, "mode", "");
+
+  /* append to keep the document order of nodes with the same key */
+  bucket=entry->hash & (AH_DEFINDEX_BUCKETS-1);
+  if (idx->lastEntries[bucket])
+    idx->lastEntries[bucket]->next=entry;
+  else
+    idx->firstEntries[bucket]=entry;
+  idx->lastEntries[bucket]=entry;
+  idx->entryCount++;
+}
+
+
+
+GWEN_XMLNODE *_findContainer(GWEN_XMLNODE *defs, const char *t)
+{
+  GWEN_XMLNODE *node;
+  size_t len;
+
+  len=strlen(t);
+  node=GWEN_XMLNode_GetFirstTag(defs);
+  while (node) {
+    const char *s;
+
+    s=GWEN_XMLNode_GetData(node);
+    if (s && strncasecmp(s, t, len)==0 && strcasecmp(s+len, "S")==0)
+      return node;
+    node=GWEN_XMLNode_GetNextTag(node);
+  }
+
+  return NULL;
+}
+
+
+
+int _isDefinitionTag(const GWEN_XMLNODE *node, const char *t)
+{
+  const char *s;
+  size_t len;
+
+  s=GWEN_XMLNode_GetData(node);
+  if (s==NULL)
+    return 0;
+
+  /* accept "SEG" and "SEGdef" */
+  len=strlen(t);
+  return (strncasecmp(s, t, len)==0 && (s[len]==0 || strcasecmp(s+len, "def")==0));
+}
+
+
+
+const AH_DEFINDEX_ENTRY *_findFirstEntry(const AH_DEFINDEX *idx,
+                                         const char *t,
+                                         const char *pname,
+                                         const char *pvalue,
+                                         uint32_t *pHash)
+{
+  const AH_DEFINDEX_ENTRY *entry;
+  uint32_t hash;
+
+  if (!(t && pname && pvalue && *pvalue))
+    return NULL;
+
+  hash=_hashKey(t, pname, pvalue);
+  *pHash=hash;
+  entry=idx->firstEntries[hash & (AH_DEFINDEX_BUCKETS-1)];
+  if (entry && !(entry->hash==hash &&
+                 strcasecmp(entry->pvalue, pvalue)==0 &&
+                 strcmp(entry->pname, pname)==0 &&
+                 strcasecmp(entry->type, t)==0))
+    entry=_findNextEntry(entry, t, pname, pvalue, hash);
+  return entry;
+}
+
+
+
+const AH_DEFINDEX_ENTRY *_findNextEntry(const AH_DEFINDEX_ENTRY *entry,
+                                        const char *t,
+                                        const char *pname,
+                                        const char *pvalue,
+                                        uint32_t hash)
+{
+  entry=entry->next;
+  while (entry) {
+    if (entry->hash==hash &&
+        strcasecmp(entry->pvalue, pvalue)==0 &&
+        strcmp(entry->pname, pname)==0 &&
+        strcasecmp(entry->type, t)==0)
+      return entry;
+    entry=entry->next;
+  }
+
+  return NULL;
+}
+
+
+
+int _entryMatches(const AH_DEFINDEX_ENTRY *entry, int protocolVersion, const char *mode)
+{
+  /* same checks as in GWEN_MsgEngine_FindNodeByProperty() */
+  if (!(protocolVersion==0 || entry->protocolVersion==0 || protocolVersion==entry->protocolVersion))
+    return 0;
+  if (*(entry->mode) && strcasecmp(entry->mode, mode?mode:"")!=0)
+    return 0;
+  return 1;
+}
+
+
+
+uint32_t _hashKey(const char *t, const char *pname, const char *pvalue)
+{
+  uint32_t hash=2166136261u;
+
+  hash=_hashString(hash, t);
+  hash=_hashString(hash, pname);
+  hash=_hashString(hash, pvalue);
+  return hash;
+}
+
+
+
+uint32_t _hashString(uint32_t hash, const char *s)
+{
+  while (*s) {
+    hash^=(uint32_t) tolower((unsigned char) *(s++));
+    hash*=16777619u;
+  }
+  /* separator */
+  hash^=0xff;
+  hash*=16777619u;
+  return hash;
+}
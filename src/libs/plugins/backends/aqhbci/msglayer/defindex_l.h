@@ -0,0 +1,65 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifndef AH_DEFINDEX_L_H
+#define AH_DEFINDEX_L_H
+
+
+#include <gwenhywfar/xml.h>
+
+
+/**
+ * Hash index over the XML definitions of AqHBCI (see @ref AH_HBCI_GetDefinitions).
+ *
+ * The definitions of SEG, JOB and GROUP nodes are indexed by their properties "id" and "code".
+ * Lookups return the same node as GWEN_MsgEngine_FindNodeByProperty() would by walking the XML tree
+ * (nodes sharing a key are kept in document order and filtered by version, protocol version and mode).
+ */
+typedef struct AH_DEFINDEX AH_DEFINDEX;
+
+
+AH_DEFINDEX *AH_DefIndex_new(GWEN_XMLNODE *defs);
+void AH_DefIndex_free(AH_DEFINDEX *idx);
+
+/**
+ * Returns the definitions for which this index has been created.
+ */
+const GWEN_XMLNODE *AH_DefIndex_GetDefinitions(const AH_DEFINDEX *idx);
+
+/**
+ * Check whether lookups by the given type (e.g. "SEG") and property name (e.g. "code") are
+ * handled by this index.
+ */
+int AH_DefIndex_IsIndexed(const AH_DEFINDEX *idx, const char *t, const char *pname);
+
+/**
+ * Find a definition node (same arguments and semantics as GWEN_MsgEngine_FindNodeByProperty() plus the
+ * protocol version and mode of the message engine).
+ */
+GWEN_XMLNODE *AH_DefIndex_FindNode(const AH_DEFINDEX *idx,
+                                   const char *t,
+                                   const char *pname,
+                                   int version,
+                                   const char *pvalue,
+                                   int protocolVersion,
+                                   const char *mode);
+
+/**
+ * Return the highest version of a definition node available for the given protocol version and mode
+ * (or 0 if there is none).
+ */
+int AH_DefIndex_GetHighestVersion(const AH_DEFINDEX *idx,
+                                  const char *t,
+                                  const char *pname,
+                                  const char *pvalue,
+                                  int protocolVersion,
+                                  const char *mode);
+
+
+#endif
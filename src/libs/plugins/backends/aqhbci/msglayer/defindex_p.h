@@ -0,0 +1,41 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifndef AH_DEFINDEX_P_H
+#define AH_DEFINDEX_P_H
+
+#include "defindex_l.h"
+
+
+#define AH_DEFINDEX_BUCKETS 1024
+
+
+typedef struct AH_DEFINDEX_ENTRY AH_DEFINDEX_ENTRY;
+struct AH_DEFINDEX_ENTRY {
+  const char *type;         /* one of the indexed types (e.g. "SEG") */
+  const char *pname;        /* one of the indexed properties (e.g. "code") */
+  const char *pvalue;       /* value of that property (points into the node) */
+  uint32_t hash;            /* case-insensitive hash over type, pname and pvalue */
+  GWEN_XMLNODE *node;
+  int version;              /* property "version" of the node */
+  int protocolVersion;      /* property "pversion" of the node (0 for any) */
+  const char *mode;         /* property "mode" of the node (points into the node, empty for any) */
+  AH_DEFINDEX_ENTRY *next;  /* next entry in the same bucket */
+};
+
+
+struct AH_DEFINDEX {
+  GWEN_XMLNODE *defs;
+  AH_DEFINDEX_ENTRY *firstEntries[AH_DEFINDEX_BUCKETS];
+  AH_DEFINDEX_ENTRY *lastEntries[AH_DEFINDEX_BUCKETS];
+  uint32_t entryCount;
+};
+
+
+#endif
@@ -91,6 +91,7 @@ void AH_HBCI_free(AH_HBCI *hbci)
 
     free(hbci->productVersion);
 
+    AH_DefIndex_free(hbci->defIndex);
     GWEN_XMLNode_free(hbci->defs);
 
     GWEN_FREE_OBJECT(hbci);
@@ -148,6 +149,10 @@ int AH_HBCI_Init(AH_HBCI *hbci, GWEN_DB_NODE *db)
   }
   GWEN_XMLNode_free(node);
 
+  /* index definitions for faster lookups by message engines */
+  AH_DefIndex_free(hbci->defIndex);
+  hbci->defIndex=AH_DefIndex_new(hbci->defs);
+
   hbci->sharedRuntimeData=GWEN_DB_Group_new("sharedRuntimeData");
 
   hbci->transferTimeout=GWEN_DB_GetIntValue(db, "transferTimeout", 0,
@@ -180,6 +185,8 @@ int AH_HBCI_Fini(AH_HBCI *hbci, GWEN_DB_NODE *db)
   GWEN_DB_Group_free(hbci->sharedRuntimeData);
   hbci->sharedRuntimeData=0;
 
+  AH_DefIndex_free(hbci->defIndex);
+  hbci->defIndex=NULL;
   GWEN_XMLNode_free(hbci->defs);
   hbci->defs=0;
 
@@ -262,6 +269,14 @@ GWEN_XMLNODE *AH_HBCI_GetDefinitions(const AH_HBCI *hbci)
 }
 
 
+
+const AH_DEFINDEX *AH_HBCI_GetDefIndex(const AH_HBCI *hbci)
+{
+  assert(hbci);
+  return hbci->defIndex;
+}
+
+
 GWEN_XMLNODE *AH_HBCI_LoadDefaultXmlFiles(const AH_HBCI *hbci)
 {
   GWEN_STRINGLIST *paths;
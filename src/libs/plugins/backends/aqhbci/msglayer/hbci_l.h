@@ -17,6 +17,7 @@
 #include <gwenhywfar/ct.h>
 
 #include "aqhbci.h"
+#include "defindex_l.h"
 
 #include <aqbanking/banking.h>
 
@@ -66,6 +67,11 @@ void AH_HBCI_AppendUniqueName(AH_HBCI *hbci, GWEN_BUFFER *nbuf);
 
 GWEN_XMLNODE *AH_HBCI_GetDefinitions(const AH_HBCI *hbci);
 
+/**
+ * Returns the index over the definitions (built by @ref AH_HBCI_Init, NULL before).
+ */
+const AH_DEFINDEX *AH_HBCI_GetDefIndex(const AH_HBCI *hbci);
+
 
 uint32_t AH_HBCI_GetLastVersion(const AH_HBCI *hbci);
 
@@ -34,6 +34,7 @@ struct AH_HBCI {
   char *productVersion;
 
   GWEN_XMLNODE *defs;
+  AH_DEFINDEX *defIndex;
 
   uint32_t counter;
 
@@ -691,10 +691,10 @@ int AH_Msg_ReadSegment(AH_MSG *msg,
 
   /* find head segment description */
   tmpdb=GWEN_DB_Group_new("head");
-  node=GWEN_MsgEngine_FindGroupByProperty(e,
-                                          "id",
-                                          0,
-                                          "SegHead");
+  node=AH_MsgEngine_FindGroupByProperty(e,
+                                        "id",
+                                        0,
+                                        "SegHead");
   if (node==0) {
     DBG_ERROR(AQHBCI_LOGDOMAIN, "Segment description not found (internal error)");
     GWEN_DB_Group_free(tmpdb);
@@ -738,11 +738,11 @@ int AH_Msg_ReadSegment(AH_MSG *msg,
   }
 
   /* try to find corresponding XML node */
-  node=GWEN_MsgEngine_FindNodeByProperty(e,
-                                         gtype,
-                                         "code",
-                                         segVer,
-                                         p);
+  node=AH_MsgEngine_FindNodeByProperty(e,
+                                       gtype,
+                                       "code",
+                                       segVer,
+                                       p);
   if (node==0) {
     GWEN_DB_NODE *storegrp;
     unsigned int startPos;
@@ -478,6 +478,91 @@ void AH_MsgEngine_SetUser(GWEN_MSGENGINE *e, AB_USER *u)
 
 
 
+void AH_MsgEngine_SetDefIndex(GWEN_MSGENGINE *e, const AH_DEFINDEX *idx)
+{
+  AH_MSGENGINE *x;
+
+  assert(e);
+  x=GWEN_INHERIT_GETDATA(GWEN_MSGENGINE, AH_MSGENGINE, e);
+  assert(x);
+  x->defIndex=idx;
+}
+
+
+
+const AH_DEFINDEX *AH_MsgEngine_GetUsableDefIndex(GWEN_MSGENGINE *e,
+                                                  const char *t,
+                                                  const char *pname,
+                                                  const char *pvalue)
+{
+  AH_MSGENGINE *x;
+
+  assert(e);
+  x=GWEN_INHERIT_GETDATA(GWEN_MSGENGINE, AH_MSGENGINE, e);
+  assert(x);
+
+  if (x->defIndex &&
+      pvalue && *pvalue &&
+      AH_DefIndex_GetDefinitions(x->defIndex)==GWEN_MsgEngine_GetDefinitions(e) &&
+      AH_DefIndex_IsIndexed(x->defIndex, t, pname))
+    return x->defIndex;
+  return NULL;
+}
+
+
+
+GWEN_XMLNODE *AH_MsgEngine_FindNodeByProperty(GWEN_MSGENGINE *e,
+                                              const char *t,
+                                              const char *pname,
+                                              int version,
+                                              const char *pvalue)
+{
+  const AH_DEFINDEX *idx;
+
+  idx=AH_MsgEngine_GetUsableDefIndex(e, t, pname, pvalue);
+  if (idx)
+    return AH_DefIndex_FindNode(idx, t, pname, version, pvalue,
+                                (int) GWEN_MsgEngine_GetProtocolVersion(e),
+                                GWEN_MsgEngine_GetMode(e));
+  return GWEN_MsgEngine_FindNodeByProperty(e, t, pname, version, pvalue);
+}
+
+
+
+GWEN_XMLNODE *AH_MsgEngine_FindGroupByProperty(GWEN_MSGENGINE *e,
+                                               const char *pname,
+                                               int version,
+                                               const char *pvalue)
+{
+  const AH_DEFINDEX *idx;
+
+  idx=AH_MsgEngine_GetUsableDefIndex(e, "GROUP", pname, pvalue);
+  if (idx)
+    return AH_DefIndex_FindNode(idx, "GROUP", pname, version, pvalue,
+                                (int) GWEN_MsgEngine_GetProtocolVersion(e),
+                                GWEN_MsgEngine_GetMode(e));
+  return GWEN_MsgEngine_FindGroupByProperty(e, pname, version, pvalue);
+}
+
+
+
+int AH_MsgEngine_GetHighestNodeVersion(GWEN_MSGENGINE *e,
+                                       const char *t,
+                                       const char *pname,
+                                       const char *pvalue)
+{
+  const AH_DEFINDEX *idx;
+
+  idx=AH_MsgEngine_GetUsableDefIndex(e, t, pname, pvalue);
+  if (idx)
+    return AH_DefIndex_GetHighestVersion(idx, t, pname, pvalue,
+                                         (int) GWEN_MsgEngine_GetProtocolVersion(e),
+                                         GWEN_MsgEngine_GetMode(e));
+  return GWEN_ERROR_NOT_AVAILABLE;
+}
+
+
+
 GWEN_MSGENGINE *AH_MsgEngine_new()
 {
   GWEN_MSGENGINE *e;
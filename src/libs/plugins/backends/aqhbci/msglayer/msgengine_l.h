@@ -14,8 +14,42 @@
 #define AH_MSGENGINE_L_H
 
 #include "msgengine.h"
+#include "defindex_l.h"
 
 void AH_MsgEngine_SetUser(GWEN_MSGENGINE *e, AB_USER *u);
 
+/**
+ * Set an index over the definitions of the message engine (see @ref AH_HBCI_GetDefIndex).
+ * The index is only used as long as it belongs to the definitions currently set.
+ */
+void AH_MsgEngine_SetDefIndex(GWEN_MSGENGINE *e, const AH_DEFINDEX *idx);
+
+/**
+ * Like GWEN_MsgEngine_FindNodeByProperty() but uses the definition index if possible.
+ */
+GWEN_XMLNODE *AH_MsgEngine_FindNodeByProperty(GWEN_MSGENGINE *e,
+                                              const char *t,
+                                              const char *pname,
+                                              int version,
+                                              const char *pvalue);
+
+/**
+ * Like GWEN_MsgEngine_FindGroupByProperty() but uses the definition index if possible.
+ */
+GWEN_XMLNODE *AH_MsgEngine_FindGroupByProperty(GWEN_MSGENGINE *e,
+                                               const char *pname,
+                                               int version,
+                                               const char *pvalue);
+
+/**
+ * Return the highest version of the given node available for the current protocol version and mode.
+ *
+ * @return version (0 if none), GWEN_ERROR_NOT_AVAILABLE if there is no index to determine it
+ */
+int AH_MsgEngine_GetHighestNodeVersion(GWEN_MSGENGINE *e,
+                                       const char *t,
+                                       const char *pname,
+                                       const char *pvalue);
+
 #endif /* AH_MSGENGINE_H */
 
@@ -19,6 +19,7 @@
 
 struct AH_MSGENGINE {
   AB_USER *user;
+  const AH_DEFINDEX *defIndex;
 };
 
 
@@ -51,6 +52,11 @@ static void AH_MsgEngine_Data_free(AH_MSGENGINE *x);
 
 static void GWENHYWFAR_CB AH_MsgEngine_FreeData(void *bp, void *p);
 
+static const AH_DEFINDEX *AH_MsgEngine_GetUsableDefIndex(GWEN_MSGENGINE *e,
+                                                         const char *t,
+                                                         const char *pname,
+                                                         const char *pvalue);
+
 
 
 #endif /* AH_MSGENGINE_P_H */
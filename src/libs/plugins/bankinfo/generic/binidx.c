@@ -0,0 +1,367 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "binidx_p.h"
+
+#include <aqbanking/error.h>
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+#include <gwenhywfar/error.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+# include <sys/mman.h>
+# define AB_BANKINFO_BINIDX_USE_MMAP
+#endif
+
+#ifndef O_BINARY
+# define O_BINARY 0
+#endif
+
+
+
+static int _checkHeader(AB_BANKINFO_BINIDX *idx, const char *fname);
+static void _makeKey(const char *s, uint8_t *keyBuf, uint32_t keySize);
+static uint32_t _readUint32(const uint8_t *p);
+static uint16_t _readUint16(const uint8_t *p);
+
+
+
+
+
+AB_BANKINFO_BINIDX *AB_BankInfoBinIndex_Open(const char *fname)
+{
+  AB_BANKINFO_BINIDX *idx;
+  int rv;
+
+  GWEN_NEW_OBJECT(AB_BANKINFO_BINIDX, idx);
+  rv=AB_BankInfoIndex_MapFile(fname, &(idx->dataPtr), &(idx->dataSize), &(idx->isMapped));
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Binary index \"%s\" not available (%d)", fname, rv);
+    AB_BankInfoBinIndex_free(idx);
+    return NULL;
+  }
+
+  rv=_checkHeader(idx, fname);
+  if (rv<0) {
+    DBG_WARN(AQBANKING_LOGDOMAIN, "Ignoring invalid binary index \"%s\" (%d)", fname, rv);
+    AB_BankInfoBinIndex_free(idx);
+    return NULL;
+  }
+
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Using binary index \"%s\" (%u records)", fname, idx->recordCount);
+  return idx;
+}
+
+
+
+void AB_BankInfoBinIndex_free(AB_BANKINFO_BINIDX *idx)
+{
+  if (idx) {
+    AB_BankInfoIndex_UnmapFile(idx->dataPtr, idx->dataSize, idx->isMapped);
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+uint32_t AB_BankInfoBinIndex_GetCount(const AB_BANKINFO_BINIDX *idx)
+{
+  assert(idx);
+  return idx->recordCount;
+}
+
+
+
+uint32_t AB_BankInfoBinIndex_GetOffset(const AB_BANKINFO_BINIDX *idx, uint32_t recordNum)
+{
+  assert(idx);
+  assert(recordNum<idx->recordCount);
+  return _readUint32(idx->records+(recordNum*idx->recordSize)+idx->keySize);
+}
+
+
+
+int AB_BankInfoBinIndex_FindRange(const AB_BANKINFO_BINIDX *idx, const char *key, uint32_t *pFirst, uint32_t *pCount)
+{
+  uint8_t keyBuf[AB_BANKINFO_BINIDX_MAX_KEYSIZE];
+  uint32_t lo, hi, first;
+
+  assert(idx);
+  assert(key);
+
+  if (strlen(key)>idx->keySize)
+    return GWEN_ERROR_NOT_FOUND;
+  _makeKey(key, keyBuf, idx->keySize);
+
+  /* find lower bound */
+  lo=0;
+  hi=idx->recordCount;
+  while (lo<hi) {
+    uint32_t mid;
+
+    mid=lo+((hi-lo)/2);
+    if (memcmp(idx->records+(mid*idx->recordSize), keyBuf, idx->keySize)<0)
+      lo=mid+1;
+    else
+      hi=mid;
+  }
+  if (lo>=idx->recordCount || memcmp(idx->records+(lo*idx->recordSize), keyBuf, idx->keySize)!=0)
+    return GWEN_ERROR_NOT_FOUND;
+  first=lo;
+
+  /* find upper bound */
+  hi=idx->recordCount;
+  while (lo<hi) {
+    uint32_t mid;
+
+    mid=lo+((hi-lo)/2);
+    if (memcmp(idx->records+(mid*idx->recordSize), keyBuf, idx->keySize)<=0)
+      lo=mid+1;
+    else
+      hi=mid;
+  }
+
+  *pFirst=first;
+  *pCount=lo-first;
+  return 0;
+}
+
+
+
+int AB_BankInfoBinIndex_FindPrefixRange(const AB_BANKINFO_BINIDX *idx, const char *prefix, uint32_t *pFirst, uint32_t *pCount)
+{
+  uint8_t keyBuf[AB_BANKINFO_BINIDX_MAX_KEYSIZE];
+  uint32_t prefixLen;
+  uint32_t lo, hi, first;
+
+  assert(idx);
+  assert(prefix);
+
+  prefixLen=strlen(prefix);
+  if (prefixLen>idx->keySize)
+    return GWEN_ERROR_NOT_FOUND;
+  _makeKey(prefix, keyBuf, idx->keySize);
+
+  /* find lower bound (padding NULs sort before any other character) */
+  lo=0;
+  hi=idx->recordCount;
+  while (lo<hi) {
+    uint32_t mid;
+
+    mid=lo+((hi-lo)/2);
+    if (memcmp(idx->records+(mid*idx->recordSize), keyBuf, idx->keySize)<0)
+      lo=mid+1;
+    else
+      hi=mid;
+  }
+  first=lo;
+
+  /* find end of the range of records starting with the prefix */
+  hi=idx->recordCount;
+  while (lo<hi) {
+    uint32_t mid;
+
+    mid=lo+((hi-lo)/2);
+    if (memcmp(idx->records+(mid*idx->recordSize), keyBuf, prefixLen)<=0)
+      lo=mid+1;
+    else
+      hi=mid;
+  }
+
+  if (lo==first)
+    return GWEN_ERROR_NOT_FOUND;
+
+  *pFirst=first;
+  *pCount=lo-first;
+  return 0;
+}
+
+
+
+int AB_BankInfoBinIndex_IsPrefixPattern(const char *s)
+{
+  const char *p;
+
+  if (s==NULL || *s==0 || *s=='*')
+    return 0;
+  p=strpbrk(s, "*?");
+  return (p && *p=='*' && p[1]==0)?1:0;
+}
+
+
+
+int AB_BankInfoBinIndex_HasWildcards(const char *s)
+{
+  return (s && strpbrk(s, "*?")!=NULL)?1:0;
+}
+
+
+
+int AB_BankInfoIndex_MapFile(const char *fname, uint8_t **pDataPtr, size_t *pDataSize, int *pIsMapped)
+{
+  int fd;
+  struct stat st;
+  uint8_t *dataPtr;
+  size_t dataSize;
+
+  fd=open(fname, O_RDONLY | O_BINARY);
+  if (fd==-1)
+    return GWEN_ERROR_NOT_FOUND;
+
+  if (fstat(fd, &st)==-1) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "fstat(%s): %s", fname, strerror(errno));
+    close(fd);
+    return GWEN_ERROR_IO;
+  }
+  if (st.st_size<AB_BANKINFO_BINIDX_HEADER_SIZE) {
+    close(fd);
+    return GWEN_ERROR_BAD_DATA;
+  }
+  dataSize=(size_t) st.st_size;
+
+#ifdef AB_BANKINFO_BINIDX_USE_MMAP
+  {
+    void *p;
+
+    p=mmap(NULL, dataSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (p!=MAP_FAILED) {
+      close(fd);
+      *pDataPtr=(uint8_t *) p;
+      *pDataSize=dataSize;
+      *pIsMapped=1;
+      return 0;
+    }
+    DBG_INFO(AQBANKING_LOGDOMAIN, "mmap(%s): %s, reading file instead", fname, strerror(errno));
+  }
+#endif
+
+  /* no mmap available, read the whole file once */
+  dataPtr=(uint8_t *) malloc(dataSize);
+  if (dataPtr==NULL) {
+    close(fd);
+    return GWEN_ERROR_MEMORY_FULL;
+  }
+  else {
+    size_t bytesRead=0;
+
+    while (bytesRead<dataSize) {
+      ssize_t rv;
+
+      rv=read(fd, dataPtr+bytesRead, dataSize-bytesRead);
+      if (rv<0 && errno==EINTR)
+        continue;
+      if (rv<=0) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "read(%s): %s", fname, strerror(errno));
+        close(fd);
+        free(dataPtr);
+        return GWEN_ERROR_IO;
+      }
+      bytesRead+=(size_t) rv;
+    }
+  }
+  close(fd);
+  *pDataPtr=dataPtr;
+  *pDataSize=dataSize;
+  *pIsMapped=0;
+  return 0;
+}
+
+
+
+void AB_BankInfoIndex_UnmapFile(uint8_t *dataPtr, size_t dataSize, int isMapped)
+{
+  if (dataPtr) {
+#ifdef AB_BANKINFO_BINIDX_USE_MMAP
+    if (isMapped)
+      munmap(dataPtr, dataSize);
+    else
+#endif
+      free(dataPtr);
+  }
+}
+
+
+
+int _checkHeader(AB_BANKINFO_BINIDX *idx, const char *fname)
+{
+  const uint8_t *p;
+  uint16_t version;
+
+  p=idx->dataPtr;
+  if (memcmp(p, AB_BANKINFO_BINIDX_MAGIC, 4)!=0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "%s: Bad magic", fname);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  version=_readUint16(p+4);
+  if (version!=AB_BANKINFO_BINIDX_VERSION) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "%s: Unsupported version %d", fname, version);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  idx->keySize=_readUint16(p+6);
+  if (idx->keySize<1 || idx->keySize>AB_BANKINFO_BINIDX_MAX_KEYSIZE) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "%s: Invalid key size %u", fname, idx->keySize);
+    return GWEN_ERROR_BAD_DATA;
+  }
+  idx->recordSize=idx->keySize+AB_BANKINFO_BINIDX_OFFSET_SIZE;
+  idx->recordCount=_readUint32(p+8);
+
+  if (((uint64_t)idx->recordCount*idx->recordSize)+AB_BANKINFO_BINIDX_HEADER_SIZE > (uint64_t) idx->dataSize) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "%s: File too short for %u records", fname, idx->recordCount);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  idx->records=p+AB_BANKINFO_BINIDX_HEADER_SIZE;
+  return 0;
+}
+
+
+
+void _makeKey(const char *s, uint8_t *keyBuf, uint32_t keySize)
+{
+  uint32_t i;
+
+  memset(keyBuf, 0, keySize);
+  for (i=0; i<keySize && s[i]; i++)
+    keyBuf[i]=(uint8_t) toupper((unsigned char) s[i]);
+}
+
+
+
+uint32_t _readUint32(const uint8_t *p)
+{
+  return (((uint32_t) p[0])<<24) | (((uint32_t) p[1])<<16) | (((uint32_t) p[2])<<8) | ((uint32_t) p[3]);
+}
+
+
+
+uint16_t _readUint16(const uint8_t *p)
+{
+  return (uint16_t)((((uint16_t) p[0])<<8) | ((uint16_t) p[1]));
+}
+
+
+
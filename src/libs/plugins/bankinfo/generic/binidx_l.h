@@ -0,0 +1,116 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifndef AQBANKING_BANKINFO_BINIDX_L_H
+#define AQBANKING_BANKINFO_BINIDX_L_H
+
+
+#include <gwenhywfar/types.h>
+
+#include <stddef.h>
+
+
+/**
+ * @defgroup G_AB_BANKINFO_BINIDX Binary Bank Info Index
+ *
+ * A binary index file contains a fixed-size header followed by fixed-width records which are sorted by key.
+ * Every record consists of the key (uppercased, padded with NUL bytes to the key size given in the header)
+ * followed by the 32 bit big-endian offset of the corresponding entry in "banks.data".
+ * Records with equal keys are stored in the order in which they appear in "banks.data".
+ *
+ * Header layout (all numbers big-endian):
+ * <ul>
+ *   <li>4 bytes: magic "ABIX"</li>
+ *   <li>2 bytes: format version (@ref AB_BANKINFO_BINIDX_VERSION)</li>
+ *   <li>2 bytes: key size</li>
+ *   <li>4 bytes: number of records</li>
+ *   <li>4 bytes: reserved (0)</li>
+ * </ul>
+ *
+ * These files are created by "mkdeinfo" next to the textual index files and are mapped into memory
+ * by the generic bankinfo plugin, so that exact lookups only need a binary search.
+ */
+/*@{*/
+
+#define AB_BANKINFO_BINIDX_MAGIC       "ABIX"
+#define AB_BANKINFO_BINIDX_VERSION     1
+#define AB_BANKINFO_BINIDX_HEADER_SIZE 16
+#define AB_BANKINFO_BINIDX_OFFSET_SIZE 4
+#define AB_BANKINFO_BINIDX_MAX_KEYSIZE 64
+
+#define AB_BANKINFO_BINIDX_FILE_BLZ    "blz.bidx"
+#define AB_BANKINFO_BINIDX_FILE_BIC    "bic.bidx"
+
+
+typedef struct AB_BANKINFO_BINIDX AB_BANKINFO_BINIDX;
+
+
+/**
+ * Open a binary index file and map it into memory.
+ *
+ * @return index object (NULL if the file does not exist or is invalid)
+ * @param fname path to the index file
+ */
+AB_BANKINFO_BINIDX *AB_BankInfoBinIndex_Open(const char *fname);
+
+void AB_BankInfoBinIndex_free(AB_BANKINFO_BINIDX *idx);
+
+uint32_t AB_BankInfoBinIndex_GetCount(const AB_BANKINFO_BINIDX *idx);
+
+/**
+ * Return the offset into "banks.data" stored in the given record.
+ */
+uint32_t AB_BankInfoBinIndex_GetOffset(const AB_BANKINFO_BINIDX *idx, uint32_t recordNum);
+
+/**
+ * Find the range of records whose key equals the given key (compared case-insensitively).
+ *
+ * @return 0 if found, GWEN_ERROR_NOT_FOUND otherwise
+ * @param idx index object
+ * @param key key to look for (no wildcards)
+ * @param pFirst pointer to a variable to receive the number of the first matching record
+ * @param pCount pointer to a variable to receive the number of matching records
+ */
+int AB_BankInfoBinIndex_FindRange(const AB_BANKINFO_BINIDX *idx, const char *key, uint32_t *pFirst, uint32_t *pCount);
+
+/**
+ * Find the range of records whose key starts with the given prefix (compared case-insensitively).
+ *
+ * @return 0 if found, GWEN_ERROR_NOT_FOUND otherwise
+ * @param idx index object
+ * @param prefix prefix to look for (no wildcards)
+ * @param pFirst pointer to a variable to receive the number of the first matching record
+ * @param pCount pointer to a variable to receive the number of matching records
+ */
+int AB_BankInfoBinIndex_FindPrefixRange(const AB_BANKINFO_BINIDX *idx, const char *prefix, uint32_t *pFirst, uint32_t *pCount);
+
+/**
+ * Check whether the given pattern is a simple prefix pattern like "1234*" (i.e. the only wildcard is a
+ * single trailing "*").
+ */
+int AB_BankInfoBinIndex_IsPrefixPattern(const char *s);
+
+/**
+ * Check whether the given string contains wildcard characters as understood by GWEN_Text_ComparePattern().
+ * Only keys without wildcards can be looked up in a binary index.
+ */
+int AB_BankInfoBinIndex_HasWildcards(const char *s);
+
+/**
+ * Map a complete index file into memory (or read it into a malloc'ed buffer if mmap is not available).
+ * Used by all binary index files of the generic plugin.
+ */
+int AB_BankInfoIndex_MapFile(const char *fname, uint8_t **pDataPtr, size_t *pDataSize, int *pIsMapped);
+
+void AB_BankInfoIndex_UnmapFile(uint8_t *dataPtr, size_t dataSize, int isMapped);
+
+/*@}*/
+
+
+#endif
@@ -0,0 +1,32 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifndef AQBANKING_BANKINFO_BINIDX_P_H
+#define AQBANKING_BANKINFO_BINIDX_P_H
+
+#include "binidx_l.h"
+
+#include <stddef.h>
+
+
+
+struct AB_BANKINFO_BINIDX {
+  uint8_t *dataPtr;       /* start of the whole file in memory */
+  size_t dataSize;
+  int isMapped;           /* 1 if dataPtr is mmap'ed, 0 if malloc'ed */
+
+  const uint8_t *records; /* first record */
+  uint32_t recordCount;
+  uint32_t keySize;
+  uint32_t recordSize;
+};
+
+
+
+#endif
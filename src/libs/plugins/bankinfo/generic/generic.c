@@ -20,6 +20,7 @@
 #include <gwenhywfar/text.h>
 #include <gwenhywfar/gui.h>
 #include <gwenhywfar/syncio_file.h>
+#include <gwenhywfar/idmap.h>
 
 #include <errno.h>
 
@@ -31,6 +32,7 @@
 
 
 GWEN_INHERIT(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC)
+GWEN_LIST_FUNCTIONS(AB_BANKINFO_GENERIC_CACHEENTRY, AB_BankInfoGenericCacheEntry)
 
 
 
@@ -48,6 +50,8 @@ AB_BANKINFO_PLUGIN *AB_BankInfoPluginGENERIC_new(AB_BANKING *ab,
 
   bde->banking=ab;
   bde->country=strdup(country);
+  bde->cacheList=AB_BankInfoGenericCacheEntry_List_new();
+  bde->cacheMap=GWEN_IdMap_new(GWEN_IdMapAlgo_Hex4);
   AB_BankInfoPlugin_SetGetBankInfoFn(bip, AB_BankInfoPluginGENERIC_GetBankInfo);
   AB_BankInfoPlugin_SetGetBankInfoByTemplateFn(bip,
                                                AB_BankInfoPluginGENERIC_SearchbyTemplate);
@@ -62,9 +66,21 @@ void GWENHYWFAR_CB AB_BankInfoPluginGENERIC_FreeData(void *bp, void *p)
   AB_BANKINFO_PLUGIN_GENERIC *bde;
 
   bde=(AB_BANKINFO_PLUGIN_GENERIC *)p;
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Bank info cache for \"%s\": %u hits, %u misses",
+           bde->country, bde->cacheHits, bde->cacheMisses);
+  if (bde->dataSio) {
+    GWEN_SyncIo_Disconnect(bde->dataSio);
+    GWEN_SyncIo_free(bde->dataSio);
+  }
+  GWEN_IdMap_free(bde->cacheMap);
+  AB_BankInfoGenericCacheEntry_List_Clear(bde->cacheList);
+  AB_BankInfoGenericCacheEntry_List_free(bde->cacheList);
   free(bde->country);
   if (bde->dataDir)
     free(bde->dataDir);
+  AB_BankInfoBinIndex_free(bde->blzIndex);
+  AB_BankInfoBinIndex_free(bde->bicIndex);
+  AB_BankInfoTrigramIndex_free(bde->namLocIndex);
 
   GWEN_FREE_OBJECT(bde);
 }
@@ -138,13 +154,29 @@ void AB_BankInfoPluginGENERIC__GetDataDir(AB_BANKINFO_PLUGIN *bip,
 
 AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfo(AB_BANKINFO_PLUGIN *bip,
                                                     const char *num)
+{
+  uint32_t pos;
+
+  /* get position */
+  assert(strlen(num)==8);
+  if (1!=sscanf(num, "%08x", &pos)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid index");
+    return 0;
+  }
+
+  return AB_BankInfoPluginGENERIC__ReadBankInfoAt(bip, pos);
+}
+
+
+
+AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfoAt(AB_BANKINFO_PLUGIN *bip,
+                                                      uint32_t pos)
 {
   AB_BANKINFO_PLUGIN_GENERIC *bde;
-  GWEN_BUFFER *pbuf;
+  const AB_BANKINFO *cachedBi;
   AB_BANKINFO *bi;
   GWEN_DB_NODE *dbT;
   GWEN_SYNCIO *sio;
-  uint32_t pos;
   int rv;
 
   assert(bip);
@@ -152,25 +184,18 @@ AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfo(AB_BANKINFO_PLUGIN *bip,
                            bip);
   assert(bde);
 
-  /* get position */
-  assert(strlen(num)==8);
-  if (1!=sscanf(num, "%08x", &pos)) {
-    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid index");
-    return 0;
+  /* lookup cache */
+  cachedBi=AB_BankInfoPluginGENERIC__CacheGet(bip, pos);
+  if (cachedBi) {
+    bde->cacheHits++;
+    return AB_BankInfo_dup(cachedBi);
   }
+  bde->cacheMisses++;
 
-  /* get path */
-  pbuf=GWEN_Buffer_new(0, 256, 0, 1);
-  AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
-  GWEN_Buffer_AppendString(pbuf, DIRSEP "banks.data");
-
-  sio=GWEN_SyncIo_File_new(GWEN_Buffer_GetStart(pbuf), GWEN_SyncIo_File_CreationMode_OpenExisting);
-  GWEN_SyncIo_AddFlags(sio, GWEN_SYNCIO_FILE_FLAGS_READ);
-  rv=GWEN_SyncIo_Connect(sio);
-  if (rv<0) {
-    DBG_INFO(GWEN_LOGDOMAIN, "here (%d)", rv);
-    GWEN_SyncIo_free(sio);
-    GWEN_Buffer_free(pbuf);
+  /* get data file (opened on first use and kept open) */
+  sio=AB_BankInfoPluginGENERIC__GetDataSio(bip);
+  if (sio==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here");
     return NULL;
   }
 
@@ -179,11 +204,10 @@ AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfo(AB_BANKINFO_PLUGIN *bip,
   if ((int64_t)-1==GWEN_SyncIo_File_Seek(sio, pos, GWEN_SyncIo_File_Whence_Set)) {
     DBG_ERROR(AQBANKING_LOGDOMAIN,
               "seek(%s, %u): %s",
-              GWEN_Buffer_GetStart(pbuf),
+              GWEN_SyncIo_File_GetPath(sio),
               pos,
               strerror(errno));
-    GWEN_SyncIo_Disconnect(sio);
-    GWEN_SyncIo_free(sio);
+    AB_BankInfoPluginGENERIC__CloseDataSio(bip);
     return NULL;
   }
 
@@ -193,25 +217,170 @@ AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfo(AB_BANKINFO_PLUGIN *bip,
                         GWEN_DB_FLAGS_DEFAULT |
                         GWEN_PATH_FLAGS_CREATE_GROUP|
                         GWEN_DB_FLAGS_UNTIL_EMPTY_LINE);
-  GWEN_SyncIo_Disconnect(sio);
-  GWEN_SyncIo_free(sio);
   if (rv<0) {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "Could not load file \"%s\" (%d)", GWEN_Buffer_GetStart(pbuf), rv);
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Could not load file \"%s\" (%d)", GWEN_SyncIo_File_GetPath(sio), rv);
     GWEN_DB_Group_free(dbT);
-    GWEN_Buffer_free(pbuf);
+    AB_BankInfoPluginGENERIC__CloseDataSio(bip);
     return 0;
   }
 
   bi=AB_BankInfo_fromDb(dbT);
   assert(bi);
   GWEN_DB_Group_free(dbT);
-  GWEN_Buffer_free(pbuf);
+
+  AB_BankInfoPluginGENERIC__CacheAdd(bip, pos, AB_BankInfo_dup(bi));
 
   return bi;
 }
 
 
 
+GWEN_SYNCIO *AB_BankInfoPluginGENERIC__GetDataSio(AB_BANKINFO_PLUGIN *bip)
+{
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+
+  assert(bip);
+  bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
+                           bip);
+  assert(bde);
+
+  if (bde->dataSio==NULL) {
+    GWEN_BUFFER *pbuf;
+    GWEN_SYNCIO *sio;
+    int rv;
+
+    /* get path */
+    pbuf=GWEN_Buffer_new(0, 256, 0, 1);
+    AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
+    GWEN_Buffer_AppendString(pbuf, DIRSEP "banks.data");
+
+    sio=GWEN_SyncIo_File_new(GWEN_Buffer_GetStart(pbuf), GWEN_SyncIo_File_CreationMode_OpenExisting);
+    GWEN_SyncIo_AddFlags(sio, GWEN_SYNCIO_FILE_FLAGS_READ);
+    rv=GWEN_SyncIo_Connect(sio);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Could not open file \"%s\" (%d)", GWEN_Buffer_GetStart(pbuf), rv);
+      GWEN_SyncIo_free(sio);
+      GWEN_Buffer_free(pbuf);
+      return NULL;
+    }
+    GWEN_Buffer_free(pbuf);
+    bde->dataSio=sio;
+  }
+
+  return bde->dataSio;
+}
+
+
+
+void AB_BankInfoPluginGENERIC__CloseDataSio(AB_BANKINFO_PLUGIN *bip)
+{
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+
+  assert(bip);
+  bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
+                           bip);
+  assert(bde);
+
+  if (bde->dataSio) {
+    GWEN_SyncIo_Disconnect(bde->dataSio);
+    GWEN_SyncIo_free(bde->dataSio);
+    bde->dataSio=NULL;
+  }
+}
+
+
+
+const AB_BANKINFO *AB_BankInfoPluginGENERIC__CacheGet(AB_BANKINFO_PLUGIN *bip, uint32_t pos)
+{
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+  AB_BANKINFO_GENERIC_CACHEENTRY *e;
+
+  assert(bip);
+  bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
+                           bip);
+  assert(bde);
+
+  e=(AB_BANKINFO_GENERIC_CACHEENTRY *) GWEN_IdMap_Find(bde->cacheMap, pos);
+  if (e==NULL)
+    return NULL;
+
+  /* move to front (most recently used) */
+  if (AB_BankInfoGenericCacheEntry_List_Previous(e)) {
+    AB_BankInfoGenericCacheEntry_List_Del(e);
+    AB_BankInfoGenericCacheEntry_List_Insert(e, bde->cacheList);
+  }
+  return e->bankInfo;
+}
+
+
+
+void AB_BankInfoPluginGENERIC__CacheAdd(AB_BANKINFO_PLUGIN *bip, uint32_t pos, AB_BANKINFO *bi)
+{
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+  AB_BANKINFO_GENERIC_CACHEENTRY *e;
+
+  assert(bip);
+  bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
+                           bip);
+  assert(bde);
+
+  /* evict least recently used entry if full */
+  if (AB_BankInfoGenericCacheEntry_List_GetCount(bde->cacheList)>=AB_BANKINFO_GENERIC__CACHE_SIZE) {
+    e=AB_BankInfoGenericCacheEntry_List_Last(bde->cacheList);
+    if (e) {
+      GWEN_IdMap_Remove(bde->cacheMap, e->pos);
+      AB_BankInfoGenericCacheEntry_List_Del(e);
+      AB_BankInfoGenericCacheEntry_free(e);
+    }
+  }
+
+  GWEN_NEW_OBJECT(AB_BANKINFO_GENERIC_CACHEENTRY, e);
+  GWEN_LIST_INIT(AB_BANKINFO_GENERIC_CACHEENTRY, e);
+  e->pos=pos;
+  e->bankInfo=bi;
+  AB_BankInfoGenericCacheEntry_List_Insert(e, bde->cacheList);
+  GWEN_IdMap_Insert(bde->cacheMap, pos, e);
+}
+
+
+
+void AB_BankInfoGenericCacheEntry_free(AB_BANKINFO_GENERIC_CACHEENTRY *e)
+{
+  if (e) {
+    GWEN_LIST_FINI(AB_BANKINFO_GENERIC_CACHEENTRY, e);
+    AB_BankInfo_free(e->bankInfo);
+    GWEN_FREE_OBJECT(e);
+  }
+}
+
+
+
+uint32_t AB_BankInfoPluginGENERIC_GetCacheHits(AB_BANKINFO_PLUGIN *bip)
+{
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+
+  assert(bip);
+  bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
+                           bip);
+  assert(bde);
+  return bde->cacheHits;
+}
+
+
+
+uint32_t AB_BankInfoPluginGENERIC_GetCacheMisses(AB_BANKINFO_PLUGIN *bip)
+{
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+
+  assert(bip);
+  bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
+                           bip);
+  assert(bde);
+  return bde->cacheMisses;
+}
+
+
+
 AB_BANKINFO *AB_BankInfoPluginGENERIC_GetBankInfo(AB_BANKINFO_PLUGIN *bip,
                                                   const char *branchId,
                                                   const char *bankId)
@@ -225,6 +394,7 @@ AB_BANKINFO *AB_BankInfoPluginGENERIC__SearchbyCode(AB_BANKINFO_PLUGIN *bip,
                                                     const char *bankId)
 {
   AB_BANKINFO_PLUGIN_GENERIC *bde;
+  AB_BANKINFO_BINIDX *idx;
   GWEN_BUFFER *pbuf;
   FILE *f;
   char lbuf[512];
@@ -234,6 +404,18 @@ AB_BANKINFO *AB_BankInfoPluginGENERIC__SearchbyCode(AB_BANKINFO_PLUGIN *bip,
                            bip);
   assert(bde);
 
+  idx=AB_BankInfoPluginGENERIC__GetBinIndex(bip, 0);
+  if (idx) {
+    uint32_t first;
+    uint32_t cnt;
+
+    if (AB_BankInfoBinIndex_FindRange(idx, bankId, &first, &cnt)<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Bank %s not found", bankId);
+      return 0;
+    }
+    return AB_BankInfoPluginGENERIC__ReadBankInfoAt(bip, AB_BankInfoBinIndex_GetOffset(idx, first));
+  }
+
   pbuf=GWEN_Buffer_new(0, 256, 0, 1);
   AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
   GWEN_Buffer_AppendString(pbuf, DIRSEP "blz.idx");
@@ -298,6 +480,14 @@ int AB_BankInfoPluginGENERIC__AddById(AB_BANKINFO_PLUGIN *bip,
                            bip);
   assert(bde);
 
+  if (!AB_BankInfoBinIndex_HasWildcards(bankId) || AB_BankInfoBinIndex_IsPrefixPattern(bankId)) {
+    AB_BANKINFO_BINIDX *idx;
+
+    idx=AB_BankInfoPluginGENERIC__GetBinIndex(bip, 0);
+    if (idx)
+      return AB_BankInfoPluginGENERIC__AddFromBinIndex(bip, idx, bankId, bl);
+  }
+
   pbuf=GWEN_Buffer_new(0, 256, 0, 1);
   AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
   GWEN_Buffer_AppendString(pbuf, DIRSEP "blz.idx");
@@ -367,6 +557,14 @@ int AB_BankInfoPluginGENERIC__AddByBic(AB_BANKINFO_PLUGIN *bip,
                            bip);
   assert(bde);
 
+  if (!AB_BankInfoBinIndex_HasWildcards(bic) || AB_BankInfoBinIndex_IsPrefixPattern(bic)) {
+    AB_BANKINFO_BINIDX *idx;
+
+    idx=AB_BankInfoPluginGENERIC__GetBinIndex(bip, 1);
+    if (idx)
+      return AB_BankInfoPluginGENERIC__AddFromBinIndex(bip, idx, bic, bl);
+  }
+
   pbuf=GWEN_Buffer_new(0, 256, 0, 1);
   AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
   GWEN_Buffer_AppendString(pbuf, DIRSEP "bic.idx");
@@ -420,12 +618,122 @@ int AB_BankInfoPluginGENERIC__AddByBic(AB_BANKINFO_PLUGIN *bip,
 
 
 
+AB_BANKINFO_BINIDX *AB_BankInfoPluginGENERIC__GetBinIndex(AB_BANKINFO_PLUGIN *bip, int bic)
+{
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+  uint32_t triedFlag;
+  AB_BANKINFO_BINIDX **pIdx;
+
+  assert(bip);
+  bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
+                           bip);
+  assert(bde);
+
+  if (bic) {
+    triedFlag=AB_BANKINFO_GENERIC__BINIDX_FLAGS_BIC_TRIED;
+    pIdx=&(bde->bicIndex);
+  }
+  else {
+    triedFlag=AB_BANKINFO_GENERIC__BINIDX_FLAGS_BLZ_TRIED;
+    pIdx=&(bde->blzIndex);
+  }
+
+  if (!(bde->binIndexFlags & triedFlag)) {
+    GWEN_BUFFER *pbuf;
+
+    /* only try once, fall back to the text index if the binary index is missing */
+    bde->binIndexFlags|=triedFlag;
+    pbuf=GWEN_Buffer_new(0, 256, 0, 1);
+    AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
+    GWEN_Buffer_AppendString(pbuf, DIRSEP);
+    GWEN_Buffer_AppendString(pbuf, bic?AB_BANKINFO_BINIDX_FILE_BIC:AB_BANKINFO_BINIDX_FILE_BLZ);
+    *pIdx=AB_BankInfoBinIndex_Open(GWEN_Buffer_GetStart(pbuf));
+    GWEN_Buffer_free(pbuf);
+  }
+
+  return *pIdx;
+}
+
+
+
+AB_BANKINFO_TRIGRAMIDX *AB_BankInfoPluginGENERIC__GetTrigramIndex(AB_BANKINFO_PLUGIN *bip)
+{
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+
+  assert(bip);
+  bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
+                           bip);
+  assert(bde);
+
+  if (!(bde->binIndexFlags & AB_BANKINFO_GENERIC__BINIDX_FLAGS_NAMLOC_TRIED)) {
+    GWEN_BUFFER *pbuf;
+
+    bde->binIndexFlags|=AB_BANKINFO_GENERIC__BINIDX_FLAGS_NAMLOC_TRIED;
+    pbuf=GWEN_Buffer_new(0, 256, 0, 1);
+    AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
+    GWEN_Buffer_AppendString(pbuf, DIRSEP AB_BANKINFO_TRIGRAMIDX_FILE);
+    bde->namLocIndex=AB_BankInfoTrigramIndex_Open(GWEN_Buffer_GetStart(pbuf));
+    GWEN_Buffer_free(pbuf);
+  }
+
+  return bde->namLocIndex;
+}
+
+
+
+int AB_BankInfoPluginGENERIC__AddFromBinIndex(AB_BANKINFO_PLUGIN *bip,
+                                              AB_BANKINFO_BINIDX *idx,
+                                              const char *key,
+                                              AB_BANKINFO_LIST2 *bl)
+{
+  uint32_t first;
+  uint32_t cnt;
+  uint32_t i;
+  uint32_t count=0;
+  int rv;
+
+  if (AB_BankInfoBinIndex_IsPrefixPattern(key)) {
+    char *prefix;
+
+    /* strip trailing joker */
+    prefix=strdup(key);
+    prefix[strlen(prefix)-1]=0;
+    rv=AB_BankInfoBinIndex_FindPrefixRange(idx, prefix, &first, &cnt);
+    free(prefix);
+  }
+  else
+    rv=AB_BankInfoBinIndex_FindRange(idx, key, &first, &cnt);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Bank %s not found", key);
+    return GWEN_ERROR_NOT_FOUND;
+  }
+
+  for (i=first; i<first+cnt; i++) {
+    AB_BANKINFO *bi;
+
+    bi=AB_BankInfoPluginGENERIC__ReadBankInfoAt(bip, AB_BankInfoBinIndex_GetOffset(idx, i));
+    if (bi) {
+      AB_BankInfo_List2_PushBack(bl, bi);
+      count++;
+    }
+  }
+
+  if (!count) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Bank %s not found", key);
+    return GWEN_ERROR_NOT_FOUND;
+  }
+  return 0;
+}
+
+
+
 int AB_BankInfoPluginGENERIC__AddByNameAndLoc(AB_BANKINFO_PLUGIN *bip,
                                               const char *name,
                                               const char *loc,
                                               AB_BANKINFO_LIST2 *bl)
 {
   AB_BANKINFO_PLUGIN_GENERIC *bde;
+  AB_BANKINFO_TRIGRAMIDX *tidx;
   GWEN_BUFFER *pbuf;
   FILE *f;
   char lbuf[512];
@@ -441,6 +749,33 @@ int AB_BankInfoPluginGENERIC__AddByNameAndLoc(AB_BANKINFO_PLUGIN *bip,
   if (loc==0)
     loc="*";
 
+  tidx=AB_BankInfoPluginGENERIC__GetTrigramIndex(bip);
+  if (tidx) {
+    uint32_t offsets[AB_BANKINFO_GENERIC__NAMLOC_MAX_RESULTS];
+    int rv;
+
+    rv=AB_BankInfoTrigramIndex_FindMatches(tidx, name, loc, offsets, AB_BANKINFO_GENERIC__NAMLOC_MAX_RESULTS);
+    if (rv>=0) {
+      int i;
+
+      for (i=0; i<rv; i++) {
+        AB_BANKINFO *bi;
+
+        bi=AB_BankInfoPluginGENERIC__ReadBankInfoAt(bip, offsets[i]);
+        if (bi) {
+          AB_BankInfo_List2_PushBack(bl, bi);
+          count++;
+        }
+      }
+      if (!count) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Bank %s/%s not found", name, loc);
+        return GWEN_ERROR_NOT_FOUND;
+      }
+      return 0;
+    }
+    /* otherwise fall back to scanning the text index */
+  }
+
   pbuf=GWEN_Buffer_new(0, 256, 0, 1);
   AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
   GWEN_Buffer_AppendString(pbuf, DIRSEP "namloc.idx");
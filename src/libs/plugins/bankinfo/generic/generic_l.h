@@ -17,6 +17,16 @@
 AB_BANKINFO_PLUGIN *AB_BankInfoPluginGENERIC_new(AB_BANKING *ab,
                                                  const char *country);
 
+/**
+ * Return the number of lookups which could be answered from the in-memory cache of bank info objects.
+ */
+uint32_t AB_BankInfoPluginGENERIC_GetCacheHits(AB_BANKINFO_PLUGIN *bip);
+
+/**
+ * Return the number of lookups for which an entry had to be read from the data file.
+ */
+uint32_t AB_BankInfoPluginGENERIC_GetCacheMisses(AB_BANKINFO_PLUGIN *bip);
+
 
 
 #endif
@@ -14,6 +14,25 @@
 #define AQBANKING_BANKINFO_GENERIC_P_H
 
 #include "generic_l.h"
+#include "binidx_l.h"
+#include "trigramidx_l.h"
+
+#include <gwenhywfar/list1.h>
+#include <gwenhywfar/idmap.h>
+#include <gwenhywfar/syncio.h>
+
+
+/** maximum number of decoded bank info objects kept in the cache */
+#define AB_BANKINFO_GENERIC__CACHE_SIZE 512
+
+
+typedef struct AB_BANKINFO_GENERIC_CACHEENTRY AB_BANKINFO_GENERIC_CACHEENTRY;
+GWEN_LIST_FUNCTION_DEFS(AB_BANKINFO_GENERIC_CACHEENTRY, AB_BankInfoGenericCacheEntry)
+struct AB_BANKINFO_GENERIC_CACHEENTRY {
+  GWEN_LIST_ELEMENT(AB_BANKINFO_GENERIC_CACHEENTRY)
+  uint32_t pos;
+  AB_BANKINFO *bankInfo;
+};
 
 
 
@@ -22,9 +41,30 @@ struct AB_BANKINFO_PLUGIN_GENERIC {
   AB_BANKING *banking;
   char *country;
   char *dataDir;
+
+  AB_BANKINFO_BINIDX *blzIndex;
+  AB_BANKINFO_BINIDX *bicIndex;
+  AB_BANKINFO_TRIGRAMIDX *namLocIndex;
+  uint32_t binIndexFlags;
+
+  GWEN_SYNCIO *dataSio;
+
+  /* LRU cache of decoded entries of "banks.data", most recently used first */
+  AB_BANKINFO_GENERIC_CACHEENTRY_LIST *cacheList;
+  GWEN_IDMAP *cacheMap;
+  uint32_t cacheHits;
+  uint32_t cacheMisses;
 };
 
 
+#define AB_BANKINFO_GENERIC__BINIDX_FLAGS_BLZ_TRIED 0x00000001
+#define AB_BANKINFO_GENERIC__BINIDX_FLAGS_BIC_TRIED 0x00000002
+#define AB_BANKINFO_GENERIC__BINIDX_FLAGS_NAMLOC_TRIED 0x00000004
+
+/** maximum number of banks returned for a search by name and location via trigram index */
+#define AB_BANKINFO_GENERIC__NAMLOC_MAX_RESULTS 250
+
+
 void GWENHYWFAR_CB AB_BankInfoPluginGENERIC_FreeData(void *bp, void *p);
 
 AB_BANKINFO *AB_BankInfoPluginGENERIC_GetBankInfo(AB_BANKINFO_PLUGIN *bip,
@@ -43,6 +83,36 @@ void AB_BankInfoPluginGENERIC__GetDataDir(AB_BANKINFO_PLUGIN *bip,
 AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfo(AB_BANKINFO_PLUGIN *bip,
                                                     const char *num);
 
+AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfoAt(AB_BANKINFO_PLUGIN *bip,
+                                                      uint32_t pos);
+
+GWEN_SYNCIO *AB_BankInfoPluginGENERIC__GetDataSio(AB_BANKINFO_PLUGIN *bip);
+void AB_BankInfoPluginGENERIC__CloseDataSio(AB_BANKINFO_PLUGIN *bip);
+
+const AB_BANKINFO *AB_BankInfoPluginGENERIC__CacheGet(AB_BANKINFO_PLUGIN *bip, uint32_t pos);
+void AB_BankInfoPluginGENERIC__CacheAdd(AB_BANKINFO_PLUGIN *bip, uint32_t pos, AB_BANKINFO *bi);
+
+void AB_BankInfoGenericCacheEntry_free(AB_BANKINFO_GENERIC_CACHEENTRY *e);
+
+/**
+ * Return the binary index for blz (if bic==0) or BIC (if bic!=0), if available.
+ * The index file is mapped on first use and kept until the plugin is freed.
+ */
+AB_BANKINFO_BINIDX *AB_BankInfoPluginGENERIC__GetBinIndex(AB_BANKINFO_PLUGIN *bip, int bic);
+
+/**
+ * Return the trigram index for name and location searches, if available.
+ */
+AB_BANKINFO_TRIGRAMIDX *AB_BankInfoPluginGENERIC__GetTrigramIndex(AB_BANKINFO_PLUGIN *bip);
+
+/**
+ * Add all banks whose key matches the given key (either an exact key or a prefix pattern like "1234*").
+ */
+int AB_BankInfoPluginGENERIC__AddFromBinIndex(AB_BANKINFO_PLUGIN *bip,
+                                              AB_BANKINFO_BINIDX *idx,
+                                              const char *key,
+                                              AB_BANKINFO_LIST2 *bl);
+
 int AB_BankInfoPluginGENERIC__AddById(AB_BANKINFO_PLUGIN *bip,
                                       const char *bankId,
                                       AB_BANKINFO_LIST2 *bl);
@@ -0,0 +1,425 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "trigramidx_p.h"
+#include "binidx_l.h"
+
+#include <aqbanking/error.h>
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+#include <gwenhywfar/text.h>
+#include <gwenhywfar/error.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+
+
+static int _checkHeader(AB_BANKINFO_TRIGRAMIDX *idx, const char *fname);
+static int _addPatternKeys(const char *pattern, uint8_t field, uint32_t *keys, int numKeys);
+static int _addKey(uint32_t key, uint32_t *keys, int numKeys);
+static int _findTrigram(const AB_BANKINFO_TRIGRAMIDX *idx, uint32_t key, uint32_t *pFirst, uint32_t *pCount);
+static int _postingContains(const AB_BANKINFO_TRIGRAMIDX *idx, uint32_t first, uint32_t count, uint32_t entryNum);
+static uint32_t _scoreField(const char *s, const char *pattern);
+static int _cmpMatches(const void *a, const void *b);
+static uint32_t _readUint32(const uint8_t *p);
+static uint16_t _readUint16(const uint8_t *p);
+
+
+
+
+
+AB_BANKINFO_TRIGRAMIDX *AB_BankInfoTrigramIndex_Open(const char *fname)
+{
+  AB_BANKINFO_TRIGRAMIDX *idx;
+  int rv;
+
+  GWEN_NEW_OBJECT(AB_BANKINFO_TRIGRAMIDX, idx);
+  rv=AB_BankInfoIndex_MapFile(fname, &(idx->dataPtr), &(idx->dataSize), &(idx->isMapped));
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Trigram index \"%s\" not available (%d)", fname, rv);
+    AB_BankInfoTrigramIndex_free(idx);
+    return NULL;
+  }
+
+  rv=_checkHeader(idx, fname);
+  if (rv<0) {
+    DBG_WARN(AQBANKING_LOGDOMAIN, "Ignoring invalid trigram index \"%s\" (%d)", fname, rv);
+    AB_BankInfoTrigramIndex_free(idx);
+    return NULL;
+  }
+
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Using trigram index \"%s\" (%u entries, %u trigrams)",
+           fname, idx->entryCount, idx->trigramCount);
+  return idx;
+}
+
+
+
+void AB_BankInfoTrigramIndex_free(AB_BANKINFO_TRIGRAMIDX *idx)
+{
+  if (idx) {
+    AB_BankInfoIndex_UnmapFile(idx->dataPtr, idx->dataSize, idx->isMapped);
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+uint8_t AB_BankInfoTrigramIndex_NormalizeChar(uint8_t c)
+{
+  if (c>='A' && c<='Z')
+    return c+('a'-'A');
+  if ((c>='a' && c<='z') || (c>='0' && c<='9') || c>=0x80)
+    return c;
+  return ' ';
+}
+
+
+
+int AB_BankInfoTrigramIndex_FindMatches(const AB_BANKINFO_TRIGRAMIDX *idx,
+                                        const char *name,
+                                        const char *loc,
+                                        uint32_t *offsetArray,
+                                        uint32_t maxOffsets)
+{
+  uint32_t keys[AB_BANKINFO_TRIGRAMIDX_MAX_QUERYKEYS];
+  uint32_t firstPosting[AB_BANKINFO_TRIGRAMIDX_MAX_QUERYKEYS];
+  uint32_t postingCount[AB_BANKINFO_TRIGRAMIDX_MAX_QUERYKEYS];
+  int numKeys=0;
+  int driver=0;
+  int i;
+  AB_BANKINFO_TRIGRAMIDX_MATCH *matches;
+  uint32_t matchCount=0;
+  uint32_t j;
+
+  assert(idx);
+
+  if (name==NULL || *name==0)
+    name="*";
+  if (loc==NULL || *loc==0)
+    loc="*";
+
+  numKeys=_addPatternKeys(name, AB_BANKINFO_TRIGRAMIDX_FIELD_NAME, keys, numKeys);
+  numKeys=_addPatternKeys(loc, AB_BANKINFO_TRIGRAMIDX_FIELD_LOC, keys, numKeys);
+  if (numKeys<1) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Not enough literal characters in \"%s\"/\"%s\" to use trigram index", name, loc);
+    return GWEN_ERROR_NOT_AVAILABLE;
+  }
+
+  /* lookup posting lists, determine the shortest one */
+  for (i=0; i<numKeys; i++) {
+    if (_findTrigram(idx, keys[i], &(firstPosting[i]), &(postingCount[i]))<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Trigram %08x not in index, no match", keys[i]);
+      return 0;
+    }
+    if (postingCount[i]<postingCount[driver])
+      driver=i;
+  }
+
+  matches=(AB_BANKINFO_TRIGRAMIDX_MATCH *) malloc(sizeof(AB_BANKINFO_TRIGRAMIDX_MATCH)*postingCount[driver]);
+  assert(matches);
+
+  for (j=0; j<postingCount[driver]; j++) {
+    uint32_t entryNum;
+    int inAll=1;
+
+    entryNum=_readUint32(idx->postings+((firstPosting[driver]+j)*4));
+    for (i=0; i<numKeys; i++) {
+      if (i!=driver && !_postingContains(idx, firstPosting[i], postingCount[i], entryNum)) {
+        inAll=0;
+        break;
+      }
+    }
+
+    if (inAll && entryNum<idx->entryCount) {
+      const char *sName;
+      const char *sLoc;
+      uint32_t stringOffset;
+
+      /* verify candidate against the real patterns */
+      stringOffset=_readUint32(idx->entries+(entryNum*AB_BANKINFO_TRIGRAMIDX_ENTRY_SIZE)+4);
+      if (stringOffset<idx->stringsSize) {
+        sName=idx->strings+stringOffset;
+        sLoc=sName+strlen(sName)+1;
+        if (GWEN_Text_ComparePattern(sName, name, 0)!=-1 &&
+            GWEN_Text_ComparePattern(sLoc, loc, 0)!=-1) {
+          matches[matchCount].entryNum=entryNum;
+          matches[matchCount].score=(_scoreField(sName, name)*4)+_scoreField(sLoc, loc);
+          matches[matchCount].nameLen=strlen(sName);
+          matchCount++;
+        }
+      }
+    }
+  }
+
+  /* rank and cap */
+  qsort(matches, matchCount, sizeof(AB_BANKINFO_TRIGRAMIDX_MATCH), _cmpMatches);
+  if (matchCount>maxOffsets) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Only returning the best %u of %u matches", maxOffsets, matchCount);
+    matchCount=maxOffsets;
+  }
+  for (j=0; j<matchCount; j++)
+    offsetArray[j]=_readUint32(idx->entries+(matches[j].entryNum*AB_BANKINFO_TRIGRAMIDX_ENTRY_SIZE));
+  free(matches);
+
+  return (int) matchCount;
+}
+
+
+
+int _checkHeader(AB_BANKINFO_TRIGRAMIDX *idx, const char *fname)
+{
+  const uint8_t *p;
+  uint16_t version;
+  uint32_t entriesOffs;
+  uint32_t trigramsOffs;
+  uint32_t postingsOffs;
+  uint32_t stringsOffs;
+
+  if (idx->dataSize<AB_BANKINFO_TRIGRAMIDX_HEADER_SIZE) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "%s: File too short", fname);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  p=idx->dataPtr;
+  if (memcmp(p, AB_BANKINFO_TRIGRAMIDX_MAGIC, 4)!=0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "%s: Bad magic", fname);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  version=_readUint16(p+4);
+  if (version!=AB_BANKINFO_TRIGRAMIDX_VERSION) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "%s: Unsupported version %d", fname, version);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  idx->entryCount=_readUint32(p+8);
+  idx->trigramCount=_readUint32(p+12);
+  entriesOffs=_readUint32(p+16);
+  trigramsOffs=_readUint32(p+20);
+  postingsOffs=_readUint32(p+24);
+  stringsOffs=_readUint32(p+28);
+
+  /* sections must follow each other in this order */
+  if (entriesOffs<AB_BANKINFO_TRIGRAMIDX_HEADER_SIZE ||
+      (uint64_t) entriesOffs+((uint64_t) idx->entryCount*AB_BANKINFO_TRIGRAMIDX_ENTRY_SIZE)>(uint64_t) trigramsOffs ||
+      (uint64_t) trigramsOffs+((uint64_t) idx->trigramCount*AB_BANKINFO_TRIGRAMIDX_TRIGRAM_SIZE)>(uint64_t) postingsOffs ||
+      postingsOffs>stringsOffs ||
+      stringsOffs>=idx->dataSize) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "%s: Invalid section offsets", fname);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  idx->entries=p+entriesOffs;
+  idx->trigrams=p+trigramsOffs;
+  idx->postings=p+postingsOffs;
+  idx->postingCount=(stringsOffs-postingsOffs)/4;
+  idx->strings=(const char *)(p+stringsOffs);
+  idx->stringsSize=idx->dataSize-stringsOffs;
+
+  /* make sure string operations can not run beyond the end of the data */
+  if (idx->strings[idx->stringsSize-1]!=0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "%s: String table not terminated", fname);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  return 0;
+}
+
+
+
+int _addPatternKeys(const char *pattern, uint8_t field, uint32_t *keys, int numKeys)
+{
+  const uint8_t *p;
+  uint8_t window[3];
+  int windowLen;
+
+  p=(const uint8_t *) pattern;
+
+  /* an anchored pattern (not starting with a wildcard) allows using the start markers */
+  if (*p && *p!='*' && *p!='?') {
+    window[0]=AB_BANKINFO_TRIGRAMIDX_STARTMARK;
+    window[1]=AB_BANKINFO_TRIGRAMIDX_STARTMARK;
+    windowLen=2;
+  }
+  else
+    windowLen=0;
+
+  while (*p) {
+    if (*p=='*' || *p=='?')
+      /* wildcard breaks the current literal segment */
+      windowLen=0;
+    else {
+      uint8_t c;
+
+      c=AB_BankInfoTrigramIndex_NormalizeChar(*p);
+      if (windowLen<3)
+        window[windowLen++]=c;
+      else {
+        window[0]=window[1];
+        window[1]=window[2];
+        window[2]=c;
+      }
+      if (windowLen==3) {
+        uint32_t key;
+
+        key=(((uint32_t) field)<<24) | (((uint32_t) window[0])<<16) | (((uint32_t) window[1])<<8) | ((uint32_t) window[2]);
+        numKeys=_addKey(key, keys, numKeys);
+      }
+    }
+    p++;
+  }
+
+  return numKeys;
+}
+
+
+
+int _addKey(uint32_t key, uint32_t *keys, int numKeys)
+{
+  int i;
+
+  for (i=0; i<numKeys; i++) {
+    if (keys[i]==key)
+      return numKeys;
+  }
+  /* more keys only narrow down the candidates, so ignore the rest */
+  if (numKeys<AB_BANKINFO_TRIGRAMIDX_MAX_QUERYKEYS)
+    keys[numKeys++]=key;
+  return numKeys;
+}
+
+
+
+int _findTrigram(const AB_BANKINFO_TRIGRAMIDX *idx, uint32_t key, uint32_t *pFirst, uint32_t *pCount)
+{
+  uint32_t lo, hi;
+
+  lo=0;
+  hi=idx->trigramCount;
+  while (lo<hi) {
+    uint32_t mid;
+    const uint8_t *p;
+    uint32_t midKey;
+
+    mid=lo+((hi-lo)/2);
+    p=idx->trigrams+(mid*AB_BANKINFO_TRIGRAMIDX_TRIGRAM_SIZE);
+    midKey=_readUint32(p);
+    if (midKey<key)
+      lo=mid+1;
+    else if (midKey>key)
+      hi=mid;
+    else {
+      uint32_t first;
+      uint32_t count;
+
+      first=_readUint32(p+4);
+      count=_readUint32(p+8);
+      if ((uint64_t) first+count>(uint64_t) idx->postingCount) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid posting list for trigram %08x", key);
+        return GWEN_ERROR_BAD_DATA;
+      }
+      *pFirst=first;
+      *pCount=count;
+      return 0;
+    }
+  }
+
+  return GWEN_ERROR_NOT_FOUND;
+}
+
+
+
+int _postingContains(const AB_BANKINFO_TRIGRAMIDX *idx, uint32_t first, uint32_t count, uint32_t entryNum)
+{
+  uint32_t lo, hi;
+
+  lo=first;
+  hi=first+count;
+  while (lo<hi) {
+    uint32_t mid;
+    uint32_t v;
+
+    mid=lo+((hi-lo)/2);
+    v=_readUint32(idx->postings+(mid*4));
+    if (v<entryNum)
+      lo=mid+1;
+    else if (v>entryNum)
+      hi=mid;
+    else
+      return 1;
+  }
+  return 0;
+}
+
+
+
+uint32_t _scoreField(const char *s, const char *pattern)
+{
+  size_t len;
+
+  /* only simple patterns like "Name" or "Name*" are ranked */
+  len=strcspn(pattern, "*?");
+  if (len==0)
+    return 0;
+  if (pattern[len]==0 || (pattern[len]=='*' && pattern[len+1]==0)) {
+    if (strlen(s)==len && strncasecmp(s, pattern, len)==0)
+      return 3;
+    if (strncasecmp(s, pattern, len)==0)
+      return 2;
+  }
+  return 1;
+}
+
+
+
+int _cmpMatches(const void *a, const void *b)
+{
+  const AB_BANKINFO_TRIGRAMIDX_MATCH *ma;
+  const AB_BANKINFO_TRIGRAMIDX_MATCH *mb;
+
+  ma=(const AB_BANKINFO_TRIGRAMIDX_MATCH *) a;
+  mb=(const AB_BANKINFO_TRIGRAMIDX_MATCH *) b;
+
+  /* higher score first */
+  if (ma->score!=mb->score)
+    return (ma->score>mb->score)?-1:1;
+  /* shorter names first */
+  if (ma->nameLen!=mb->nameLen)
+    return (ma->nameLen<mb->nameLen)?-1:1;
+  /* keep order of the data file */
+  if (ma->entryNum!=mb->entryNum)
+    return (ma->entryNum<mb->entryNum)?-1:1;
+  return 0;
+}
+
+
+
+uint32_t _readUint32(const uint8_t *p)
+{
+  return (((uint32_t) p[0])<<24) | (((uint32_t) p[1])<<16) | (((uint32_t) p[2])<<8) | ((uint32_t) p[3]);
+}
+
+
+
+uint16_t _readUint16(const uint8_t *p)
+{
+  return (uint16_t)((((uint16_t) p[0])<<8) | ((uint16_t) p[1]));
+}
+
+
+
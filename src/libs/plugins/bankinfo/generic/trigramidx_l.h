@@ -0,0 +1,101 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifndef AQBANKING_BANKINFO_TRIGRAMIDX_L_H
+#define AQBANKING_BANKINFO_TRIGRAMIDX_L_H
+
+
+#include <gwenhywfar/types.h>
+
+
+/**
+ * @defgroup G_AB_BANKINFO_TRIGRAMIDX Trigram Index for Bank Name and Location
+ *
+ * This index is used to answer wildcard and prefix searches for bank name and location without
+ * scanning "namloc.idx".
+ *
+ * Names and locations are normalized (ASCII letters lowercased, other ASCII characters except digits
+ * replaced by blanks, non-ASCII bytes kept) and prefixed by two start markers (0x01). Every trigram of
+ * such a string is stored together with the field it belongs to (name or location) and a sorted list of
+ * the entries containing it.
+ *
+ * File layout (all numbers 32 bit big-endian unless noted otherwise):
+ * <ul>
+ *   <li>header:
+ *     magic "ABTX", version (16 bit), reserved (16 bit), number of entries, number of trigrams,
+ *     offset of entry table, offset of trigram table, offset of posting lists, offset of string table</li>
+ *   <li>entry table: for every entry the offset into "banks.data" and the offset of the entry
+ *     strings (name and location, each terminated by NUL) relative to the string table</li>
+ *   <li>trigram table (sorted by key): key, index of the first posting, number of postings</li>
+ *   <li>posting lists: entry numbers (ascending per trigram)</li>
+ *   <li>string table</li>
+ * </ul>
+ *
+ * These files are created by "mkdeinfo".
+ */
+/*@{*/
+
+#define AB_BANKINFO_TRIGRAMIDX_MAGIC       "ABTX"
+#define AB_BANKINFO_TRIGRAMIDX_VERSION     1
+#define AB_BANKINFO_TRIGRAMIDX_HEADER_SIZE 32
+
+#define AB_BANKINFO_TRIGRAMIDX_FILE        "namloc.tidx"
+
+#define AB_BANKINFO_TRIGRAMIDX_FIELD_NAME  1
+#define AB_BANKINFO_TRIGRAMIDX_FIELD_LOC   2
+
+#define AB_BANKINFO_TRIGRAMIDX_STARTMARK   0x01
+
+
+typedef struct AB_BANKINFO_TRIGRAMIDX AB_BANKINFO_TRIGRAMIDX;
+
+
+/**
+ * Open a trigram index file and map it into memory.
+ *
+ * @return index object (NULL if the file does not exist or is invalid)
+ * @param fname path to the index file
+ */
+AB_BANKINFO_TRIGRAMIDX *AB_BankInfoTrigramIndex_Open(const char *fname);
+
+void AB_BankInfoTrigramIndex_free(AB_BANKINFO_TRIGRAMIDX *idx);
+
+
+/**
+ * Find entries whose name and location match the given patterns (as understood by GWEN_Text_ComparePattern()).
+ *
+ * Matches are ranked (exact matches of the name before prefix matches before other matches, shorter names
+ * first) and only the best ones are returned.
+ *
+ * @return number of matching entries stored in offsetArray (might be 0), GWEN_ERROR_NOT_AVAILABLE if the
+ *   patterns do not contain enough literal characters to use the index (the caller should do a full scan
+ *   in that case)
+ * @param idx index object
+ * @param name pattern for the bank name (NULL for any)
+ * @param loc pattern for the location (NULL for any)
+ * @param offsetArray array to receive the offsets of the best matching entries in "banks.data"
+ * @param maxOffsets size of the array
+ */
+int AB_BankInfoTrigramIndex_FindMatches(const AB_BANKINFO_TRIGRAMIDX *idx,
+                                        const char *name,
+                                        const char *loc,
+                                        uint32_t *offsetArray,
+                                        uint32_t maxOffsets);
+
+
+/**
+ * Normalize a single character for use in trigrams. Writers of index files must use this
+ * exact function.
+ */
+uint8_t AB_BankInfoTrigramIndex_NormalizeChar(uint8_t c);
+
+/*@}*/
+
+
+#endif
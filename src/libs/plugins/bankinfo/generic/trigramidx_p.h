@@ -0,0 +1,52 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifndef AQBANKING_BANKINFO_TRIGRAMIDX_P_H
+#define AQBANKING_BANKINFO_TRIGRAMIDX_P_H
+
+#include "trigramidx_l.h"
+
+#include <stddef.h>
+
+
+/** maximum number of trigrams taken from a query */
+#define AB_BANKINFO_TRIGRAMIDX_MAX_QUERYKEYS 128
+
+#define AB_BANKINFO_TRIGRAMIDX_ENTRY_SIZE    8
+#define AB_BANKINFO_TRIGRAMIDX_TRIGRAM_SIZE  12
+
+
+struct AB_BANKINFO_TRIGRAMIDX {
+  uint8_t *dataPtr;
+  size_t dataSize;
+  int isMapped;
+
+  uint32_t entryCount;
+  uint32_t trigramCount;
+  uint32_t postingCount;
+  uint32_t stringsSize;
+
+  const uint8_t *entries;
+  const uint8_t *trigrams;
+  const uint8_t *postings;
+  const char *strings;
+};
+
+
+
+typedef struct AB_BANKINFO_TRIGRAMIDX_MATCH AB_BANKINFO_TRIGRAMIDX_MATCH;
+struct AB_BANKINFO_TRIGRAMIDX_MATCH {
+  uint32_t entryNum;
+  uint32_t score;
+  uint32_t nameLen;
+};
+
+
+
+#endif
@@ -15,11 +15,18 @@
 
 #include "aqbanking/i18n_l.h"
 #include <aqbanking/banking.h>
+#include <aqbanking/types/imexporter_context_bin.h>
 
 #include <gwenhywfar/debug.h>
 #include <gwenhywfar/misc.h>
 #include <gwenhywfar/gui.h>
 #include <gwenhywfar/inherit.h>
+#include <gwenhywfar/syncio_file.h>
+#include <gwenhywfar/syncio_memory.h>
+
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
 
 
 GWEN_INHERIT(AB_IMEXPORTER, AH_IMEXPORTER_CTXFILE);
@@ -60,13 +67,51 @@ int AH_ImExporterCtxFile_Import(AB_IMEXPORTER *ie,
                                 GWEN_DB_NODE *params)
 {
   AH_IMEXPORTER_CTXFILE *ieh;
-  GWEN_DB_NODE *dbData;
+  GWEN_SYNCIO *sioMem=NULL;
   int rv;
 
   assert(ie);
   ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AH_IMEXPORTER_CTXFILE, ie);
   assert(ieh);
 
+  if (!AH_ImExporterCtxFile__CanInspectSource(sio)) {
+    GWEN_BUFFER *buf;
+
+    /* e.g. stdin: the format can't be detected without consuming data, so read everything into memory first */
+    buf=GWEN_Buffer_new(0, 4096, 0, 1);
+    rv=AH_ImExporterCtxFile__ReadIntoBuffer(sio, buf);
+    if (rv<0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading data (%d)", rv);
+      GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
+                           "Error importing data");
+      GWEN_Buffer_free(buf);
+      return rv;
+    }
+    sioMem=GWEN_SyncIo_Memory_new(buf, 1);
+    sio=sioMem;
+  }
+
+  rv=AH_ImExporterCtxFile__ImportBinary(ctx, sio);
+  if (rv==GWEN_ERROR_NOT_SUPPORTED)
+    rv=AH_ImExporterCtxFile__ImportText(ctx, sio);
+  else if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Error importing binary data (%d)", rv);
+    GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
+                         "Error importing data");
+  }
+
+  if (sioMem)
+    GWEN_SyncIo_free(sioMem);
+  return (rv<0)?rv:0;
+}
+
+
+
+int AH_ImExporterCtxFile__ImportText(AB_IMEXPORTER_CONTEXT *ctx, GWEN_SYNCIO *sio)
+{
+  GWEN_DB_NODE *dbData;
+  int rv;
+
   dbData=GWEN_DB_Group_new("context");
   rv=GWEN_DB_ReadFromIo(dbData,
                         sio,
@@ -101,6 +146,84 @@ int AH_ImExporterCtxFile_Import(AB_IMEXPORTER *ie,
 
 
 
+int AH_ImExporterCtxFile__ImportBinary(AB_IMEXPORTER_CONTEXT *ctx, GWEN_SYNCIO *sio)
+{
+  const char *typeName;
+
+  /* binary files are decoded in place, so only look at the source without reading from it */
+  typeName=GWEN_SyncIo_GetTypeName(sio);
+  if (typeName && strcasecmp(typeName, GWEN_SYNCIO_FILE_TYPE)==0) {
+    const char *fname;
+
+    fname=GWEN_SyncIo_File_GetPath(sio);
+    if (fname && AB_ImExporterContextBin_IsBinaryFile(fname)) {
+      GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Notice, I18N("Reading binary context file"));
+      return AB_ImExporterContextBin_ReadFile(ctx, fname);
+    }
+  }
+  else if (typeName && strcasecmp(typeName, GWEN_SYNCIO_MEMORY_TYPE)==0) {
+    GWEN_BUFFER *buf;
+
+    buf=GWEN_SyncIo_Memory_GetBuffer(sio);
+    if (buf && AB_ImExporterContextBin_IsBinary((const uint8_t *) GWEN_Buffer_GetPosPointer(buf),
+                                                GWEN_Buffer_GetBytesLeft(buf))) {
+      GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Notice, I18N("Reading binary context data"));
+      return AB_ImExporterContextBin_ReadFromMemory(ctx,
+                                                    (const uint8_t *) GWEN_Buffer_GetPosPointer(buf),
+                                                    GWEN_Buffer_GetBytesLeft(buf));
+    }
+  }
+
+  return GWEN_ERROR_NOT_SUPPORTED;
+}
+
+
+
+int AH_ImExporterCtxFile__CanInspectSource(GWEN_SYNCIO *sio)
+{
+  const char *typeName;
+
+  typeName=GWEN_SyncIo_GetTypeName(sio);
+  if (typeName && strcasecmp(typeName, GWEN_SYNCIO_MEMORY_TYPE)==0)
+    return 1;
+  if (typeName && strcasecmp(typeName, GWEN_SYNCIO_FILE_TYPE)==0) {
+    const char *fname;
+    struct stat st;
+
+    /* only regular files can be opened again by name (not stdin or pipes) */
+    fname=GWEN_SyncIo_File_GetPath(sio);
+    if (fname && stat(fname, &st)==0 && S_ISREG(st.st_mode))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+
+int AH_ImExporterCtxFile__ReadIntoBuffer(GWEN_SYNCIO *sio, GWEN_BUFFER *buf)
+{
+  for (;;) {
+    int rv;
+
+    GWEN_Buffer_AllocRoom(buf, 4096);
+    rv=GWEN_SyncIo_Read(sio, (uint8_t *) GWEN_Buffer_GetPosPointer(buf), 4096);
+    if (rv==0 || rv==GWEN_ERROR_EOF)
+      break;
+    else if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    GWEN_Buffer_IncrementPos(buf, rv);
+    GWEN_Buffer_AdjustUsedBytes(buf);
+  }
+
+  GWEN_Buffer_Rewind(buf);
+  return 0;
+}
+
+
+
 int AH_ImExporterCtxFile_CheckFile(AB_IMEXPORTER *ie, const char *fname)
 {
   AH_IMEXPORTER_CTXFILE *ieh;
@@ -109,7 +232,10 @@ int AH_ImExporterCtxFile_CheckFile(AB_IMEXPORTER *ie, const char *fname)
   ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AH_IMEXPORTER_CTXFILE, ie);
   assert(ieh);
 
-  /* always return indifferent (for now) */
+  if (AB_ImExporterContextBin_IsBinaryFile(fname))
+    return 0;
+
+  /* always return indifferent for text files (for now) */
   return AB_ERROR_INDIFFERENT;
 }
 
@@ -128,6 +254,17 @@ int AH_ImExporterCtxFile_Export(AB_IMEXPORTER *ie,
   ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AH_IMEXPORTER_CTXFILE, ie);
   assert(ieh);
 
+  if (GWEN_DB_GetIntValue(params, "binary", 0, 0)) {
+    rv=AB_ImExporterContextBin_Write(ctx, sio);
+    if (rv<0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Error exporting data (%d)", rv);
+      GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
+                           "Error exporting data");
+      return rv;
+    }
+    return 0;
+  }
+
   /* create db, store context in it */
   dbData=GWEN_DB_Group_new("context");
 
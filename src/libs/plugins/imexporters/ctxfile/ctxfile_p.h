@@ -37,5 +37,10 @@ static int AH_ImExporterCtxFile_Export(AB_IMEXPORTER *ie,
 
 static int AH_ImExporterCtxFile_CheckFile(AB_IMEXPORTER *ie, const char *fname);
 
+static int AH_ImExporterCtxFile__ImportBinary(AB_IMEXPORTER_CONTEXT *ctx, GWEN_SYNCIO *sio);
+static int AH_ImExporterCtxFile__ImportText(AB_IMEXPORTER_CONTEXT *ctx, GWEN_SYNCIO *sio);
+static int AH_ImExporterCtxFile__CanInspectSource(GWEN_SYNCIO *sio);
+static int AH_ImExporterCtxFile__ReadIntoBuffer(GWEN_SYNCIO *sio, GWEN_BUFFER *buf);
+
 
 #endif /* AQHBCI_IMEX_CTXFILE_P_H */
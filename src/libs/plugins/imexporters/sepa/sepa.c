@@ -23,6 +23,8 @@
 #include <gwenhywfar/misc.h>
 #include <gwenhywfar/gui.h>
 #include <gwenhywfar/inherit.h>
+#include <gwenhywfar/syncio.h>
+#include <gwenhywfar/text.h>
 
 #include <ctype.h>
 
@@ -84,11 +86,34 @@ void GWENHYWFAR_CB AH_ImExporterSEPA_FreeData(void *bp, void *p)
   AH_IMEXPORTER_SEPA *ieh;
 
   ieh=(AH_IMEXPORTER_SEPA *)p;
+  GWEN_Time_free(ieh->fixedTime);
   GWEN_FREE_OBJECT(ieh);
 }
 
 
 
+int AH_ImExporterSEPA_SetFixedIds(AB_IMEXPORTER *ie, const char *creationTime, uint32_t firstUniqueId)
+{
+  AH_IMEXPORTER_SEPA *ieh;
+  GWEN_TIME *ti;
+
+  assert(ie);
+  ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AH_IMEXPORTER_SEPA, ie);
+  assert(ieh);
+
+  ti=GWEN_Time_fromUtcString(creationTime, "YYYYMMDDhhmmss");
+  if (ti==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid creation time \"%s\"", creationTime);
+    return GWEN_ERROR_INVALID;
+  }
+  GWEN_Time_free(ieh->fixedTime);
+  ieh->fixedTime=ti;
+  ieh->nextFixedUniqueId=firstUniqueId;
+  return 0;
+}
+
+
+
 int AH_ImExporterSEPA_Import(AB_IMEXPORTER *ie,
                              AB_IMEXPORTER_CONTEXT *ctx,
                              GWEN_SYNCIO *sio,
@@ -106,21 +131,18 @@ int AH_ImExporterSEPA_Import(AB_IMEXPORTER *ie,
 
 
 
-static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
-                                               AB_IMEXPORTER_CONTEXT *ctx,
-                                               GWEN_XMLNODE *painNode,
-                                               uint32_t doctype[],
-                                               AH_IMEXPORTER_SEPA_PMTINF_LIST **pList)
+int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER_CONTEXT *ctx,
+                                        uint32_t doctype[],
+                                        GWEN_DB_NODE *params,
+                                        AH_IMEXPORTER_SEPA_PMTINF_LIST **pList,
+                                        int *pTransactionCount)
 {
-  GWEN_XMLNODE *n;
   AB_IMEXPORTER_ACCOUNTINFO *ai;
   AB_TRANSACTION *t;
   AH_IMEXPORTER_SEPA_PMTINF_LIST *pl;
   AH_IMEXPORTER_SEPA_PMTINF *pmtinf;
   int tcount=0;
-  AB_VALUE *v;
   GWEN_BUFFER *tbuf;
-  char *ctrlsum;
 
   ai=AB_ImExporterContext_GetFirstAccountInfo(ctx);
   if (ai==0) {
@@ -139,6 +161,19 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
     return GWEN_ERROR_NO_DATA;
   }
 
+  if (doctype[0]==8 && !(doctype[1]==1 && doctype[2]==1)) {
+    const char *s;
+
+    s=GWEN_DB_GetCharValue(params, "LocalInstrumentSEPACode", 0, "CORE");
+    if (!((doctype[1]>=3 && !strcmp(s, "COR1")) || /* new in 008.003.02 */
+          !strcmp(s, "CORE") ||
+          !strcmp(s, "B2B"))) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN,
+                "Invalid Local InstrumentCode");
+      return GWEN_ERROR_BAD_DATA;
+    }
+  }
+
   /* collect matching transactions for storage in a shared PmtInf block */
   pl=AH_ImExporter_Sepa_PmtInf_List_new();
   pmtinf=AH_ImExporter_Sepa_PmtInf_new();
@@ -151,6 +186,7 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
     AB_TRANSACTION_SEQUENCE sequenceType=AB_Transaction_SequenceUnknown;
     const char *s;
     const AB_VALUE *tv;
+    int rv;
 
     tcount++;
     da=AB_Transaction_GetDate(t);
@@ -211,6 +247,14 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
       }
     }
 
+    /* check everything the writers need here, they must not fail half-way through the document */
+    rv=AH_ImExporterSEPA_Export_Pain_CheckTransaction(t, doctype);
+    if (rv<0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Error in transaction %d", tcount);
+      AH_ImExporter_Sepa_PmtInf_List_free(pl);
+      return rv;
+    }
+
     if (pmtinf->tcount) {
       /* specify list of match criteria in one place */
 #define TRANSACTION_DOES_NOT_MATCH          \
@@ -264,8 +308,7 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
     t=AB_Transaction_List_Next(t);
   }
 
-  /* construct CtrlSum for PmtInf blocks and GrpHdr */
-  v=AB_Value_new();
+  /* construct CtrlSum for PmtInf blocks, check data needed per block */
   tbuf=GWEN_Buffer_new(0, 64, 0, 1);
   pmtinf=AH_ImExporter_Sepa_PmtInf_List_First(pl);
   while (pmtinf) {
@@ -273,82 +316,223 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
     pmtinf->ctrlsum=strdup(GWEN_Buffer_GetStart(tbuf));
     assert(pmtinf->ctrlsum);
     GWEN_Buffer_Reset(tbuf);
-    AB_Value_AddValue(v, pmtinf->value);
+
+    /* BIC not required since 001.003.03 and 008.003.02, but must be written as "Othr/Id/NOTPROVIDED" */
+    if (!(pmtinf->localBic && *(pmtinf->localBic)) && doctype[1]<3) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "No local BIC, but is required");
+      GWEN_Buffer_free(tbuf);
+      AH_ImExporter_Sepa_PmtInf_List_free(pl);
+      return GWEN_ERROR_BAD_DATA;
+    }
+
+    if (doctype[0]==8 &&
+        pmtinf->sequenceType!=AB_Transaction_SequenceOnce &&
+        pmtinf->sequenceType!=AB_Transaction_SequenceFirst &&
+        pmtinf->sequenceType!=AB_Transaction_SequenceFollowing &&
+        pmtinf->sequenceType!=AB_Transaction_SequenceFinal) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Sequence type of debit note unknown");
+      GWEN_Buffer_free(tbuf);
+      AH_ImExporter_Sepa_PmtInf_List_free(pl);
+      return GWEN_ERROR_BAD_DATA;
+    }
+
     pmtinf=AH_ImExporter_Sepa_PmtInf_List_Next(pmtinf);
   }
-
-  AB_Value_toHumanReadableString(v, tbuf, 2, 0);
-  ctrlsum=strdup(GWEN_Buffer_GetStart(tbuf));
-  assert(ctrlsum);
   GWEN_Buffer_free(tbuf);
-  AB_Value_free(v);
 
-  /* create GrpHdr */
-  n=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "GrpHdr");
-  if (n) {
-    GWEN_TIME *ti;
-    uint32_t uid;
-    char numbuf[32];
-    GWEN_XMLNODE *nn;
+  *pList=pl;
+  *pTransactionCount=tcount;
+  return 0;
+}
 
-    GWEN_XMLNode_AddChild(painNode, n);
-    ti=GWEN_CurrentTime();
 
-    tbuf=GWEN_Buffer_new(0, 64, 0, 1);
 
-    /* generate MsgId */
-    uid=AB_Banking_GetNamedUniqueId(AB_ImExporter_GetBanking(ie), "sepamsg", 1);
-    GWEN_Time_toUtcString(ti, "YYYYMMDD-hh:mm:ss-", tbuf);
-    snprintf(numbuf, sizeof(numbuf)-1, "%08x", uid);
-    GWEN_Buffer_AppendString(tbuf, numbuf);
-    GWEN_XMLNode_SetCharValue(n, "MsgId", GWEN_Buffer_GetStart(tbuf));
-    GWEN_Buffer_Reset(tbuf);
+int AH_ImExporterSEPA_Export_Pain_CheckTransaction(const AB_TRANSACTION *t, uint32_t doctype[])
+{
+  const char *s;
 
-    /* generate CreDtTm */
-    GWEN_Time_toUtcString(ti, "YYYY-MM-DDThh:mm:ssZ", tbuf);
-    GWEN_XMLNode_SetCharValue(n, "CreDtTm", GWEN_Buffer_GetStart(tbuf));
-    GWEN_Time_free(ti);
-    GWEN_Buffer_free(tbuf);
+  if (doctype[0]==8) {
+    if (AB_Transaction_GetMandateDate(t)==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Missing mandate date for direct debit");
+      return GWEN_ERROR_BAD_DATA;
+    }
+    if (AB_Transaction_GetMandateId(t)==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Missing mandate id for direct debit");
+      return GWEN_ERROR_BAD_DATA;
+    }
+  }
 
-    /* store NbOfTxs */
-    GWEN_XMLNode_SetIntValue(n, "NbOfTxs", tcount);
-#if 0
-    /* store CtrlSum */
-    GWEN_XMLNode_SetCharValue(n, "CtrlSum", ctrlsum);
-#endif
+  /* BIC not required since 001.003.03 and 008.003.02 */
+  s=AB_Transaction_GetRemoteBic(t);
+  if (!(s && *s) && doctype[1]<3) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "No remote BIC");
+    return GWEN_ERROR_BAD_DATA;
+  }
 
-    /* special treatment for pain.001.001.02 and pain.008.001.01 */
-    if (doctype[1]==1 && ((doctype[0]==1 && doctype[2]==2) ||
-                          (doctype[0]==8 && doctype[2]==1)))
-      GWEN_XMLNode_SetCharValue(n, "Grpg", "GRPD");
+  s=AB_Transaction_GetRemoteName(t);
+  if (!(s && *s)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "No remote name");
+    return GWEN_ERROR_BAD_DATA;
+  }
 
-    nn=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "InitgPty");
-    if (nn) {
-      GWEN_XMLNode_AddChild(n, nn);
-      pmtinf=AH_ImExporter_Sepa_PmtInf_List_First(pl);
-      AH_ImExporterSEPA_XmlSetCharValueEscaped(nn, "Nm", pmtinf->localName);
-    }
+  if (AB_Transaction_GetRemoteIban(t)==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "No remote IBAN");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  s=AB_Transaction_GetPurpose(t);
+  if (!(s && *s)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Missing purpose in transaction");
+    return GWEN_ERROR_BAD_DATA;
   }
-  free(ctrlsum);
 
-  *pList=pl;
   return 0;
 }
 
 
 
+GWEN_TIME *AH_ImExporterSEPA_Export_Pain_GetTime(AB_IMEXPORTER *ie)
+{
+  AH_IMEXPORTER_SEPA *ieh;
+
+  ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AH_IMEXPORTER_SEPA, ie);
+  assert(ieh);
+  if (ieh->fixedTime)
+    return GWEN_Time_dup(ieh->fixedTime);
+
+  return GWEN_CurrentTime();
+}
+
+
+
+uint32_t AH_ImExporterSEPA_Export_Pain_GetUniqueId(AB_IMEXPORTER *ie)
+{
+  AH_IMEXPORTER_SEPA *ieh;
+
+  ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AH_IMEXPORTER_SEPA, ie);
+  assert(ieh);
+  if (ieh->fixedTime)
+    return ieh->nextFixedUniqueId++;
+
+  return AB_Banking_GetNamedUniqueId(AB_ImExporter_GetBanking(ie), "sepamsg", 1);
+}
+
+
+
+void AH_ImExporterSEPA_Export_Pain_WriteGrpHdr(AB_IMEXPORTER *ie,
+                                               AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                               uint32_t doctype[],
+                                               const AH_IMEXPORTER_SEPA_PMTINF_LIST *pl,
+                                               int transactionCount)
+{
+  GWEN_TIME *ti;
+  GWEN_BUFFER *tbuf;
+  uint32_t uid;
+  char numbuf[32];
+
+  AH_ImExporterSEPA_XmlWriter_OpenTag(w, "GrpHdr");
+  ti=AH_ImExporterSEPA_Export_Pain_GetTime(ie);
+
+  tbuf=GWEN_Buffer_new(0, 64, 0, 1);
+
+  /* generate MsgId */
+  uid=AH_ImExporterSEPA_Export_Pain_GetUniqueId(ie);
+  GWEN_Time_toUtcString(ti, "YYYYMMDD-hh:mm:ss-", tbuf);
+  snprintf(numbuf, sizeof(numbuf)-1, "%08x", uid);
+  GWEN_Buffer_AppendString(tbuf, numbuf);
+  AH_ImExporterSEPA_XmlWriter_WriteElement(w, "MsgId", GWEN_Buffer_GetStart(tbuf));
+  GWEN_Buffer_Reset(tbuf);
+
+  /* generate CreDtTm */
+  GWEN_Time_toUtcString(ti, "YYYY-MM-DDThh:mm:ssZ", tbuf);
+  AH_ImExporterSEPA_XmlWriter_WriteElement(w, "CreDtTm", GWEN_Buffer_GetStart(tbuf));
+  GWEN_Time_free(ti);
+  GWEN_Buffer_free(tbuf);
+
+  /* store NbOfTxs */
+  AH_ImExporterSEPA_XmlWriter_WriteIntElement(w, "NbOfTxs", transactionCount);
+
+  /* special treatment for pain.001.001.02 and pain.008.001.01 */
+  if (doctype[1]==1 && ((doctype[0]==1 && doctype[2]==2) ||
+                        (doctype[0]==8 && doctype[2]==1)))
+    AH_ImExporterSEPA_XmlWriter_WriteElement(w, "Grpg", "GRPD");
+
+  AH_ImExporterSEPA_XmlWriter_OpenTag(w, "InitgPty");
+  AH_ImExporterSEPA_XmlWriter_WriteElementEscaped(w, "Nm", AH_ImExporter_Sepa_PmtInf_List_First(pl)->localName);
+  AH_ImExporterSEPA_XmlWriter_CloseTag(w);
+
+  AH_ImExporterSEPA_XmlWriter_CloseTag(w);
+}
+
+
+
+void AH_ImExporterSEPA_Export_Pain_WritePmtInfId(AB_IMEXPORTER *ie, AH_IMEXPORTER_SEPA_XMLWRITER *w)
+{
+  GWEN_TIME *ti;
+  GWEN_BUFFER *tbuf;
+  uint32_t uid;
+  char numbuf[32];
+
+  ti=AH_ImExporterSEPA_Export_Pain_GetTime(ie);
+  tbuf=GWEN_Buffer_new(0, 64, 0, 1);
+
+  uid=AH_ImExporterSEPA_Export_Pain_GetUniqueId(ie);
+  GWEN_Time_toUtcString(ti, "YYYYMMDD-hh:mm:ss-", tbuf);
+  snprintf(numbuf, sizeof(numbuf)-1, "%08x", uid);
+  GWEN_Buffer_AppendString(tbuf, numbuf);
+  AH_ImExporterSEPA_XmlWriter_WriteElementEscaped(w, "PmtInfId", GWEN_Buffer_GetStart(tbuf));
+  GWEN_Buffer_free(tbuf);
+  GWEN_Time_free(ti);
+}
+
+
+
+void AH_ImExporterSEPA_Export_Pain_WriteDate(AH_IMEXPORTER_SEPA_XMLWRITER *w, const char *name, const GWEN_DATE *da)
+{
+  if (da) {
+    GWEN_BUFFER *tbuf;
+
+    tbuf=GWEN_Buffer_new(0, 64, 0, 1);
+    GWEN_Date_toStringWithTemplate(da, "YYYY-MM-DD", tbuf);
+    AH_ImExporterSEPA_XmlWriter_WriteElementEscaped(w, name, GWEN_Buffer_GetStart(tbuf));
+    GWEN_Buffer_free(tbuf);
+  }
+  else {
+    AH_ImExporterSEPA_XmlWriter_WriteElementEscaped(w, name, "1999-01-01");
+  }
+}
+
+
+
+void AH_ImExporterSEPA_Export_Pain_WriteAmount(AH_IMEXPORTER_SEPA_XMLWRITER *w, const char *name, const AB_VALUE *v)
+{
+  GWEN_BUFFER *tbuf;
+  const char *s;
+
+  tbuf=GWEN_Buffer_new(0, 64, 0, 1);
+  AB_Value_toHumanReadableString(v, tbuf, 2, 0);
+  s=AB_Value_GetCurrency(v);
+  if (!s)
+    s="EUR";
+  AH_ImExporterSEPA_XmlWriter_WriteElementWithProperty(w, name, "Ccy", s, GWEN_Buffer_GetStart(tbuf));
+  GWEN_Buffer_free(tbuf);
+}
+
+
+
 int AH_ImExporterSEPA_Export(AB_IMEXPORTER *ie,
                              AB_IMEXPORTER_CONTEXT *ctx,
                              GWEN_SYNCIO *sio,
                              GWEN_DB_NODE *params)
 {
   AH_IMEXPORTER_SEPA *ieh;
-  GWEN_XMLNODE *root;
-  GWEN_XMLNODE *documentNode;
-  GWEN_XMLNODE *topNode;
-  GWEN_XMLNODE *n;
+  AH_IMEXPORTER_SEPA_PMTINF_LIST *pl;
+  AH_IMEXPORTER_SEPA_XMLWRITER *w;
   uint32_t doctype[]= {0, 0, 0};
+  const char *xmlns;
+  const char *topName;
   const char *s;
+  int tcount=0;
   int rv;
 
   assert(ie);
@@ -378,70 +562,65 @@ int AH_ImExporterSEPA_Export(AB_IMEXPORTER *ie,
       doctype[0]=0;
   }
 
-  root=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "root");
-  n=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "?xml");
-  if (n) {
-    GWEN_XMLNode_AddHeader(root, n);
-    GWEN_XMLNode_SetProperty(n, "version", "1.0");
-    GWEN_XMLNode_SetProperty(n, "encoding", "UTF-8");
-  }
-
-  documentNode=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "Document");
-  s=GWEN_DB_GetCharValue(params, "xmlns", 0, 0);
-  if (!s || !*s) {
+  xmlns=GWEN_DB_GetCharValue(params, "xmlns", 0, 0);
+  if (!xmlns || !*xmlns) {
     DBG_ERROR(AQBANKING_LOGDOMAIN,
               "xmlns not specified in profile \"%s\"",
               GWEN_DB_GetCharValue(params, "name", 0, 0));
-    GWEN_XMLNode_free(root);
     return GWEN_ERROR_INVALID;
   }
-  GWEN_XMLNode_SetProperty(documentNode, "xmlns", s);
-  GWEN_XMLNode_AddChild(root, documentNode);
 
   switch (doctype[0]) {
   case 1:
     if (doctype[1]>1 || doctype[2]>2)
-      s="CstmrCdtTrfInitn";
+      topName="CstmrCdtTrfInitn";
     else
-      s=strstr(s, "pain");
-    topNode=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, s);
-    GWEN_XMLNode_AddChild(documentNode, topNode);
-    rv=AH_ImExporterSEPA_Export_Pain_001(ie, ctx, topNode, doctype, params);
+      topName=strstr(xmlns, "pain");
     break;
   case 8:
     if (!(doctype[1]==1 && doctype[2]==1))
-      s="CstmrDrctDbtInitn";
+      topName="CstmrDrctDbtInitn";
     else
-      s=strstr(s, "pain");
-    topNode=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, s);
-    GWEN_XMLNode_AddChild(documentNode, topNode);
-    rv=AH_ImExporterSEPA_Export_Pain_008(ie, ctx, topNode, doctype, params);
+      topName=strstr(xmlns, "pain");
     break;
   default:
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Unknown SEPA type \"%s\"",
               GWEN_DB_GetCharValue(params, "type", 0, 0));
-    GWEN_XMLNode_free(root);
+    return GWEN_ERROR_INVALID;
+  }
+  if (topName==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid xmlns \"%s\"", xmlns);
     return GWEN_ERROR_INVALID;
   }
 
-  if (rv==0) {
-    GWEN_XML_CONTEXT *xmlctx;
-
-    xmlctx=GWEN_XmlCtxStore_new(root,
-                                GWEN_XML_FLAGS_INDENT |
-                                GWEN_XML_FLAGS_SIMPLE |
-                                GWEN_XML_FLAGS_HANDLE_HEADERS);
+  /* sort transactions into PmtInf blocks, precompute counts and sums, check all data */
+  rv=AH_ImExporterSEPA_Export_Pain_Setup(ctx, doctype, params, &pl, &tcount);
+  if (rv) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "here %d", rv);
+    return rv;
+  }
 
-    rv=GWEN_XMLNode_WriteToStream(root, xmlctx, sio);
-    if (rv) {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
-    }
-    GWEN_XmlCtx_free(xmlctx);
-    GWEN_XMLNode_free(root);
+  /* write the document straight to the io layer */
+  w=AH_ImExporterSEPA_XmlWriter_new(sio);
+  AH_ImExporterSEPA_XmlWriter_WriteHeader(w);
+  AH_ImExporterSEPA_XmlWriter_OpenTagWithProperty(w, "Document", "xmlns", xmlns);
+  AH_ImExporterSEPA_XmlWriter_OpenTag(w, topName);
+  AH_ImExporterSEPA_Export_Pain_WriteGrpHdr(ie, w, doctype, pl, tcount);
+  if (doctype[0]==1)
+    AH_ImExporterSEPA_Export_Pain_001(ie, w, pl, doctype, params);
+  else
+    AH_ImExporterSEPA_Export_Pain_008(ie, w, pl, doctype, params);
+  AH_ImExporterSEPA_XmlWriter_CloseTag(w);
+  AH_ImExporterSEPA_XmlWriter_CloseTag(w);
+  rv=AH_ImExporterSEPA_XmlWriter_Finish(w);
+  AH_ImExporterSEPA_XmlWriter_free(w);
+  AH_ImExporter_Sepa_PmtInf_List_free(pl);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
   }
 
-  /* TODO */
-  return rv;
+  return 0;
 }
 
 
@@ -464,31 +643,10 @@ int AH_ImExporterSEPA_CheckFile(AB_IMEXPORTER *ie, const char *fname)
 
 
 
-int AH_ImExporterSEPA_XmlSetCharValueEscaped(GWEN_XMLNODE *n, const char *varName, const char *value)
-{
-  if (value && *value) {
-    GWEN_BUFFER *dbuf;
-    int rv;
-
-    dbuf=GWEN_Buffer_new(0, 256, 0, 1);
-    rv=GWEN_Text_EscapeXmlToBuffer(value, dbuf);
-    if (rv<0) {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
-      GWEN_Buffer_free(dbuf);
-      return rv;
-    }
-
-    GWEN_XMLNode_SetCharValue(n, varName, GWEN_Buffer_GetStart(dbuf));
-    GWEN_Buffer_free(dbuf);
-  }
-  return 0;
-}
-
-
-
 
 
 
+#include "sepa_xmlwriter.c"
 #include "sepa_pain_001.c"
 #include "sepa_pain_008.c"
 
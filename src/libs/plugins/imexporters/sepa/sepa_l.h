@@ -0,0 +1,28 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AQHBCI_IMEX_SEPA_L_H
+#define AQHBCI_IMEX_SEPA_L_H
+
+
+#include "sepa.h"
+
+
+/**
+ * Makes the output of the given SEPA exporter reproducible (only used by tests): Every following
+ * export writes the given creation time (UTC, "YYYYMMDDhhmmss") and numbers the message and payment
+ * info ids starting with firstUniqueId instead of using the current time and the "sepamsg" unique
+ * id counter.
+ * @return 0 if ok, error code if the creation time could not be parsed
+ */
+int AH_ImExporterSEPA_SetFixedIds(AB_IMEXPORTER *ie, const char *creationTime, uint32_t firstUniqueId);
+
+
+#endif /* AQHBCI_IMEX_SEPA_L_H */
@@ -12,14 +12,15 @@
 #define AQHBCI_IMEX_SEPA_P_H
 
 
-#include "sepa.h"
+#include "sepa_l.h"
 
 #include <aqbanking/backendsupport/imexporter_be.h>
 
 
 typedef struct AH_IMEXPORTER_SEPA AH_IMEXPORTER_SEPA;
 struct AH_IMEXPORTER_SEPA {
-  int dummy;
+  GWEN_TIME *fixedTime;
+  uint32_t nextFixedUniqueId;
 };
 
 typedef struct AH_IMEXPORTER_SEPA_PMTINF AH_IMEXPORTER_SEPA_PMTINF;
@@ -38,6 +39,21 @@ struct AH_IMEXPORTER_SEPA_PMTINF {
   AB_TRANSACTION_LIST2 *transactions;
 };
 
+#define AH_IMEXPORTER_SEPA_XMLWRITER_MAXDEPTH   16
+#define AH_IMEXPORTER_SEPA_XMLWRITER_MAXNAMELEN 32
+#define AH_IMEXPORTER_SEPA_XMLWRITER_FLUSHSIZE  65536
+
+typedef struct AH_IMEXPORTER_SEPA_XMLWRITER AH_IMEXPORTER_SEPA_XMLWRITER;
+struct AH_IMEXPORTER_SEPA_XMLWRITER {
+  GWEN_SYNCIO *sio;
+  GWEN_BUFFER *buffer;
+  int rv;
+  int depth;
+  int openTagPending;
+  const char *openTags[AH_IMEXPORTER_SEPA_XMLWRITER_MAXDEPTH];
+  char pathNames[AH_IMEXPORTER_SEPA_XMLWRITER_MAXDEPTH][AH_IMEXPORTER_SEPA_XMLWRITER_MAXNAMELEN];
+};
+
 /* these functions are not part of the public API */
 static void AH_ImExporter_Sepa_PmtInf_free(AH_IMEXPORTER_SEPA_PMTINF *pmtinf);
 GWEN_LIST_FUNCTION_DEFS(AH_IMEXPORTER_SEPA_PMTINF, AH_ImExporter_Sepa_PmtInf)
@@ -59,20 +75,67 @@ static int AH_ImExporterSEPA_Export(AB_IMEXPORTER *ie,
 static int AH_ImExporterSEPA_CheckFile(AB_IMEXPORTER *ie, const char *fname);
 
 
-static int AH_ImExporterSEPA_XmlSetCharValueEscaped(GWEN_XMLNODE *n, const char *varName, const char *value);
-
-
-static int AH_ImExporterSEPA_Export_Pain_001(AB_IMEXPORTER *ie,
-                                             AB_IMEXPORTER_CONTEXT *ctx,
-                                             GWEN_XMLNODE *painNode,
-                                             uint32_t doctype[],
-                                             GWEN_DB_NODE *params);
-
-static int AH_ImExporterSEPA_Export_Pain_008(AB_IMEXPORTER *ie,
-                                             AB_IMEXPORTER_CONTEXT *ctx,
-                                             GWEN_XMLNODE *painNode,
-                                             uint32_t doctype[],
-                                             GWEN_DB_NODE *params);
+static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER_CONTEXT *ctx,
+                                               uint32_t doctype[],
+                                               GWEN_DB_NODE *params,
+                                               AH_IMEXPORTER_SEPA_PMTINF_LIST **pList,
+                                               int *pTransactionCount);
+static int AH_ImExporterSEPA_Export_Pain_CheckTransaction(const AB_TRANSACTION *t, uint32_t doctype[]);
+static GWEN_TIME *AH_ImExporterSEPA_Export_Pain_GetTime(AB_IMEXPORTER *ie);
+static uint32_t AH_ImExporterSEPA_Export_Pain_GetUniqueId(AB_IMEXPORTER *ie);
+static void AH_ImExporterSEPA_Export_Pain_WriteGrpHdr(AB_IMEXPORTER *ie,
+                                                      AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                      uint32_t doctype[],
+                                                      const AH_IMEXPORTER_SEPA_PMTINF_LIST *pl,
+                                                      int transactionCount);
+static void AH_ImExporterSEPA_Export_Pain_WritePmtInfId(AB_IMEXPORTER *ie, AH_IMEXPORTER_SEPA_XMLWRITER *w);
+static void AH_ImExporterSEPA_Export_Pain_WriteDate(AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                    const char *name,
+                                                    const GWEN_DATE *da);
+static void AH_ImExporterSEPA_Export_Pain_WriteAmount(AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                      const char *name,
+                                                      const AB_VALUE *v);
+
+
+static void AH_ImExporterSEPA_Export_Pain_001(AB_IMEXPORTER *ie,
+                                              AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                              const AH_IMEXPORTER_SEPA_PMTINF_LIST *pl,
+                                              uint32_t doctype[],
+                                              GWEN_DB_NODE *params);
+
+static void AH_ImExporterSEPA_Export_Pain_008(AB_IMEXPORTER *ie,
+                                              AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                              const AH_IMEXPORTER_SEPA_PMTINF_LIST *pl,
+                                              uint32_t doctype[],
+                                              GWEN_DB_NODE *params);
+
+
+static AH_IMEXPORTER_SEPA_XMLWRITER *AH_ImExporterSEPA_XmlWriter_new(GWEN_SYNCIO *sio);
+static void AH_ImExporterSEPA_XmlWriter_free(AH_IMEXPORTER_SEPA_XMLWRITER *w);
+static int AH_ImExporterSEPA_XmlWriter_Finish(AH_IMEXPORTER_SEPA_XMLWRITER *w);
+static int AH_ImExporterSEPA_XmlWriter__Flush(AH_IMEXPORTER_SEPA_XMLWRITER *w, uint32_t minSize);
+static void AH_ImExporterSEPA_XmlWriter__Indent(AH_IMEXPORTER_SEPA_XMLWRITER *w);
+static void AH_ImExporterSEPA_XmlWriter_WriteHeader(AH_IMEXPORTER_SEPA_XMLWRITER *w);
+static void AH_ImExporterSEPA_XmlWriter_OpenTagWithProperty(AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                            const char *name,
+                                                            const char *propName,
+                                                            const char *propValue);
+static void AH_ImExporterSEPA_XmlWriter_OpenTag(AH_IMEXPORTER_SEPA_XMLWRITER *w, const char *name);
+static void AH_ImExporterSEPA_XmlWriter__OpenTagN(AH_IMEXPORTER_SEPA_XMLWRITER *w, const char *name, int len);
+static void AH_ImExporterSEPA_XmlWriter_CloseTag(AH_IMEXPORTER_SEPA_XMLWRITER *w);
+static void AH_ImExporterSEPA_XmlWriter_WriteElementWithProperty(AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                                 const char *name,
+                                                                 const char *propName,
+                                                                 const char *propValue,
+                                                                 const char *value);
+static void AH_ImExporterSEPA_XmlWriter_WriteElement(AH_IMEXPORTER_SEPA_XMLWRITER *w, const char *name, const char *value);
+static void AH_ImExporterSEPA_XmlWriter_WriteIntElement(AH_IMEXPORTER_SEPA_XMLWRITER *w, const char *name, int value);
+static void AH_ImExporterSEPA_XmlWriter_WriteElementEscaped(AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                            const char *name,
+                                                            const char *value);
+static void AH_ImExporterSEPA_XmlWriter_WriteElementByPath(AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                           const char *path,
+                                                           const char *value);
 
 
 #endif /* AQHBCI_IMEX_SEPA_P_H */
@@ -0,0 +1,261 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+/* included by sepa.c */
+
+
+/*
+ * Minimal streaming XML writer for pain documents.
+ *
+ * The layout is the same as that of GWEN_XMLNode_WriteToStream() with the flags
+ * GWEN_XML_FLAGS_INDENT, GWEN_XML_FLAGS_SIMPLE and GWEN_XML_FLAGS_HANDLE_HEADERS which was used
+ * before: every tag on its own line indented by two blanks per level, elements without sub tags
+ * (including empty ones) written as "<Name>data</Name>" on a single line.
+ *
+ * Errors are sticky: after the first write error all further calls are ignored and the error is
+ * returned by AH_ImExporterSEPA_XmlWriter_Finish().
+ */
+
+
+
+static AH_IMEXPORTER_SEPA_XMLWRITER *AH_ImExporterSEPA_XmlWriter_new(GWEN_SYNCIO *sio)
+{
+  AH_IMEXPORTER_SEPA_XMLWRITER *w;
+
+  GWEN_NEW_OBJECT(AH_IMEXPORTER_SEPA_XMLWRITER, w);
+  w->sio=sio;
+  w->buffer=GWEN_Buffer_new(0, AH_IMEXPORTER_SEPA_XMLWRITER_FLUSHSIZE+1024, 0, 1);
+  return w;
+}
+
+
+
+static void AH_ImExporterSEPA_XmlWriter_free(AH_IMEXPORTER_SEPA_XMLWRITER *w)
+{
+  if (w) {
+    GWEN_Buffer_free(w->buffer);
+    GWEN_FREE_OBJECT(w);
+  }
+}
+
+
+
+static int AH_ImExporterSEPA_XmlWriter__Flush(AH_IMEXPORTER_SEPA_XMLWRITER *w, uint32_t minSize)
+{
+  uint32_t len;
+
+  len=GWEN_Buffer_GetUsedBytes(w->buffer);
+  if (w->rv==0 && len>0 && len>=minSize) {
+    int rv;
+
+    rv=GWEN_SyncIo_WriteForced(w->sio, (const uint8_t *) GWEN_Buffer_GetStart(w->buffer), len);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      w->rv=rv;
+    }
+    GWEN_Buffer_Reset(w->buffer);
+  }
+
+  return w->rv;
+}
+
+
+
+static int AH_ImExporterSEPA_XmlWriter_Finish(AH_IMEXPORTER_SEPA_XMLWRITER *w)
+{
+  if (w->rv==0 && w->depth) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Unclosed tag \"%s\"", w->openTags[w->depth-1]);
+    w->rv=GWEN_ERROR_INTERNAL;
+  }
+  return AH_ImExporterSEPA_XmlWriter__Flush(w, 0);
+}
+
+
+
+static void AH_ImExporterSEPA_XmlWriter__Indent(AH_IMEXPORTER_SEPA_XMLWRITER *w)
+{
+  int i;
+
+  /* the line of the enclosing tag is only finished once it gets a sub tag */
+  if (w->openTagPending) {
+    GWEN_Buffer_AppendByte(w->buffer, '\n');
+    w->openTagPending=0;
+  }
+
+  for (i=0; i<w->depth; i++)
+    GWEN_Buffer_AppendString(w->buffer, "  ");
+}
+
+
+
+static void AH_ImExporterSEPA_XmlWriter_WriteHeader(AH_IMEXPORTER_SEPA_XMLWRITER *w)
+{
+  GWEN_Buffer_AppendString(w->buffer, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+}
+
+
+
+static void AH_ImExporterSEPA_XmlWriter_OpenTagWithProperty(AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                            const char *name,
+                                                            const char *propName,
+                                                            const char *propValue)
+{
+  if (w->depth>=AH_IMEXPORTER_SEPA_XMLWRITER_MAXDEPTH) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Tags nested too deeply");
+    w->rv=GWEN_ERROR_INTERNAL;
+    return;
+  }
+
+  AH_ImExporterSEPA_XmlWriter__Indent(w);
+  GWEN_Buffer_AppendByte(w->buffer, '<');
+  GWEN_Buffer_AppendString(w->buffer, name);
+  if (propName) {
+    GWEN_Buffer_AppendByte(w->buffer, ' ');
+    GWEN_Buffer_AppendString(w->buffer, propName);
+    GWEN_Buffer_AppendString(w->buffer, "=\"");
+    GWEN_Buffer_AppendString(w->buffer, propValue);
+    GWEN_Buffer_AppendByte(w->buffer, '"');
+  }
+  GWEN_Buffer_AppendByte(w->buffer, '>');
+  w->openTagPending=1;
+  w->openTags[w->depth++]=name;
+}
+
+
+
+static void AH_ImExporterSEPA_XmlWriter_OpenTag(AH_IMEXPORTER_SEPA_XMLWRITER *w, const char *name)
+{
+  AH_ImExporterSEPA_XmlWriter_OpenTagWithProperty(w, name, NULL, NULL);
+}
+
+
+
+static void AH_ImExporterSEPA_XmlWriter_CloseTag(AH_IMEXPORTER_SEPA_XMLWRITER *w)
+{
+  assert(w->depth>0);
+  w->depth--;
+  if (w->openTagPending)
+    /* no sub tags, close on the same line */
+    w->openTagPending=0;
+  else
+    AH_ImExporterSEPA_XmlWriter__Indent(w);
+  GWEN_Buffer_AppendString(w->buffer, "</");
+  GWEN_Buffer_AppendString(w->buffer, w->openTags[w->depth]);
+  GWEN_Buffer_AppendString(w->buffer, ">\n");
+
+  /* only flush between complete elements */
+  AH_ImExporterSEPA_XmlWriter__Flush(w, AH_IMEXPORTER_SEPA_XMLWRITER_FLUSHSIZE);
+}
+
+
+
+/* writes the value as is (like GWEN_XMLNode_SetCharValue) */
+static void AH_ImExporterSEPA_XmlWriter_WriteElementWithProperty(AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                                 const char *name,
+                                                                 const char *propName,
+                                                                 const char *propValue,
+                                                                 const char *value)
+{
+  AH_ImExporterSEPA_XmlWriter__Indent(w);
+  GWEN_Buffer_AppendByte(w->buffer, '<');
+  GWEN_Buffer_AppendString(w->buffer, name);
+  if (propName) {
+    GWEN_Buffer_AppendByte(w->buffer, ' ');
+    GWEN_Buffer_AppendString(w->buffer, propName);
+    GWEN_Buffer_AppendString(w->buffer, "=\"");
+    GWEN_Buffer_AppendString(w->buffer, propValue);
+    GWEN_Buffer_AppendByte(w->buffer, '"');
+  }
+  GWEN_Buffer_AppendByte(w->buffer, '>');
+  if (value)
+    GWEN_Buffer_AppendString(w->buffer, value);
+  GWEN_Buffer_AppendString(w->buffer, "</");
+  GWEN_Buffer_AppendString(w->buffer, name);
+  GWEN_Buffer_AppendString(w->buffer, ">\n");
+}
+
+
+
+static void AH_ImExporterSEPA_XmlWriter_WriteElement(AH_IMEXPORTER_SEPA_XMLWRITER *w, const char *name, const char *value)
+{
+  AH_ImExporterSEPA_XmlWriter_WriteElementWithProperty(w, name, NULL, NULL, value);
+}
+
+
+
+static void AH_ImExporterSEPA_XmlWriter_WriteIntElement(AH_IMEXPORTER_SEPA_XMLWRITER *w, const char *name, int value)
+{
+  char numbuf[32];
+
+  snprintf(numbuf, sizeof(numbuf)-1, "%d", value);
+  numbuf[sizeof(numbuf)-1]=0;
+  AH_ImExporterSEPA_XmlWriter_WriteElement(w, name, numbuf);
+}
+
+
+
+/* escapes the value, empty values are not written at all (like AH_ImExporterSEPA_XmlSetCharValueEscaped) */
+static void AH_ImExporterSEPA_XmlWriter_WriteElementEscaped(AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                            const char *name,
+                                                            const char *value)
+{
+  if (value && *value) {
+    AH_ImExporterSEPA_XmlWriter__Indent(w);
+    GWEN_Buffer_AppendByte(w->buffer, '<');
+    GWEN_Buffer_AppendString(w->buffer, name);
+    GWEN_Buffer_AppendByte(w->buffer, '>');
+    if (GWEN_Text_EscapeXmlToBuffer(value, w->buffer)<0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not escape value of \"%s\"", name);
+      if (w->rv==0)
+        w->rv=GWEN_ERROR_BAD_DATA;
+    }
+    GWEN_Buffer_AppendString(w->buffer, "</");
+    GWEN_Buffer_AppendString(w->buffer, name);
+    GWEN_Buffer_AppendString(w->buffer, ">\n");
+  }
+}
+
+
+
+/* writes "A/B/C" as nested elements with the value as is (like GWEN_XMLNode_SetCharValueByPath) */
+static void AH_ImExporterSEPA_XmlWriter_WriteElementByPath(AH_IMEXPORTER_SEPA_XMLWRITER *w,
+                                                           const char *path,
+                                                           const char *value)
+{
+  const char *p;
+  int depth;
+
+  depth=w->depth;
+  p=strchr(path, '/');
+  while (p) {
+    AH_ImExporterSEPA_XmlWriter__OpenTagN(w, path, p-path);
+    path=p+1;
+    p=strchr(path, '/');
+  }
+  AH_ImExporterSEPA_XmlWriter_WriteElement(w, path, value);
+  while (w->depth>depth)
+    AH_ImExporterSEPA_XmlWriter_CloseTag(w);
+}
+
+
+
+/* open a tag whose name is the first len bytes of the given string */
+static void AH_ImExporterSEPA_XmlWriter__OpenTagN(AH_IMEXPORTER_SEPA_XMLWRITER *w, const char *name, int len)
+{
+  if (w->depth>=AH_IMEXPORTER_SEPA_XMLWRITER_MAXDEPTH || len>=AH_IMEXPORTER_SEPA_XMLWRITER_MAXNAMELEN) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid path element \"%.*s\"", len, name);
+    w->rv=GWEN_ERROR_INTERNAL;
+    return;
+  }
+
+  /* path elements are copied because the path string is only valid during the call */
+  memmove(w->pathNames[w->depth], name, len);
+  w->pathNames[w->depth][len]=0;
+  AH_ImExporterSEPA_XmlWriter_OpenTag(w, w->pathNames[w->depth]);
+}
@@ -13,6 +13,7 @@
 
 #include "swift_p.h"
 #include "aqbanking/i18n_l.h"
+#include "plugins/parsers/swift/swift_l.h"
 
 #include <aqbanking/banking.h>
 #include <aqbanking/types/balance.h>
@@ -22,11 +23,16 @@
 #include <gwenhywfar/gui.h>
 #include <gwenhywfar/inherit.h>
 
+#include <string.h>
+
 
 /*#define SWIFT_VERBOSE_DEBUG*/
 
 
 
+static int _handleTransactionGroup(GWEN_DB_NODE *dbTransaction, void *user_data);
+static int _groupNameMatches(GWEN_DB_NODE *dbT, GWEN_DB_NODE *dbParams);
+static int _importTransactionFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbT);
 static int _importSecuritiesFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db);
 static void _replaceValueInDb(GWEN_DB_NODE *db, const char *grpName, const char *destName);
 
@@ -79,6 +85,7 @@ int AH_ImExporterSWIFT_Import(AB_IMEXPORTER *ie,
                               GWEN_DB_NODE *params)
 {
   AH_IMEXPORTER_SWIFT *ieh;
+  AH_IMEXPORTER_SWIFT_IMPORT xi;
   GWEN_DB_NODE *dbData;
   GWEN_DB_NODE *dbSubParams;
   int rv;
@@ -101,13 +108,19 @@ int AH_ImExporterSWIFT_Import(AB_IMEXPORTER *ie,
 #endif
 
 
-  DBG_INFO(AQBANKING_LOGDOMAIN, "Importing SWIFT data into GWEN_DB");
-  rv=GWEN_DBIO_Import(ieh->dbio,
-                      sio,
-                      dbData,
-                      dbSubParams,
-                      GWEN_DB_FLAGS_DEFAULT |
-                      GWEN_PATH_FLAGS_CREATE_GROUP);
+  /* transactions are added to the context as soon as they are complete, only balances and securities
+   * are collected in dbData */
+  memset(&xi, 0, sizeof(xi));
+  xi.context=ctx;
+  xi.dbParams=params;
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Importing SWIFT data");
+  rv=AHB_SWIFT_ImportWithHandler(sio,
+                                 dbData,
+                                 dbSubParams,
+                                 GWEN_DB_FLAGS_DEFAULT |
+                                 GWEN_PATH_FLAGS_CREATE_GROUP,
+                                 _handleTransactionGroup,
+                                 &xi);
   if (rv) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Error importing data (%d)", rv);
     GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
@@ -115,16 +128,16 @@ int AH_ImExporterSWIFT_Import(AB_IMEXPORTER *ie,
     GWEN_DB_Group_free(dbData);
     return GWEN_ERROR_BAD_DATA;
   }
-  DBG_INFO(AQBANKING_LOGDOMAIN, "Importing SWIFT data into GWEN_DB: done");
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Importing SWIFT data: %d transactions imported while reading", xi.transactionCount);
 
 #ifdef SWIFT_VERBOSE_DEBUG
   DBG_ERROR(0, "Imported SWIFT data is (GWEN_DB):");
   GWEN_DB_Dump(dbData, 2);
 #endif
 
-  /* transform DB to transactions */
+  /* transform remaining DB to balances */
   GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Debug,
-                       "Data imported, transforming to transactions");
+                       "Data imported, transforming to balances");
   rv=AH_ImExporterSWIFT__ImportFromGroup(ctx, dbData, params);
   if (rv) {
     GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error, "Error importing data");
@@ -166,157 +179,16 @@ int AH_ImExporterSWIFT__ImportFromGroup(AB_IMEXPORTER_CONTEXT *ctx,
   dbT=GWEN_DB_GetFirstGroup(db);
   while (dbT) {
     int matches;
-    int i;
-    const char *p;
-    const char *gn;
-
-    // check whether the name of the current groups matches
-    matches=0;
-    gn=GWEN_DB_GroupName(dbT);
-    for (i=0; ; i++) {
-      p=GWEN_DB_GetCharValue(dbParams, "groupNames", i, 0);
-      if (!p)
-        break;
-      if (strcasecmp(gn, p)==0) {
-        matches=1;
-        break;
-      }
-    } // for
-
-    if (!matches && i==0) {
-      // no names given, check default
-      if ((strcasecmp(GWEN_DB_GroupName(dbT), "transaction")==0) ||
-          (strcasecmp(GWEN_DB_GroupName(dbT), "debitnote")==0))
-        matches=1;
-    }
 
+    matches=_groupNameMatches(dbT, dbParams);
     if (matches) {
-      AB_TRANSACTION *t;
-      const char *s;
-      const GWEN_DATE *dt;
-
-      /* replace "name/value" and "name/currency" by "name=value:currency" */
-      _replaceValueInDb(dbT, "value", "value");
-      _replaceValueInDb(dbT, "fees", "fees");
-      _replaceValueInDb(dbT, "unitPriceValue", "unitPriceValue");
-      _replaceValueInDb(dbT, "commissionValue", "commissionValue");
-
-      t=AB_Transaction_fromDb(dbT);
-      if (!t) {
-        DBG_ERROR(AQBANKING_LOGDOMAIN, "Error in config file");
-        GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
-                             I18N("Error in config file"));
-        return GWEN_ERROR_GENERIC;
-      }
-
-      /* check for date */
-      dt=AB_Transaction_GetDate(t);
-      if (dt==NULL) {
-        /* no date, use valutaDate for both fields */
-        dt=AB_Transaction_GetValutaDate(t);
-        AB_Transaction_SetDate(t, dt);
-      }
-
-      /* some translations */
-      s=AB_Transaction_GetRemoteIban(t);
-      if (!(s && *s)) {
-        const char *sAid;
-
-        /* no remote IBAN set, check whether the bank sends this info in the
-         * fields for national account specifications (instead of the SWIFT
-         * field "?38" which was specified for this case) */
-        sAid=AB_Transaction_GetRemoteAccountNumber(t);
-        if (sAid && *sAid && AB_Banking_CheckIban(sAid)==0) {
-          /* there is a remote account number specification, and that is an IBAN,
-           * so we set that accordingly */
-          DBG_INFO(AQBANKING_LOGDOMAIN, "Setting remote IBAN from account number");
-          AB_Transaction_SetRemoteIban(t, sAid);
-
-          /* set remote BIC if it not already is */
-          s=AB_Transaction_GetRemoteBic(t);
-          if (!(s && *s)) {
-            const char *sBid;
-
-            sBid=AB_Transaction_GetRemoteBankCode(t);
-            if (sBid && *sBid) {
-              DBG_INFO(AQBANKING_LOGDOMAIN, "Setting remote BIC from bank code");
-              AB_Transaction_SetRemoteBic(t, sBid);
-            }
-          }
-        }
-      }
-
-#if 0   /* disable ABWA+ and ABWE+: We can't safely know when to change them */
-      if (1) {
-        const char *varName;
-        int i;
-        GWEN_BUFFER *nameBuf;
-
-        if (GWEN_DB_VariableExists(dbT, "sepa/ABWA"))
-          varName="sepa/ABWA";
-        else if (GWEN_DB_VariableExists(dbT, "sepa/ABWE"))
-          varName="sepa/ABWE";
-        else
-          varName="remoteName";
-        nameBuf=GWEN_Buffer_new(0, 256, 0, 1);
-        for (i=0; i<2; i++) {
-          s=GWEN_DB_GetCharValue(dbT, varName, i, NULL);
-          if (s && *s) {
-            GWEN_Buffer_AppendString(nameBuf, s);
-          }
-        }
-        if (GWEN_Buffer_GetUsedBytes(nameBuf))
-          AB_Transaction_SetRemoteName(t, GWEN_Buffer_GetStart(nameBuf));
-      }
-#endif
-
-      /* read all lines of the remote name and concatenate them (addresses bug #57) */
-      if (1) {
-        int i;
-        GWEN_BUFFER *nameBuf;
-
-        nameBuf=GWEN_Buffer_new(0, 256, 0, 1);
-        for (i=0; i<4; i++) {
-          s=GWEN_DB_GetCharValue(dbT, "remoteName", i, NULL);
-          if (s && *s)
-            GWEN_Buffer_AppendString(nameBuf, s);
-          else
-            break;
-        }
-        if (GWEN_Buffer_GetUsedBytes(nameBuf))
-          AB_Transaction_SetRemoteName(t, GWEN_Buffer_GetStart(nameBuf));
-        GWEN_Buffer_free(nameBuf);
-      }
-
-
-#if 0
-      /* for now ignore these variables.
-       *
-       * Who is the recipient and who the initiator depends on the type of transaction.
-       * Currently we have no safe way to determine whether the transaction was a
-       * - transfer (negative amount, we are the payee and the initiator)
-       * - or a debit note from someone else (also negative amount, we are the payee also but not the initiator)
-       * - debit note initiated by us (we are the recipient but also the initiator)
-       */
-      if (1) {
-        const char *s;
-
-        s=GWEN_DB_GetCharValue(dbT, "sepa/ABWA", 0, NULL);
-        if (s && *s) {
-          /* for now: ignore this "ABWA"="Abweichender Auftraggeber" */
-        }
+      int rv;
 
-        s=GWEN_DB_GetCharValue(dbT, "sepa/ABWE", 0, NULL);
-        if (s && *s) {
-          /* for now: ignore this "ABWA"="Abweichender Empfaenger" */
-        }
+      rv=_importTransactionFromGroup(ctx, dbT);
+      if (rv) {
+        GWEN_Gui_ProgressEnd(progressId);
+        return rv;
       }
-#endif
-
-      /* add transaction */
-      DBG_DEBUG(AQBANKING_LOGDOMAIN, "Adding transaction");
-      GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Debug, I18N("Adding transaction"));
-      AB_ImExporterContext_AddTransaction(ctx, t);
     }
     else if (strcasecmp(GWEN_DB_GroupName(dbT), "startSaldo")==0) {
       /* ignore start saldo, but since the existence of this group shows
@@ -390,6 +262,7 @@ int AH_ImExporterSWIFT__ImportFromGroup(AB_IMEXPORTER_CONTEXT *ctx,
       GWEN_Gui_ProgressEnd(progressId);
       return GWEN_ERROR_USER_ABORTED;
     }
+
     dbT=GWEN_DB_GetNextGroup(dbT);
   } // while
 
@@ -400,6 +273,187 @@ int AH_ImExporterSWIFT__ImportFromGroup(AB_IMEXPORTER_CONTEXT *ctx,
 
 
 
+int _handleTransactionGroup(GWEN_DB_NODE *dbTransaction, void *user_data)
+{
+  AH_IMEXPORTER_SWIFT_IMPORT *xi;
+
+  xi=(AH_IMEXPORTER_SWIFT_IMPORT *) user_data;
+  if (_groupNameMatches(dbTransaction, xi->dbParams)) {
+    int rv;
+
+    rv=_importTransactionFromGroup(xi->context, dbTransaction);
+    if (rv) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    xi->transactionCount++;
+  }
+
+  return 0;
+}
+
+
+
+int _groupNameMatches(GWEN_DB_NODE *dbT, GWEN_DB_NODE *dbParams)
+{
+  int i;
+  const char *p;
+  const char *gn;
+
+  gn=GWEN_DB_GroupName(dbT);
+  for (i=0; ; i++) {
+    p=GWEN_DB_GetCharValue(dbParams, "groupNames", i, 0);
+    if (!p)
+      break;
+    if (strcasecmp(gn, p)==0)
+      return 1;
+  } // for
+
+  if (i==0) {
+    // no names given, check default
+    if ((strcasecmp(gn, "transaction")==0) ||
+        (strcasecmp(gn, "debitnote")==0))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+
+int _importTransactionFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbT)
+{
+  AB_TRANSACTION *t;
+  const char *s;
+  const GWEN_DATE *dt;
+
+  /* replace "name/value" and "name/currency" by "name=value:currency" */
+  _replaceValueInDb(dbT, "value", "value");
+  _replaceValueInDb(dbT, "fees", "fees");
+  _replaceValueInDb(dbT, "unitPriceValue", "unitPriceValue");
+  _replaceValueInDb(dbT, "commissionValue", "commissionValue");
+
+  t=AB_Transaction_fromDb(dbT);
+  if (!t) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Error in config file");
+    GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
+                         I18N("Error in config file"));
+    return GWEN_ERROR_GENERIC;
+  }
+
+  /* check for date */
+  dt=AB_Transaction_GetDate(t);
+  if (dt==NULL) {
+    /* no date, use valutaDate for both fields */
+    dt=AB_Transaction_GetValutaDate(t);
+    AB_Transaction_SetDate(t, dt);
+  }
+
+  /* some translations */
+  s=AB_Transaction_GetRemoteIban(t);
+  if (!(s && *s)) {
+    const char *sAid;
+
+    /* no remote IBAN set, check whether the bank sends this info in the
+     * fields for national account specifications (instead of the SWIFT
+     * field "?38" which was specified for this case) */
+    sAid=AB_Transaction_GetRemoteAccountNumber(t);
+    if (sAid && *sAid && AB_Banking_CheckIban(sAid)==0) {
+      /* there is a remote account number specification, and that is an IBAN,
+       * so we set that accordingly */
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Setting remote IBAN from account number");
+      AB_Transaction_SetRemoteIban(t, sAid);
+
+      /* set remote BIC if it not already is */
+      s=AB_Transaction_GetRemoteBic(t);
+      if (!(s && *s)) {
+        const char *sBid;
+
+        sBid=AB_Transaction_GetRemoteBankCode(t);
+        if (sBid && *sBid) {
+          DBG_INFO(AQBANKING_LOGDOMAIN, "Setting remote BIC from bank code");
+          AB_Transaction_SetRemoteBic(t, sBid);
+        }
+      }
+    }
+  }
+
+#if 0   /* disable ABWA+ and ABWE+: We can't safely know when to change them */
+  if (1) {
+    const char *varName;
+    int i;
+    GWEN_BUFFER *nameBuf;
+
+    if (GWEN_DB_VariableExists(dbT, "sepa/ABWA"))
+      varName="sepa/ABWA";
+    else if (GWEN_DB_VariableExists(dbT, "sepa/ABWE"))
+      varName="sepa/ABWE";
+    else
+      varName="remoteName";
+    nameBuf=GWEN_Buffer_new(0, 256, 0, 1);
+    for (i=0; i<2; i++) {
+      s=GWEN_DB_GetCharValue(dbT, varName, i, NULL);
+      if (s && *s) {
+        GWEN_Buffer_AppendString(nameBuf, s);
+      }
+    }
+    if (GWEN_Buffer_GetUsedBytes(nameBuf))
+      AB_Transaction_SetRemoteName(t, GWEN_Buffer_GetStart(nameBuf));
+  }
+#endif
+
+  /* read all lines of the remote name and concatenate them (addresses bug #57) */
+  if (1) {
+    int i;
+    GWEN_BUFFER *nameBuf;
+
+    nameBuf=GWEN_Buffer_new(0, 256, 0, 1);
+    for (i=0; i<4; i++) {
+      s=GWEN_DB_GetCharValue(dbT, "remoteName", i, NULL);
+      if (s && *s)
+        GWEN_Buffer_AppendString(nameBuf, s);
+      else
+        break;
+    }
+    if (GWEN_Buffer_GetUsedBytes(nameBuf))
+      AB_Transaction_SetRemoteName(t, GWEN_Buffer_GetStart(nameBuf));
+    GWEN_Buffer_free(nameBuf);
+  }
+
+
+#if 0
+  /* for now ignore these variables.
+   *
+   * Who is the recipient and who the initiator depends on the type of transaction.
+   * Currently we have no safe way to determine whether the transaction was a
+   * - transfer (negative amount, we are the payee and the initiator)
+   * - or a debit note from someone else (also negative amount, we are the payee also but not the initiator)
+   * - debit note initiated by us (we are the recipient but also the initiator)
+   */
+  if (1) {
+    const char *s;
+
+    s=GWEN_DB_GetCharValue(dbT, "sepa/ABWA", 0, NULL);
+    if (s && *s) {
+      /* for now: ignore this "ABWA"="Abweichender Auftraggeber" */
+    }
+
+    s=GWEN_DB_GetCharValue(dbT, "sepa/ABWE", 0, NULL);
+    if (s && *s) {
+      /* for now: ignore this "ABWA"="Abweichender Empfaenger" */
+    }
+  }
+#endif
+
+  /* add transaction */
+  DBG_DEBUG(AQBANKING_LOGDOMAIN, "Adding transaction");
+  GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Debug, I18N("Adding transaction"));
+  AB_ImExporterContext_AddTransaction(ctx, t);
+  return 0;
+}
+
+
+
 int _importSecuritiesFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db)
 {
   GWEN_DB_NODE *dbT;
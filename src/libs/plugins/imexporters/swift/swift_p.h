@@ -24,6 +24,15 @@ struct AH_IMEXPORTER_SWIFT {
 };
 
 
+/* data for the handler of transaction groups while reading a document */
+typedef struct AH_IMEXPORTER_SWIFT_IMPORT AH_IMEXPORTER_SWIFT_IMPORT;
+struct AH_IMEXPORTER_SWIFT_IMPORT {
+  AB_IMEXPORTER_CONTEXT *context;
+  GWEN_DB_NODE *dbParams;
+  int transactionCount;
+};
+
+
 static void GWENHYWFAR_CB AH_ImExporterSWIFT_FreeData(void *bp, void *p);
 
 static int AH_ImExporterSWIFT_Import(AB_IMEXPORTER *ie,
@@ -14,6 +14,7 @@
 #include "xml_p.h"
 #include "xml_sepa_exp.h"
 #include "xml_sepa_imp.h"
+#include "xml_stream_imp.h"
 
 #include "aqbanking/i18n_l.h"
 
@@ -40,6 +41,8 @@ GWEN_INHERIT(AB_IMEXPORTER, AB_IMEXPORTER_XML);
  */
 
 static void _readAccountsFromDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbData);
+static AB_IMEXPORTER_ACCOUNTINFO *_getAccountInfoForDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbAccount);
+static void _readTransactionsFromDb(AB_IMEXPORTER_ACCOUNTINFO *accountInfo, GWEN_DB_NODE *dbAccount);
 static int _readSecuritiesFromDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbData);
 static AB_TRANSACTION *dbToTransaction(GWEN_DB_NODE *dbAccount, GWEN_DB_NODE *dbTransaction);
 static void handleTransactionDetails(AB_TRANSACTION *t, const char *sDetails);
@@ -68,17 +71,6 @@ static GWEN_DB_NODE *AB_ImExporterXML_ImportIntoDbWithSchemaDoc(AB_IMEXPORTER *i
                                                                 GWEN_XMLNODE *xmlDocSchema);
 
 
-static GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFiles(AB_IMEXPORTER *ie);
-
-static GWEN_XMLNODE *AB_ImExporterXML_FindMatchingSchema(AB_IMEXPORTER *ie, GWEN_XMLNODE *xmlNodeAllSchemata,
-                                                         GWEN_XMLNODE *xmlDocData);
-static const char *AB_ImExporterXML_GetCharValueByPath(GWEN_XMLNODE *xmlNode, const char *path, const char *defValue);
-
-
-static int AB_ImExporterXML_ImportDb(AB_IMEXPORTER *ie,
-                                     AB_IMEXPORTER_CONTEXT *ctx,
-                                     GWEN_DB_NODE *dbData);
-
 static void _transformValue(GWEN_DB_NODE *dbData, const char *varNameValue, const char *varNameCurrency,
                             const char *destVarName);
 
@@ -121,6 +113,7 @@ AB_IMEXPORTER *AB_ImExporterXML_new(AB_BANKING *ab)
 
   ie=AB_ImExporter_new(ab, "xml");
   GWEN_NEW_OBJECT(AB_IMEXPORTER_XML, ieh);
+  ieh->schemaCache=AB_ImExporterXML_SchemaCache_new();
   GWEN_INHERIT_SETDATA(AB_IMEXPORTER, AB_IMEXPORTER_XML, ie, ieh, AB_ImExporterXML_FreeData);
 
   AB_ImExporter_SetImportFn(ie, AB_ImExporterXML_Import);
@@ -137,6 +130,7 @@ void GWENHYWFAR_CB AB_ImExporterXML_FreeData(void *bp, void *p)
 
   ieh=(AB_IMEXPORTER_XML *)p;
 
+  AB_ImExporterXML_SchemaCache_free(ieh->schemaCache);
   GWEN_FREE_OBJECT(ieh);
 }
 
@@ -178,6 +172,15 @@ int AB_ImExporterXML_Import(AB_IMEXPORTER *ie,
     if (s && strcasecmp(s, "sgml")==0)
       xmlFlags|=GWEN_XML_FLAGS_SGML|GWEN_XML_FLAGS_TOLERANT_ENDTAGS;
 
+    s=GWEN_DB_GetCharValue(dbSubParams, "streamElement", 0, NULL);
+    if (s && *s) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Importing file in streaming mode (record element \"%s\")", s);
+      return AB_ImExporterXML_ImportStream(ie, ctx, sio,
+                                           GWEN_DB_GetCharValue(dbSubParams, "schema", 0, NULL),
+                                           s,
+                                           xmlFlags);
+    }
+
     xmlDocData=AB_ImExporterXML_ReadXmlFromSio(ie, sio, xmlFlags);
     if (xmlDocData==NULL) {
       DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not read XML input");
@@ -343,6 +346,7 @@ GWEN_DB_NODE *AB_ImExporterXML_ImportIntoDbWithSchemaDoc(AB_IMEXPORTER *ie, GWEN
 
 GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFromFile(AB_IMEXPORTER *ie, const char *schemaName)
 {
+  AB_IMEXPORTER_XML *ieh;
   GWEN_BUFFER *tbuf;
   GWEN_BUFFER *fullPathBuffer;
   GWEN_XMLNODE *xmlNodeFile;
@@ -365,6 +369,16 @@ GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFromFile(AB_IMEXPORTER *ie, const char
   }
   GWEN_Buffer_free(tbuf);
 
+  ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AB_IMEXPORTER_XML, ie);
+  assert(ieh);
+  xmlNodeSchema=AB_ImExporterXML_SchemaCache_GetSchemaByFile(ieh->schemaCache, AB_ImExporter_GetBanking(ie),
+                                                             GWEN_Buffer_GetStart(fullPathBuffer));
+  if (xmlNodeSchema) {
+    GWEN_Buffer_free(fullPathBuffer);
+    return xmlNodeSchema;
+  }
+
+  /* not in the list of schema files, read directly */
   xmlNodeFile=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "schemaFile");
   rv=GWEN_XML_ReadFile(xmlNodeFile, GWEN_Buffer_GetStart(fullPathBuffer),
                        GWEN_XML_FLAGS_HANDLE_COMMENTS | GWEN_XML_FLAGS_HANDLE_HEADERS);
@@ -395,190 +409,17 @@ GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFromFile(AB_IMEXPORTER *ie, const char
 
 GWEN_XMLNODE *AB_ImExporterXML_DetermineSchema(AB_IMEXPORTER *ie, GWEN_XMLNODE *xmlDocData)
 {
-  GWEN_XMLNODE *xmlNodeAllSchemata;
-
-  xmlNodeAllSchemata=AB_ImExporterXML_ReadSchemaFiles(ie);
-  if (xmlNodeAllSchemata) {
-    GWEN_XMLNODE *xmlNodeSchema;
-
-    xmlNodeSchema=AB_ImExporterXML_FindMatchingSchema(ie, xmlNodeAllSchemata, xmlDocData);
-    if (xmlNodeSchema) {
-      GWEN_XMLNode_UnlinkChild(xmlNodeAllSchemata, xmlNodeSchema);
-      GWEN_XMLNode_free(xmlNodeAllSchemata);
-      return xmlNodeSchema;
-    }
-    else {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "No matching schema");
-      GWEN_XMLNode_free(xmlNodeAllSchemata);
-      return NULL;
-    }
-  }
-  else {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "No schemata");
-    return NULL;
-  }
-
-
-}
-
-
-
-GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFiles(AB_IMEXPORTER *ie)
-{
-  GWEN_STRINGLIST *slDataFiles;
-
-  /* get list of all schema files */
-  slDataFiles=AB_Banking_ListDataFilesForImExporter(AB_ImExporter_GetBanking(ie), "xml", "*.xml");
-  if (slDataFiles) {
-    GWEN_XMLNODE *xmlNodeAllSchemata;
-    GWEN_STRINGLISTENTRY *seDataFile;
-
-    xmlNodeAllSchemata=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "allSchemaFiles");
-
-    seDataFile=GWEN_StringList_FirstEntry(slDataFiles);
-    while (seDataFile) {
-      GWEN_XMLNODE *xmlNodeFile;
-      int rv;
-
-      xmlNodeFile=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "schemaFile");
-      rv=GWEN_XML_ReadFile(xmlNodeFile, GWEN_StringListEntry_Data(seDataFile),
-                           GWEN_XML_FLAGS_HANDLE_COMMENTS | GWEN_XML_FLAGS_HANDLE_HEADERS);
-      if (rv<0) {
-        DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading schema file \"%s\" (%d), ignoring.",
-                  GWEN_StringListEntry_Data(seDataFile), rv);
-      }
-      else {
-        GWEN_XMLNODE *xmlNodeSchema;
-
-        xmlNodeSchema=GWEN_XMLNode_FindFirstTag(xmlNodeFile, "Schema", NULL, NULL);
-        if (xmlNodeSchema) {
-          GWEN_XMLNode_UnlinkChild(xmlNodeFile, xmlNodeSchema);
-          GWEN_XMLNode_AddChild(xmlNodeAllSchemata, xmlNodeSchema);
-        }
-        else {
-          DBG_ERROR(AQBANKING_LOGDOMAIN, "Missing \"Schema\" in schema file \"%s\", ignoring.",
-                    GWEN_StringListEntry_Data(seDataFile));
-        }
-      } /* if (xmlNode) */
-      GWEN_XMLNode_free(xmlNodeFile);
-
-      seDataFile=GWEN_StringListEntry_Next(seDataFile);
-    } /* while(se) */
-
-    GWEN_StringList_free(slDataFiles);
-
-    return xmlNodeAllSchemata;
-  } /* if (sl) */
-  else {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "No data files");
-    return NULL;
-  }
-}
-
-
-
-GWEN_XMLNODE *AB_ImExporterXML_FindMatchingSchema(AB_IMEXPORTER *ie, GWEN_XMLNODE *xmlNodeAllSchemata,
-                                                  GWEN_XMLNODE *xmlDocData)
-{
-  GWEN_XMLNODE *xmlNodeSchema;
+  AB_IMEXPORTER_XML *ieh;
 
-  xmlNodeSchema=GWEN_XMLNode_FindFirstTag(xmlNodeAllSchemata, "Schema", NULL, NULL);
-  while (xmlNodeSchema) {
-    GWEN_XMLNODE *xmlNodeDocMatches;
-
-    xmlNodeDocMatches=GWEN_XMLNode_FindFirstTag(xmlNodeSchema, "DocMatches", NULL, NULL);
-    if (xmlNodeDocMatches) {
-      GWEN_XMLNODE *xmlNodeMatch;
-
-      xmlNodeMatch=GWEN_XMLNode_FindFirstTag(xmlNodeDocMatches, "Match", NULL, NULL);
-      if (xmlNodeMatch) {
-        const char *xmlPropPath;
-        const char *sPattern;
-
-        xmlPropPath=GWEN_XMLNode_GetProperty(xmlNodeMatch, "path", NULL);
-        sPattern=GWEN_XMLNode_GetCharValue(xmlNodeMatch, NULL, NULL);
-        if (xmlPropPath && *xmlPropPath && sPattern && *sPattern) {
-          const char *sDocData;
-
-          sDocData=AB_ImExporterXML_GetCharValueByPath(xmlDocData, xmlPropPath, NULL);
-          if (sDocData && *sDocData) {
-            if (-1!=GWEN_Text_ComparePattern(sDocData, sPattern, 0)) {
-              /* found match */
-              DBG_INFO(AQBANKING_LOGDOMAIN, "Document data matches (path=%s, data=%s, pattern=%s",
-                       xmlPropPath, sDocData, sPattern);
-              return xmlNodeSchema;
-            } /* if (-1!=GWEN_Text_ComparePattern(sDocData, sPattern)) */
-            else {
-              DBG_INFO(AQBANKING_LOGDOMAIN, "Document data does not match (path=%s, data=%s, pattern=%s",
-                       xmlPropPath, sDocData, sPattern);
-            }
-          }
-          else {
-            DBG_INFO(AQBANKING_LOGDOMAIN, "Missing or empty match data in document (path=%s)", xmlPropPath);
-          }
-        }  /* if (xmlPropPath && *xmlPropPath && sPattern && *sPattern) */
-        else {
-          DBG_INFO(AQBANKING_LOGDOMAIN, "Missing data in schema file: path=%s, pattern=%s",
-                   (xmlPropPath && *xmlPropPath)?xmlPropPath:"-- empty --",
-                   (sPattern && *sPattern)?sPattern:"-- empty --");
-        }
-      } /* if (xmlNodeMatch) */
-      else {
-        DBG_INFO(AQBANKING_LOGDOMAIN, "<DocMatches> element has no <Match> element");
-      }
-    } /* xmlNodeDocMatches */
-    else {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "Schema has no <DocMatches> element");
-      GWEN_XMLNode_Dump(xmlNodeSchema, 2);
-    }
-    xmlNodeSchema=GWEN_XMLNode_FindNextTag(xmlNodeSchema, "Schema", NULL, NULL);
-  } /* while(xmlNodeSchema) */
+  assert(ie);
+  ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AB_IMEXPORTER_XML, ie);
+  assert(ieh);
 
-  return NULL;
+  return AB_ImExporterXML_SchemaCache_FindMatchingSchema(ieh->schemaCache, AB_ImExporter_GetBanking(ie), xmlDocData);
 }
 
 
 
-const char *AB_ImExporterXML_GetCharValueByPath(GWEN_XMLNODE *xmlNode, const char *path, const char *defValue)
-{
-  const char *s;
-
-  s=strchr(path, '@');
-  if (s) {
-    int idx;
-    char *cpyOfPath;
-    char *property;
-    GWEN_XMLNODE *n;
-
-
-    idx=s-path;
-    cpyOfPath=strdup(path);
-    assert(cpyOfPath);
-    cpyOfPath[idx]=0;
-    property=cpyOfPath+idx+1;
-
-    if (*cpyOfPath) {
-      n=GWEN_XMLNode_GetNodeByXPath(xmlNode, cpyOfPath, GWEN_PATH_FLAGS_PATHMUSTEXIST);
-    }
-    else
-      n=xmlNode;
-
-    if (n) {
-      const char *result;
-
-      result=GWEN_XMLNode_GetProperty(n, property, defValue);
-      DBG_INFO(GWEN_LOGDOMAIN, "Got XML property: %s = %s (%s)", property, result, path);
-      free(cpyOfPath);
-      return result;
-    }
-    free(cpyOfPath);
-    return defValue;
-  }
-  else
-    return GWEN_XMLNode_GetCharValueByPath(xmlNode, path, defValue);
-}
-
-
 
 GWEN_XMLNODE *AB_ImExporterXML_ReadXmlFromSio(AB_IMEXPORTER *ie, GWEN_SYNCIO *sio, uint32_t xmlFlags)
 {
@@ -621,45 +462,13 @@ void _readAccountsFromDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbData)
 
   dbAccount=GWEN_DB_FindFirstGroup(dbData, "account");
   while (dbAccount) {
-    AB_ACCOUNT_SPEC *accountSpec;
     AB_IMEXPORTER_ACCOUNTINFO *accountInfo;
     GWEN_DB_NODE *dbCurrent;
-    const char *s;
 
-    accountSpec=AB_AccountSpec_fromDb(dbAccount);
-    assert(accountSpec);
-
-    accountInfo=AB_ImExporterContext_GetOrAddAccountInfo(ctx,
-                                                         0,
-                                                         AB_AccountSpec_GetIban(accountSpec),
-                                                         AB_AccountSpec_GetBankCode(accountSpec),
-                                                         AB_AccountSpec_GetAccountNumber(accountSpec),
-                                                         AB_AccountSpec_GetType(accountSpec));
-    assert(accountInfo);
-
-    s=AB_ImExporterAccountInfo_GetBankName(accountInfo);
-    if (!(s && *s))
-      AB_ImExporterAccountInfo_SetBankName(accountInfo, AB_AccountSpec_GetBankName(accountSpec));
-
-    s=AB_ImExporterAccountInfo_GetCurrency(accountInfo);
-    if (!(s && *s)) {
-      s=AB_AccountSpec_GetCurrency(accountSpec);
-      if (s && *s)
-        AB_ImExporterAccountInfo_SetCurrency(accountInfo, s);
-    }
+    accountInfo=_getAccountInfoForDb(ctx, dbAccount);
 
     /* import transactions */
-    dbCurrent=GWEN_DB_FindFirstGroup(dbAccount, "transaction");
-    while (dbCurrent) {
-      AB_TRANSACTION *t;
-
-      t=dbToTransaction(dbAccount, dbCurrent);
-      assert(t);
-
-      AB_ImExporterAccountInfo_AddTransaction(accountInfo, t);
-      dbCurrent=GWEN_DB_FindNextGroup(dbCurrent, "transaction");
-    }
-
+    _readTransactionsFromDb(accountInfo, dbAccount);
 
     /* import balances */
     dbCurrent=GWEN_DB_FindFirstGroup(dbAccount, "balance");
@@ -671,14 +480,78 @@ void _readAccountsFromDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbData)
       dbCurrent=GWEN_DB_FindNextGroup(dbCurrent, "balance");
     }
 
-    AB_AccountSpec_free(accountSpec);
+    dbAccount=GWEN_DB_FindNextGroup(dbAccount, "account");
+  }
+}
+
+
+
+void AB_ImExporterXML_ImportDbTransactions(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbData)
+{
+  GWEN_DB_NODE *dbAccount;
 
+  dbAccount=GWEN_DB_FindFirstGroup(dbData, "account");
+  while (dbAccount) {
+    if (GWEN_DB_FindFirstGroup(dbAccount, "transaction"))
+      _readTransactionsFromDb(_getAccountInfoForDb(ctx, dbAccount), dbAccount);
     dbAccount=GWEN_DB_FindNextGroup(dbAccount, "account");
   }
 }
 
 
 
+AB_IMEXPORTER_ACCOUNTINFO *_getAccountInfoForDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbAccount)
+{
+  AB_ACCOUNT_SPEC *accountSpec;
+  AB_IMEXPORTER_ACCOUNTINFO *accountInfo;
+  const char *s;
+
+  accountSpec=AB_AccountSpec_fromDb(dbAccount);
+  assert(accountSpec);
+
+  accountInfo=AB_ImExporterContext_GetOrAddAccountInfo(ctx,
+                                                       0,
+                                                       AB_AccountSpec_GetIban(accountSpec),
+                                                       AB_AccountSpec_GetBankCode(accountSpec),
+                                                       AB_AccountSpec_GetAccountNumber(accountSpec),
+                                                       AB_AccountSpec_GetType(accountSpec));
+  assert(accountInfo);
+
+  s=AB_ImExporterAccountInfo_GetBankName(accountInfo);
+  if (!(s && *s))
+    AB_ImExporterAccountInfo_SetBankName(accountInfo, AB_AccountSpec_GetBankName(accountSpec));
+
+  s=AB_ImExporterAccountInfo_GetCurrency(accountInfo);
+  if (!(s && *s)) {
+    s=AB_AccountSpec_GetCurrency(accountSpec);
+    if (s && *s)
+      AB_ImExporterAccountInfo_SetCurrency(accountInfo, s);
+  }
+
+  AB_AccountSpec_free(accountSpec);
+  return accountInfo;
+}
+
+
+
+void _readTransactionsFromDb(AB_IMEXPORTER_ACCOUNTINFO *accountInfo, GWEN_DB_NODE *dbAccount)
+{
+  GWEN_DB_NODE *dbCurrent;
+
+  dbCurrent=GWEN_DB_FindFirstGroup(dbAccount, "transaction");
+  while (dbCurrent) {
+    AB_TRANSACTION *t;
+
+    t=dbToTransaction(dbAccount, dbCurrent);
+    assert(t);
+
+    AB_ImExporterAccountInfo_AddTransaction(accountInfo, t);
+    dbCurrent=GWEN_DB_FindNextGroup(dbCurrent, "transaction");
+  }
+}
+
+
+
 int _readSecuritiesFromDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbData)
 {
   GWEN_DB_NODE *dbSecurity;
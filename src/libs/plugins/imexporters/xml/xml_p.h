@@ -13,6 +13,7 @@
 
 
 #include "xml.h"
+#include "xml_schemacache.h"
 
 #include <aqbanking/backendsupport/imexporter_be.h>
 
@@ -24,7 +25,7 @@
 
 typedef struct AB_IMEXPORTER_XML AB_IMEXPORTER_XML;
 struct AB_IMEXPORTER_XML {
-  int dummy;
+  AB_IMEXPORTER_XML_SCHEMACACHE *schemaCache;
 };
 
 
@@ -33,6 +34,14 @@ GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFromFile(AB_IMEXPORTER *ie, const char
 GWEN_XMLNODE *AB_ImExporterXML_DetermineSchema(AB_IMEXPORTER *ie, GWEN_XMLNODE *xmlDocData);
 GWEN_XMLNODE *AB_ImExporterXML_ReadXmlFromSio(AB_IMEXPORTER *ie, GWEN_SYNCIO *sio, uint32_t xmlFlags);
 
+int AB_ImExporterXML_ImportDb(AB_IMEXPORTER *ie, AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbData);
+
+/**
+ * Only import the transactions below the "account" groups of the given data (used in streaming mode,
+ * balances and securities are read from the remaining document at the end).
+ */
+void AB_ImExporterXML_ImportDbTransactions(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbData);
+
 
 
 #endif /* AQBANKING_IMEX_XML_P_H */
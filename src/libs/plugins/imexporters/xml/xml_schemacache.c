@@ -0,0 +1,458 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "./xml_schemacache_p.h"
+
+#include <aqbanking/banking_be.h>
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+#include <gwenhywfar/text.h>
+#include <gwenhywfar/buffer.h>
+
+#include <sys/stat.h>
+#include <string.h>
+#include <stdlib.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static int _validate(AB_IMEXPORTER_XML_SCHEMACACHE *sc, AB_BANKING *ab);
+static int _isUpToDate(const AB_IMEXPORTER_XML_SCHEMACACHE *sc, GWEN_STRINGLIST *slDataFiles);
+static void _rebuild(AB_IMEXPORTER_XML_SCHEMACACHE *sc, GWEN_STRINGLIST *slDataFiles);
+static void _clear(AB_IMEXPORTER_XML_SCHEMACACHE *sc);
+static void _clearMatchSlots(AB_IMEXPORTER_XML_SCHEMACACHE *sc);
+static void _readSchemaFile(AB_IMEXPORTER_XML_SCHEMA *schema, const char *fileName);
+static void _compileMatchRule(AB_IMEXPORTER_XML_SCHEMACACHE *sc, AB_IMEXPORTER_XML_SCHEMA *schema);
+static int _getOrAddMatchPath(AB_IMEXPORTER_XML_SCHEMACACHE *sc, const char *fullPath);
+static const char *_getDocumentValue(const AB_IMEXPORTER_XML_MATCHPATH *mp, GWEN_XMLNODE *xmlDocData);
+static int _findMatchingSchemaIndex(const AB_IMEXPORTER_XML_SCHEMACACHE *sc, const char **valueArray);
+static int _statFile(const char *fileName, time_t *pModTime, long *pFileSize);
+static uint32_t _hashString(const char *s);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AB_IMEXPORTER_XML_SCHEMACACHE *AB_ImExporterXML_SchemaCache_new(void)
+{
+  AB_IMEXPORTER_XML_SCHEMACACHE *sc;
+
+  GWEN_NEW_OBJECT(AB_IMEXPORTER_XML_SCHEMACACHE, sc);
+  return sc;
+}
+
+
+
+void AB_ImExporterXML_SchemaCache_free(AB_IMEXPORTER_XML_SCHEMACACHE *sc)
+{
+  if (sc) {
+    _clear(sc);
+    GWEN_FREE_OBJECT(sc);
+  }
+}
+
+
+
+GWEN_XMLNODE *AB_ImExporterXML_SchemaCache_GetSchemaByFile(AB_IMEXPORTER_XML_SCHEMACACHE *sc,
+                                                           AB_BANKING *ab,
+                                                           const char *fileName)
+{
+  int i;
+
+  assert(sc);
+  assert(fileName);
+
+  if (_validate(sc, ab)<0)
+    return NULL;
+
+  for (i=0; i<sc->schemaCount; i++) {
+    const AB_IMEXPORTER_XML_SCHEMA *schema;
+
+    schema=&(sc->schemaArray[i]);
+    if (schema->xmlNodeSchema && strcmp(schema->fileName, fileName)==0)
+      return GWEN_XMLNode_dup(schema->xmlNodeSchema);
+  }
+
+  return NULL;
+}
+
+
+
+GWEN_XMLNODE *AB_ImExporterXML_SchemaCache_FindMatchingSchema(AB_IMEXPORTER_XML_SCHEMACACHE *sc,
+                                                              AB_BANKING *ab,
+                                                              GWEN_XMLNODE *xmlDocData)
+{
+  const char **valueArray;
+  GWEN_BUFFER *keyBuffer;
+  AB_IMEXPORTER_XML_MATCHSLOT *slot;
+  int idx;
+  int i;
+
+  assert(sc);
+
+  if (_validate(sc, ab)<0 || sc->matchPathCount<1) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No schemata");
+    return NULL;
+  }
+
+  /*
+   * evaluate every distinct path only once, the values found form the key for the match table
+   * (each value prefixed by its length so that no two lists of values result in the same key,
+   * missing values are written as "-")
+   */
+  valueArray=(const char **) calloc(sc->matchPathCount, sizeof(const char *));
+  assert(valueArray);
+  keyBuffer=GWEN_Buffer_new(0, 256, 0, 1);
+  for (i=0; i<sc->matchPathCount; i++) {
+    valueArray[i]=_getDocumentValue(&(sc->matchPathArray[i]), xmlDocData);
+    if (valueArray[i]) {
+      GWEN_Buffer_AppendArgs(keyBuffer, "%u:", (unsigned int) strlen(valueArray[i]));
+      GWEN_Buffer_AppendString(keyBuffer, valueArray[i]);
+    }
+    else
+      GWEN_Buffer_AppendByte(keyBuffer, '-');
+  }
+
+  slot=&(sc->matchSlots[_hashString(GWEN_Buffer_GetStart(keyBuffer)) % AB_IMEXPORTER_XML_SCHEMACACHE_MATCHSLOTS]);
+  if (slot->documentKey && strcmp(slot->documentKey, GWEN_Buffer_GetStart(keyBuffer))==0)
+    idx=slot->schemaIndex;
+  else {
+    idx=_findMatchingSchemaIndex(sc, valueArray);
+    free(slot->documentKey);
+    slot->documentKey=strdup(GWEN_Buffer_GetStart(keyBuffer));
+    slot->schemaIndex=idx;
+  }
+  GWEN_Buffer_free(keyBuffer);
+  free(valueArray);
+
+  if (idx<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No matching schema");
+    return NULL;
+  }
+
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Document matches schema file \"%s\"", sc->schemaArray[idx].fileName);
+  return GWEN_XMLNode_dup(sc->schemaArray[idx].xmlNodeSchema);
+}
+
+
+
+int _validate(AB_IMEXPORTER_XML_SCHEMACACHE *sc, AB_BANKING *ab)
+{
+  GWEN_STRINGLIST *slDataFiles;
+
+  slDataFiles=AB_Banking_ListDataFilesForImExporter(ab, "xml", "*.xml");
+  if (slDataFiles==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No data files");
+    _clear(sc);
+    return GWEN_ERROR_NOT_FOUND;
+  }
+
+  if (!_isUpToDate(sc, slDataFiles)) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Schema files changed, rebuilding cache");
+    _rebuild(sc, slDataFiles);
+  }
+  GWEN_StringList_free(slDataFiles);
+
+  return 0;
+}
+
+
+
+int _isUpToDate(const AB_IMEXPORTER_XML_SCHEMACACHE *sc, GWEN_STRINGLIST *slDataFiles)
+{
+  GWEN_STRINGLISTENTRY *se;
+  int i;
+
+  if (sc->schemaArray==NULL || (int) GWEN_StringList_Count(slDataFiles)!=sc->schemaCount)
+    return 0;
+
+  i=0;
+  se=GWEN_StringList_FirstEntry(slDataFiles);
+  while (se) {
+    const AB_IMEXPORTER_XML_SCHEMA *schema;
+    time_t modTime;
+    long fileSize;
+
+    schema=&(sc->schemaArray[i++]);
+    if (strcmp(schema->fileName, GWEN_StringListEntry_Data(se))!=0)
+      return 0;
+    if (_statFile(schema->fileName, &modTime, &fileSize)<0 ||
+        modTime!=schema->modTime ||
+        fileSize!=schema->fileSize)
+      return 0;
+    se=GWEN_StringListEntry_Next(se);
+  }
+
+  return 1;
+}
+
+
+
+void _rebuild(AB_IMEXPORTER_XML_SCHEMACACHE *sc, GWEN_STRINGLIST *slDataFiles)
+{
+  GWEN_STRINGLISTENTRY *se;
+  int i;
+
+  _clear(sc);
+
+  sc->schemaCount=GWEN_StringList_Count(slDataFiles);
+  sc->schemaArray=(AB_IMEXPORTER_XML_SCHEMA *) calloc(sc->schemaCount?sc->schemaCount:1, sizeof(AB_IMEXPORTER_XML_SCHEMA));
+  assert(sc->schemaArray);
+
+  i=0;
+  se=GWEN_StringList_FirstEntry(slDataFiles);
+  while (se) {
+    AB_IMEXPORTER_XML_SCHEMA *schema;
+
+    schema=&(sc->schemaArray[i++]);
+    schema->fileName=strdup(GWEN_StringListEntry_Data(se));
+    schema->matchPathIndex=-1;
+    /* stat before reading, so a file changed while reading is read again next time */
+    _statFile(schema->fileName, &(schema->modTime), &(schema->fileSize));
+    _readSchemaFile(schema, schema->fileName);
+    if (schema->xmlNodeSchema)
+      _compileMatchRule(sc, schema);
+    se=GWEN_StringListEntry_Next(se);
+  }
+}
+
+
+
+void _clear(AB_IMEXPORTER_XML_SCHEMACACHE *sc)
+{
+  int i;
+
+  for (i=0; i<sc->schemaCount; i++) {
+    AB_IMEXPORTER_XML_SCHEMA *schema;
+
+    schema=&(sc->schemaArray[i]);
+    free(schema->fileName);
+    GWEN_XMLNode_free(schema->xmlNodeSchema);
+    free(schema->matchPattern);
+  }
+  free(sc->schemaArray);
+  sc->schemaArray=NULL;
+  sc->schemaCount=0;
+
+  for (i=0; i<sc->matchPathCount; i++) {
+    AB_IMEXPORTER_XML_MATCHPATH *mp;
+
+    mp=&(sc->matchPathArray[i]);
+    free(mp->fullPath);
+    free(mp->nodePath);
+    free(mp->property);
+  }
+  free(sc->matchPathArray);
+  sc->matchPathArray=NULL;
+  sc->matchPathCount=0;
+
+  _clearMatchSlots(sc);
+}
+
+
+
+void _clearMatchSlots(AB_IMEXPORTER_XML_SCHEMACACHE *sc)
+{
+  int i;
+
+  for (i=0; i<AB_IMEXPORTER_XML_SCHEMACACHE_MATCHSLOTS; i++) {
+    free(sc->matchSlots[i].documentKey);
+    sc->matchSlots[i].documentKey=NULL;
+    sc->matchSlots[i].schemaIndex=-1;
+  }
+}
+
+
+
+void _readSchemaFile(AB_IMEXPORTER_XML_SCHEMA *schema, const char *fileName)
+{
+  GWEN_XMLNODE *xmlNodeFile;
+  int rv;
+
+  xmlNodeFile=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "schemaFile");
+  rv=GWEN_XML_ReadFile(xmlNodeFile, fileName, GWEN_XML_FLAGS_HANDLE_COMMENTS | GWEN_XML_FLAGS_HANDLE_HEADERS);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading schema file \"%s\" (%d), ignoring.", fileName, rv);
+  }
+  else {
+    GWEN_XMLNODE *xmlNodeSchema;
+
+    xmlNodeSchema=GWEN_XMLNode_FindFirstTag(xmlNodeFile, "Schema", NULL, NULL);
+    if (xmlNodeSchema) {
+      GWEN_XMLNode_UnlinkChild(xmlNodeFile, xmlNodeSchema);
+      schema->xmlNodeSchema=xmlNodeSchema;
+    }
+    else {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Missing \"Schema\" in schema file \"%s\", ignoring.", fileName);
+    }
+  }
+  GWEN_XMLNode_free(xmlNodeFile);
+}
+
+
+
+void _compileMatchRule(AB_IMEXPORTER_XML_SCHEMACACHE *sc, AB_IMEXPORTER_XML_SCHEMA *schema)
+{
+  GWEN_XMLNODE *xmlNodeDocMatches;
+  GWEN_XMLNODE *xmlNodeMatch;
+  const char *xmlPropPath;
+  const char *sPattern;
+
+  xmlNodeDocMatches=GWEN_XMLNode_FindFirstTag(schema->xmlNodeSchema, "DocMatches", NULL, NULL);
+  if (xmlNodeDocMatches==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Schema \"%s\" has no <DocMatches> element", schema->fileName);
+    return;
+  }
+
+  xmlNodeMatch=GWEN_XMLNode_FindFirstTag(xmlNodeDocMatches, "Match", NULL, NULL);
+  if (xmlNodeMatch==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "<DocMatches> element of \"%s\" has no <Match> element", schema->fileName);
+    return;
+  }
+
+  xmlPropPath=GWEN_XMLNode_GetProperty(xmlNodeMatch, "path", NULL);
+  sPattern=GWEN_XMLNode_GetCharValue(xmlNodeMatch, NULL, NULL);
+  if (!(xmlPropPath && *xmlPropPath && sPattern && *sPattern)) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Missing data in schema file \"%s\": path=%s, pattern=%s",
+             schema->fileName,
+             (xmlPropPath && *xmlPropPath)?xmlPropPath:"-- empty --",
+             (sPattern && *sPattern)?sPattern:"-- empty --");
+    return;
+  }
+
+  schema->matchPathIndex=_getOrAddMatchPath(sc, xmlPropPath);
+  schema->matchPattern=strdup(sPattern);
+}
+
+
+
+int _getOrAddMatchPath(AB_IMEXPORTER_XML_SCHEMACACHE *sc, const char *fullPath)
+{
+  AB_IMEXPORTER_XML_MATCHPATH *mp;
+  const char *s;
+  int i;
+
+  for (i=0; i<sc->matchPathCount; i++) {
+    if (strcmp(sc->matchPathArray[i].fullPath, fullPath)==0)
+      return i;
+  }
+
+  sc->matchPathArray=(AB_IMEXPORTER_XML_MATCHPATH *) realloc(sc->matchPathArray,
+                                                            (sc->matchPathCount+1)*sizeof(AB_IMEXPORTER_XML_MATCHPATH));
+  assert(sc->matchPathArray);
+  mp=&(sc->matchPathArray[sc->matchPathCount]);
+  memset(mp, 0, sizeof(AB_IMEXPORTER_XML_MATCHPATH));
+  mp->fullPath=strdup(fullPath);
+
+  /* "path/to/element@property" */
+  s=strchr(fullPath, '@');
+  if (s) {
+    if (s>fullPath) {
+      mp->nodePath=(char *) malloc(s-fullPath+1);
+      assert(mp->nodePath);
+      memmove(mp->nodePath, fullPath, s-fullPath);
+      mp->nodePath[s-fullPath]=0;
+    }
+    mp->property=strdup(s+1);
+  }
+  else
+    mp->nodePath=strdup(fullPath);
+
+  return sc->matchPathCount++;
+}
+
+
+
+const char *_getDocumentValue(const AB_IMEXPORTER_XML_MATCHPATH *mp, GWEN_XMLNODE *xmlDocData)
+{
+  const char *s;
+
+  if (mp->property) {
+    GWEN_XMLNODE *n;
+
+    if (mp->nodePath)
+      n=GWEN_XMLNode_GetNodeByXPath(xmlDocData, mp->nodePath, GWEN_PATH_FLAGS_PATHMUSTEXIST);
+    else
+      n=xmlDocData;
+    s=n?GWEN_XMLNode_GetProperty(n, mp->property, NULL):NULL;
+  }
+  else
+    s=GWEN_XMLNode_GetCharValueByPath(xmlDocData, mp->nodePath, NULL);
+
+  return (s && *s)?s:NULL;
+}
+
+
+
+int _findMatchingSchemaIndex(const AB_IMEXPORTER_XML_SCHEMACACHE *sc, const char **valueArray)
+{
+  int i;
+
+  for (i=0; i<sc->schemaCount; i++) {
+    const AB_IMEXPORTER_XML_SCHEMA *schema;
+
+    schema=&(sc->schemaArray[i]);
+    if (schema->matchPathIndex>=0) {
+      const char *sDocData;
+
+      sDocData=valueArray[schema->matchPathIndex];
+      if (sDocData && -1!=GWEN_Text_ComparePattern(sDocData, schema->matchPattern, 0)) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Document data matches (path=%s, data=%s, pattern=%s)",
+                 sc->matchPathArray[schema->matchPathIndex].fullPath, sDocData, schema->matchPattern);
+        return i;
+      }
+    }
+  }
+
+  return -1;
+}
+
+
+
+int _statFile(const char *fileName, time_t *pModTime, long *pFileSize)
+{
+  struct stat st;
+
+  if (stat(fileName, &st)!=0) {
+    *pModTime=0;
+    *pFileSize=-1;
+    return GWEN_ERROR_IO;
+  }
+  *pModTime=st.st_mtime;
+  *pFileSize=(long) st.st_size;
+  return 0;
+}
+
+
+
+uint32_t _hashString(const char *s)
+{
+  uint32_t h=2166136261u;
+
+  while (*s) {
+    h^=(uint8_t)(*s++);
+    h*=16777619u;
+  }
+  return h;
+}
@@ -0,0 +1,62 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AQBANKING_IMEX_XML_SCHEMACACHE_H
+#define AQBANKING_IMEX_XML_SCHEMACACHE_H
+
+
+#include <aqbanking/banking.h>
+
+#include <gwenhywfar/xml.h>
+
+
+/**
+ * Cache for the schema files of the XML im-/exporter.
+ *
+ * All schema files are read once, their "DocMatches" rules are compiled (paths split into element path and
+ * property, identical paths shared between schemata) and documents are matched against them by evaluating
+ * every distinct path only once. The result is remembered for the values found in a document (e.g. the
+ * namespace of the root element), so the next document with the same values is matched by a single lookup.
+ *
+ * The cache is revalidated on every use by comparing the list of schema files with their size and
+ * modification time, any change leads to the cache being rebuilt.
+ */
+typedef struct AB_IMEXPORTER_XML_SCHEMACACHE AB_IMEXPORTER_XML_SCHEMACACHE;
+
+
+AB_IMEXPORTER_XML_SCHEMACACHE *AB_ImExporterXML_SchemaCache_new(void);
+void AB_ImExporterXML_SchemaCache_free(AB_IMEXPORTER_XML_SCHEMACACHE *sc);
+
+/**
+ * Return a copy of the "Schema" element from the given schema file (the caller takes over the returned node).
+ *
+ * @param sc schema cache
+ * @param ab banking object (used to find the schema files)
+ * @param fileName full path of the schema file
+ */
+GWEN_XMLNODE *AB_ImExporterXML_SchemaCache_GetSchemaByFile(AB_IMEXPORTER_XML_SCHEMACACHE *sc,
+                                                           AB_BANKING *ab,
+                                                           const char *fileName);
+
+/**
+ * Return a copy of the first "Schema" element whose "DocMatches" rule matches the given document
+ * (the caller takes over the returned node).
+ *
+ * @param sc schema cache
+ * @param ab banking object (used to find the schema files)
+ * @param xmlDocData XML document to find a schema for
+ */
+GWEN_XMLNODE *AB_ImExporterXML_SchemaCache_FindMatchingSchema(AB_IMEXPORTER_XML_SCHEMACACHE *sc,
+                                                              AB_BANKING *ab,
+                                                              GWEN_XMLNODE *xmlDocData);
+
+
+
+#endif /* AQBANKING_IMEX_XML_SCHEMACACHE_H */
@@ -0,0 +1,64 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AQBANKING_IMEX_XML_SCHEMACACHE_P_H
+#define AQBANKING_IMEX_XML_SCHEMACACHE_P_H
+
+
+#include "xml_schemacache.h"
+
+#include <time.h>
+
+
+/** number of slots in the table remembering which schema matched which document values */
+#define AB_IMEXPORTER_XML_SCHEMACACHE_MATCHSLOTS 64
+
+
+/** distinct path used by at least one "Match" rule, split into element path and property */
+typedef struct AB_IMEXPORTER_XML_MATCHPATH AB_IMEXPORTER_XML_MATCHPATH;
+struct AB_IMEXPORTER_XML_MATCHPATH {
+  char *fullPath;
+  char *nodePath;  /* NULL for the document itself */
+  char *property;  /* NULL if the path refers to char data */
+};
+
+
+typedef struct AB_IMEXPORTER_XML_SCHEMA AB_IMEXPORTER_XML_SCHEMA;
+struct AB_IMEXPORTER_XML_SCHEMA {
+  char *fileName;
+  time_t modTime;
+  long fileSize;
+
+  GWEN_XMLNODE *xmlNodeSchema;   /* NULL if the file could not be read */
+  int matchPathIndex;            /* -1 if the schema has no usable "Match" rule */
+  char *matchPattern;
+};
+
+
+typedef struct AB_IMEXPORTER_XML_MATCHSLOT AB_IMEXPORTER_XML_MATCHSLOT;
+struct AB_IMEXPORTER_XML_MATCHSLOT {
+  char *documentKey;
+  int schemaIndex;               /* -1 if no schema matched */
+};
+
+
+struct AB_IMEXPORTER_XML_SCHEMACACHE {
+  AB_IMEXPORTER_XML_SCHEMA *schemaArray;
+  int schemaCount;
+
+  AB_IMEXPORTER_XML_MATCHPATH *matchPathArray;
+  int matchPathCount;
+
+  AB_IMEXPORTER_XML_MATCHSLOT matchSlots[AB_IMEXPORTER_XML_SCHEMACACHE_MATCHSLOTS];
+};
+
+
+
+#endif /* AQBANKING_IMEX_XML_SCHEMACACHE_P_H */
@@ -0,0 +1,462 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "./xml_p.h"
+#include "./xml_stream_imp_p.h"
+
+#include <aqbanking/banking.h>
+#include <aqbanking/banking_be.h>
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+#include <gwenhywfar/inherit.h>
+#include <gwenhywfar/xml2db.h>
+
+
+
+GWEN_INHERIT(GWEN_XML_CONTEXT, AB_IMEXPORTER_XML_STREAM);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void GWENHYWFAR_CB _freeData(void *bp, void *p);
+
+static int GWENHYWFAR_CB _startTag(GWEN_XML_CONTEXT *xmlCtx, const char *tagName);
+static int GWENHYWFAR_CB _endTag(GWEN_XML_CONTEXT *xmlCtx, int closing);
+
+static int _handleClosedElements(AB_IMEXPORTER_XML_STREAM *xs, GWEN_XMLNODE *nodeBefore, GWEN_XMLNODE *nodeAfter);
+static int _isAncestor(const GWEN_XMLNODE *n, const GWEN_XMLNODE *ancestor);
+static int _isRecordElement(const AB_IMEXPORTER_XML_STREAM *xs, const GWEN_XMLNODE *n);
+static int _importRecord(AB_IMEXPORTER_XML_STREAM *xs, GWEN_XMLNODE *nRecord);
+static GWEN_XMLNODE *_createRecordDocument(AB_IMEXPORTER_XML_STREAM *xs, GWEN_XMLNODE *nRecord);
+static GWEN_XMLNODE *_copyEnclosingElements(AB_IMEXPORTER_XML_STREAM *xs,
+                                           GWEN_XMLNODE *n,
+                                           const GWEN_XMLNODE *nChildOnPath,
+                                           GWEN_XMLNODE *xmlDocRecord);
+static void _copyContextElements(AB_IMEXPORTER_XML_STREAM *xs,
+                                 const GWEN_XMLNODE *n,
+                                 const GWEN_XMLNODE *nChildOnPath,
+                                 GWEN_XMLNODE *nCopy);
+static int _importRemainingDocument(AB_IMEXPORTER_XML_STREAM *xs);
+static int _loadSchema(AB_IMEXPORTER_XML_STREAM *xs);
+static GWEN_XMLNODE *_createRecordSchema(const GWEN_XMLNODE *nSchema, const char *recordElement);
+static int _isSchemaLoop(const GWEN_XMLNODE *nSchema, const char *name);
+static int _containsRecordLoop(const GWEN_XMLNODE *nSchema, const char *recordElement);
+static GWEN_DB_NODE *_applySchema(AB_IMEXPORTER_XML_STREAM *xs);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+int AB_ImExporterXML_ImportStream(AB_IMEXPORTER *ie,
+                                  AB_IMEXPORTER_CONTEXT *ctx,
+                                  GWEN_SYNCIO *sio,
+                                  const char *schemaName,
+                                  const char *recordElement,
+                                  uint32_t xmlFlags)
+{
+  AB_IMEXPORTER_XML_STREAM *xs;
+  GWEN_XMLNODE *xmlDocRoot;
+  GWEN_XML_CONTEXT *xmlCtx;
+  int rv;
+
+  assert(recordElement && *recordElement);
+
+  xmlDocRoot=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "xmlDocRoot");
+  xmlCtx=GWEN_XmlCtxStore_new(xmlDocRoot, xmlFlags);
+
+  GWEN_NEW_OBJECT(AB_IMEXPORTER_XML_STREAM, xs);
+  GWEN_INHERIT_SETDATA(GWEN_XML_CONTEXT, AB_IMEXPORTER_XML_STREAM, xmlCtx, xs, _freeData);
+  xs->imExporter=ie;
+  xs->context=ctx;
+  xs->schemaName=(schemaName && *schemaName)?schemaName:NULL;
+  xs->recordElement=recordElement;
+  xs->xmlDocRoot=xmlDocRoot;
+
+  /* wrap the callbacks of the store context to get notified about closed elements */
+  xs->previousStartTagFn=GWEN_XmlCtx_SetStartTagFn(xmlCtx, _startTag);
+  xs->previousEndTagFn=GWEN_XmlCtx_SetEndTagFn(xmlCtx, _endTag);
+
+  rv=GWEN_XMLContext_ReadFromIo(xmlCtx, sio);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    GWEN_XmlCtx_free(xmlCtx);
+    GWEN_XMLNode_free(xmlDocRoot);
+    return rv;
+  }
+
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Imported %d \"%s\" elements while reading", xs->recordCount, recordElement);
+  rv=_importRemainingDocument(xs);
+  GWEN_XmlCtx_free(xmlCtx);
+  GWEN_XMLNode_free(xmlDocRoot);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+void GWENHYWFAR_CB _freeData(GWEN_UNUSED void *bp, void *p)
+{
+  AB_IMEXPORTER_XML_STREAM *xs;
+
+  xs=(AB_IMEXPORTER_XML_STREAM *) p;
+  GWEN_XMLNode_free(xs->xmlNodeRecordImport);
+  GWEN_XMLNode_free(xs->xmlDocSchema);
+  GWEN_FREE_OBJECT(xs);
+}
+
+
+
+int GWENHYWFAR_CB _startTag(GWEN_XML_CONTEXT *xmlCtx, const char *tagName)
+{
+  AB_IMEXPORTER_XML_STREAM *xs;
+  GWEN_XMLNODE *nodeBefore;
+  int rv;
+
+  xs=GWEN_INHERIT_GETDATA(GWEN_XML_CONTEXT, AB_IMEXPORTER_XML_STREAM, xmlCtx);
+  assert(xs);
+
+  /* closing tags like "</Ntry>" are reported as start tags */
+  nodeBefore=GWEN_XmlCtx_GetCurrentNode(xmlCtx);
+  rv=xs->previousStartTagFn(xmlCtx, tagName);
+  if (rv<0)
+    return rv;
+  return _handleClosedElements(xs, nodeBefore, GWEN_XmlCtx_GetCurrentNode(xmlCtx));
+}
+
+
+
+int GWENHYWFAR_CB _endTag(GWEN_XML_CONTEXT *xmlCtx, int closing)
+{
+  AB_IMEXPORTER_XML_STREAM *xs;
+  GWEN_XMLNODE *nodeBefore;
+  int rv;
+
+  xs=GWEN_INHERIT_GETDATA(GWEN_XML_CONTEXT, AB_IMEXPORTER_XML_STREAM, xmlCtx);
+  assert(xs);
+
+  /* elements like "<Ntry/>" are closed here */
+  nodeBefore=GWEN_XmlCtx_GetCurrentNode(xmlCtx);
+  rv=xs->previousEndTagFn(xmlCtx, closing);
+  if (rv<0)
+    return rv;
+  return _handleClosedElements(xs, nodeBefore, GWEN_XmlCtx_GetCurrentNode(xmlCtx));
+}
+
+
+
+int _handleClosedElements(AB_IMEXPORTER_XML_STREAM *xs, GWEN_XMLNODE *nodeBefore, GWEN_XMLNODE *nodeAfter)
+{
+  GWEN_XMLNODE *n;
+
+  /* elements are only closed if the reader moved up in the tree (maybe more than one level with SGML) */
+  if (nodeBefore==NULL || nodeAfter==NULL || nodeBefore==nodeAfter || !_isAncestor(nodeBefore, nodeAfter))
+    return 0;
+
+  n=nodeBefore;
+  while (n && n!=nodeAfter) {
+    GWEN_XMLNODE *nParent;
+
+    nParent=GWEN_XMLNode_GetParent(n);
+    if (_isRecordElement(xs, n)) {
+      int rv;
+
+      /* this might remove the element from the tree and free it */
+      rv=_importRecord(xs, n);
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        return rv;
+      }
+    }
+    n=nParent;
+  }
+
+  return 0;
+}
+
+
+
+int _isAncestor(const GWEN_XMLNODE *n, const GWEN_XMLNODE *ancestor)
+{
+  n=GWEN_XMLNode_GetParent(n);
+  while (n) {
+    if (n==ancestor)
+      return 1;
+    n=GWEN_XMLNode_GetParent(n);
+  }
+  return 0;
+}
+
+
+
+int _isRecordElement(const AB_IMEXPORTER_XML_STREAM *xs, const GWEN_XMLNODE *n)
+{
+  const char *s;
+
+  if (GWEN_XMLNode_GetType(n)!=GWEN_XMLNodeTypeTag)
+    return 0;
+  s=GWEN_XMLNode_GetData(n);
+  return (s && strcmp(s, xs->recordElement)==0);
+}
+
+
+
+int _importRecord(AB_IMEXPORTER_XML_STREAM *xs, GWEN_XMLNODE *nRecord)
+{
+  GWEN_XMLNODE *xmlDocRecord;
+  GWEN_DB_NODE *dbData;
+  int rv;
+
+  if (xs->xmlNodeImport==NULL) {
+    rv=_loadSchema(xs);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+  }
+
+  if (xs->xmlNodeRecordImport==NULL)
+    /* keep the record, it is imported with the remaining document */
+    return 0;
+
+  /* data of this record goes to the import context, no need to keep it in the tree */
+  xmlDocRecord=_createRecordDocument(xs, nRecord);
+  dbData=GWEN_DB_Group_new("data");
+  rv=GWEN_Xml2Db(xmlDocRecord, xs->xmlNodeRecordImport, dbData);
+  GWEN_XMLNode_free(xmlDocRecord);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    GWEN_DB_Group_free(dbData);
+    return rv;
+  }
+
+  AB_ImExporterXML_ImportDbTransactions(xs->context, dbData);
+  GWEN_DB_Group_free(dbData);
+  xs->recordCount++;
+  return 0;
+}
+
+
+
+GWEN_XMLNODE *_createRecordDocument(AB_IMEXPORTER_XML_STREAM *xs, GWEN_XMLNODE *nRecord)
+{
+  GWEN_XMLNODE *nParent;
+  GWEN_XMLNODE *nParentCopy;
+  GWEN_XMLNODE *xmlDocRecord;
+
+  xmlDocRecord=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "xmlDocRoot");
+  nParent=GWEN_XMLNode_GetParent(nRecord);
+  nParentCopy=_copyEnclosingElements(xs, nParent, nRecord, xmlDocRecord);
+  GWEN_XMLNode_UnlinkChild(nParent, nRecord);
+  GWEN_XMLNode_AddChild(nParentCopy, nRecord);
+
+  return xmlDocRecord;
+}
+
+
+
+/* copy the given element and its ancestors up to the document root (without their children on the path) */
+GWEN_XMLNODE *_copyEnclosingElements(AB_IMEXPORTER_XML_STREAM *xs,
+                                     GWEN_XMLNODE *n,
+                                     const GWEN_XMLNODE *nChildOnPath,
+                                     GWEN_XMLNODE *xmlDocRecord)
+{
+  GWEN_XMLNODE *nCopy;
+
+  if (n==xs->xmlDocRoot)
+    nCopy=xmlDocRecord;
+  else {
+    GWEN_XMLNODE *nParentCopy;
+
+    nParentCopy=_copyEnclosingElements(xs, GWEN_XMLNode_GetParent(n), n, xmlDocRecord);
+    nCopy=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, GWEN_XMLNode_GetData(n));
+    GWEN_XMLNode_CopyProperties(nCopy, n, 1);
+    GWEN_XMLNode_AddChild(nParentCopy, nCopy);
+  }
+  _copyContextElements(xs, n, nChildOnPath, nCopy);
+
+  return nCopy;
+}
+
+
+
+/* copy child elements needed to interpret the record (like "Acct" inside "Stmt") */
+void _copyContextElements(AB_IMEXPORTER_XML_STREAM *xs,
+                          const GWEN_XMLNODE *n,
+                          const GWEN_XMLNODE *nChildOnPath,
+                          GWEN_XMLNODE *nCopy)
+{
+  const GWEN_XMLNODE *nChild;
+  const char *pathName;
+
+  pathName=GWEN_XMLNode_GetData(nChildOnPath);
+  nChild=GWEN_XMLNode_GetFirstTag(n);
+  while (nChild) {
+    const char *s;
+
+    s=GWEN_XMLNode_GetData(nChild);
+    /* skip siblings of elements on the path with the same name (e.g. previous "Stmt" elements) */
+    if (nChild!=nChildOnPath &&
+        !_isRecordElement(xs, nChild) &&
+        !(s && pathName && strcmp(s, pathName)==0))
+      GWEN_XMLNode_AddChild(nCopy, GWEN_XMLNode_dup(nChild));
+    nChild=GWEN_XMLNode_GetNextTag(nChild);
+  }
+}
+
+
+
+int _importRemainingDocument(AB_IMEXPORTER_XML_STREAM *xs)
+{
+  GWEN_DB_NODE *dbData;
+  int rv;
+
+  dbData=_applySchema(xs);
+  if (dbData==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  rv=AB_ImExporterXML_ImportDb(xs->imExporter, xs->context, dbData);
+  GWEN_DB_Group_free(dbData);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+  return 0;
+}
+
+
+
+int _loadSchema(AB_IMEXPORTER_XML_STREAM *xs)
+{
+  if (xs->schemaName)
+    xs->xmlDocSchema=AB_ImExporterXML_ReadSchemaFromFile(xs->imExporter, xs->schemaName);
+  else
+    /* the data needed to match schemata (like "Document@xmlns") precedes the first record */
+    xs->xmlDocSchema=AB_ImExporterXML_DetermineSchema(xs->imExporter, xs->xmlDocRoot);
+  if (xs->xmlDocSchema==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not load schema file for \"%s\"", xs->schemaName?xs->schemaName:"<auto>");
+    return GWEN_ERROR_NOT_FOUND;
+  }
+
+  xs->xmlNodeImport=GWEN_XMLNode_FindFirstTag(xs->xmlDocSchema, "Import", NULL, NULL);
+  if (xs->xmlNodeImport==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Missing \"Import\" in schema file.");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  if (_containsRecordLoop(xs->xmlNodeImport, xs->recordElement))
+    xs->xmlNodeRecordImport=_createRecordSchema(xs->xmlNodeImport, xs->recordElement);
+  else {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Schema has no loop over \"%s\", importing the whole document at once", xs->recordElement);
+  }
+
+  return 0;
+}
+
+
+
+/* copy the schema without loops which don't lead to the loop over the records (those are run on the
+ * remaining document) */
+GWEN_XMLNODE *_createRecordSchema(const GWEN_XMLNODE *nSchema, const char *recordElement)
+{
+  GWEN_XMLNODE *nCopy;
+  const GWEN_XMLNODE *nChild;
+
+  nCopy=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, GWEN_XMLNode_GetData(nSchema));
+  GWEN_XMLNode_CopyProperties(nCopy, nSchema, 1);
+
+  nChild=GWEN_XMLNode_GetFirstTag(nSchema);
+  while (nChild) {
+    if (_isSchemaLoop(nChild, recordElement))
+      GWEN_XMLNode_AddChild(nCopy, GWEN_XMLNode_dup(nChild));
+    else if (_containsRecordLoop(nChild, recordElement))
+      GWEN_XMLNode_AddChild(nCopy, _createRecordSchema(nChild, recordElement));
+    else if (!_isSchemaLoop(nChild, NULL))
+      GWEN_XMLNode_AddChild(nCopy, GWEN_XMLNode_dup(nChild));
+    nChild=GWEN_XMLNode_GetNextTag(nChild);
+  }
+
+  return nCopy;
+}
+
+
+
+/* check for an "XmlForEvery" command (over elements with the given name unless NULL) */
+int _isSchemaLoop(const GWEN_XMLNODE *nSchema, const char *name)
+{
+  const char *s;
+
+  s=GWEN_XMLNode_GetData(nSchema);
+  if (!(s && strcmp(s, "XmlForEvery")==0))
+    return 0;
+  if (name==NULL)
+    return 1;
+  s=GWEN_XMLNode_GetProperty(nSchema, "name", NULL);
+  return (s && strcmp(s, name)==0);
+}
+
+
+
+int _containsRecordLoop(const GWEN_XMLNODE *nSchema, const char *recordElement)
+{
+  const GWEN_XMLNODE *nChild;
+
+  nChild=GWEN_XMLNode_GetFirstTag(nSchema);
+  while (nChild) {
+    if (_isSchemaLoop(nChild, recordElement) || _containsRecordLoop(nChild, recordElement))
+      return 1;
+    nChild=GWEN_XMLNode_GetNextTag(nChild);
+  }
+  return 0;
+}
+
+
+
+GWEN_DB_NODE *_applySchema(AB_IMEXPORTER_XML_STREAM *xs)
+{
+  GWEN_DB_NODE *dbData;
+  int rv;
+
+  if (xs->xmlNodeImport==NULL) {
+    rv=_loadSchema(xs);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return NULL;
+    }
+  }
+
+  dbData=GWEN_DB_Group_new("data");
+  rv=GWEN_Xml2Db(xs->xmlDocRoot, xs->xmlNodeImport, dbData);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    GWEN_DB_Group_free(dbData);
+    return NULL;
+  }
+
+  return dbData;
+}
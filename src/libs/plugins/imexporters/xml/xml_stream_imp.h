@@ -0,0 +1,49 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AQBANKING_IMEX_XML_STREAM_IMP_H
+#define AQBANKING_IMEX_XML_STREAM_IMP_H
+
+
+#include <aqbanking/backendsupport/imexporter_be.h>
+
+
+/**
+ * Import an XML document without keeping the whole document in memory.
+ *
+ * The document is read into a tree as usual, but whenever an element named @a recordElement (e.g. "Ntry"
+ * for CAMT documents) is closed it is removed from the tree and imported on its own: It is moved into a
+ * small document which only contains copies of its enclosing elements and their other child elements
+ * (e.g. "Stmt" with "Acct" and "Bal"). The part of the schema which leads to the loop over the records
+ * (without other loops like the one over "Bal") is applied to that document, the transactions created by
+ * it are added to the given context and the small document is freed. After the document has been read
+ * completely the whole schema is applied to the remaining tree to import accounts, balances and securities.
+ *
+ * So the time and peak memory needed per record only depend on the size of that record and the data
+ * enclosing it. If the schema has no loop over @a recordElement all records are kept in the tree and
+ * imported with the remaining document.
+ *
+ * @param ie im-/exporter
+ * @param ctx context to add imported data to
+ * @param sio io layer to read from
+ * @param schemaName name of the schema to use (NULL to determine the schema from the document)
+ * @param recordElement name of the elements to import one at a time
+ * @param xmlFlags flags for the XML reader (see GWEN_XML_FLAGS_HANDLE_COMMENTS etc)
+ */
+int AB_ImExporterXML_ImportStream(AB_IMEXPORTER *ie,
+                                  AB_IMEXPORTER_CONTEXT *ctx,
+                                  GWEN_SYNCIO *sio,
+                                  const char *schemaName,
+                                  const char *recordElement,
+                                  uint32_t xmlFlags);
+
+
+
+#endif /* AQBANKING_IMEX_XML_STREAM_IMP_H */
@@ -0,0 +1,43 @@
+/***************************************************************************
+    begin       : Sat Oct 17 2026
+    copyright   : (C) 2026 by Martin Preuss
+    email       : martin@libchipcard.de
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AQBANKING_IMEX_XML_STREAM_IMP_P_H
+#define AQBANKING_IMEX_XML_STREAM_IMP_P_H
+
+
+#include "xml_stream_imp.h"
+
+#include <gwenhywfar/xml.h>
+#include <gwenhywfar/xmlctx.h>
+
+
+
+typedef struct AB_IMEXPORTER_XML_STREAM AB_IMEXPORTER_XML_STREAM;
+struct AB_IMEXPORTER_XML_STREAM {
+  AB_IMEXPORTER *imExporter;
+  AB_IMEXPORTER_CONTEXT *context;
+
+  const char *schemaName;
+  const char *recordElement;
+
+  GWEN_XMLNODE *xmlDocRoot;
+  GWEN_XMLNODE *xmlDocSchema;
+  GWEN_XMLNODE *xmlNodeImport;
+  GWEN_XMLNODE *xmlNodeRecordImport;
+
+  GWEN_XMLCTX_STARTTAG_FN previousStartTagFn;
+  GWEN_XMLCTX_ENDTAG_FN previousEndTagFn;
+
+  int recordCount;
+};
+
+
+
+#endif /* AQBANKING_IMEX_XML_STREAM_IMP_P_H */
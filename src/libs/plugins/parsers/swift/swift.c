@@ -35,6 +35,17 @@ GWEN_LIST_FUNCTIONS(AHB_SWIFT_SUBTAG, AHB_SWIFT_SubTag);
 
 
 static const char *_findStartOfSubTag(const char *sptr);
+static int _readTextBlock(GWEN_FAST_BUFFER *fb,
+                          AHB_SWIFT_TAG_LIST *tl,
+                          unsigned int maxTags,
+                          AHB_SWIFT_TAG_HANDLER_FN fn,
+                          void *user_data);
+static int _readDocument(GWEN_FAST_BUFFER *fb,
+                         AHB_SWIFT_TAG_LIST *tl,
+                         unsigned int maxTags,
+                         AHB_SWIFT_TAG_HANDLER_FN fn,
+                         void *user_data);
+static int _handleSwift940Tag(AHB_SWIFT_TAG *tg, void *user_data);
 
 
 
@@ -390,11 +401,15 @@ int AHB_SWIFT_ReadLine(GWEN_FAST_BUFFER *fb,
 
 
 /* This will read the contents of a SWIFT data block ({4: ... })
-   inside of a SWIFT document
+   inside of a SWIFT document.
+   If a handler function is given every tag is handed to it as soon as it is complete and freed
+   afterwards, otherwise the tags are added to the given list.
  */
-int AHB_SWIFT_ReadTextBlock(GWEN_FAST_BUFFER *fb,
-                            AHB_SWIFT_TAG_LIST *tl,
-                            unsigned int maxTags)
+int _readTextBlock(GWEN_FAST_BUFFER *fb,
+                   AHB_SWIFT_TAG_LIST *tl,
+                   unsigned int maxTags,
+                   AHB_SWIFT_TAG_HANDLER_FN fn,
+                   void *user_data)
 {
   GWEN_BUFFER *lbuf;
   char buffer[AHB_SWIFT_MAXLINELEN];
@@ -557,7 +572,17 @@ int AHB_SWIFT_ReadTextBlock(GWEN_FAST_BUFFER *fb,
     DBG_DEBUG(AQBANKING_LOGDOMAIN,
               "Creating tag \"%s\" (%s)", p, p2);
     tag=AHB_SWIFT_Tag_new(p, p2);
-    AHB_SWIFT_Tag_List_Add(tag, tl);
+    if (fn) {
+      rv=fn(tag, user_data);
+      AHB_SWIFT_Tag_free(tag);
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        GWEN_Buffer_free(lbuf);
+        return rv;
+      }
+    }
+    else
+      AHB_SWIFT_Tag_List_Add(tag, tl);
     tagCount++;
     if (maxTags && tagCount>=maxTags) {
       DBG_INFO(AQBANKING_LOGDOMAIN,
@@ -656,7 +681,7 @@ int AHB_SWIFT_ReadDocument(GWEN_FAST_BUFFER *fb,
     } /* for */
   }
 
-  rv=AHB_SWIFT_ReadTextBlock(fb, tl, maxTags);
+  rv=_readTextBlock(fb, tl, maxTags, NULL, NULL);
   if (rv)
     return rv;
 
@@ -752,6 +777,27 @@ int AHB_SWIFT_ReadDocument(GWEN_FAST_BUFFER *fb,
 int AHB_SWIFT_ReadDocument(GWEN_FAST_BUFFER *fb,
                            AHB_SWIFT_TAG_LIST *tl,
                            unsigned int maxTags)
+{
+  return _readDocument(fb, tl, maxTags, NULL, NULL);
+}
+
+
+
+int AHB_SWIFT_ReadDocumentWithHandler(GWEN_FAST_BUFFER *fb,
+                                      AHB_SWIFT_TAG_HANDLER_FN fn,
+                                      void *user_data)
+{
+  assert(fn);
+  return _readDocument(fb, NULL, 0, fn, user_data);
+}
+
+
+
+int _readDocument(GWEN_FAST_BUFFER *fb,
+                  AHB_SWIFT_TAG_LIST *tl,
+                  unsigned int maxTags,
+                  AHB_SWIFT_TAG_HANDLER_FN fn,
+                  void *user_data)
 {
   int rv;
   int c;
@@ -830,7 +876,7 @@ int AHB_SWIFT_ReadDocument(GWEN_FAST_BUFFER *fb,
       DBG_DEBUG(0, "Reading block %d", swhead[1]-'0');
       if (swhead[1]=='4') {
         /* read document from block 4 */
-        rv=AHB_SWIFT_ReadTextBlock(fb, tl, maxTags);
+        rv=_readTextBlock(fb, tl, maxTags, fn, user_data);
         if (rv) {
           DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
           return rv;
@@ -864,7 +910,7 @@ int AHB_SWIFT_ReadDocument(GWEN_FAST_BUFFER *fb,
   }
   else {
     /* not a full swift document, just read the SWIFT document directly */
-    rv=AHB_SWIFT_ReadTextBlock(fb, tl, maxTags);
+    rv=_readTextBlock(fb, tl, maxTags, fn, user_data);
     if (rv)
       return rv;
   }
@@ -879,6 +925,18 @@ int AHB_SWIFT_Import(GWEN_DBIO *dbio,
                      GWEN_DB_NODE *data,
                      GWEN_DB_NODE *cfg,
                      uint32_t flags)
+{
+  return AHB_SWIFT_ImportWithHandler(sio, data, cfg, flags, NULL, NULL);
+}
+
+
+
+int AHB_SWIFT_ImportWithHandler(GWEN_SYNCIO *sio,
+                                GWEN_DB_NODE *data,
+                                GWEN_DB_NODE *cfg,
+                                uint32_t flags,
+                                AHB_SWIFT_RECORD_HANDLER_FN fn,
+                                void *user_data)
 {
   int rv;
   const char *p;
@@ -892,9 +950,8 @@ int AHB_SWIFT_Import(GWEN_DBIO *dbio,
       strcasecmp(p, "mt942")!=0 &&
       strcasecmp(p, "mt535")!=0) {
     DBG_ERROR(AQBANKING_LOGDOMAIN,
-              "Type \"%s\" not supported by plugin \"%s\"",
-              p,
-              GWEN_DBIO_GetName(dbio));
+              "Type \"%s\" not supported by SWIFT parser",
+              p);
     return GWEN_ERROR_INVALID;
   }
 
@@ -938,7 +995,8 @@ int AHB_SWIFT_Import(GWEN_DBIO *dbio,
   }
 
   for (;;) {
-    AHB_SWIFT_TAG_LIST *tl;
+    AHB_SWIFT_TAG_LIST *tl=NULL;
+    AHB_SWIFT940_READER *reader=NULL;
 
     /* check for user abort */
     rv=GWEN_Gui_ProgressAdvance(0, GWEN_GUI_PROGRESS_NONE);
@@ -981,9 +1039,27 @@ int AHB_SWIFT_Import(GWEN_DBIO *dbio,
 
     GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Debug,
                          I18N("Parsing SWIFT data"));
-    tl=AHB_SWIFT_Tag_List_new();
-    assert(tl);
-    rv=AHB_SWIFT_ReadDocument(fb, tl, 0);
+    if (strcasecmp(p, "mt940")==0 || strcasecmp(p, "mt942")==0) {
+      /* MT940/942 tags are handled as soon as they are read instead of being collected in a tag list first,
+       * complete transactions are passed to the handler (if any) */
+      reader=AHB_SWIFT940_Reader_new(data, cfg, flags);
+      if (fn)
+        AHB_SWIFT940_Reader_SetRecordHandler(reader, fn, user_data);
+      rv=AHB_SWIFT_ReadDocumentWithHandler(fb, _handleSwift940Tag, reader);
+      if (rv>=0) {
+        int rv2;
+
+        rv2=AHB_SWIFT940_Reader_Finish(reader);
+        if (rv2<0)
+          rv=rv2;
+      }
+      AHB_SWIFT940_Reader_free(reader);
+    }
+    else {
+      tl=AHB_SWIFT_Tag_List_new();
+      assert(tl);
+      rv=AHB_SWIFT_ReadDocument(fb, tl, 0);
+    }
     if (rv<0) {
       DBG_INFO(AQBANKING_LOGDOMAIN, "Error in report, aborting");
       GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
@@ -1006,16 +1082,12 @@ int AHB_SWIFT_Import(GWEN_DBIO *dbio,
       break;
     }
 
-    /* now all tags have been read, transform them */
-    GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Debug,
-                         I18N("Importing SWIFT data"));
-
-    DBG_INFO(AQBANKING_LOGDOMAIN, "*** before branching ***");
-    if (strcasecmp(p, "mt940")==0 || strcasecmp(p, "mt942")==0)
-      rv=AHB_SWIFT940_Import(tl, data, cfg, flags);
-    if (strcasecmp(p, "mt535")==0)
+    if (tl) {
+      /* now all tags have been read, transform them */
+      GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Debug,
+                           I18N("Importing SWIFT data"));
       rv=AHB_SWIFT535_Import(tl, data, cfg, flags);
-
+    }
 
     if (rv) {
       DBG_INFO(AQBANKING_LOGDOMAIN, "Error importing SWIFT MT940/942/535");
@@ -1039,6 +1111,27 @@ int AHB_SWIFT_Import(GWEN_DBIO *dbio,
 
 
 
+int _handleSwift940Tag(AHB_SWIFT_TAG *tg, void *user_data)
+{
+  int rv;
+
+  rv=AHB_SWIFT940_Reader_HandleTag((AHB_SWIFT940_READER *) user_data, tg);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  rv=GWEN_Gui_ProgressAdvance(0, GWEN_GUI_PROGRESS_NONE);
+  if (rv==GWEN_ERROR_USER_ABORTED) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "User aborted");
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
 int AHB_SWIFT_Export(GWEN_DBIO *dbio,
                      GWEN_SYNCIO *sio,
                      GWEN_DB_NODE *data,
@@ -39,13 +39,34 @@
  * ------------------------------------------------------------------------------------------------
  */
 
-static void _extractAndHandleSepaTags(GWEN_DB_NODE *dbData, uint32_t flags);
-static void _transformPurposeIntoOneString(GWEN_DB_NODE *dbData, uint32_t flags);
-static void _readSubTagsIntoDb(AHB_SWIFT_SUBTAG_LIST *stlist, GWEN_DB_NODE *dbData, uint32_t flags);
-static int _readSepaTags(const char *sPurpose, GWEN_DB_NODE *dbSepaTags);
-static int _storeSepaTag(const char *sTagStart, int tagLen, GWEN_DB_NODE *dbSepaTags);
-static void _transformSepaTags(GWEN_DB_NODE *dbData, GWEN_DB_NODE *dbSepaTags, uint32_t flags);
+static void _readSubTagsIntoDb(AHB_SWIFT_SUBTAG_LIST *stlist, GWEN_DB_NODE *dbData, uint32_t flags, int isSepa);
+static void _addPurposeLine(const char *s, GWEN_BUFFER *bufLines, GWEN_BUFFER *bufConcat, int *pLineCount, uint32_t flags);
+static void _readSepaTags(const char *sPurpose, AHB_SWIFT940_SEPA_TAGS *tags);
+static int _findSepaKeyword(const char *s);
+static void _storeSepaTag(const char *sTagStart, int tagLen, AHB_SWIFT940_SEPA_TAGS *tags);
+static void _appendSepaValue(AHB_SWIFT940_SEPA_TAGS *tags, int idx, const char *s, int len);
+static void _transformSepaTags(GWEN_DB_NODE *dbData, AHB_SWIFT940_SEPA_TAGS *tags, GWEN_BUFFER *bufPurpose, uint32_t flags);
 static void _parseTransactionData(const char *p, GWEN_DB_NODE *dbData, uint32_t flags);
+static int _finishTransaction(AHB_SWIFT940_READER *reader);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * static vars
+ * ------------------------------------------------------------------------------------------------
+ */
+
+/* the first and fourth letter identify a keyword, see _findSepaKeyword() */
+static const AHB_SWIFT940_SEPA_KEYWORD _sepaKeywords[AHB_SWIFT940_SEPA_KEYWORDS]= {
+  {"EREF+", "endToEndReference"},
+  {"KREF+", "customerReference"},
+  {"MREF+", "mandateId"},
+  {"CRED+", "creditorSchemeId"},
+  {"DEBT+", "originatorId"},
+  {"SVWZ+", "purpose"},
+  {"ABWA+", "ultimateDebtor"},   /* "abweichender Auftraggeber" */
+  {"ABWE+", "ultimateCreditor"}  /* "abweichender Empfaenger" */
+};
 
 
 
@@ -222,15 +243,12 @@ int AHB_SWIFT940_Parse_86(const AHB_SWIFT_TAG *tg,
       if (code<900) {
         /* sepa */
         DBG_INFO(AQBANKING_LOGDOMAIN, "Reading as SEPA tag (%d)", code);
-        _readSubTagsIntoDb(stlist, dbData, flags);
-        _extractAndHandleSepaTags(dbData, flags);
-        _transformPurposeIntoOneString(dbData, flags);
+        _readSubTagsIntoDb(stlist, dbData, flags, 1);
       }
       else {
         /* non-sepa */
         DBG_INFO(AQBANKING_LOGDOMAIN, "Reading as non-SEPA tag (%d)", code);
-        _readSubTagsIntoDb(stlist, dbData, flags);
-        _transformPurposeIntoOneString(dbData, flags);
+        _readSubTagsIntoDb(stlist, dbData, flags, 0);
       }
     } /* if really structured */
     AHB_SWIFT_SubTag_List_free(stlist);
@@ -817,262 +835,318 @@ int AHB_SWIFT940_Parse_NS(const AHB_SWIFT_TAG *tg,
 }
 
 
-/* Import SWIFT MT940 data.
-   @param tl input: list of tags. Tags are lines in a SWIFT data block (block 4). A tag has an
-          id and content. See the AHB_SWIFT_Tag_new function for more information.
- */
-int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
-                        GWEN_DB_NODE *data,
-                        GWEN_DB_NODE *cfg,
-                        uint32_t flags)
+AHB_SWIFT940_READER *AHB_SWIFT940_Reader_new(GWEN_DB_NODE *data, GWEN_DB_NODE *cfg, uint32_t flags)
 {
-  AHB_SWIFT_TAG *tg;
-  GWEN_DB_NODE *dbDay=NULL;
-  GWEN_DB_NODE *dbTemplate=NULL;
-  GWEN_DB_NODE *dbTransaction=NULL;
-  const char *sDate=NULL;
-  uint32_t progressId;
-  const char *acceptTag20="*";
-  const char *rejectTag20=NULL;
-  int ignoreCurrentReport=0;
-
-  acceptTag20=GWEN_DB_GetCharValue(cfg, "acceptTag20", 0, NULL);
-  if (acceptTag20 && *acceptTag20==0)
-    acceptTag20=NULL;
-  rejectTag20=GWEN_DB_GetCharValue(cfg, "rejectTag20", 0, NULL);
-  if (rejectTag20 && *rejectTag20==0)
-    rejectTag20=NULL;
-
-  dbTemplate=GWEN_DB_Group_new("template");
-
-  progressId=GWEN_Gui_ProgressStart(GWEN_GUI_PROGRESS_DELAY |
-                                    GWEN_GUI_PROGRESS_ALLOW_EMBED |
-                                    GWEN_GUI_PROGRESS_SHOW_PROGRESS |
-                                    GWEN_GUI_PROGRESS_SHOW_ABORT,
-                                    I18N("Importing SWIFT tags..."),
-                                    NULL,
-                                    AHB_SWIFT_Tag_List_GetCount(tl),
-                                    0);
-
-  tg=AHB_SWIFT_Tag_List_First(tl);
-  while (tg) {
-    const char *id;
-
-    id=AHB_SWIFT_Tag_GetId(tg);
-    assert(id);
-
-    if (strcasecmp(id, "20")==0) {
-      if (acceptTag20 || rejectTag20) {
-        const char *p;
-
-        p=AHB_SWIFT_Tag_GetData(tg);
-        assert(p);
-        if (rejectTag20) {
-          if (-1!=GWEN_Text_ComparePattern(p, rejectTag20, 0)) {
-            DBG_INFO(AQBANKING_LOGDOMAIN, "Ignoring report [%s]", p);
-            ignoreCurrentReport=1;
-          }
-          else {
-            ignoreCurrentReport=0;
-          }
-        }
-        else if (acceptTag20) {
-          if (-1==GWEN_Text_ComparePattern(p, acceptTag20, 0)) {
-            DBG_INFO(AQBANKING_LOGDOMAIN,
-                     "Ignoring report [%s] (not matching [%s])",
-                     p, acceptTag20);
-            ignoreCurrentReport=1;
-          }
-          else {
-            ignoreCurrentReport=0;
-          }
-        }
+  AHB_SWIFT940_READER *reader;
 
-      }
+  GWEN_NEW_OBJECT(AHB_SWIFT940_READER, reader);
+  reader->data=data;
+  reader->cfg=cfg;
+  reader->flags=flags;
+
+  reader->acceptTag20=GWEN_DB_GetCharValue(cfg, "acceptTag20", 0, NULL);
+  if (reader->acceptTag20 && *(reader->acceptTag20)==0)
+    reader->acceptTag20=NULL;
+  reader->rejectTag20=GWEN_DB_GetCharValue(cfg, "rejectTag20", 0, NULL);
+  if (reader->rejectTag20 && *(reader->rejectTag20)==0)
+    reader->rejectTag20=NULL;
+
+  reader->dbTemplate=GWEN_DB_Group_new("template");
+
+  return reader;
+}
+
+
+
+void AHB_SWIFT940_Reader_free(AHB_SWIFT940_READER *reader)
+{
+  if (reader) {
+    GWEN_DB_Group_free(reader->dbTemplate);
+    GWEN_FREE_OBJECT(reader);
+  }
+}
+
+
+
+void AHB_SWIFT940_Reader_SetRecordHandler(AHB_SWIFT940_READER *reader, AHB_SWIFT_RECORD_HANDLER_FN fn, void *user_data)
+{
+  assert(reader);
+  reader->recordFn=fn;
+  reader->recordUserData=user_data;
+}
+
+
+
+/* Must be called after the last tag of a document has been handled to pass the last transaction to
+   the record handler. */
+int AHB_SWIFT940_Reader_Finish(AHB_SWIFT940_READER *reader)
+{
+  assert(reader);
+  return _finishTransaction(reader);
+}
+
+
+
+int _finishTransaction(AHB_SWIFT940_READER *reader)
+{
+  GWEN_DB_NODE *dbTransaction;
+
+  dbTransaction=reader->dbTransaction;
+  reader->dbTransaction=NULL;
+  if (dbTransaction && reader->recordFn) {
+    int rv;
+
+    GWEN_DB_UnlinkGroup(dbTransaction);
+    rv=reader->recordFn(dbTransaction, reader->recordUserData);
+    GWEN_DB_Group_free(dbTransaction);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
     }
-    else {
-      if (!ignoreCurrentReport) {
-        if (strcasecmp(id, "25")==0) { /* LocalAccount */
-          if (AHB_SWIFT940_Parse_25(tg, flags, dbTemplate, cfg)) {
-            DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
-            GWEN_DB_Group_free(dbTemplate);
-            GWEN_Gui_ProgressEnd(progressId);
-            return -1;
-          }
-        }
-        else if (strcasecmp(id, "28C")==0) {
-          /* Sequence/Statement Number - currently ignored */
-          /* PostFinance statements don't have a correctly incrementing count... */
-        }
-        else if (strcasecmp(id, "60M")==0 || /* Interim StartSaldo */
-                 strcasecmp(id, "60F")==0) { /* StartSaldo */
-          GWEN_DB_NODE *dbSaldo;
-          const char *curr;
-
-          /* start a new day */
-          dbDay=GWEN_DB_GetGroup(data, GWEN_PATH_FLAGS_CREATE_GROUP, "day");
-
-          dbTransaction=0;
-          DBG_INFO(AQBANKING_LOGDOMAIN, "Starting new day");
-          if (strcasecmp(id, "60F")==0)
-            dbSaldo=GWEN_DB_GetGroup(dbDay, GWEN_PATH_FLAGS_CREATE_GROUP, "StartSaldo");
-          else
-            dbSaldo=GWEN_DB_GetGroup(dbDay, GWEN_PATH_FLAGS_CREATE_GROUP, "InterimStartSaldo");
-          GWEN_DB_AddGroupChildren(dbSaldo, dbTemplate);
-          if (AHB_SWIFT940_Parse_6_0_2(tg, flags, dbSaldo, cfg)) {
-            DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
-            GWEN_DB_Group_free(dbTemplate);
-            GWEN_Gui_ProgressEnd(progressId);
-            return -1;
-          }
-          else {
-            sDate=GWEN_DB_GetCharValue(dbSaldo, "date", 0, NULL);
-            DBG_INFO(AQBANKING_LOGDOMAIN, "Storing date \"%s\" as default for maybe later", sDate?sDate:"(empty)");
-          }
+  }
 
-          curr=GWEN_DB_GetCharValue(dbSaldo, "value/currency", 0, 0);
-          if (curr) {
-            AHB_SWIFT__SetCharValue(dbTemplate, flags,
-                                    "value/currency", curr);
-          }
-          if (strcasecmp(id, "60F")==0)
-            GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "final");
-          else
-            GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "interim");
+  return 0;
+}
 
-        }
-        else if (strcasecmp(id, "62M")==0 || /* Interim EndSaldo */
-                 strcasecmp(id, "62F")==0) { /* EndSaldo */
-          GWEN_DB_NODE *dbSaldo;
-
-          /* end current day */
-          dbTransaction=0;
-          if (!dbDay) {
-            DBG_WARN(AQBANKING_LOGDOMAIN, "Your bank does not send an opening saldo");
-            dbDay=GWEN_DB_GetGroup(data, GWEN_PATH_FLAGS_CREATE_GROUP, "day");
-          }
-          dbSaldo=GWEN_DB_GetGroup(dbDay, GWEN_PATH_FLAGS_CREATE_GROUP, "EndSaldo");
-          GWEN_DB_AddGroupChildren(dbSaldo, dbTemplate);
-          if (AHB_SWIFT940_Parse_6_0_2(tg, flags, dbSaldo, cfg)) {
-            DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
-            GWEN_DB_Group_free(dbTemplate);
-            GWEN_Gui_ProgressEnd(progressId);
-            return -1;
-          }
-          if (strcasecmp(id, "62F")==0)
-            GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "final");
-          else
-            GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "interim");
-          dbDay=0;
 
-        }
-        else if (strcasecmp(id, "61")==0) {
-          if (!dbDay) {
-            DBG_WARN(AQBANKING_LOGDOMAIN,
-                     "Your bank does not send an opening saldo");
-            dbDay=GWEN_DB_GetGroup(data, GWEN_PATH_FLAGS_CREATE_GROUP, "day");
-          }
 
-          DBG_INFO(AQBANKING_LOGDOMAIN, "Creating new transaction");
-          dbTransaction=GWEN_DB_GetGroup(dbDay, GWEN_PATH_FLAGS_CREATE_GROUP,
-                                         "transaction");
-          GWEN_DB_AddGroupChildren(dbTransaction, dbTemplate);
-          if (sDate && *sDate) {
-            /* dbDate is set upon parsing of tag 60F, use it as a default
-             * if possible */
-            GWEN_DB_SetCharValue(dbTransaction, GWEN_DB_FLAGS_OVERWRITE_VARS, "date", sDate);
-          }
-          if (AHB_SWIFT940_Parse_61(tg, flags, dbTransaction, cfg)) {
-            DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
-            GWEN_DB_Group_free(dbTemplate);
-            GWEN_Gui_ProgressEnd(progressId);
-            return -1;
-          }
-        }
-        else if (strcasecmp(id, "86")==0) {
-          if (!dbTransaction) {
-            DBG_WARN(AQBANKING_LOGDOMAIN,
-                     "Bad sequence of tags (86 before 61), ignoring");
-          }
-          else {
-            if (AHB_SWIFT940_Parse_86(tg, flags, dbTransaction, cfg)) {
-              DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
-              GWEN_DB_Group_free(dbTemplate);
-              GWEN_Gui_ProgressEnd(progressId);
-              return -1;
-            }
-          }
-        }
-        else if (strcasecmp(id, "NS")==0) {
-          if (!dbTransaction) {
-            DBG_DEBUG(AQBANKING_LOGDOMAIN,
-                      "Ignoring NS tags outside transactions");
-          }
-          else {
-            if (AHB_SWIFT940_Parse_NS(tg, flags, dbTransaction, cfg)) {
-              DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
-              GWEN_DB_Group_free(dbTemplate);
-              GWEN_Gui_ProgressEnd(progressId);
-              return -1;
-            }
-          }
-        }
-        else if (strcmp(id, "21")==0) {
-          const char *p;
+/* Handle a single tag of a SWIFT MT940/942 document.
+   The tags must be given in document order, a transaction is complete as soon as the next
+   tag 20, 60, 61 or 62 is handled (or @ref AHB_SWIFT940_Reader_Finish is called), it is then handed
+   to the record handler (if any).
+ */
+int AHB_SWIFT940_Reader_HandleTag(AHB_SWIFT940_READER *reader, const AHB_SWIFT_TAG *tg)
+{
+  const char *id;
+  GWEN_DB_NODE *data;
+  GWEN_DB_NODE *cfg;
+  uint32_t flags;
+
+  assert(reader);
+  data=reader->data;
+  cfg=reader->cfg;
+  flags=reader->flags;
+
+  id=AHB_SWIFT_Tag_GetId(tg);
+  assert(id);
+
+  if (strcasecmp(id, "20")==0 ||
+      strncasecmp(id, "60", 2)==0 ||
+      strcasecmp(id, "61")==0 ||
+      strncasecmp(id, "62", 2)==0) {
+    int rv;
 
-          p=AHB_SWIFT_Tag_GetData(tg);
-          assert(p);
-          if (0==strcmp(p, "NONREF")) {
-            DBG_INFO(AQBANKING_LOGDOMAIN, "Ignoring related reference '%s' in document tag 21.", p);
-          }
-          else {
-            DBG_WARN(AQBANKING_LOGDOMAIN, "Unexpected related reference '%s' in document tag 21 encountered.", p);
-          }
+    rv=_finishTransaction(reader);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+  }
+
+  if (strcasecmp(id, "20")==0) {
+    if (reader->acceptTag20 || reader->rejectTag20) {
+      const char *p;
+
+      p=AHB_SWIFT_Tag_GetData(tg);
+      assert(p);
+      if (reader->rejectTag20) {
+        if (-1!=GWEN_Text_ComparePattern(p, reader->rejectTag20, 0)) {
+          DBG_INFO(AQBANKING_LOGDOMAIN, "Ignoring report [%s]", p);
+          reader->ignoreCurrentReport=1;
+        }
+        else {
+          reader->ignoreCurrentReport=0;
         }
-        else if (strcmp(id, "13")==0 ||  /* "Erstellungszeitpunkt */
-                 strcmp(id, "34F")==0 || /* "Mindestbetrag" (sometimes contains some strange values) */
-                 strcmp(id, "90D")==0 || /* "Anzahl und Summe Soll-Buchungen" (examples I've seen are invalid anyway) */
-                 strcmp(id, "90C")==0) { /* "Anzahl und Summe Haben-Buchungen" (examples I've seen are invalid anyway) */
-          /* ignore some well known tags */
-          DBG_INFO(AQBANKING_LOGDOMAIN, "Ignoring well known tag \"%s\"", id);
+      }
+      else if (reader->acceptTag20) {
+        if (-1==GWEN_Text_ComparePattern(p, reader->acceptTag20, 0)) {
+          DBG_INFO(AQBANKING_LOGDOMAIN,
+                   "Ignoring report [%s] (not matching [%s])",
+                   p, reader->acceptTag20);
+          reader->ignoreCurrentReport=1;
         }
         else {
-          DBG_WARN(AQBANKING_LOGDOMAIN,
-                   "Unhandled tag '%s' found. "
-                   "This only means the file contains info we currently don't read, "
-                   "in most cases this is unimportant data.",
-                   id);
-          DBG_WARN(AQBANKING_LOGDOMAIN,
-                   "To debug set environment variable AQBANKING_LOGLEVEL=info and rerun,"
-                   "otherwise just ignore this message.");
+          reader->ignoreCurrentReport=0;
         }
+      }
 
+    }
+  }
+  else if (!reader->ignoreCurrentReport) {
+    if (strcasecmp(id, "25")==0) { /* LocalAccount */
+      if (AHB_SWIFT940_Parse_25(tg, flags, reader->dbTemplate, cfg)) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
+        return -1;
       }
     }
+    else if (strcasecmp(id, "28C")==0) {
+      /* Sequence/Statement Number - currently ignored */
+      /* PostFinance statements don't have a correctly incrementing count... */
+    }
+    else if (strcasecmp(id, "60M")==0 || /* Interim StartSaldo */
+             strcasecmp(id, "60F")==0) { /* StartSaldo */
+      GWEN_DB_NODE *dbSaldo;
+      const char *curr;
+
+      /* start a new day */
+      reader->dbDay=GWEN_DB_GetGroup(data, GWEN_PATH_FLAGS_CREATE_GROUP, "day");
+
+      reader->dbTransaction=NULL;
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Starting new day");
+      if (strcasecmp(id, "60F")==0)
+        dbSaldo=GWEN_DB_GetGroup(reader->dbDay, GWEN_PATH_FLAGS_CREATE_GROUP, "StartSaldo");
+      else
+        dbSaldo=GWEN_DB_GetGroup(reader->dbDay, GWEN_PATH_FLAGS_CREATE_GROUP, "InterimStartSaldo");
+      GWEN_DB_AddGroupChildren(dbSaldo, reader->dbTemplate);
+      if (AHB_SWIFT940_Parse_6_0_2(tg, flags, dbSaldo, cfg)) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
+        return -1;
+      }
+      else {
+        reader->sDate=GWEN_DB_GetCharValue(dbSaldo, "date", 0, NULL);
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Storing date \"%s\" as default for maybe later",
+                 reader->sDate?reader->sDate:"(empty)");
+      }
+
+      curr=GWEN_DB_GetCharValue(dbSaldo, "value/currency", 0, 0);
+      if (curr) {
+        AHB_SWIFT__SetCharValue(reader->dbTemplate, flags,
+                                "value/currency", curr);
+      }
+      if (strcasecmp(id, "60F")==0)
+        GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "final");
+      else
+        GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "interim");
+
+    }
+    else if (strcasecmp(id, "62M")==0 || /* Interim EndSaldo */
+             strcasecmp(id, "62F")==0) { /* EndSaldo */
+      GWEN_DB_NODE *dbSaldo;
+
+      /* end current day */
+      reader->dbTransaction=NULL;
+      if (!reader->dbDay) {
+        DBG_WARN(AQBANKING_LOGDOMAIN, "Your bank does not send an opening saldo");
+        reader->dbDay=GWEN_DB_GetGroup(data, GWEN_PATH_FLAGS_CREATE_GROUP, "day");
+      }
+      dbSaldo=GWEN_DB_GetGroup(reader->dbDay, GWEN_PATH_FLAGS_CREATE_GROUP, "EndSaldo");
+      GWEN_DB_AddGroupChildren(dbSaldo, reader->dbTemplate);
+      if (AHB_SWIFT940_Parse_6_0_2(tg, flags, dbSaldo, cfg)) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
+        return -1;
+      }
+      if (strcasecmp(id, "62F")==0)
+        GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "final");
+      else
+        GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "interim");
+      reader->dbDay=NULL;
 
-    if (GWEN_Gui_ProgressAdvance(progressId, GWEN_GUI_PROGRESS_ONE)==
-        GWEN_ERROR_USER_ABORTED) {
-      GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
-                           I18N("Aborted by user"));
-      GWEN_Gui_ProgressEnd(progressId);
-      GWEN_DB_Group_free(dbTemplate);
-      return GWEN_ERROR_USER_ABORTED;
     }
+    else if (strcasecmp(id, "61")==0) {
+      if (!reader->dbDay) {
+        DBG_WARN(AQBANKING_LOGDOMAIN,
+                 "Your bank does not send an opening saldo");
+        reader->dbDay=GWEN_DB_GetGroup(data, GWEN_PATH_FLAGS_CREATE_GROUP, "day");
+      }
 
-    tg=AHB_SWIFT_Tag_List_Next(tg);
-  } /* while */
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Creating new transaction");
+      reader->dbTransaction=GWEN_DB_GetGroup(reader->dbDay, GWEN_PATH_FLAGS_CREATE_GROUP,
+                                             "transaction");
+      GWEN_DB_AddGroupChildren(reader->dbTransaction, reader->dbTemplate);
+      if (reader->sDate && *(reader->sDate)) {
+        /* dbDate is set upon parsing of tag 60F, use it as a default
+         * if possible */
+        GWEN_DB_SetCharValue(reader->dbTransaction, GWEN_DB_FLAGS_OVERWRITE_VARS, "date", reader->sDate);
+      }
+      if (AHB_SWIFT940_Parse_61(tg, flags, reader->dbTransaction, cfg)) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
+        return -1;
+      }
+    }
+    else if (strcasecmp(id, "86")==0) {
+      if (!reader->dbTransaction) {
+        DBG_WARN(AQBANKING_LOGDOMAIN,
+                 "Bad sequence of tags (86 before 61), ignoring");
+      }
+      else {
+        if (AHB_SWIFT940_Parse_86(tg, flags, reader->dbTransaction, cfg)) {
+          DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
+          return -1;
+        }
+      }
+    }
+    else if (strcasecmp(id, "NS")==0) {
+      if (!reader->dbTransaction) {
+        DBG_DEBUG(AQBANKING_LOGDOMAIN,
+                  "Ignoring NS tags outside transactions");
+      }
+      else {
+        if (AHB_SWIFT940_Parse_NS(tg, flags, reader->dbTransaction, cfg)) {
+          DBG_INFO(AQBANKING_LOGDOMAIN, "Error in tag");
+          return -1;
+        }
+      }
+    }
+    else if (strcmp(id, "21")==0) {
+      const char *p;
 
-  GWEN_DB_Group_free(dbTemplate);
-  GWEN_Gui_ProgressEnd(progressId);
+      p=AHB_SWIFT_Tag_GetData(tg);
+      assert(p);
+      if (0==strcmp(p, "NONREF")) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Ignoring related reference '%s' in document tag 21.", p);
+      }
+      else {
+        DBG_WARN(AQBANKING_LOGDOMAIN, "Unexpected related reference '%s' in document tag 21 encountered.", p);
+      }
+    }
+    else if (strcmp(id, "13")==0 ||  /* "Erstellungszeitpunkt */
+             strcmp(id, "34F")==0 || /* "Mindestbetrag" (sometimes contains some strange values) */
+             strcmp(id, "90D")==0 || /* "Anzahl und Summe Soll-Buchungen" (examples I've seen are invalid anyway) */
+             strcmp(id, "90C")==0) { /* "Anzahl und Summe Haben-Buchungen" (examples I've seen are invalid anyway) */
+      /* ignore some well known tags */
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Ignoring well known tag \"%s\"", id);
+    }
+    else {
+      DBG_WARN(AQBANKING_LOGDOMAIN,
+               "Unhandled tag '%s' found. "
+               "This only means the file contains info we currently don't read, "
+               "in most cases this is unimportant data.",
+               id);
+      DBG_WARN(AQBANKING_LOGDOMAIN,
+               "To debug set environment variable AQBANKING_LOGLEVEL=info and rerun,"
+               "otherwise just ignore this message.");
+    }
+  }
 
   return 0;
 }
 
 
 
-void _readSubTagsIntoDb(AHB_SWIFT_SUBTAG_LIST *stlist, GWEN_DB_NODE *dbData, uint32_t flags)
+/* Read the sub tags of a structured :86: tag.
+   The purpose lines are collected in buffers and written to the DB only once, either as a
+   single value or (for SEPA transactions) split into the fields found in them.
+ */
+void _readSubTagsIntoDb(AHB_SWIFT_SUBTAG_LIST *stlist, GWEN_DB_NODE *dbData, uint32_t flags, int isSepa)
 {
   AHB_SWIFT_SUBTAG *stg;
+  GWEN_BUFFER *bufLines;
+  GWEN_BUFFER *bufConcat;
+  int lineCount=0;
+  int i;
+
+  bufLines=GWEN_Buffer_new(0, 256, 0, 1);
+  bufConcat=GWEN_Buffer_new(0, 256, 0, 1);
+
+  /* purpose lines from previous tags come first */
+  for (i=0; i<AHB_SWIFT940_SEPA_MAXPURPOSE; i++) {
+    const char *s;
+
+    s=GWEN_DB_GetCharValue(dbData, "purpose", i, NULL);
+    if (s==NULL)
+      break;
+    _addPurposeLine(s, bufLines, bufConcat, &lineCount, GWEN_DB_FLAGS_DEFAULT);
+  }
 
   stg=AHB_SWIFT_SubTag_List_First(stlist);
   while (stg) {
@@ -1104,7 +1178,10 @@ void _readSubTagsIntoDb(AHB_SWIFT_SUBTAG_LIST *stlist, GWEN_DB_NODE *dbData, uin
     case 61:
     case 62:
     case 63: /* Verwendungszweck */
-      AHB_SWIFT__SetCharValue(dbData, flags, "purpose", s);
+      _addPurposeLine(s, bufLines, bufConcat, &lineCount, flags);
+      if (!(s && *s))
+        /* empty lines are only kept if there is no purpose at all */
+        GWEN_DB_SetCharValue(dbData, flags, "purpose", "");
       break;
 
     case 30: /* BLZ Gegenseite */
@@ -1140,78 +1217,63 @@ void _readSubTagsIntoDb(AHB_SWIFT_SUBTAG_LIST *stlist, GWEN_DB_NODE *dbData, uin
     } /* switch */
     stg=AHB_SWIFT_SubTag_List_Next(stg);
   } /* while */
-}
-
-
-
-void _extractAndHandleSepaTags(GWEN_DB_NODE *dbData, uint32_t flags)
-{
-  GWEN_BUFFER *tbuf;
-  int i;
-
-  tbuf=GWEN_Buffer_new(0, 256, 0, 1);
-  for (i=0; i<99; i++) {
-    const char *s;
 
-    s=GWEN_DB_GetCharValue(dbData, "purpose", i, 0);
-    if (s && *s)
-      GWEN_Buffer_AppendString(tbuf, s);
-  }
+  if (GWEN_Buffer_GetUsedBytes(bufConcat)) {
+    AHB_SWIFT940_SEPA_TAGS tags;
 
-  if (GWEN_Buffer_GetUsedBytes(tbuf)) {
-    GWEN_DB_NODE *dbSepaTags;
-    int realSepaTagCount;
+    memset(&tags, 0, sizeof(tags));
+    if (isSepa)
+      _readSepaTags(GWEN_Buffer_GetStart(bufConcat), &tags);
 
-    dbSepaTags=GWEN_DB_Group_new("sepa-tags");
-    realSepaTagCount=_readSepaTags(GWEN_Buffer_GetStart(tbuf), dbSepaTags);
+    if (tags.realTagCount>0 && tags.storedCount>0) {
+      GWEN_Buffer_Reset(bufLines);
+      _transformSepaTags(dbData, &tags, bufLines, flags);
+    }
 
-    if (realSepaTagCount>0 && GWEN_DB_Variables_Count(dbSepaTags))
-      _transformSepaTags(dbData, dbSepaTags, flags);
+    for (i=0; i<=AHB_SWIFT940_SEPA_KEYWORDS; i++)
+      GWEN_Buffer_free(tags.values[i]);
 
-    GWEN_DB_Group_free(dbSepaTags);
+    GWEN_DB_DeleteVar(dbData, "purpose");
+    if (GWEN_Buffer_GetUsedBytes(bufLines))
+      GWEN_DB_SetCharValue(dbData, GWEN_DB_FLAGS_DEFAULT, "purpose", GWEN_Buffer_GetStart(bufLines));
   }
 
-  /* buffer no longer needed */
-  GWEN_Buffer_free(tbuf);
+  GWEN_Buffer_free(bufConcat);
+  GWEN_Buffer_free(bufLines);
 }
 
 
 
-void _transformPurposeIntoOneString(GWEN_DB_NODE *dbData, uint32_t flags)
+void _addPurposeLine(const char *s, GWEN_BUFFER *bufLines, GWEN_BUFFER *bufConcat, int *pLineCount, uint32_t flags)
 {
-  GWEN_BUFFER *tbuf;
-  int i;
-
-  tbuf=GWEN_Buffer_new(0, 256, 0, 1);
-  for (i=0; i<99; i++) {
-    const char *s;
-
-    s=GWEN_DB_GetCharValue(dbData, "purpose", i, 0);
-    if (s && *s) {
-      if (GWEN_Buffer_GetUsedBytes(tbuf))
-        GWEN_Buffer_AppendString(tbuf, "\n");
-      GWEN_Buffer_AppendString(tbuf, s);
-    }
+  if (flags & GWEN_DB_FLAGS_OVERWRITE_VARS) {
+    /* every line replaces the previous ones */
+    GWEN_Buffer_Reset(bufLines);
+    GWEN_Buffer_Reset(bufConcat);
+    *pLineCount=0;
   }
 
-  if (GWEN_Buffer_GetUsedBytes(tbuf)) {
-    GWEN_DB_DeleteVar(dbData, "purpose");
-    GWEN_DB_SetCharValue(dbData, GWEN_DB_FLAGS_DEFAULT, "purpose", GWEN_Buffer_GetStart(tbuf));
+  if (s && *s && *pLineCount<AHB_SWIFT940_SEPA_MAXPURPOSE) {
+    uint32_t pos;
+
+    if (GWEN_Buffer_GetUsedBytes(bufLines))
+      GWEN_Buffer_AppendByte(bufLines, '\n');
+    pos=GWEN_Buffer_GetUsedBytes(bufLines);
+    _iso8859_1ToUtf8(s, -1, bufLines);
+    GWEN_Buffer_AppendString(bufConcat, GWEN_Buffer_GetStart(bufLines)+pos);
   }
-  GWEN_Buffer_free(tbuf);
+  (*pLineCount)++;
 }
 
 
 
-int _readSepaTags(const char *sPurpose, GWEN_DB_NODE *dbSepaTags)
+void _readSepaTags(const char *sPurpose, AHB_SWIFT940_SEPA_TAGS *tags)
 {
   const char *s;
   const char *sLastTagStart;
-  int realSepaTagCount=0;
 
 #ifdef ENABLE_FULL_SEPA_LOG
-  DBG_ERROR(AQHBCI_LOGDOMAIN, "FullPurposeBuffer");
-  GWEN_Buffer_Dump(bufFullPurpose, 2);
+  DBG_ERROR(AQBANKING_LOGDOMAIN, "FullPurpose: %s", sPurpose);
 #endif
 
   s=sPurpose;
@@ -1225,31 +1287,17 @@ int _readSepaTags(const char *sPurpose, GWEN_DB_NODE *dbSepaTags)
           (s[1] && isalpha(s[1])) &&
           (s[2] && isalpha(s[2])) &&
           (s[3] && isalpha(s[3])) &&
-          s[4]=='+') {
-        if (strncasecmp(s, "EREF+", 5)==0 ||
-            strncasecmp(s, "KREF+", 5)==0 ||
-            strncasecmp(s, "MREF+", 5)==0 ||
-            strncasecmp(s, "CRED+", 5)==0 ||
-            strncasecmp(s, "DEBT+", 5)==0 ||
-            strncasecmp(s, "SVWZ+", 5)==0 ||
-            strncasecmp(s, "ABWA+", 5)==0 ||
-            strncasecmp(s, "ABWE+", 5)==0)
-          break;
-      }
+          s[4]=='+' &&
+          _findSepaKeyword(s)>=0)
+        break;
       /* not the beginning of a SEPA field, just skip */
       s++;
     }
 
     /* found begin of the next SEPA field or end of buffer */
-    if (s > sLastTagStart) {
-      int tagLen;
-
+    if (s > sLastTagStart)
       /* we currently have a field, close that first */
-      tagLen=s-sLastTagStart;
-
-      if (_storeSepaTag(sLastTagStart, tagLen, dbSepaTags)>0)
-        realSepaTagCount++;
-    }
+      _storeSepaTag(sLastTagStart, s-sLastTagStart, tags);
 
     if (*s) {
       /* save start of next tag */
@@ -1259,16 +1307,50 @@ int _readSepaTags(const char *sPurpose, GWEN_DB_NODE *dbSepaTags)
       s+=5;
     }
   } /* while */
-
-  return realSepaTagCount;
 }
 
 
 
-int _storeSepaTag(const char *sTagStart, int tagLen, GWEN_DB_NODE *dbSepaTags)
+/* Return the index of the SEPA keyword at the beginning of the given string (-1 if none).
+   The string must contain at least 5 bytes.
+ */
+int _findSepaKeyword(const char *s)
 {
-  int isRealSepaTag=0;
+  int idx;
+
+  switch (toupper(s[0])) {
+  case 'E':
+    idx=0;
+    break;
+  case 'K':
+    idx=1;
+    break;
+  case 'M':
+    idx=2;
+    break;
+  case 'C':
+    idx=3;
+    break;
+  case 'D':
+    idx=4;
+    break;
+  case 'S':
+    idx=5;
+    break;
+  case 'A':
+    idx=(toupper(s[3])=='A')?6:7;
+    break;
+  default:
+    return -1;
+  }
+
+  return (strncasecmp(s, _sepaKeywords[idx].keyword, 5)==0)?idx:-1;
+}
 
+
+
+void _storeSepaTag(const char *sTagStart, int tagLen, AHB_SWIFT940_SEPA_TAGS *tags)
+{
 #ifdef ENABLE_FULL_SEPA_LOG
   DBG_ERROR(0, "Current tag:");
   GWEN_Text_LogString(sTagStart, tagLen, 0, GWEN_LoggerLevel_Error);
@@ -1276,12 +1358,11 @@ int _storeSepaTag(const char *sTagStart, int tagLen, GWEN_DB_NODE *dbSepaTags)
 
   /* check tag length (must be long enough for 'XXX+', i.e. at least 5 bytes) */
   if (tagLen>5 && sTagStart[4]=='+') {
-    char sIdentifier[6];
     const char *sPayload;
+    int idx;
 
     /* ok, 5 bytes or more, 4 alphas and a plus sign, should be the begin of a SEPA tag */
-    strncpy(sIdentifier, sTagStart, 5);
-    sIdentifier[5]=0;
+    idx=_findSepaKeyword(sTagStart);
 
     /* remove leading blanks */
     sPayload=sTagStart+5;
@@ -1292,112 +1373,71 @@ int _storeSepaTag(const char *sTagStart, int tagLen, GWEN_DB_NODE *dbSepaTags)
     }
 
     /* remove trailing blanks */
-    if (tagLen>0) {
-      while (tagLen>0) {
-        if (!isblank(sPayload[tagLen-1]))
-          break;
-        tagLen--;
-      }
-    }
+    while (tagLen>0 && isblank(sPayload[tagLen-1]))
+      tagLen--;
 
     /* store tag, if still data left */
     if (tagLen>0) {
-      char *sCopyPayload;
-
-      sCopyPayload=GWEN_Text_strndup(sPayload, tagLen);
-      GWEN_DB_SetCharValue(dbSepaTags, GWEN_DB_FLAGS_DEFAULT, sIdentifier, sCopyPayload);
-      free(sCopyPayload);
-      isRealSepaTag=1;
+      if (idx>=0)
+        _appendSepaValue(tags, idx, sPayload, tagLen);
+      else if (memchr(sTagStart, '/', 5)==NULL)
+        /* unknown fields are dropped but still count as stored values (unless their name is a DB path) */
+        tags->storedCount++;
+      tags->realTagCount++;
     }
     else {
-      DBG_WARN(GWEN_LOGDOMAIN, "Ignoring empty SEPA field \"%s\"", sIdentifier);
+      DBG_WARN(AQBANKING_LOGDOMAIN, "Ignoring empty SEPA field \"%.5s\"", sTagStart);
     }
   }
   else {
     /* tag is shorter than 5 bytes or pos 4 doesn't contain a plus, treat as normal purpose */
-    if (tagLen>0) {
-      char *sCopyPayload;
-
-      sCopyPayload=GWEN_Text_strndup(sTagStart, tagLen);
-      GWEN_DB_SetCharValue(dbSepaTags, GWEN_DB_FLAGS_DEFAULT, "_purpose", sCopyPayload);
-      free(sCopyPayload);
-    }
+    if (tagLen>0)
+      _appendSepaValue(tags, AHB_SWIFT940_SEPA_OTHER, sTagStart, tagLen);
   }
-
-  return isRealSepaTag?1:0;
 }
 
 
 
-void _transformSepaTags(GWEN_DB_NODE *dbData, GWEN_DB_NODE *dbSepaTags, uint32_t flags)
+void _appendSepaValue(AHB_SWIFT940_SEPA_TAGS *tags, int idx, const char *s, int len)
 {
-  GWEN_DB_NODE *dbVar;
-
-#ifdef ENABLE_FULL_SEPA_LOG
-  DBG_ERROR(0, "Got these SEPA tags:");
-  GWEN_DB_Dump(dbSepaTags, 2);
-#endif
-
-  /* clear purpose variable, since we are about to add it back from SEPA tags */
-  GWEN_DB_DeleteVar(dbData, "purpose");
-
-  dbVar=GWEN_DB_GetFirstVar(dbSepaTags);
-  while (dbVar) {
-    const char *sVarName;
+  if (tags->values[idx]==NULL) {
+    /* remember the order in which the fields appeared */
+    tags->values[idx]=GWEN_Buffer_new(0, 128, 0, 1);
+    tags->order[tags->orderCount++]=idx;
+  }
+  GWEN_Buffer_AppendBytes(tags->values[idx], s, len);
+  tags->storedCount++;
+}
 
-    sVarName=GWEN_DB_VariableName(dbVar);
-    if (sVarName && *sVarName) {
-      GWEN_BUFFER *tbuf;
-      GWEN_DB_NODE *dbValue;
 
-      /* sample all values into a buffer and concatenate */
-      tbuf=GWEN_Buffer_new(0, 128, 0, 1);
-      dbValue=GWEN_DB_GetFirstValue(dbVar);
-      while (dbValue) {
-        const char *s;
 
-        s=GWEN_DB_GetCharValueFromNode(dbValue);
-        if (s && *s)
-          GWEN_Buffer_AppendString(tbuf, s);
+/* Store the SEPA fields found in the purpose lines, the remaining purpose is returned in bufPurpose. */
+void _transformSepaTags(GWEN_DB_NODE *dbData, AHB_SWIFT940_SEPA_TAGS *tags, GWEN_BUFFER *bufPurpose, uint32_t flags)
+{
+  int i;
 
-        dbValue=GWEN_DB_GetNextValue(dbValue);
-      }
+  for (i=0; i<tags->orderCount; i++) {
+    int idx;
+    const char *s;
 
-      if (strcasecmp(sVarName, "EREF+")==0) {
-        AHB_SWIFT__SetCharValue(dbData, flags, "endToEndReference", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "KREF+")==0) {
-        AHB_SWIFT__SetCharValue(dbData, flags, "customerReference", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "MREF+")==0) {
-        AHB_SWIFT__SetCharValue(dbData, flags, "mandateId", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "CRED+")==0) {
-        AHB_SWIFT__SetCharValue(dbData, flags, "creditorSchemeId", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "DEBT+")==0) {
-        AHB_SWIFT__SetCharValue(dbData, flags, "originatorId", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "SVWZ+")==0) {
-        AHB_SWIFT__SetCharValue(dbData, flags | GWEN_DB_FLAGS_OVERWRITE_VARS, "purpose", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "ABWA+")==0) {
-        /* "abweichender Auftraggeber" */
-        AHB_SWIFT__SetCharValue(dbData, flags, "ultimateDebtor", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "ABWE+")==0) {
-        /* "abweichender Empfaenger" */
-        AHB_SWIFT__SetCharValue(dbData, flags, "ultimateCreditor", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "_purpose")==0) {
-        /* manually added tag (i.e. data outside a tag)
-        * will be replaced if there was a real purpose field (i.e. "SVWZ+") */
-        AHB_SWIFT__SetCharValue(dbData, flags, "purpose", GWEN_Buffer_GetStart(tbuf));
-      }
-      GWEN_Buffer_free(tbuf);
+    idx=tags->order[i];
+    s=GWEN_Buffer_GetStart(tags->values[idx]);
+    if (idx==AHB_SWIFT940_SEPA_SVWZ) {
+      /* real purpose field replaces data outside of fields found so far */
+      GWEN_Buffer_Reset(bufPurpose);
+      GWEN_Buffer_AppendString(bufPurpose, s);
     }
-
-    dbVar=GWEN_DB_GetNextVar(dbVar);
+    else if (idx==AHB_SWIFT940_SEPA_OTHER) {
+      /* data outside of fields, will be replaced if there is a real purpose field (i.e. "SVWZ+") */
+      if (flags & GWEN_DB_FLAGS_OVERWRITE_VARS)
+        GWEN_Buffer_Reset(bufPurpose);
+      if (GWEN_Buffer_GetUsedBytes(bufPurpose))
+        GWEN_Buffer_AppendByte(bufPurpose, '\n');
+      GWEN_Buffer_AppendString(bufPurpose, s);
+    }
+    else
+      /* values have already been converted to UTF-8 */
+      GWEN_DB_SetCharValue(dbData, flags, _sepaKeywords[idx].varName, s);
   }
 }
 
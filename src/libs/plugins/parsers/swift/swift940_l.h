@@ -14,10 +14,14 @@
 #include "swift_l.h"
 
 
-int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
-                        GWEN_DB_NODE *data,
-                        GWEN_DB_NODE *cfg,
-                        uint32_t flags);
+typedef struct AHB_SWIFT940_READER AHB_SWIFT940_READER;
+
+
+AHB_SWIFT940_READER *AHB_SWIFT940_Reader_new(GWEN_DB_NODE *data, GWEN_DB_NODE *cfg, uint32_t flags);
+void AHB_SWIFT940_Reader_free(AHB_SWIFT940_READER *reader);
+void AHB_SWIFT940_Reader_SetRecordHandler(AHB_SWIFT940_READER *reader, AHB_SWIFT_RECORD_HANDLER_FN fn, void *user_data);
+int AHB_SWIFT940_Reader_HandleTag(AHB_SWIFT940_READER *reader, const AHB_SWIFT_TAG *tg);
+int AHB_SWIFT940_Reader_Finish(AHB_SWIFT940_READER *reader);
 
 
 #endif /* AQHBCIBANK_SWIFT940_P_H */
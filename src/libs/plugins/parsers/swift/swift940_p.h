@@ -12,10 +12,55 @@
 #define AQHBCIBANK_SWIFT940_P_H
 
 
-#include "swift_l.h"
+#include "swift940_l.h"
 #include <gwenhywfar/buffer.h>
 
 
+struct AHB_SWIFT940_READER {
+  GWEN_DB_NODE *data;
+  GWEN_DB_NODE *cfg;
+  uint32_t flags;
+
+  GWEN_DB_NODE *dbTemplate;
+  GWEN_DB_NODE *dbDay;
+  GWEN_DB_NODE *dbTransaction;
+  const char *sDate;
+  const char *acceptTag20;
+  const char *rejectTag20;
+  int ignoreCurrentReport;
+
+  AHB_SWIFT_RECORD_HANDLER_FN recordFn;
+  void *recordUserData;
+};
+
+
+#define AHB_SWIFT940_SEPA_KEYWORDS   8
+/** index of "SVWZ+" in the keyword table */
+#define AHB_SWIFT940_SEPA_SVWZ       5
+/** index of the text outside of SEPA fields in @ref AHB_SWIFT940_SEPA_TAGS */
+#define AHB_SWIFT940_SEPA_OTHER      AHB_SWIFT940_SEPA_KEYWORDS
+#define AHB_SWIFT940_SEPA_MAXPURPOSE 99
+
+
+typedef struct AHB_SWIFT940_SEPA_KEYWORD AHB_SWIFT940_SEPA_KEYWORD;
+struct AHB_SWIFT940_SEPA_KEYWORD {
+  const char *keyword;
+  const char *varName;
+};
+
+
+/* SEPA fields found in the purpose lines of a single :86: tag */
+typedef struct AHB_SWIFT940_SEPA_TAGS AHB_SWIFT940_SEPA_TAGS;
+struct AHB_SWIFT940_SEPA_TAGS {
+  GWEN_BUFFER *values[AHB_SWIFT940_SEPA_KEYWORDS+1];
+  int order[AHB_SWIFT940_SEPA_KEYWORDS+1];
+  int orderCount;
+  int realTagCount;
+  int storedCount;
+};
+
+
+
 int AHB_SWIFT940_Parse_25(const AHB_SWIFT_TAG *tg,
                           uint32_t flags,
                           GWEN_DB_NODE *data,
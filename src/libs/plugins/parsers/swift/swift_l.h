@@ -27,6 +27,35 @@ const char *AHB_SWIFT_Tag_GetId(const AHB_SWIFT_TAG *tg);
 const char *AHB_SWIFT_Tag_GetData(const AHB_SWIFT_TAG *tg);
 
 
+/**
+ * Handler for tags read by @ref AHB_SWIFT_ReadDocumentWithHandler. The tag is freed by the caller
+ * after the handler returns, a negative return value aborts reading.
+ */
+typedef int (*AHB_SWIFT_TAG_HANDLER_FN)(AHB_SWIFT_TAG *tg, void *user_data);
+
+
+/**
+ * Handler for MT940/942 transaction groups given to @ref AHB_SWIFT_ImportWithHandler. It is called as soon
+ * as a transaction is complete (i.e. when its :61: tag and all following :86: tags have been read).
+ * The group has already been removed from the imported DB and is freed after the handler returns,
+ * a negative return value aborts reading.
+ */
+typedef int (*AHB_SWIFT_RECORD_HANDLER_FN)(GWEN_DB_NODE *dbTransaction, void *user_data);
+
+
+/**
+ * Same as the import function of the DBIO plugin, but MT940/942 transactions are handed to the given
+ * handler one by one instead of being added to @a data (balances are still added to @a data).
+ * @param fn handler for transaction groups (NULL to add them to @a data)
+ */
+int AHB_SWIFT_ImportWithHandler(GWEN_SYNCIO *sio,
+                                GWEN_DB_NODE *data,
+                                GWEN_DB_NODE *cfg,
+                                uint32_t flags,
+                                AHB_SWIFT_RECORD_HANDLER_FN fn,
+                                void *user_data);
+
+
 GWEN_LIST_FUNCTION_DEFS(AHB_SWIFT_SUBTAG, AHB_SWIFT_SubTag);
 
 
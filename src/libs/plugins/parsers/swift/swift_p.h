@@ -62,6 +62,10 @@ int AHB_SWIFT_ReadDocument(GWEN_FAST_BUFFER *fb,
                            AHB_SWIFT_TAG_LIST *tl,
                            unsigned int maxTags);
 
+int AHB_SWIFT_ReadDocumentWithHandler(GWEN_FAST_BUFFER *fb,
+                                      AHB_SWIFT_TAG_HANDLER_FN fn,
+                                      void *user_data);
+
 
 int AHB_SWIFT_Export(GWEN_DBIO *dbio,
                      GWEN_SYNCIO *sio,
@@ -17,11 +17,15 @@
 /* Gwenhywfar includes */
 #include <gwenhywfar/text.h>
 
+/* AqBanking includes */
+#include <aqbanking/types/imexporter_context_cursor.h>
+
 
 
 /* forward declarations */
 static GWEN_DB_NODE *_readCommandLine(GWEN_DB_NODE *dbArgs, int argc, char **argv);
-static int _copyTransactionsAndFillGaps(AB_IMEXPORTER_CONTEXT *inCtx,
+static int _copyTransactionsAndFillGaps(AB_BANKING *ab,
+                                        AB_IMEXPORTER_CONTEXT_CURSOR *cursor,
                                         AB_ACCOUNT_SPEC_LIST *accountSpecList,
                                         AB_IMEXPORTER_CONTEXT *outCtx);
 
@@ -34,7 +38,7 @@ int fillGaps(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
   int rv;
   const char *ctxFile;
   int noWriteOnError=0;
-  AB_IMEXPORTER_CONTEXT *inCtx=NULL;
+  AB_IMEXPORTER_CONTEXT_CURSOR *cursor=NULL;
   AB_IMEXPORTER_CONTEXT *outCtx=NULL;
   AB_ACCOUNT_SPEC_LIST *accountSpecList=NULL;
 
@@ -55,10 +59,10 @@ int fillGaps(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
     return 2;
   }
 
-  /* read in-context */
+  /* open in-context (which is read record by record, a missing file is treated as an empty context) */
   ctxFile=GWEN_DB_GetCharValue(db, "ctxfile", 0, 0);
-  rv=readContext(ctxFile, &inCtx, 0);
-  if (rv<0) {
+  rv=AB_ImExporterContextCursor_Open(ctxFile, &cursor);
+  if (rv<0 && rv!=GWEN_ERROR_NOT_FOUND) {
     DBG_ERROR(0, "Error reading context (%d)", rv);
     AB_Banking_Fini(ab);
     return 4;
@@ -68,14 +72,22 @@ int fillGaps(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
   rv=AB_Banking_GetAccountSpecList(ab, &accountSpecList);
   if (rv<0) {
     DBG_INFO(0, "here (%d)", rv);
+    AB_ImExporterContextCursor_free(cursor);
     AB_Banking_Fini(ab);
     return 4;
   }
 
   /* fill gaps */
   outCtx=AB_ImExporterContext_new();
-  rv=_copyTransactionsAndFillGaps(inCtx, accountSpecList, outCtx);
-  if (rv<0) {
+  rv=cursor?_copyTransactionsAndFillGaps(ab, cursor, accountSpecList, outCtx):0;
+  AB_ImExporterContextCursor_free(cursor);
+  if (rv==GWEN_ERROR_BAD_DATA) {
+    DBG_ERROR(0, "Error reading context, nothing written.");
+    AB_ImExporterContext_free(outCtx);
+    AB_Banking_Fini(ab);
+    return 4;
+  }
+  else if (rv<0) {
     if (noWriteOnError) {
       DBG_ERROR(0, "Some transactions could not be assigned to configured accounts, nothing written.");
       AB_ImExporterContext_free(outCtx);
@@ -84,7 +96,6 @@ int fillGaps(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
     }
     DBG_ERROR(0, "Some transactions could not be assigned to configured accounts, those have status=error");
   }
-  AB_ImExporterContext_free(inCtx);
 
   rv=writeContext(ctxFile, outCtx);
   if (rv<0) {
@@ -175,49 +186,50 @@ GWEN_DB_NODE *_readCommandLine(GWEN_DB_NODE *dbArgs, int argc, char **argv)
 
 
 
-int _copyTransactionsAndFillGaps(AB_IMEXPORTER_CONTEXT *inCtx,
+int _copyTransactionsAndFillGaps(AB_BANKING *ab,
+                                 AB_IMEXPORTER_CONTEXT_CURSOR *cursor,
                                  AB_ACCOUNT_SPEC_LIST *accountSpecList,
                                  AB_IMEXPORTER_CONTEXT *outCtx)
 {
-  AB_IMEXPORTER_ACCOUNTINFO *iea;
   int allOk=1;
   int transactionCount=0;
+  int rv;
 
-  iea=AB_ImExporterContext_GetFirstAccountInfo(inCtx);
-  while (iea) {
+  while ((rv=AB_ImExporterContextCursor_Next(cursor))>0) {
     const AB_TRANSACTION *t;
+    AB_ACCOUNT_SPEC *as;
+    AB_TRANSACTION *tCopy=NULL;
+
+    if (rv!=AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_TRANSACTION)
+      continue;
+    t=AB_ImExporterContextCursor_GetTransaction(cursor);
+    if (t==NULL)
+      return GWEN_ERROR_BAD_DATA;
+
+    tCopy=AB_Transaction_dup(t);
+
+    as=pickAccountSpecForTransaction(ab, accountSpecList, tCopy);
+    if (as==NULL) {
+      DBG_ERROR(0, "Could not determine account for transaction %d", transactionCount);
+      allOk=0;
+      AB_Transaction_SetStatus(tCopy, AB_Transaction_StatusError);
+    }
 
-    t=AB_ImExporterAccountInfo_GetFirstTransaction(iea, 0, 0);
-    while (t) {
-      AB_ACCOUNT_SPEC *as;
-      AB_TRANSACTION *tCopy=NULL;
-
-      tCopy=AB_Transaction_dup(t);
-
-      as=pickAccountSpecForTransaction(accountSpecList, tCopy);
-      if (as==NULL) {
-        DBG_ERROR(0, "Could not determine account for transaction %d", transactionCount);
-        allOk=0;
-        AB_Transaction_SetStatus(tCopy, AB_Transaction_StatusError);
-      }
-
-      /* fill missing fields in transaction from account spec */
-      AB_Banking_FillTransactionFromAccountSpec(tCopy, as);
-
-      /* add to new context */
-      AB_ImExporterContext_AddTransaction(outCtx, tCopy);
+    /* fill missing fields in transaction from account spec */
+    AB_Banking_FillTransactionFromAccountSpec(tCopy, as);
+    AB_AccountSpec_free(as);
 
-      transactionCount++;
-      t=AB_Transaction_List_Next(t);
-    } /* while t */
+    /* add to new context */
+    AB_ImExporterContext_AddTransaction(outCtx, tCopy);
 
-    iea=AB_ImExporterAccountInfo_List_Next(iea);
+    transactionCount++;
   } /* while */
+  if (rv<0) {
+    DBG_INFO(0, "here (%d)", rv);
+    return GWEN_ERROR_BAD_DATA;
+  }
 
   if (allOk==0)
     return GWEN_ERROR_GENERIC;
   return 0;
 }
-
-
-
@@ -49,6 +49,7 @@ typedef enum {
 #define AQBANKING_TOOL_REQUEST_ESTATEMENTS   0x0008
 #define AQBANKING_TOOL_REQUEST_DEPOT         0x0010
 
+#define AQBANKING_TOOL_REQUEST_DROP_KNOWN    0x4000
 #define AQBANKING_TOOL_REQUEST_IGNORE_UNSUP  0x8000
 
 
@@ -81,7 +82,14 @@ AB_ACCOUNT_SPEC *getSingleSelectedAccount(AB_BANKING *ab, GWEN_DB_NODE *db);
 
 
 AB_ACCOUNT_SPEC *pickAccountSpecForArgs(const AB_ACCOUNT_SPEC_LIST *accountSpecList, GWEN_DB_NODE *db);
-AB_ACCOUNT_SPEC *pickAccountSpecForTransaction(const AB_ACCOUNT_SPEC_LIST *as, const AB_TRANSACTION *t);
+
+/**
+ * Find the account spec for the local account of the given transaction. The caller takes over the
+ * account spec returned.
+ */
+AB_ACCOUNT_SPEC *pickAccountSpecForTransaction(AB_BANKING *ab,
+                                              const AB_ACCOUNT_SPEC_LIST *accountSpecList,
+                                              const AB_TRANSACTION *t);
 
 
 
@@ -94,7 +102,7 @@ int addTransactionToContextFile(const AB_TRANSACTION *t, const char *ctxFile);
 int writeJobsAsContextFile(AB_TRANSACTION_LIST2 *tList, const char *ctxFile);
 
 
-int execBankingJobs(AB_BANKING *ab, AB_TRANSACTION_LIST2 *tList, const char *ctxFile);
+int execBankingJobs(AB_BANKING *ab, AB_TRANSACTION_LIST2 *tList, const char *ctxFile, int dropKnown);
 int execSingleBankingJob(AB_BANKING *ab, AB_TRANSACTION *t, const char *ctxFile);
 
 AB_TRANSACTION *createAndCheckRequest(AB_BANKING *ab, AB_ACCOUNT_SPEC *as, AB_TRANSACTION_COMMAND cmd);
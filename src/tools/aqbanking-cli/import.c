@@ -28,6 +28,7 @@ int import(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
   const char *profileFile;
   const char *bankId;
   const char *accountId;
+  int dropKnown;
   AB_IMEXPORTER_CONTEXT *ctx=0;
   const GWEN_ARGS args[]= {
     {
@@ -107,6 +108,17 @@ int import(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
       "overwrite the account number",     /* short description */
       "overwrite the account number"      /* long description */
     },
+    {
+      0,                            /* flags */
+      GWEN_ArgsType_Int,             /* type */
+      "dropKnown",                  /* name */
+      0,                            /* minnum */
+      1,                            /* maxnum */
+      0,                            /* short option */
+      "dropKnown",                  /* long option */
+      "drop transactions already imported in earlier runs",     /* short description */
+      "drop bank statement transactions which have already been imported or received in earlier runs"  /* long description */
+    },
     {
       GWEN_ARGS_FLAGS_HELP | GWEN_ARGS_FLAGS_LAST, /* flags */
       GWEN_ArgsType_Int,             /* type */
@@ -144,6 +156,7 @@ int import(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
 
   bankId=GWEN_DB_GetCharValue(db, "bankId", 0, 0);
   accountId=GWEN_DB_GetCharValue(db, "accountId", 0, 0);
+  dropKnown=GWEN_DB_GetIntValue(db, "dropKnown", 0, 0);
   importerName=GWEN_DB_GetCharValue(db, "importerName", 0, "csv");
   profileName=GWEN_DB_GetCharValue(db, "profileName", 0, "default");
   profileFile=GWEN_DB_GetCharValue(db, "profileFile", 0, NULL);
@@ -181,12 +194,35 @@ int import(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
     } /* while */
   }
 
+  /* remove statement transactions seen in earlier runs */
+  if (dropKnown) {
+    rv=AB_Banking_DropKnownTransactions(ab, ctx);
+    if (rv<0) {
+      DBG_ERROR(0, "Error dropping known transactions (%d)", rv);
+      AB_ImExporterContext_free(ctx);
+      AB_Banking_Fini(ab);
+      return 4;
+    }
+    DBG_INFO(0, "Dropped %d known transactions", rv);
+  }
+
   /* write context */
   rv=writeContext(ctxFile, ctx);
   if (rv<0) {
     AB_Banking_Fini(ab);
     return 4;
   }
+
+  /* only remember the transactions once they have been written */
+  if (dropKnown) {
+    rv=AB_Banking_AddKnownTransactions(ab, ctx);
+    if (rv<0) {
+      DBG_ERROR(0, "Error storing known transactions (%d)", rv);
+      AB_ImExporterContext_free(ctx);
+      AB_Banking_Fini(ab);
+      return 4;
+    }
+  }
   AB_ImExporterContext_free(ctx);
 
   /* that's is */
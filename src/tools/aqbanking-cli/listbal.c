@@ -15,6 +15,7 @@
 #include <gwenhywfar/text.h>
 
 #include <aqbanking/types/balance.h>
+#include <aqbanking/types/imexporter_context_cursor.h>
 
 
 
@@ -28,8 +29,7 @@ int listBal(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
   GWEN_DB_NODE *db;
   int rv;
   const char *ctxFile;
-  AB_IMEXPORTER_CONTEXT *ctx=0;
-  AB_IMEXPORTER_ACCOUNTINFO *iea=0;
+  AB_IMEXPORTER_CONTEXT_CURSOR *cursor=NULL;
   uint32_t aid;
   const char *bankId;
   const char *accountId;
@@ -77,18 +77,20 @@ int listBal(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
     return 2;
   }
 
-  /* load ctx file */
+  /* walk through the ctx file record by record, only account infos are needed */
   ctxFile=GWEN_DB_GetCharValue(db, "ctxfile", 0, 0);
-  rv=readContext(ctxFile, &ctx, 1);
+  rv=AB_ImExporterContextCursor_Open(ctxFile, &cursor);
   if (rv<0) {
     DBG_ERROR(0, "Error reading context (%d)", rv);
-    AB_ImExporterContext_free(ctx);
     return 4;
   }
 
-  /* copy context, but only keep wanted accounts and transactions */
-  iea=AB_ImExporterContext_GetFirstAccountInfo(ctx);
-  while (iea) {
+  while ((rv=AB_ImExporterContextCursor_Next(cursor))>0) {
+    const AB_IMEXPORTER_ACCOUNTINFO *iea;
+
+    if (rv!=AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_ACCOUNTINFO)
+      continue;
+    iea=AB_ImExporterContextCursor_GetAccountInfo(cursor);
     if (AB_ImExporterAccountInfo_Matches(iea,
                                          aid,  /* unique account id */
                                          "*",
@@ -163,10 +165,12 @@ int listBal(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
 
       GWEN_DB_Group_free(dbAccount);
     } /* if account matches */
-
-    iea=AB_ImExporterAccountInfo_List_Next(iea);
   } /* while */
-  AB_ImExporterContext_free(ctx);
+  AB_ImExporterContextCursor_free(cursor);
+  if (rv<0) {
+    DBG_ERROR(0, "Error reading context (%d)", rv);
+    return 4;
+  }
 
   /* deinit */
   rv=AB_Banking_Fini(ab);
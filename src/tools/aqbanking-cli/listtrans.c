@@ -14,6 +14,8 @@
 #include "globals.h"
 #include <gwenhywfar/text.h>
 
+#include <aqbanking/types/imexporter_context_cursor.h>
+
 
 
 static GWEN_DB_NODE *_readCommandLine(GWEN_DB_NODE *dbArgs, int argc, char **argv);
@@ -26,8 +28,9 @@ int listTrans(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
   GWEN_DB_NODE *db;
   int rv;
   const char *ctxFile;
-  AB_IMEXPORTER_CONTEXT *ctx=0;
-  AB_IMEXPORTER_ACCOUNTINFO *iea=0;
+  AB_IMEXPORTER_CONTEXT_CURSOR *cursor=NULL;
+  int accountMatches=0;
+  GWEN_BUFFER *dbuf;
   uint32_t aid;
   const char *bankId;
   const char *accountId;
@@ -86,54 +89,45 @@ int listTrans(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
     return 2;
   }
 
-  /* load ctx file */
+  /* walk through the ctx file record by record */
   ctxFile=GWEN_DB_GetCharValue(db, "ctxfile", 0, 0);
-  rv=readContext(ctxFile, &ctx, 1);
+  rv=AB_ImExporterContextCursor_Open(ctxFile, &cursor);
   if (rv<0) {
     DBG_ERROR(0, "Error reading context (%d)", rv);
-    AB_ImExporterContext_free(ctx);
     return 4;
   }
 
-  /* copy context, but only keep wanted accounts and transactions */
-  iea=AB_ImExporterContext_GetFirstAccountInfo(ctx);
-  while (iea) {
-    if (AB_ImExporterAccountInfo_Matches(iea,
-                                         aid,  /* unique account id */
-                                         "*",
-                                         bankId,
-                                         accountId,
-                                         subAccountId,
-                                         iban,
-                                         "*", /* currency */
-                                         AB_AccountType_Unknown)) {
-      AB_TRANSACTION_LIST *tl;
-
-      tl=AB_ImExporterAccountInfo_GetTransactionList(iea);
-      if (tl) {
-        const AB_TRANSACTION *t;
-        GWEN_BUFFER *dbuf;
-
-        dbuf=GWEN_Buffer_new(0, 256, 0, 1);
-
-        t=AB_Transaction_List_FindFirstByType(tl, transactionType, transactionCommand);
-        while (t) {
-          rv=addTransactionToBufferByTemplate(t, tmplString, dbuf);
-          if (rv<0) {
-          }
-
-          fprintf(stdout, "%s\n", GWEN_Buffer_GetStart(dbuf));
-          GWEN_Buffer_Reset(dbuf);
-
-          t=AB_Transaction_List_FindNextByType(t, transactionType, transactionCommand);
+  dbuf=GWEN_Buffer_new(0, 256, 0, 1);
+  while ((rv=AB_ImExporterContextCursor_Next(cursor))>0) {
+    if (rv==AB_IMEXPORTER_CONTEXT_CURSOR_ITEM_ACCOUNTINFO)
+      accountMatches=AB_ImExporterAccountInfo_Matches(AB_ImExporterContextCursor_GetAccountInfo(cursor),
+                                                      aid,  /* unique account id */
+                                                      "*",
+                                                      bankId,
+                                                      accountId,
+                                                      subAccountId,
+                                                      iban,
+                                                      "*", /* currency */
+                                                      AB_AccountType_Unknown);
+    else if (accountMatches) {
+      const AB_TRANSACTION *t;
+
+      t=AB_ImExporterContextCursor_GetTransaction(cursor);
+      if (t && AB_Transaction_MatchTypeAndCommand(t, transactionType, transactionCommand)) {
+        rv=addTransactionToBufferByTemplate(t, tmplString, dbuf);
+        if (rv<0) {
         }
-        GWEN_Buffer_free(dbuf);
+        fprintf(stdout, "%s\n", GWEN_Buffer_GetStart(dbuf));
+        GWEN_Buffer_Reset(dbuf);
       }
     }
-
-    iea=AB_ImExporterAccountInfo_List_Next(iea);
   } /* while */
-  AB_ImExporterContext_free(ctx);
+  GWEN_Buffer_free(dbuf);
+  AB_ImExporterContextCursor_free(cursor);
+  if (rv<0) {
+    DBG_ERROR(0, "Error reading context (%d)", rv);
+    return 4;
+  }
 
   /* deinit */
   rv=AB_Banking_Fini(ab);
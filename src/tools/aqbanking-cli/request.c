@@ -66,6 +66,8 @@ int request(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
     requestFlags|=AQBANKING_TOOL_REQUEST_DEPOT;
   if (GWEN_DB_GetIntValue(db, "ignoreUnsupported", 0, 0))
     requestFlags|=AQBANKING_TOOL_REQUEST_IGNORE_UNSUP;
+  if (GWEN_DB_GetIntValue(db, "dropKnown", 0, 0))
+    requestFlags|=AQBANKING_TOOL_REQUEST_DROP_KNOWN;
 
   /* read command line arguments */
   ctxFile=GWEN_DB_GetCharValue(db, "ctxfile", 0, 0);
@@ -164,7 +166,7 @@ int _createAndAndSendRequests(AB_BANKING *ab,
   if (AB_Transaction_List2_GetSize(jobList)) {
     int rv;
 
-    rv=execBankingJobs(ab, jobList, ctxFile);
+    rv=execBankingJobs(ab, jobList, ctxFile, (requestFlags & AQBANKING_TOOL_REQUEST_DROP_KNOWN)?1:0);
     if (rv) {
       fprintf(stderr, "Error on sendCommands (%d)\n", rv);
       AB_Transaction_List2_free(jobList);
@@ -365,6 +367,18 @@ GWEN_DB_NODE *_readCommandLine(GWEN_DB_NODE *dbArgs, int argc, char **argv)
       "let AqBanking ignore unsupported requests for accounts",
       "let AqBanking ignore unsupported requests for accounts",
     },
+    {
+      0,
+      GWEN_ArgsType_Int,
+      "dropKnown",
+      0,
+      1,
+      0,
+      "dropKnown",
+      "drop transactions already received in earlier runs",
+      "drop bank statement transactions which have already been received in earlier runs "
+      "(their fingerprints are kept per account below the AqBanking user data folder)",
+    },
     {
       GWEN_ARGS_FLAGS_HAS_ARGUMENT, /* flags */
       GWEN_ArgsType_Char,            /* type */
@@ -21,7 +21,8 @@
 
 static GWEN_DB_NODE *_readCommandLine(GWEN_DB_NODE *dbArgs, int argc, char **argv);
 
-static int _createJobsFromContext(AB_IMEXPORTER_CONTEXT *ctx,
+static int _createJobsFromContext(AB_BANKING *ab,
+                                  AB_IMEXPORTER_CONTEXT *ctx,
                                   const AB_ACCOUNT_SPEC_LIST *accountSpecList,
                                   AB_ACCOUNT_SPEC *forcedAccount,
                                   AB_TRANSACTION_COMMAND cmd,
@@ -120,7 +121,7 @@ int sepaMultiJobs(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv,
 
   /* populate job list */
   jobList=AB_Transaction_List2_new();
-  rv=_createJobsFromContext(ctx, accountSpecList, forcedAccount, cmd, jobList);
+  rv=_createJobsFromContext(ab, ctx, accountSpecList, forcedAccount, cmd, jobList);
   AB_ImExporterContext_free(ctx);
   if (rv<0) {
     DBG_INFO(0, "Error (%d)", rv);
@@ -137,7 +138,7 @@ int sepaMultiJobs(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv,
     writeJobsAsContextFile(jobList, ctxFile);
   }
   else {
-    rv=execBankingJobs(ab, jobList, ctxFile);
+    rv=execBankingJobs(ab, jobList, ctxFile, 0);
     if (rv) {
       DBG_ERROR(0, "Error on executeQueue (%d)", rv);
       rvExec=3;
@@ -351,7 +352,8 @@ GWEN_DB_NODE *_readCommandLine(GWEN_DB_NODE *dbArgs, int argc, char **argv)
 
 
 
-int _createJobsFromContext(AB_IMEXPORTER_CONTEXT *ctx,
+int _createJobsFromContext(AB_BANKING *ab,
+                           AB_IMEXPORTER_CONTEXT *ctx,
                            const AB_ACCOUNT_SPEC_LIST *accountSpecList,
                            AB_ACCOUNT_SPEC *forcedAccount,
                            AB_TRANSACTION_COMMAND cmd,
@@ -368,6 +370,7 @@ int _createJobsFromContext(AB_IMEXPORTER_CONTEXT *ctx,
     t=AB_ImExporterAccountInfo_GetFirstTransaction(iea, 0, 0);
     while (t) {
       AB_ACCOUNT_SPEC *as;
+      AB_ACCOUNT_SPEC *asPicked=NULL;
       AB_TRANSACTION *job=NULL;
       const char *rIBAN;
       const char *lIBAN;
@@ -380,7 +383,7 @@ int _createJobsFromContext(AB_IMEXPORTER_CONTEXT *ctx,
       if (forcedAccount)
         as=forcedAccount;
       else
-        as=pickAccountSpecForTransaction(accountSpecList, t);
+        as=asPicked=pickAccountSpecForTransaction(ab, accountSpecList, t);
       if (as==NULL) {
         DBG_ERROR(0, "Could not determine account for job in line %d", transactionLine);
         reallyExecute=0;
@@ -445,6 +448,7 @@ int _createJobsFromContext(AB_IMEXPORTER_CONTEXT *ctx,
         }
       }
       AB_Transaction_SetCommand(job, cmd);
+      AB_AccountSpec_free(asPicked);
 
       AB_Transaction_List2_PushBack(jobList, job);
       transactionLine++;
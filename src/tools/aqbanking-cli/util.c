@@ -16,12 +16,21 @@
 #include <gwenhywfar/text.h>
 #include <gwenhywfar/syncio_file.h>
 
+#include <aqbanking/types/imexporter_context_bin.h>
+
 #include <errno.h>
 #include <ctype.h>
 
 
 
 static int GWENHYWFAR_CB _replaceVarsCb(void *cbPtr, const char *name, int index, int maxLen, GWEN_BUFFER *dstBuf);
+static int _isExactKey(const char *s);
+static int _readContextFromStdin(AB_IMEXPORTER_CONTEXT **pCtx);
+static int _getAccountSpecByExactKey(AB_BANKING *ab,
+                                     const char *iban,
+                                     const char *bankCode,
+                                     const char *accountNumber,
+                                     AB_ACCOUNT_SPEC **pAccountSpec);
 
 
 
@@ -40,26 +49,34 @@ int readContext(const char *ctxFile,
   GWEN_DB_NODE *dbCtx;
   int rv;
 
-  if (ctxFile==NULL) {
-    sio=GWEN_SyncIo_File_fromStdin();
-    GWEN_SyncIo_AddFlags(sio,
-                         GWEN_SYNCIO_FLAGS_DONTCLOSE |
-                         GWEN_SYNCIO_FILE_FLAGS_READ);
-  }
-  else {
-    sio=GWEN_SyncIo_File_new(ctxFile, GWEN_SyncIo_File_CreationMode_OpenExisting);
-    GWEN_SyncIo_AddFlags(sio, GWEN_SYNCIO_FILE_FLAGS_READ);
-    rv=GWEN_SyncIo_Connect(sio);
+  if (ctxFile && AB_ImExporterContextBin_IsBinaryFile(ctxFile)) {
+    /* binary context files are mapped into memory and decoded in place */
+    ctx=AB_ImExporterContext_new();
+    rv=AB_ImExporterContextBin_ReadFile(ctx, ctxFile);
     if (rv<0) {
-      if (!mustExist) {
-        ctx=AB_ImExporterContext_new();
-        *pCtx=ctx;
-        GWEN_SyncIo_free(sio);
-        return 0;
-      }
+      DBG_ERROR(0, "Error reading context file (%d)", rv);
+      AB_ImExporterContext_free(ctx);
+      return rv;
+    }
+    *pCtx=ctx;
+    return 0;
+  }
+
+  if (ctxFile==NULL)
+    return _readContextFromStdin(pCtx);
+
+  sio=GWEN_SyncIo_File_new(ctxFile, GWEN_SyncIo_File_CreationMode_OpenExisting);
+  GWEN_SyncIo_AddFlags(sio, GWEN_SYNCIO_FILE_FLAGS_READ);
+  rv=GWEN_SyncIo_Connect(sio);
+  if (rv<0) {
+    if (!mustExist) {
+      ctx=AB_ImExporterContext_new();
+      *pCtx=ctx;
       GWEN_SyncIo_free(sio);
-      return 4;
+      return 0;
     }
+    GWEN_SyncIo_free(sio);
+    return 4;
   }
 
   /* actually read */
@@ -91,6 +108,54 @@ int readContext(const char *ctxFile,
 
 
 
+int _readContextFromStdin(AB_IMEXPORTER_CONTEXT **pCtx)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  GWEN_SYNCIO *sio;
+  GWEN_BUFFER *buf;
+  int rv;
+
+  /* stdin can not be inspected before reading, so read everything and detect the format from the data */
+  sio=GWEN_SyncIo_File_fromStdin();
+  GWEN_SyncIo_AddFlags(sio,
+                       GWEN_SYNCIO_FLAGS_DONTCLOSE |
+                       GWEN_SYNCIO_FILE_FLAGS_READ);
+  buf=GWEN_Buffer_new(0, 65536, 0, 1);
+  for (;;) {
+    GWEN_Buffer_AllocRoom(buf, 65536);
+    rv=GWEN_SyncIo_Read(sio, (uint8_t *) GWEN_Buffer_GetPosPointer(buf), 65536);
+    if (rv==0 || rv==GWEN_ERROR_EOF)
+      break;
+    else if (rv<0) {
+      DBG_ERROR(0, "Error reading context data (%d)", rv);
+      GWEN_Buffer_free(buf);
+      GWEN_SyncIo_Disconnect(sio);
+      GWEN_SyncIo_free(sio);
+      return rv;
+    }
+    GWEN_Buffer_IncrementPos(buf, rv);
+    GWEN_Buffer_AdjustUsedBytes(buf);
+  }
+  GWEN_SyncIo_Disconnect(sio);
+  GWEN_SyncIo_free(sio);
+
+  ctx=AB_ImExporterContext_new();
+  rv=AB_ImExporterContextBin_ReadAnyFromMemory(ctx,
+                                               (const uint8_t *) GWEN_Buffer_GetStart(buf),
+                                               GWEN_Buffer_GetUsedBytes(buf));
+  GWEN_Buffer_free(buf);
+  if (rv<0) {
+    DBG_ERROR(0, "Error reading context data (%d)", rv);
+    AB_ImExporterContext_free(ctx);
+    return rv;
+  }
+  *pCtx=ctx;
+
+  return 0;
+}
+
+
+
 /* ========================================================================================================================
  *                                                writeContext
  * ========================================================================================================================
@@ -100,8 +165,13 @@ int writeContext(const char *ctxFile, const AB_IMEXPORTER_CONTEXT *ctx)
 {
   GWEN_DB_NODE *dbCtx;
   GWEN_SYNCIO *sio;
+  int binary=0;
   int rv;
 
+  /* keep the format of an existing binary context file */
+  if (ctxFile && AB_ImExporterContextBin_IsBinaryFile(ctxFile))
+    binary=1;
+
   if (ctxFile==NULL) {
     sio=GWEN_SyncIo_File_fromStdout();
     GWEN_SyncIo_AddFlags(sio,
@@ -126,6 +196,14 @@ int writeContext(const char *ctxFile, const AB_IMEXPORTER_CONTEXT *ctx)
     }
   }
 
+  if (binary) {
+    rv=AB_ImExporterContextBin_Write(ctx, sio);
+    if (rv<0)
+      DBG_ERROR(0, "Error writing context (%d)", rv);
+    GWEN_SyncIo_Disconnect(sio);
+    GWEN_SyncIo_free(sio);
+    return rv;
+  }
 
   dbCtx=GWEN_DB_Group_new("context");
   rv=AB_ImExporterContext_toDb(ctx, dbCtx);
@@ -469,7 +547,52 @@ AB_ACCOUNT_SPEC_LIST *getSelectedAccounts(AB_BANKING *ab, GWEN_DB_NODE *db)
     AB_AccountSpec_List_Add(as, asl);
   }
   else {
+    const char *backendName;
+    const char *country;
+    const char *bankId;
+    const char *accountId;
+    const char *subAccountId;
+    const char *iban;
+    const char *s;
+    AB_ACCOUNT_TYPE aType=AB_AccountType_Unknown;
+    AB_ACCOUNT_SPEC *as=NULL;
+
     /* no unique account id given, try match parameters */
+    backendName=GWEN_DB_GetCharValue(db, "backendName", 0, "*");
+    country=GWEN_DB_GetCharValue(db, "country", 0, "*");
+    bankId=GWEN_DB_GetCharValue(db, "bankId", 0, "*");
+    accountId=GWEN_DB_GetCharValue(db, "accountId", 0, "*");
+    subAccountId=GWEN_DB_GetCharValue(db, "subAccountId", 0, "*");
+    iban=GWEN_DB_GetCharValue(db, "iban", 0, "*");
+    s=GWEN_DB_GetCharValue(db, "accountType", 0, NULL);
+    if (s && *s)
+      aType=AB_AccountType_fromChar(s);
+    if (aType==AB_AccountType_Invalid) {
+      DBG_ERROR(0, "Invalid account type (%s)", s);
+      AB_AccountSpec_List_free(asl);
+      return NULL;
+    }
+
+    /* exact IBAN or account number given: use the lookup indices of AqBanking */
+    rv=_getAccountSpecByExactKey(ab, iban, bankId, accountId, &as);
+    if (rv==GWEN_ERROR_NOT_FOUND) {
+      DBG_INFO(0, "No matching account spec");
+      AB_AccountSpec_List_free(asl);
+      return NULL;
+    }
+    else if (rv==0) {
+      if (AB_AccountSpec_Matches(as, backendName,
+                                 country, bankId, accountId, subAccountId,
+                                 iban,
+                                 "*", /* currency */
+                                 aType)>0) {
+        AB_AccountSpec_List_Add(as, asl);
+        return asl;
+      }
+      /* other criteria don't match, check all account specs */
+      AB_AccountSpec_free(as);
+    }
+
     rv=AB_Banking_GetAccountSpecList(ab, &asl);
     if (rv<0) {
       if (rv==GWEN_ERROR_NOT_FOUND) {
@@ -481,46 +604,21 @@ AB_ACCOUNT_SPEC_LIST *getSelectedAccounts(AB_BANKING *ab, GWEN_DB_NODE *db)
       AB_AccountSpec_List_free(asl);
       return NULL;
     }
-    else {
-      const char *backendName;
-      const char *country;
-      const char *bankId;
-      const char *accountId;
-      const char *subAccountId;
-      const char *iban;
-      const char *s;
-      AB_ACCOUNT_TYPE aType=AB_AccountType_Unknown;
-      AB_ACCOUNT_SPEC *as;
-
-      backendName=GWEN_DB_GetCharValue(db, "backendName", 0, "*");
-      country=GWEN_DB_GetCharValue(db, "country", 0, "*");
-      bankId=GWEN_DB_GetCharValue(db, "bankId", 0, "*");
-      accountId=GWEN_DB_GetCharValue(db, "accountId", 0, "*");
-      subAccountId=GWEN_DB_GetCharValue(db, "subAccountId", 0, "*");
-      iban=GWEN_DB_GetCharValue(db, "iban", 0, "*");
-      s=GWEN_DB_GetCharValue(db, "accountType", 0, NULL);
-      if (s && *s)
-        aType=AB_AccountType_fromChar(s);
-      if (aType==AB_AccountType_Invalid) {
-        DBG_ERROR(0, "Invalid Could not load account specs (%d)", rv);
-        AB_AccountSpec_List_free(asl);
-        return NULL;
-      }
-      as=AB_AccountSpec_List_First(asl);
-      while (as) {
-        AB_ACCOUNT_SPEC *asNext;
-        asNext=AB_AccountSpec_List_Next(as);
-        if (AB_AccountSpec_Matches(as, backendName,
-                                   country, bankId, accountId, subAccountId,
-                                   iban,
-                                   "*", /* currency */
-                                   aType)<1) {
-          /* doesn't match, remove from list */
-          AB_AccountSpec_List_Del(as);
-          AB_AccountSpec_free(as);
-        }
-        as=asNext;
+
+    as=AB_AccountSpec_List_First(asl);
+    while (as) {
+      AB_ACCOUNT_SPEC *asNext;
+      asNext=AB_AccountSpec_List_Next(as);
+      if (AB_AccountSpec_Matches(as, backendName,
+                                 country, bankId, accountId, subAccountId,
+                                 iban,
+                                 "*", /* currency */
+                                 aType)<1) {
+        /* doesn't match, remove from list */
+        AB_AccountSpec_List_Del(as);
+        AB_AccountSpec_free(as);
       }
+      as=asNext;
     }
   }
   if (AB_AccountSpec_List_GetCount(asl)<1) {
@@ -650,23 +748,28 @@ AB_ACCOUNT_SPEC *pickAccountSpecForArgs(const AB_ACCOUNT_SPEC_LIST *accountSpecL
  */
 
 
-AB_ACCOUNT_SPEC *pickAccountSpecForTransaction(const AB_ACCOUNT_SPEC_LIST *accountSpecList, const AB_TRANSACTION *t)
+AB_ACCOUNT_SPEC *pickAccountSpecForTransaction(AB_BANKING *ab,
+                                              const AB_ACCOUNT_SPEC_LIST *accountSpecList,
+                                              const AB_TRANSACTION *t)
 {
   uint32_t uaid;
   AB_ACCOUNT_SPEC *accountSpec=NULL;
+  int rv;
 
+  assert(ab);
   assert(accountSpecList);
   assert(t);
 
   uaid=AB_Transaction_GetUniqueAccountId(t);
   if (uaid>0) {
-    accountSpec=AB_AccountSpec_List_GetByUniqueId(accountSpecList, uaid);
-    if (accountSpec==NULL) {
+    rv=AB_Banking_GetAccountSpecByUniqueId(ab, uaid, &accountSpec);
+    if (rv<0) {
       DBG_ERROR(0, "ERROR: No account spec with unique id %" PRIu32, uaid);
       return NULL;
     }
   }
   else {
+    const AB_ACCOUNT_SPEC *asInList;
     const char *country;
     const char *bankCode;
     const char *accountNumber;
@@ -679,21 +782,42 @@ AB_ACCOUNT_SPEC *pickAccountSpecForTransaction(const AB_ACCOUNT_SPEC_LIST *accou
     accountSuffix=AB_Transaction_GetLocalSuffix(t);
     iban=AB_Transaction_GetLocalIban(t);
 
-    accountSpec=AB_AccountSpec_List_FindFirst(accountSpecList,
-                                              "*", /* backend */
-                                              (country && *country)?country:"*",
-                                              (bankCode && *bankCode)?bankCode:"*",
-                                              (accountNumber && *accountNumber)?accountNumber:"*",
-                                              (accountSuffix && *accountSuffix)?accountSuffix:"*",
-                                              (iban && *iban)?iban:"*",
-                                              "*", /* currency */
-                                              AB_AccountType_Unknown);
-    if (accountSpec==NULL) {
+    /* exact IBAN or account number given: use the lookup indices of AqBanking */
+    rv=_getAccountSpecByExactKey(ab, iban, bankCode, accountNumber, &accountSpec);
+    if (rv==GWEN_ERROR_NOT_FOUND) {
       DBG_ERROR(0, "ERROR: No matching account spec found");
       return NULL;
     }
+    else if (rv==0) {
+      if (AB_AccountSpec_Matches(accountSpec,
+                                 "*", /* backend */
+                                 (country && *country)?country:"*",
+                                 (bankCode && *bankCode)?bankCode:"*",
+                                 (accountNumber && *accountNumber)?accountNumber:"*",
+                                 (accountSuffix && *accountSuffix)?accountSuffix:"*",
+                                 (iban && *iban)?iban:"*",
+                                 "*", /* currency */
+                                 AB_AccountType_Unknown)>0)
+        return accountSpec;
+      /* other criteria don't match, check all account specs */
+      AB_AccountSpec_free(accountSpec);
+    }
 
-    if (AB_AccountSpec_List_FindNext(accountSpec,
+    asInList=AB_AccountSpec_List_FindFirst(accountSpecList,
+                                           "*", /* backend */
+                                           (country && *country)?country:"*",
+                                           (bankCode && *bankCode)?bankCode:"*",
+                                           (accountNumber && *accountNumber)?accountNumber:"*",
+                                           (accountSuffix && *accountSuffix)?accountSuffix:"*",
+                                           (iban && *iban)?iban:"*",
+                                           "*", /* currency */
+                                           AB_AccountType_Unknown);
+    if (asInList==NULL) {
+      DBG_ERROR(0, "ERROR: No matching account spec found");
+      return NULL;
+    }
+
+    if (AB_AccountSpec_List_FindNext(asInList,
                                      "*", /* backend */
                                      (country && *country)?country:"*",
                                      (bankCode && *bankCode)?bankCode:"*",
@@ -705,6 +829,7 @@ AB_ACCOUNT_SPEC *pickAccountSpecForTransaction(const AB_ACCOUNT_SPEC_LIST *accou
       DBG_ERROR(0, "ERROR: Ambiguous account specification");
       return NULL;
     }
+    accountSpec=AB_AccountSpec_dup(asInList);
   }
 
   return accountSpec;
@@ -861,7 +986,7 @@ int addTransactionToContextFile(const AB_TRANSACTION *t, const char *ctxFile)
  * ========================================================================================================================
  */
 
-int execBankingJobs(AB_BANKING *ab, AB_TRANSACTION_LIST2 *tList, const char *ctxFile)
+int execBankingJobs(AB_BANKING *ab, AB_TRANSACTION_LIST2 *tList, const char *ctxFile, int dropKnown)
 {
   int rv;
   int rvExec=0;
@@ -875,15 +1000,39 @@ int execBankingJobs(AB_BANKING *ab, AB_TRANSACTION_LIST2 *tList, const char *ctx
     rvExec=3;
   }
 
+  /* remove statement transactions received in earlier runs */
+  if (dropKnown) {
+    rv=AB_Banking_DropKnownTransactions(ab, ctx);
+    if (rv<0) {
+      fprintf(stderr, "Error dropping known transactions (%d)\n", rv);
+      if (rvExec==0)
+        rvExec=3;
+    }
+    else
+      DBG_INFO(0, "Dropped %d known transactions", rv);
+  }
+
   /* write result */
   rv=writeContext(ctxFile, ctx);
-  AB_ImExporterContext_free(ctx);
   if (rv<0) {
     DBG_ERROR(0, "Error writing context file (%d)", rv);
+    AB_ImExporterContext_free(ctx);
     if (rvExec==0)
       return 4;
+    return rvExec;
   }
 
+  /* only remember the transactions once they have been written */
+  if (dropKnown) {
+    rv=AB_Banking_AddKnownTransactions(ab, ctx);
+    if (rv<0) {
+      fprintf(stderr, "Error storing known transactions (%d)\n", rv);
+      if (rvExec==0)
+        rvExec=4;
+    }
+  }
+  AB_ImExporterContext_free(ctx);
+
   return rvExec;
 }
 
@@ -901,7 +1050,7 @@ int execSingleBankingJob(AB_BANKING *ab, AB_TRANSACTION *t, const char *ctxFile)
 
   jobList=AB_Transaction_List2_new();
   AB_Transaction_List2_PushBack(jobList, t);
-  rv=execBankingJobs(ab, jobList, ctxFile);
+  rv=execBankingJobs(ab, jobList, ctxFile, 0);
   AB_Transaction_List2_free(jobList);
 
   return rv;
@@ -1165,6 +1314,29 @@ int addTransactionToBufferByTemplate(const AB_TRANSACTION *t, const char *tmplSt
 
 
 
+int _isExactKey(const char *s)
+{
+  return (s && *s && strchr(s, '*')==NULL && strchr(s, '?')==NULL);
+}
+
+
+
+int _getAccountSpecByExactKey(AB_BANKING *ab,
+                              const char *iban,
+                              const char *bankCode,
+                              const char *accountNumber,
+                              AB_ACCOUNT_SPEC **pAccountSpec)
+{
+  /* with multiple account specs for the same key AqBanking returns the one with the lowest unique id */
+  if (_isExactKey(iban))
+    return AB_Banking_GetAccountSpecByIban(ab, iban, pAccountSpec);
+  if (_isExactKey(bankCode) && _isExactKey(accountNumber))
+    return AB_Banking_GetAccountSpecByBankCodeAndAccountNumber(ab, bankCode, accountNumber, pAccountSpec);
+  return GWEN_ERROR_NOT_SUPPORTED;
+}
+
+
+
 int GWENHYWFAR_CB _replaceVarsCb(void *cbPtr, const char *name, int index, int maxLen, GWEN_BUFFER *dstBuf)
 {
   GWEN_DB_NODE *db;
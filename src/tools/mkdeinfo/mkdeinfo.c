@@ -24,6 +24,7 @@
 #include <aqbanking/types/bankinfo.h>
 
 #include <ctype.h>
+#include <stdlib.h>
 #include <sys/stat.h>
 #include <errno.h>
 
@@ -37,6 +38,35 @@
 #define FUZZY_SHIFT 10
 #define FUZZY_THRESHOLD 850
 
+/* binary index format, must match src/libs/plugins/bankinfo/generic/binidx_l.h */
+#define BINIDX_MAGIC       "ABIX"
+#define BINIDX_VERSION     1
+#define BINIDX_HEADER_SIZE 16
+#define BINIDX_MAX_KEYSIZE 64
+
+
+/* trigram index format, must match src/libs/plugins/bankinfo/generic/trigramidx_l.h */
+#define TRIGRAMIDX_MAGIC       "ABTX"
+#define TRIGRAMIDX_VERSION     1
+#define TRIGRAMIDX_HEADER_SIZE 32
+#define TRIGRAMIDX_FIELD_NAME  1
+#define TRIGRAMIDX_FIELD_LOC   2
+#define TRIGRAMIDX_STARTMARK   0x01
+
+
+typedef struct BINIDX_ENTRY BINIDX_ENTRY;
+struct BINIDX_ENTRY {
+  char key[BINIDX_MAX_KEYSIZE];
+  uint32_t pos;
+};
+
+
+typedef struct TRIGRAM_PAIR TRIGRAM_PAIR;
+struct TRIGRAM_PAIR {
+  uint32_t key;
+  uint32_t entryNum;
+};
+
 
 static AB_BANKINFO_LIST *bis=0;
 static GWEN_DB_NODE *dbIdx=0;
@@ -1502,6 +1532,345 @@ int makeIndexNameAndLoc(const char *fname)
 
 
 
+int _cmpBinIndexEntries(const void *a, const void *b)
+{
+  const BINIDX_ENTRY *ea;
+  const BINIDX_ENTRY *eb;
+  int rv;
+
+  ea=(const BINIDX_ENTRY *) a;
+  eb=(const BINIDX_ENTRY *) b;
+  rv=memcmp(ea->key, eb->key, BINIDX_MAX_KEYSIZE);
+  if (rv)
+    return rv;
+  /* keep order of banks.data for equal keys */
+  if (ea->pos<eb->pos)
+    return -1;
+  else if (ea->pos>eb->pos)
+    return 1;
+  return 0;
+}
+
+
+
+void _writeUint32(uint8_t *p, uint32_t v)
+{
+  p[0]=(v>>24) & 0xff;
+  p[1]=(v>>16) & 0xff;
+  p[2]=(v>>8) & 0xff;
+  p[3]=v & 0xff;
+}
+
+
+
+int makeBinIndex(const char *fname, int useBic)
+{
+  AB_BANKINFO *bi;
+  BINIDX_ENTRY *entries;
+  uint32_t entryCount=0;
+  uint32_t keySize=1;
+  uint32_t count=0;
+  uint32_t i;
+  uint8_t hdr[BINIDX_HEADER_SIZE];
+  FILE *f;
+
+  entries=(BINIDX_ENTRY *) malloc(sizeof(BINIDX_ENTRY)*(AB_BankInfo_List_GetCount(bis)+1));
+  assert(entries);
+
+  bi=AB_BankInfo_List_First(bis);
+  while (bi) {
+    const char *s;
+
+    count++;
+    s=useBic?AB_BankInfo_GetBic(bi):AB_BankInfo_GetBankId(bi);
+    if (s && *s) {
+      uint32_t pos;
+      uint32_t len;
+      char numbuf[32];
+
+      snprintf(numbuf, sizeof(numbuf), "%08x", count);
+      pos=(uint32_t)GWEN_DB_GetIntValue(dbIdx, numbuf, 0, 0);
+      if (pos==0 && count!=1) {
+        DBG_ERROR(0, "No index given for \"%s\" (%d)", numbuf, count);
+        free(entries);
+        return -1;
+      }
+      len=strlen(s);
+      if (len>=BINIDX_MAX_KEYSIZE) {
+        DBG_ERROR(0, "Key \"%s\" too long for binary index", s);
+        free(entries);
+        return -1;
+      }
+      memset(entries[entryCount].key, 0, BINIDX_MAX_KEYSIZE);
+      for (i=0; i<len; i++)
+        entries[entryCount].key[i]=toupper((unsigned char) s[i]);
+      entries[entryCount].pos=pos;
+      entryCount++;
+      if (len>keySize)
+        keySize=len;
+    }
+    bi=AB_BankInfo_List_Next(bi);
+  }
+
+  qsort(entries, entryCount, sizeof(BINIDX_ENTRY), _cmpBinIndexEntries);
+
+  f=fopen(fname, "wb");
+  if (!f) {
+    DBG_ERROR(0, "Error creating file \"%s\"", fname);
+    free(entries);
+    return -1;
+  }
+
+  memset(hdr, 0, sizeof(hdr));
+  memmove(hdr, BINIDX_MAGIC, 4);
+  hdr[4]=(BINIDX_VERSION>>8) & 0xff;
+  hdr[5]=BINIDX_VERSION & 0xff;
+  hdr[6]=(keySize>>8) & 0xff;
+  hdr[7]=keySize & 0xff;
+  _writeUint32(hdr+8, entryCount);
+  if (1!=fwrite(hdr, sizeof(hdr), 1, f)) {
+    DBG_ERROR(0, "Error writing file \"%s\"", fname);
+    fclose(f);
+    free(entries);
+    return -1;
+  }
+
+  for (i=0; i<entryCount; i++) {
+    uint8_t posBuf[4];
+
+    _writeUint32(posBuf, entries[i].pos);
+    if (1!=fwrite(entries[i].key, keySize, 1, f) ||
+        1!=fwrite(posBuf, sizeof(posBuf), 1, f)) {
+      DBG_ERROR(0, "Error writing file \"%s\"", fname);
+      fclose(f);
+      free(entries);
+      return -1;
+    }
+  }
+  free(entries);
+
+  if (fclose(f)) {
+    DBG_ERROR(0, "Error closing file \"%s\"", fname);
+    return -1;
+  }
+
+  return 0;
+}
+
+
+
+uint8_t _normalizeTrigramChar(uint8_t c)
+{
+  /* must match AB_BankInfoTrigramIndex_NormalizeChar() */
+  if (c>='A' && c<='Z')
+    return c+('a'-'A');
+  if ((c>='a' && c<='z') || (c>='0' && c<='9') || c>=0x80)
+    return c;
+  return ' ';
+}
+
+
+
+int _addTrigrams(const char *s, uint8_t field, uint32_t entryNum,
+                 TRIGRAM_PAIR **pPairs, uint32_t *pPairCount, uint32_t *pPairSize)
+{
+  uint8_t window[3];
+  const uint8_t *p;
+
+  window[0]=TRIGRAMIDX_STARTMARK;
+  window[1]=TRIGRAMIDX_STARTMARK;
+  p=(const uint8_t *) s;
+  while (*p) {
+    window[2]=_normalizeTrigramChar(*p);
+
+    if (*pPairCount>=*pPairSize) {
+      *pPairSize=(*pPairSize)?(*pPairSize)*2:65536;
+      *pPairs=(TRIGRAM_PAIR *) realloc(*pPairs, sizeof(TRIGRAM_PAIR)*(*pPairSize));
+      if (*pPairs==NULL) {
+        DBG_ERROR(0, "Out of memory");
+        return -1;
+      }
+    }
+    (*pPairs)[*pPairCount].key=(((uint32_t) field)<<24) |
+                               (((uint32_t) window[0])<<16) |
+                               (((uint32_t) window[1])<<8) |
+                               ((uint32_t) window[2]);
+    (*pPairs)[*pPairCount].entryNum=entryNum;
+    (*pPairCount)++;
+
+    window[0]=window[1];
+    window[1]=window[2];
+    p++;
+  }
+
+  return 0;
+}
+
+
+
+int _cmpTrigramPairs(const void *a, const void *b)
+{
+  const TRIGRAM_PAIR *pa;
+  const TRIGRAM_PAIR *pb;
+
+  pa=(const TRIGRAM_PAIR *) a;
+  pb=(const TRIGRAM_PAIR *) b;
+  if (pa->key!=pb->key)
+    return (pa->key<pb->key)?-1:1;
+  if (pa->entryNum!=pb->entryNum)
+    return (pa->entryNum<pb->entryNum)?-1:1;
+  return 0;
+}
+
+
+
+int _fwriteUint32(FILE *f, uint32_t v)
+{
+  uint8_t buf[4];
+
+  _writeUint32(buf, v);
+  return (1==fwrite(buf, sizeof(buf), 1, f))?0:-1;
+}
+
+
+
+int makeTrigramIndex(const char *fname)
+{
+  AB_BANKINFO *bi;
+  GWEN_BUFFER *entryBuf;
+  GWEN_BUFFER *stringBuf;
+  TRIGRAM_PAIR *pairs=NULL;
+  uint32_t pairCount=0;
+  uint32_t pairSize=0;
+  uint32_t entryCount=0;
+  uint32_t trigramCount=0;
+  uint32_t postingCount=0;
+  uint32_t count=0;
+  uint32_t i;
+  uint32_t entriesOffs, trigramsOffs, postingsOffs, stringsOffs;
+  uint8_t hdr[TRIGRAMIDX_HEADER_SIZE];
+  FILE *f;
+  int rv=0;
+
+  entryBuf=GWEN_Buffer_new(0, 256, 0, 1);
+  stringBuf=GWEN_Buffer_new(0, 256, 0, 1);
+
+  bi=AB_BankInfo_List_First(bis);
+  while (bi) {
+    const char *name;
+    const char *loc;
+
+    count++;
+    name=AB_BankInfo_GetBankName(bi);
+    loc=AB_BankInfo_GetLocation(bi);
+    if (name && *name && loc && *loc) {
+      uint32_t pos;
+      uint8_t numBuf[8];
+      char numbuf[32];
+
+      snprintf(numbuf, sizeof(numbuf), "%08x", count);
+      pos=(uint32_t)GWEN_DB_GetIntValue(dbIdx, numbuf, 0, 0);
+      if (pos==0 && count!=1) {
+        DBG_ERROR(0, "No index given for \"%s\" (%d)", numbuf, count);
+        rv=-1;
+        break;
+      }
+
+      _writeUint32(numBuf, pos);
+      _writeUint32(numBuf+4, GWEN_Buffer_GetUsedBytes(stringBuf));
+      GWEN_Buffer_AppendBytes(entryBuf, (const char *) numBuf, sizeof(numBuf));
+      GWEN_Buffer_AppendBytes(stringBuf, name, strlen(name)+1);
+      GWEN_Buffer_AppendBytes(stringBuf, loc, strlen(loc)+1);
+
+      if (_addTrigrams(name, TRIGRAMIDX_FIELD_NAME, entryCount, &pairs, &pairCount, &pairSize) ||
+          _addTrigrams(loc, TRIGRAMIDX_FIELD_LOC, entryCount, &pairs, &pairCount, &pairSize)) {
+        rv=-1;
+        break;
+      }
+      entryCount++;
+    }
+    bi=AB_BankInfo_List_Next(bi);
+  }
+  if (GWEN_Buffer_GetUsedBytes(stringBuf)==0)
+    /* string table must never be empty */
+    GWEN_Buffer_AppendByte(stringBuf, 0);
+
+  if (rv==0) {
+    /* sort and remove duplicates */
+    qsort(pairs, pairCount, sizeof(TRIGRAM_PAIR), _cmpTrigramPairs);
+    postingCount=0;
+    for (i=0; i<pairCount; i++) {
+      if (postingCount==0 || _cmpTrigramPairs(&pairs[postingCount-1], &pairs[i])!=0) {
+        if (postingCount==0 || pairs[postingCount-1].key!=pairs[i].key)
+          trigramCount++;
+        pairs[postingCount++]=pairs[i];
+      }
+    }
+
+    entriesOffs=TRIGRAMIDX_HEADER_SIZE;
+    trigramsOffs=entriesOffs+GWEN_Buffer_GetUsedBytes(entryBuf);
+    postingsOffs=trigramsOffs+(trigramCount*12);
+    stringsOffs=postingsOffs+(postingCount*4);
+
+    memset(hdr, 0, sizeof(hdr));
+    memmove(hdr, TRIGRAMIDX_MAGIC, 4);
+    hdr[4]=(TRIGRAMIDX_VERSION>>8) & 0xff;
+    hdr[5]=TRIGRAMIDX_VERSION & 0xff;
+    _writeUint32(hdr+8, entryCount);
+    _writeUint32(hdr+12, trigramCount);
+    _writeUint32(hdr+16, entriesOffs);
+    _writeUint32(hdr+20, trigramsOffs);
+    _writeUint32(hdr+24, postingsOffs);
+    _writeUint32(hdr+28, stringsOffs);
+
+    f=fopen(fname, "wb");
+    if (!f) {
+      DBG_ERROR(0, "Error creating file \"%s\"", fname);
+      rv=-1;
+    }
+    else {
+      if (1!=fwrite(hdr, sizeof(hdr), 1, f) ||
+          1!=fwrite(GWEN_Buffer_GetStart(entryBuf), GWEN_Buffer_GetUsedBytes(entryBuf), 1, f))
+        rv=-1;
+
+      /* trigram table */
+      for (i=0; rv==0 && i<postingCount; i++) {
+        if (i==0 || pairs[i-1].key!=pairs[i].key) {
+          uint32_t j;
+
+          for (j=i; j<postingCount && pairs[j].key==pairs[i].key; j++);
+          if (_fwriteUint32(f, pairs[i].key) || _fwriteUint32(f, i) || _fwriteUint32(f, j-i))
+            rv=-1;
+        }
+      }
+
+      /* posting lists */
+      for (i=0; rv==0 && i<postingCount; i++) {
+        if (_fwriteUint32(f, pairs[i].entryNum))
+          rv=-1;
+      }
+
+      if (rv==0 &&
+          1!=fwrite(GWEN_Buffer_GetStart(stringBuf), GWEN_Buffer_GetUsedBytes(stringBuf), 1, f))
+        rv=-1;
+      if (rv)
+        DBG_ERROR(0, "Error writing file \"%s\"", fname);
+
+      if (fclose(f)) {
+        DBG_ERROR(0, "Error closing file \"%s\"", fname);
+        rv=-1;
+      }
+    }
+  }
+
+  free(pairs);
+  GWEN_Buffer_free(stringBuf);
+  GWEN_Buffer_free(entryBuf);
+  return rv;
+}
+
+
+
 int saveBankInfos(const char *path)
 {
   AB_BANKINFO *bi;
@@ -1982,6 +2351,72 @@ int main(int argc, char **argv)
       GWEN_Buffer_free(dbuf);
       return 3;
     }
+    GWEN_Buffer_Crop(dbuf, 0, pos);
+
+    fprintf(stdout, "- writing binary BLZ index...\n");
+    GWEN_Buffer_AppendString(dbuf, "blz.bidx");
+    if (makeBinIndex(GWEN_Buffer_GetStart(dbuf), 0)) {
+      fprintf(stderr, "Error saving index file.\n");
+      GWEN_Buffer_free(dbuf);
+      return 3;
+    }
+    GWEN_Buffer_Crop(dbuf, 0, pos);
+
+    fprintf(stdout, "- writing binary BIC index...\n");
+    GWEN_Buffer_AppendString(dbuf, "bic.bidx");
+    if (makeBinIndex(GWEN_Buffer_GetStart(dbuf), 1)) {
+      fprintf(stderr, "Error saving index file.\n");
+      GWEN_Buffer_free(dbuf);
+      return 3;
+    }
+    GWEN_Buffer_Crop(dbuf, 0, pos);
+
+    fprintf(stdout, "- writing NAMLOC trigram index...\n");
+    GWEN_Buffer_AppendString(dbuf, "namloc.tidx");
+    if (makeTrigramIndex(GWEN_Buffer_GetStart(dbuf))) {
+      fprintf(stderr, "Error saving index file.\n");
+      GWEN_Buffer_free(dbuf);
+      return 3;
+    }
+    GWEN_Buffer_free(dbuf);
+  }
+  else if (strcasecmp(argv[1], "trigram-index")==0) {
+    const char *path;
+    GWEN_BUFFER *dbuf;
+    uint32_t pos;
+
+    if (argc<3) {
+      fprintf(stderr,
+              "Usage:\n"
+              "%s trigram-index DATADIR\n",
+              argv[0]);
+      return 1;
+    }
+    path=argv[2];
+    bis=AB_BankInfo_List_new();
+    dbIdx=GWEN_DB_Group_new("indexList");
+
+    dbuf=GWEN_Buffer_new(0, 256, 0, 1);
+    GWEN_Buffer_AppendString(dbuf, path);
+    GWEN_Buffer_AppendByte(dbuf, GWEN_DIR_SEPARATOR);
+    pos=GWEN_Buffer_GetPos(dbuf);
+
+    /* positions of the entries are taken from the existing data file */
+    GWEN_Buffer_AppendString(dbuf, "banks.data");
+    if (loadBanks(GWEN_Buffer_GetStart(dbuf), bis)) {
+      fprintf(stderr, "Error loading data file.\n");
+      GWEN_Buffer_free(dbuf);
+      return 2;
+    }
+    GWEN_Buffer_Crop(dbuf, 0, pos);
+
+    fprintf(stdout, "- writing NAMLOC trigram index...\n");
+    GWEN_Buffer_AppendString(dbuf, "namloc.tidx");
+    if (makeTrigramIndex(GWEN_Buffer_GetStart(dbuf))) {
+      fprintf(stderr, "Error saving index file.\n");
+      GWEN_Buffer_free(dbuf);
+      return 3;
+    }
     GWEN_Buffer_free(dbuf);
   }
   else if (strcasecmp(argv[1], "update")==0) {